@@ -0,0 +1,763 @@
+/*!
+ *************************************************************************************
+ * \file codecbench.c
+ *
+ * \brief
+ *    Encoder and decoder benchmark with regression gating.
+ *
+ *    Synthetic 4:2:0 clips are generated at several resolutions: a gradient
+ *    moving by fractions of a pel, the same gradient with noise, a scene cut
+ *    to moving blocks and a cut to a gradient moving the other way. They
+ *    are generated with integer arithmetic only, so the clips and thus the
+ *    bitstreams are the same on every platform. Each clip is coded with a
+ *    set of standard configurations and decoded again. For every case the
+ *    frame rates of the encoder and the decoder, the module times of the
+ *    encoder (ModuleProfile) and the MD5 of the bitstream are recorded, and
+ *    the decoded pictures are checked against the reconstructed pictures of
+ *    the encoder. The fastest of the repeated runs counts; the short runs of
+ *    the decoder are averaged over at least MIN_DEC_MS first.
+ *
+ *    The results are written to results.txt in the current directory and
+ *    compared with the baseline. A changed bitstream, a decoder mismatch, a
+ *    bitstream that differs between runs or from the configuration it has to
+ *    match, or a frame rate more than the tolerance below the baseline fails
+ *    the run. For a slower encoder the
+ *    modules that slowed down most are listed.
+ *
+ *    Usage: codecbench -e <lencod> -d <ldecod> -c <cfg dir> [options]
+ *
+ * \author
+ *    Main contributors (see contributors.h for copyright, address and affiliation details)
+ *************************************************************************************
+ */
+
+#include "contributors.h"
+
+#include "global.h"
+
+#define MAX_CASES       64
+#define MAX_MODULES     32
+#define CMD_SIZE        4096
+#define MIN_RUN_MS      1.0   //!< lower limit of a measured time, avoids divisions by zero
+#define MIN_DEC_MS      250.0 //!< the decoder is run until this time is reached, its runs are short
+
+//! one coded resolution
+typedef struct bench_size
+{
+  char *name;
+  int   width;
+  int   height;
+} BenchSize;
+
+//! one encoder configuration: a configuration file of cfg/ and parameters changed on top of it.
+//! The search range and references of the exhaustive searches are reduced to keep the run time short.
+//! Configurations that must give the bitstream of another configuration name it in same_as.
+typedef struct bench_config
+{
+  char *name;
+  char *cfg_file;
+  char *params;
+  char *same_as;
+} BenchConfig;
+
+static const BenchSize sizes[] =
+{
+  { "qcif", 176, 144 },
+  { "cif",  352, 288 },
+};
+
+static const BenchConfig configs[] =
+{
+  { "baseline",    "encoder_baseline.cfg", "-p SearchRange=16" },
+  { "main",        "encoder_main.cfg",     "-p SearchRange=16" },
+  { "high",        "encoder.cfg",          "" },
+  { "md_low",      "encoder.cfg",          "-p RDOptimization=0" },
+  { "md_highfast", "encoder.cfg",          "-p RDOptimization=2 -p ProfileIDC=77 -p Transform8x8Mode=0" },
+  { "umhex",       "encoder.cfg",          "-p SearchMode=1 -p HMEEnable=0 -p UseDistortionReorder=0" },
+  { "full_search", "encoder.cfg",          "-p SearchMode=-1 -p SearchRange=16 -p NumberReferenceFrames=2 -p HMEEnable=0 -p UseDistortionReorder=0" },
+  { "cavlc",       "encoder.cfg",          "-p SymbolMode=0" },
+  { "rdpic_serial",   "encoder.cfg",       "-p AdaptiveRounding=0 -p ContextInitMethod=0 -p RDPictureDecision=1 -p IntraPeriod=3"
+                                           " -p RDPictureMaxPassISlice=3 -p RDPictureMaxPassPSlice=1 -p RDPictureMaxPassBSlice=1 -p RDPictureParallel=0" },
+  { "rdpic_parallel", "encoder.cfg",       "-p AdaptiveRounding=0 -p ContextInitMethod=0 -p RDPictureDecision=1 -p IntraPeriod=3"
+                                           " -p RDPictureMaxPassISlice=3 -p RDPictureMaxPassPSlice=1 -p RDPictureMaxPassBSlice=1 -p RDPictureParallel=1",
+                                           "rdpic_serial" },
+};
+
+//! result of one case, as written to the results and baseline files
+typedef struct bench_result
+{
+  char   name[64];
+  int    frames;
+  double enc_fps;
+  double dec_fps;
+  char   md5[33];
+  int    match;                              //!< decoded pictures equal the reconstructed ones
+  int    stable;                             //!< same bitstream in all runs
+  int    num_modules;
+  char   module[MAX_MODULES][32];
+  double module_ms[MAX_MODULES];             //!< encoder module times of the fastest run
+  char   same_as[64];                        //!< case with the same bitstream, not stored
+} BenchResult;
+
+//! command line options
+typedef struct bench_options
+{
+  char  *encoder;
+  char  *decoder;
+  char  *cfg_dir;
+  char  *baseline;
+  char  *filter;
+  int    update;
+  int    repeats;
+  int    frames;
+  double tolerance;                          //!< in percent
+} BenchOptions;
+
+char errortext[ET_SIZE];
+
+void error(char *text, int code)
+{
+  fprintf(stderr, "%s\n", text);
+  exit(code);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    MD5 (RFC 1321) of one 64 byte block
+ ************************************************************************
+ */
+static void md5_block(uint32 h[4], const byte *p)
+{
+  static const uint32 k[64] =
+  {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+  };
+  static const int r[4][4] = { { 7, 12, 17, 22 }, { 5, 9, 14, 20 }, { 4, 11, 16, 23 }, { 6, 10, 15, 21 } };
+  uint32 w[16], a = h[0], b = h[1], c = h[2], d = h[3], f, t;
+  int i, g;
+
+  for (i = 0; i < 16; ++i)
+    w[i] = p[4 * i] | (p[4 * i + 1] << 8) | (p[4 * i + 2] << 16) | ((uint32) p[4 * i + 3] << 24);
+
+  for (i = 0; i < 64; ++i)
+  {
+    if (i < 16)
+    {
+      f = (b & c) | (~b & d);
+      g = i;
+    }
+    else if (i < 32)
+    {
+      f = (d & b) | (~d & c);
+      g = (5 * i + 1) & 15;
+    }
+    else if (i < 48)
+    {
+      f = b ^ c ^ d;
+      g = (3 * i + 5) & 15;
+    }
+    else
+    {
+      f = c ^ (b | ~d);
+      g = (7 * i) & 15;
+    }
+    t = a + f + k[i] + w[g];
+    a = d;
+    d = c;
+    c = b;
+    b += (t << r[i >> 4][i & 3]) | (t >> (32 - r[i >> 4][i & 3]));
+  }
+
+  h[0] += a;
+  h[1] += b;
+  h[2] += c;
+  h[3] += d;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    MD5 of a file as hex string
+ * \return
+ *    0 if the file can not be read
+ ************************************************************************
+ */
+static int md5_file(const char *name, char md5[33])
+{
+  uint32 h[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+  byte   block[64];
+  int64  length = 0;
+  size_t n;
+  int    i;
+  FILE  *f;
+
+  if ((f = fopen(name, "rb")) == NULL)
+    return 0;
+
+  while ((n = fread(block, 1, 64, f)) == 64)
+  {
+    md5_block(h, block);
+    length += 64;
+  }
+  fclose(f);
+
+  // padding and length in bits
+  length += n;
+  block[n++] = 0x80;
+  if (n > 56)
+  {
+    memset(block + n, 0, 64 - n);
+    md5_block(h, block);
+    n = 0;
+  }
+  memset(block + n, 0, 56 - n);
+  for (i = 0; i < 8; ++i)
+    block[56 + i] = (byte) ((length << 3) >> (8 * i));
+  md5_block(h, block);
+
+  for (i = 0; i < 16; ++i)
+    sprintf(md5 + 2 * i, "%02x", (h[i >> 2] >> (8 * (i & 3))) & 0xff);
+  return 1;
+}
+
+//! triangle wave of period 2 * half, values 0..half-1
+static int triangle(int v, int half)
+{
+  v %= 2 * half;
+  if (v < 0)
+    v += 2 * half;
+  return (v < half) ? v : 2 * half - 1 - v;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Write the synthetic 4:2:0 clip. The frames are split into four
+ *    segments: a gradient moving by 2.5 pels horizontally and 1.5 pels
+ *    vertically per frame, the same gradient with noise, moving blocks
+ *    and a gradient moving the other way.
+ ************************************************************************
+ */
+static int write_clip(const char *name, int width, int height, int frames)
+{
+  byte  *buf;
+  uint32 seed = 12345;
+  int    size = width * height;
+  int    cw = width / 2, ch = height / 2;
+  int    t, x, y, segment, dir, noise, block;
+  FILE  *f;
+
+  if ((f = fopen(name, "wb")) == NULL)
+    return 0;
+  if ((buf = (byte *) malloc(size + 2 * cw * ch)) == NULL)
+    error("write_clip: buf", 100);
+
+  for (t = 0; t < frames; ++t)
+  {
+    segment = (4 * t) / frames;
+    dir     = (segment == 3) ? -1 : 1;
+
+    for (y = 0; y < height; ++y)
+    {
+      for (x = 0; x < width; ++x)
+      {
+        int v;
+
+        if (segment == 2)
+        {
+          block = (((x + 3 * t) / 24) + ((y + 2 * t) / 16)) & 1;
+          v = (block ? 176 : 64) + ((x + 3 * t) & 15);
+        }
+        else
+          v = 24 + (triangle(4 * x + dir * 10 * t, 512) + triangle(4 * y + 6 * t, 384)) * 200 / 894;
+
+        if (segment == 1)
+        {
+          seed  = seed * 1103515245 + 12345;
+          noise = (int) ((seed >> 16) % 25) - 12;
+          v += noise;
+        }
+        buf[y * width + x] = (byte) iClip3(16, 235, v);
+      }
+    }
+
+    for (y = 0; y < ch; ++y)
+    {
+      for (x = 0; x < cw; ++x)
+      {
+        byte *u = buf + size + y * cw + x;
+        byte *v = u + cw * ch;
+
+        if (segment == 2)
+        {
+          block = (((2 * x + 3 * t) / 24) + ((2 * y + 2 * t) / 16)) & 1;
+          *u = (byte) (block ? 96 : 160);
+          *v = (byte) (block ? 150 : 110);
+        }
+        else
+        {
+          *u = (byte) (96 + triangle(2 * x + dir * 5 * t, 64));
+          *v = (byte) (96 + triangle(2 * y + 3 * t, 64));
+        }
+      }
+    }
+
+    if (fwrite(buf, 1, size + 2 * cw * ch, f) != (size_t) (size + 2 * cw * ch))
+    {
+      free(buf);
+      fclose(f);
+      return 0;
+    }
+  }
+
+  free(buf);
+  fclose(f);
+  return 1;
+}
+
+//! run a command, return its exit code and the wall time in ms
+static int run(const char *cmd, double *ms)
+{
+  TIME_T start, end;
+  int    rc;
+
+  gettime(&start);
+  rc = system(cmd);
+  gettime(&end);
+  *ms = dmax(MIN_RUN_MS, (double) timenorm(1000 * timediff(&start, &end)) / 1000.0);
+
+  return rc;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Read the module times of the sequence from the profile written by
+ *    the encoder (the first "modules" object)
+ ************************************************************************
+ */
+static void read_profile(const char *name, BenchResult *res)
+{
+  char  *text, *p, *end;
+  long   size;
+  FILE  *f;
+
+  res->num_modules = 0;
+  if ((f = fopen(name, "rb")) == NULL)
+    return;
+  fseek(f, 0, SEEK_END);
+  size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  if ((text = (char *) calloc(size + 1, 1)) == NULL)
+    error("read_profile: text", 100);
+  size = (long) fread(text, 1, size, f);
+  fclose(f);
+
+  // "modules": { "name": { "ms": 1.0, "calls": 1 }, ... }
+  if ((p = strstr(text, "\"modules\"")) != NULL && (p = strchr(p, '{')) != NULL)
+  {
+    while (res->num_modules < MAX_MODULES)
+    {
+      char  *q;
+      size_t len;
+
+      p += strspn(p + 1, " \t\r\n,") + 1;
+      if (*p != '"' || (q = strchr(p + 1, '"')) == NULL || (end = strchr(q, '}')) == NULL)
+        break;
+      len = imin((int) (q - p - 1), 31);
+      strncpy(res->module[res->num_modules], p + 1, len);
+      res->module[res->num_modules][len] = '\0';
+      if ((q = strstr(q, "\"ms\":")) != NULL && q < end)
+        res->module_ms[res->num_modules] = atof(q + 5);
+      ++res->num_modules;
+      p = end;
+    }
+  }
+  free(text);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Encode and decode one case
+ * \return
+ *    0 if the encoder or the decoder failed
+ ************************************************************************
+ */
+static int run_case(BenchOptions *opt, const BenchConfig *cfg, const BenchSize *sz, const char *clip, BenchResult *res)
+{
+  char   cmd[CMD_SIZE], stream[256], rec[256], dec[256], stats[256], profile[256], md5[33], rec_md5[33], dec_md5[33];
+  double ms, best_enc = 0.0, best_dec = 0.0;
+  int    i;
+
+  snprintf(res->name, sizeof(res->name), "%s_%s", cfg->name, sz->name);
+  snprintf(stream,  sizeof(stream),  "%s.264", res->name);
+  snprintf(rec,     sizeof(rec),     "%s_rec.yuv", res->name);
+  snprintf(dec,     sizeof(dec),     "%s_dec.yuv", res->name);
+  snprintf(stats,   sizeof(stats),   "%s.dat", res->name);
+  snprintf(profile, sizeof(profile), "%s.profile.json", res->name);
+  res->frames = opt->frames;
+  res->match  = 0;
+  res->stable = 1;
+  strcpy(res->md5, "-");
+
+  for (i = 0; i < opt->repeats; ++i)
+  {
+    snprintf(cmd, CMD_SIZE, "\"%s\" -d \"%s/%s\" %s -p InputFile=%s -p SourceWidth=%d -p SourceHeight=%d"
+      " -p OutputWidth=%d -p OutputHeight=%d -p FramesToBeEncoded=%d -p StartFrame=0 -p ModuleProfile=1"
+      " -p OutputFile=%s -p ReconFile=%s -p StatsFile=%s > %s.enc.log 2>&1",
+      opt->encoder, opt->cfg_dir, cfg->cfg_file, cfg->params, clip, sz->width, sz->height,
+      sz->width, sz->height, opt->frames, stream, rec, stats, res->name);
+    if (run(cmd, &ms) != 0 || !md5_file(stream, md5))
+    {
+      fprintf(stderr, "%s: encoder failed, see %s.enc.log\n", res->name, res->name);
+      return 0;
+    }
+    if (i == 0)
+      strcpy(res->md5, md5);
+    else if (strcmp(res->md5, md5))
+      res->stable = 0;
+    if (i == 0 || ms < best_enc)
+    {
+      best_enc = ms;
+      read_profile(profile, res);
+    }
+  }
+
+  snprintf(cmd, CMD_SIZE, "\"%s\" -d \"%s/decoder.cfg\" -p InputFile=%s -p OutputFile=%s -p RefFile=%s > %s.dec.log 2>&1",
+    opt->decoder, opt->cfg_dir, stream, dec, rec, res->name);
+  for (i = 0; i < opt->repeats; ++i)
+  {
+    double total = 0.0;
+    int    runs = 0;
+
+    do
+    {
+      if (run(cmd, &ms) != 0)
+      {
+        fprintf(stderr, "%s: decoder failed, see %s.dec.log\n", res->name, res->name);
+        return 0;
+      }
+      total += ms;
+      ++runs;
+    } while (total < MIN_DEC_MS);
+
+    if (i == 0 || total / runs < best_dec)
+      best_dec = total / runs;
+  }
+
+  res->match   = md5_file(rec, rec_md5) && md5_file(dec, dec_md5) && !strcmp(rec_md5, dec_md5);
+  res->enc_fps = 1000.0 * opt->frames / best_enc;
+  res->dec_fps = 1000.0 * opt->frames / best_dec;
+
+  // the pictures are large and only needed for the comparison
+  remove(rec);
+  remove(dec);
+  return 1;
+}
+
+static void write_results(const char *name, BenchResult *res, int num)
+{
+  FILE *f;
+  int   i, j;
+
+  if ((f = fopen(name, "w")) == NULL)
+  {
+    fprintf(stderr, "Error open file %s\n", name);
+    exit(500);
+  }
+  fprintf(f, "# codecbench results: case frames enc_fps dec_fps md5 match stable, encoder module times in ms\n");
+  for (i = 0; i < num; ++i)
+  {
+    fprintf(f, "%s frames=%d enc_fps=%.3f dec_fps=%.3f md5=%s match=%d stable=%d", res[i].name, res[i].frames,
+      res[i].enc_fps, res[i].dec_fps, res[i].md5, res[i].match, res[i].stable);
+    for (j = 0; j < res[i].num_modules; ++j)
+      fprintf(f, " %s=%.3f", res[i].module[j], res[i].module_ms[j]);
+    fprintf(f, "\n");
+  }
+  fclose(f);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Read a results file
+ * \return
+ *    number of cases read, -1 if the file can not be opened
+ ************************************************************************
+ */
+static int read_results(const char *name, BenchResult *res)
+{
+  char  line[4096], *tok;
+  int   num = 0;
+  FILE *f;
+
+  if ((f = fopen(name, "r")) == NULL)
+    return -1;
+
+  while (num < MAX_CASES && fgets(line, sizeof(line), f) != NULL)
+  {
+    BenchResult *r = &res[num];
+
+    if (line[0] == '#' || (tok = strtok(line, " \t\r\n")) == NULL)
+      continue;
+    memset(r, 0, sizeof(BenchResult));
+    strncpy(r->name, tok, sizeof(r->name) - 1);
+    strcpy(r->md5, "-");
+    while ((tok = strtok(NULL, " \t\r\n")) != NULL)
+    {
+      char *val = strchr(tok, '=');
+
+      if (val == NULL)
+        continue;
+      *val++ = '\0';
+      if (!strcmp(tok, "frames"))
+        r->frames = atoi(val);
+      else if (!strcmp(tok, "enc_fps"))
+        r->enc_fps = atof(val);
+      else if (!strcmp(tok, "dec_fps"))
+        r->dec_fps = atof(val);
+      else if (!strcmp(tok, "md5"))
+      {
+        strncpy(r->md5, val, 32);
+        r->md5[32] = '\0';
+      }
+      else if (!strcmp(tok, "match"))
+        r->match = atoi(val);
+      else if (!strcmp(tok, "stable"))
+        r->stable = atoi(val);
+      else if (r->num_modules < MAX_MODULES)
+      {
+        strncpy(r->module[r->num_modules], tok, 31);
+        r->module_ms[r->num_modules++] = atof(val);
+      }
+    }
+    ++num;
+  }
+  fclose(f);
+  return num;
+}
+
+static double module_ms(BenchResult *res, const char *module)
+{
+  int i;
+
+  for (i = 0; i < res->num_modules; ++i)
+  {
+    if (!strcmp(res->module[i], module))
+      return res->module_ms[i];
+  }
+  return 0.0;
+}
+
+//! list the three modules whose time per frame grew most
+static void report_slow_modules(BenchResult *cur, BenchResult *base)
+{
+  int    used[MAX_MODULES] = { 0 };
+  int    i, k, best;
+  double growth, best_growth;
+
+  printf("      modules slowed down most (ms per frame):");
+  for (k = 0; k < 3; ++k)
+  {
+    best = -1;
+    best_growth = 0.0;
+    for (i = 0; i < cur->num_modules; ++i)
+    {
+      growth = cur->module_ms[i] / cur->frames - module_ms(base, cur->module[i]) / imax(1, base->frames);
+      if (!used[i] && growth > best_growth)
+      {
+        best = i;
+        best_growth = growth;
+      }
+    }
+    if (best < 0)
+      break;
+    used[best] = 1;
+    printf(" %s +%.2f", cur->module[best], best_growth);
+  }
+  printf("%s\n", k ? "" : " none");
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Compare the results with the baseline
+ * \return
+ *    number of failed cases
+ ************************************************************************
+ */
+static int compare(BenchOptions *opt, BenchResult *res, int num, BenchResult *base, int num_base)
+{
+  double limit = 1.0 - opt->tolerance / 100.0;
+  int    failed = 0;
+  int    i, j;
+
+  printf("\n%-20s %10s %10s %7s %10s %10s %7s  %s\n", "case", "enc fps", "baseline", "change",
+    "dec fps", "baseline", "change", "status");
+  for (i = 0; i < num; ++i)
+  {
+    BenchResult *cur = &res[i];
+    BenchResult *ref = NULL;
+    char status[256] = "";
+
+    for (j = 0; j < num_base; ++j)
+    {
+      if (!strcmp(base[j].name, cur->name))
+        ref = &base[j];
+    }
+
+    if (!strcmp(cur->md5, "-"))
+      strcat(status, " FAILED");
+    if (!cur->match && strcmp(cur->md5, "-"))
+      strcat(status, " DECODER MISMATCH");
+    if (!cur->stable)
+      strcat(status, " NONDETERMINISTIC");
+    for (j = 0; j < num && cur->same_as[0]; ++j)
+    {
+      if (!strcmp(res[j].name, cur->same_as) && strcmp(res[j].md5, cur->md5))
+      {
+        strcat(status, " DIFFERS FROM ");
+        strncat(status, cur->same_as, 64);
+      }
+    }
+
+    if (ref == NULL)
+    {
+      printf("%-20s %10.2f %10s %7s %10.2f %10s %7s %s\n", cur->name, cur->enc_fps, "-", "", cur->dec_fps, "-", "",
+        status[0] ? status : " new");
+    }
+    else
+    {
+      int slow_enc = cur->enc_fps < ref->enc_fps * limit;
+
+      if (ref->frames != cur->frames)
+        strcat(status, " FRAMES DIFFER");
+      else if (strcmp(cur->md5, ref->md5))
+        strcat(status, " BITSTREAM CHANGED");
+      if (slow_enc)
+        strcat(status, " ENCODER SLOWER");
+      if (cur->dec_fps < ref->dec_fps * limit)
+        strcat(status, " DECODER SLOWER");
+
+      printf("%-20s %10.2f %10.2f %+6.1f%% %10.2f %10.2f %+6.1f%% %s\n", cur->name,
+        cur->enc_fps, ref->enc_fps, ref->enc_fps > 0 ? 100.0 * (cur->enc_fps / ref->enc_fps - 1.0) : 0.0,
+        cur->dec_fps, ref->dec_fps, ref->dec_fps > 0 ? 100.0 * (cur->dec_fps / ref->dec_fps - 1.0) : 0.0,
+        status[0] ? status : " ok");
+      if (slow_enc)
+        report_slow_modules(cur, ref);
+    }
+
+    if (status[0])
+      ++failed;
+  }
+  return failed;
+}
+
+static void usage(void)
+{
+  fprintf(stderr,
+    "Usage: codecbench -e <lencod> -d <ldecod> -c <cfg dir> [options]\n"
+    "   -b <file>   baseline (default baseline.txt)\n"
+    "   -u          store the results as new baseline\n"
+    "   -r <n>      runs per case, the fastest counts (default 3)\n"
+    "   -t <pct>    tolerated frame rate drop in percent (default 5)\n"
+    "   -f <n>      frames per clip (default 17)\n"
+    "   -s <text>   only run the cases whose name contains text\n"
+    "The clips and the results (results.txt) are written to the current directory.\n");
+  exit(1);
+}
+
+int main(int argc, char **argv)
+{
+  static BenchResult res[MAX_CASES], base[MAX_CASES];
+  BenchOptions opt = { NULL, NULL, NULL, "baseline.txt", NULL, 0, 3, 17, 5.0 };
+  char   clip[64];
+  int    num = 0, num_base, failed, clip_written;
+  int    i, c, s;
+
+  for (i = 1; i < argc; ++i)
+  {
+    if (argv[i][0] != '-' || strlen(argv[i]) != 2)
+      usage();
+    if (argv[i][1] == 'u')
+    {
+      opt.update = 1;
+      continue;
+    }
+    if (i + 1 >= argc)
+      usage();
+    switch (argv[i][1])
+    {
+    case 'e': opt.encoder   = argv[++i];       break;
+    case 'd': opt.decoder   = argv[++i];       break;
+    case 'c': opt.cfg_dir   = argv[++i];       break;
+    case 'b': opt.baseline  = argv[++i];       break;
+    case 's': opt.filter    = argv[++i];       break;
+    case 'r': opt.repeats   = atoi(argv[++i]); break;
+    case 't': opt.tolerance = atof(argv[++i]); break;
+    case 'f': opt.frames    = atoi(argv[++i]); break;
+    default:  usage();
+    }
+  }
+  if (opt.encoder == NULL || opt.decoder == NULL || opt.cfg_dir == NULL || opt.repeats < 1 || opt.frames < 1)
+    usage();
+
+  init_time();
+
+  for (s = 0; s < (int) (sizeof(sizes) / sizeof(sizes[0])); ++s)
+  {
+    snprintf(clip, sizeof(clip), "synth_%s_%d.yuv", sizes[s].name, opt.frames);
+    clip_written = 0;
+
+    for (c = 0; c < (int) (sizeof(configs) / sizeof(configs[0])) && num < MAX_CASES; ++c)
+    {
+      char name[64];
+
+      snprintf(name, sizeof(name), "%s_%s", configs[c].name, sizes[s].name);
+      if (opt.filter != NULL && strstr(name, opt.filter) == NULL)
+        continue;
+      if (!clip_written && !(clip_written = write_clip(clip, sizes[s].width, sizes[s].height, opt.frames)))
+      {
+        fprintf(stderr, "Error writing %s\n", clip);
+        return 1;
+      }
+
+      printf("%-20s", name);
+      fflush(stdout);
+      if (!run_case(&opt, &configs[c], &sizes[s], clip, &res[num]))
+        strcpy(res[num].md5, "-");
+      if (configs[c].same_as != NULL)
+        snprintf(res[num].same_as, sizeof(res[num].same_as), "%s_%s", configs[c].same_as, sizes[s].name);
+      printf(" enc %8.2f fps  dec %8.2f fps  %s\n", res[num].enc_fps, res[num].dec_fps, res[num].md5);
+      ++num;
+    }
+  }
+
+  write_results("results.txt", res, num);
+
+  // without a baseline only the failures of the cases themselves are checked
+  num_base = opt.update ? 0 : read_results(opt.baseline, base);
+  failed   = compare(&opt, res, num, base, imax(0, num_base));
+  if (failed)
+    printf("\n%d of %d cases FAILED (tolerance %.1f%%, baseline %s)\n", failed, num, opt.tolerance, opt.baseline);
+  else
+    printf("\nAll %d cases passed (tolerance %.1f%%, baseline %s)\n", num, opt.tolerance, opt.baseline);
+
+  if (failed)
+    return 1;
+  if (opt.update || num_base < 0)
+  {
+    write_results(opt.baseline, res, num);
+    printf("Results stored as baseline %s\n", opt.baseline);
+  }
+  return 0;
+}
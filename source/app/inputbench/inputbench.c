@@ -0,0 +1,331 @@
+
+/*!
+ *************************************************************************************
+ * \file inputbench.c
+ *
+ * \brief
+ *    Micro-benchmark of the input format converters (img_convert.c).
+ *
+ *    For every supported PixelFormat / Interleaved / sample size / bit depth
+ *    combination a random source frame is converted to padded image planes
+ *    the way read_one_frame() does it (deinterleave, buf2img, pad_borders),
+ *    at 1080p and 4K. The result is checked against a plain per-sample
+ *    reference conversion and the frame rate of both is reported.
+ *
+ *    Usage: inputbench [min_seconds_per_test]
+ *
+ * \author
+ *    Main contributors (see contributors.h for copyright, address and affiliation details)
+ *************************************************************************************
+ */
+
+#include "contributors.h"
+
+#include "global.h"
+#include "memalloc.h"
+#include "img_convert.h"
+
+//! one tested source format
+typedef struct bench_format
+{
+  char *name;
+  int   yuv_format;
+  int   pixel_format;
+  int   interleaved;
+  int   symbol_size_in_bytes;   //!< sample size in the file
+  int   bit_depth;              //!< bit depth of the file samples
+  int   out_bit_depth;          //!< bit depth of the image planes
+} BenchFormat;
+
+static const BenchFormat formats[] =
+{
+  { "planar 4:2:0  8 bit",         YUV420, 0,    0, 1,  8,  8 },
+  { "planar 4:2:0 10 bit",         YUV420, 0,    0, 2, 10, 10 },
+  { "planar 4:2:0 10->8 bit",      YUV420, 0,    0, 2, 10,  8 },
+  { "planar 4:2:0  8->10 bit",     YUV420, 0,    0, 1,  8, 10 },
+  { "planar 4:4:4 12 bit",         YUV444, 0,    0, 2, 12, 12 },
+  { "interleaved 4:2:0  8 bit",    YUV420, 0,    1, 1,  8,  8 },
+  { "interleaved 4:2:0 10 bit",    YUV420, 0,    1, 2, 10, 10 },
+  { "interleaved 4:4:4  8 bit",    YUV444, 0,    1, 1,  8,  8 },
+  { "interleaved 4:4:4 10->8 bit", YUV444, 0,    1, 2, 10,  8 },
+  { "YUYV  8 bit",                 YUV422, YUYV, 1, 1,  8,  8 },
+  { "YVYU  8 bit",                 YUV422, YVYU, 1, 1,  8,  8 },
+  { "UYVY  8 bit",                 YUV422, UYVY, 1, 1,  8,  8 },
+  { "YUYV 10 bit",                 YUV422, YUYV, 1, 2, 10, 10 },
+  { "UYVY 10->8 bit",              YUV422, UYVY, 1, 2, 10,  8 },
+  { "V210",                        YUV422, V210, 1, 2, 10, 10 },
+};
+
+static const int sizes[][2] = { { 1920, 1080 }, { 3840, 2160 } };
+
+char errortext[ET_SIZE];
+
+void error(char *text, int code)
+{
+  fprintf(stderr, "%s\n", text);
+  exit(code);
+}
+
+int testEndian(void)
+{
+  short s;
+  byte *p;
+
+  p = (byte*)&s;
+  s = 1;
+
+  return (*p == 0);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Component order of the packed formats (0: Y, 1: U, 2: V)
+ ************************************************************************
+ */
+static int get_pattern(const BenchFormat *fmt, int pattern[6])
+{
+  static const int p420[6] = { 1, 0, 0, 2, 0, 0 };
+  static const int p444[3] = { 0, 1, 2 };
+  static const int puyvy[4] = { 1, 0, 2, 0 };
+  static const int pyuyv[4] = { 0, 1, 0, 2 };
+  static const int pyvyu[4] = { 0, 2, 0, 1 };
+
+  if (fmt->yuv_format == YUV420)
+  {
+    memcpy(pattern, p420, sizeof(p420));
+    return 6;
+  }
+  if (fmt->yuv_format == YUV444)
+  {
+    memcpy(pattern, p444, sizeof(p444));
+    return 3;
+  }
+  memcpy(pattern, (fmt->pixel_format == YUYV) ? pyuyv : (fmt->pixel_format == YVYU) ? pyvyu : puyvy, sizeof(puyvy));
+  return 4;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Per-sample reference conversion of a file buffer to padded planes
+ ************************************************************************
+ */
+static void ref_convert(const BenchFormat *fmt, FrameFormat *source, byte *buf, imgpel **img[3], int pad_x[2], int pad_y[2])
+{
+  int sss = fmt->symbol_size_in_bytes;
+  int bitshift = fmt->bit_depth - fmt->out_bit_depth;
+  int pattern[6], group, pos[3] = { 0, 0, 0 };
+  int i, k, x, y, c;
+  int *plane[3];
+
+  for (k = 0; k < 3; k++)
+    plane[k] = (int *) malloc(source->size_cmp[k] * sizeof(int));
+
+  if (fmt->pixel_format == V210 && fmt->interleaved)
+  {
+    // 6 samples (UYVYUY ...) in 3 ten bit fields of 4 words
+    unsigned int *word = (unsigned int *) buf;
+    for (i = 0; i < (source->size_cmp[1] / 3) * 12; i++)
+    {
+      c = (i & 1) ? 0 : ((i & 3) == 0 ? 1 : 2);
+      plane[c][pos[c]++] = (word[i / 3] >> (10 * (i % 3))) & 0x3FF;
+    }
+  }
+  else if (fmt->interleaved)
+  {
+    group = get_pattern(fmt, pattern);
+    for (i = 0; i < source->size; i++)
+    {
+      c = pattern[i % group];
+      plane[c][pos[c]++] = (sss == 1) ? buf[i] : ((uint16 *) buf)[i];
+    }
+  }
+  else
+  {
+    for (i = 0; i < source->size; i++)
+    {
+      c = (i < source->size_cmp[0]) ? 0 : (i < source->size_cmp[0] + source->size_cmp[1]) ? 1 : 2;
+      plane[c][pos[c]++] = (sss == 1) ? buf[i] : ((uint16 *) buf)[i];
+    }
+  }
+
+  for (k = 0; k < 3; k++)
+  {
+    int w = source->width[k != 0], h = source->height[k != 0];
+    for (y = 0; y < pad_y[k != 0]; y++)
+    {
+      for (x = 0; x < pad_x[k != 0]; x++)
+        img[k][y][x] = (imgpel) rshift_rnd(plane[k][imin(y, h - 1) * w + imin(x, w - 1)], bitshift);
+    }
+    free(plane[k]);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Convert a file buffer the way read_one_frame() does
+ ************************************************************************
+ */
+static void convert(const BenchFormat *fmt, FrameFormat *source, FrameFormat *output, byte **buf, byte **ibuf, imgpel **img[3], int pad_x[2], int pad_y[2])
+{
+  int sss = fmt->symbol_size_in_bytes;
+  int bitshift = fmt->bit_depth - fmt->out_bit_depth;
+  int bytes_y  = source->size_cmp[0] * sss;
+  int bytes_uv = source->size_cmp[1] * sss;
+  byte *in = *buf;
+
+  if (fmt->interleaved)
+    deinterleave(buf, ibuf, source, sss);
+
+  if (bitshift)
+  {
+    buf2img_bitshift(img[0], *buf, source->width[0], source->height[0], output->width[0], output->height[0], sss, bitshift);
+    buf2img_bitshift(img[1], *buf + bytes_y, source->width[1], source->height[1], output->width[1], output->height[1], sss, bitshift);
+    buf2img_bitshift(img[2], *buf + bytes_y + bytes_uv, source->width[1], source->height[1], output->width[1], output->height[1], sss, bitshift);
+  }
+  else
+  {
+    buf2img_basic(img[0], *buf, source->width[0], source->height[0], output->width[0], output->height[0], sss, 0);
+    buf2img_basic(img[1], *buf + bytes_y, source->width[1], source->height[1], output->width[1], output->height[1], sss, 0);
+    buf2img_basic(img[2], *buf + bytes_y + bytes_uv, source->width[1], source->height[1], output->width[1], output->height[1], sss, 0);
+  }
+  pad_borders(*output, pad_x[0], pad_y[0], pad_x[1], pad_y[1], img);
+
+  // keep the source frame in the first buffer
+  if (*buf != in)
+  {
+    *ibuf = *buf;
+    *buf = in;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Run one format at one size
+ * \return
+ *    0 if the converted planes differ from the reference
+ ************************************************************************
+ */
+static int run(const BenchFormat *fmt, int width, int height, double min_time)
+{
+  FrameFormat source, output;
+  imgpel **img[3], **ref[3];
+  byte *buf, *ibuf, *src;
+  int pad_x[2], pad_y[2];
+  int buf_size, i, k, y, frames, ok = 1;
+  int64 fmt_time, ref_time;
+  TIME_T start, end;
+
+  memset(&source, 0, sizeof(FrameFormat));
+  source.yuv_format = fmt->yuv_format;
+  source.pixel_format = fmt->pixel_format;
+  source.width[0] = width;
+  source.height[0] = height;
+  source.width[1] = source.width[2] = (fmt->yuv_format == YUV444) ? width : width >> 1;
+  source.height[1] = source.height[2] = (fmt->yuv_format == YUV420) ? height >> 1 : height;
+  source.size_cmp[0] = width * height;
+  source.size_cmp[1] = source.size_cmp[2] = source.width[1] * source.height[1];
+  source.size = source.size_cmp[0] + 2 * source.size_cmp[1];
+  output = source;
+
+  pad_x[0] = (width + 15) & ~15;
+  pad_y[0] = (height + 15) & ~15;
+  pad_x[1] = pad_x[0] * source.width[1] / width;
+  pad_y[1] = pad_y[0] * source.height[1] / height;
+
+  buf_size = source.size * 4;
+  if ((src = (byte *) malloc(buf_size)) == NULL)
+    no_mem_exit("run: src");
+  if ((buf = (byte *) malloc(buf_size)) == NULL)
+    no_mem_exit("run: buf");
+  if ((ibuf = (byte *) malloc(buf_size)) == NULL)
+    no_mem_exit("run: ibuf");
+
+  // random samples of the file bit depth
+  for (i = 0; i < buf_size / 2; i++)
+  {
+    if (fmt->symbol_size_in_bytes == 1)
+      src[i] = (byte) (rand() & 0xFF);
+    else
+      ((uint16 *) src)[i] = (uint16) (rand() & ((1 << fmt->bit_depth) - 1));
+  }
+  if (fmt->pixel_format == V210 && fmt->interleaved)
+  {
+    for (i = 0; i < buf_size / 4; i++)
+      ((unsigned int *) src)[i] = ((unsigned int) rand() << 16) ^ (unsigned int) rand();
+  }
+
+  for (k = 0; k < 3; k++)
+  {
+    get_mem2Dpel(&img[k], pad_y[k != 0], pad_x[k != 0]);
+    get_mem2Dpel(&ref[k], pad_y[k != 0], pad_x[k != 0]);
+  }
+
+  // reference
+  frames = 0;
+  gettime(&start);
+  do
+  {
+    ref_convert(fmt, &source, src, ref, pad_x, pad_y);
+    ++frames;
+    gettime(&end);
+  } while (timediff(&start, &end) < min_time * 1e6 / 4);
+  ref_time = timediff(&start, &end) / frames;
+
+  // converters
+  memcpy(buf, src, buf_size);
+  convert(fmt, &source, &output, &buf, &ibuf, img, pad_x, pad_y);
+  for (k = 0; k < 3; k++)
+  {
+    for (y = 0; y < pad_y[k != 0]; y++)
+      ok &= (memcmp(img[k][y], ref[k][y], pad_x[k != 0] * sizeof(imgpel)) == 0);
+  }
+
+  frames = 0;
+  gettime(&start);
+  do
+  {
+    memcpy(buf, src, buf_size);
+    convert(fmt, &source, &output, &buf, &ibuf, img, pad_x, pad_y);
+    ++frames;
+    gettime(&end);
+  } while (timediff(&start, &end) < min_time * 1e6);
+  fmt_time = timediff(&start, &end) / frames;
+
+  printf("%-28s %4dx%-4d %8.3f ms %8.1f fps   reference %8.3f ms   x%5.2f  %s\n", fmt->name, width, height,
+    fmt_time / 1000.0, 1e6 / imax(1, (int) fmt_time), ref_time / 1000.0, (double) ref_time / imax(1, (int) fmt_time), ok ? "ok" : "MISMATCH");
+
+  for (k = 0; k < 3; k++)
+  {
+    free_mem2Dpel(img[k]);
+    free_mem2Dpel(ref[k]);
+  }
+  free(src);
+  free(buf);
+  free(ibuf);
+
+  return ok;
+}
+
+int main(int argc, char **argv)
+{
+  double min_time = (argc > 1) ? atof(argv[1]) : 0.5;
+  int f, s, ok = 1;
+
+  init_time();
+  printf("Input converter benchmark (time per frame including the copy of the file buffer)\n");
+  for (s = 0; s < (int) (sizeof(sizes) / sizeof(sizes[0])); s++)
+  {
+    for (f = 0; f < (int) (sizeof(formats) / sizeof(formats[0])); f++)
+    {
+      if (8 * (int) sizeof(imgpel) < formats[f].out_bit_depth || (sizeof(imgpel) == 1 && formats[f].symbol_size_in_bytes > 1))
+        continue;
+      ok &= run(&formats[f], sizes[s][0], sizes[s][1], min_time);
+    }
+  }
+
+  return ok ? 0 : 1;
+}
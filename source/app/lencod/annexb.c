@@ -14,86 +14,77 @@
 
 #include "global.h"
 #include "nalucommon.h"
+#include "annexb.h"
 
 /*!
  ********************************************************************************************
  * \brief
- *    Writes a NALU to the Annex B Byte Stream
+ *    Assembles the start code and the NALU header bytes of a NALU of the
+ *    Annex B Byte Stream
  *
  * \return
- *    number of bits written
+ *    number of bytes written to header
  *
  ********************************************************************************************
 */
-int WriteAnnexbNALU (VideoParameters *p_Vid, NALU_t *n, FILE **f_annexb)
+int AnnexbNALUHeader (VideoParameters *p_Vid, NALU_t *n, byte header[ANNEXB_HEADER_SIZE])
 {
-  int BitsWritten = 0;
-  int offset = 0;
-  int length = 4;
-  static const byte startcode[] = {0,0,0,1};
-  byte first_byte;
+  int length = 0;
 
   assert (n != NULL);
   assert (n->forbidden_bit == 0);
-  assert ((*f_annexb) != NULL);
   assert (n->startcodeprefix_len == 3 || n->startcodeprefix_len == 4);
 
-// printf ("WriteAnnexbNALU: writing %d bytes w/ startcode_len %d\n", n->len+1, n->startcodeprefix_len);
-  if (n->startcodeprefix_len < 4)
-  {
-    offset = 1;
-    length = 3;
-  }
+  if (n->startcodeprefix_len == 4)
+    header[length++] = 0;
+  header[length++] = 0;
+  header[length++] = 0;
+  header[length++] = 1;
+
+  header[length++] = (byte) ((n->forbidden_bit << 7) | (n->nal_reference_idc << 5) | n->nal_unit_type);
 
-  if ( length != (int) fwrite (startcode+offset, 1, length, *f_annexb))
+#if (MVC_EXTENSION_ENABLE)
+  if(n->nal_unit_type==NALU_TYPE_PREFIX || n->nal_unit_type==NALU_TYPE_SLC_EXT)
   {
-    printf ("Fatal: cannot write %d bytes to bitstream file, exit (-1)\n", length);
-    exit (-1);
+    int view_id = p_Vid->p_Inp->MVCFlipViews ? !(n->view_id) : n->view_id;
+
+    header[length++] = (byte) ((n->svc_extension_flag << 7) | (n->non_idr_flag << 6) | n->priority_id);
+    header[length++] = (byte) (view_id >> 2);
+    header[length++] = (byte) (((view_id&3) << 6) | (n->temporal_id << 3) | (n->anchor_pic_flag << 2) | (n->inter_view_flag << 1) | n->reserved_one_bit);
   }
+#endif
 
-  BitsWritten = (length) << 3;
+  return length;
+}
 
-  first_byte = (unsigned char) ((n->forbidden_bit << 7) | (n->nal_reference_idc << 5) | n->nal_unit_type);
+/*!
+ ********************************************************************************************
+ * \brief
+ *    Writes a NALU to the Annex B Byte Stream
+ *
+ * \return
+ *    number of bits written
+ *
+ ********************************************************************************************
+*/
+int WriteAnnexbNALU (VideoParameters *p_Vid, NALU_t *n, FILE **f_annexb)
+{
+  int BitsWritten = 0;
+  int length;
+  byte header[ANNEXB_HEADER_SIZE];
 
-  if ( 1 != fwrite (&first_byte, 1, 1, *f_annexb))
-  {
-    printf ("Fatal: cannot write %d bytes to bitstream file, exit (-1)\n", 1);
-    exit (-1);
-  }
+  assert ((*f_annexb) != NULL);
 
-  BitsWritten += 8;
+// printf ("WriteAnnexbNALU: writing %d bytes w/ startcode_len %d\n", n->len+1, n->startcodeprefix_len);
+  length = AnnexbNALUHeader (p_Vid, n, header);
 
-  // printf ("First Byte %x, nal_ref_idc %x, nal_unit_type %d\n", first_byte, n->nal_reference_idc, n->nal_unit_type);
-#if (MVC_EXTENSION_ENABLE)
-  if(n->nal_unit_type==NALU_TYPE_PREFIX || n->nal_unit_type==NALU_TYPE_SLC_EXT)
+  if ( length != (int) fwrite (header, 1, length, *f_annexb))
   {
-    int view_id = p_Vid->p_Inp->MVCFlipViews ? !(n->view_id) : n->view_id;
-
-    first_byte = (unsigned char) ((n->svc_extension_flag << 7) | (n->non_idr_flag << 6) | n->priority_id);
-    if ( 1 != fwrite (&first_byte, 1, 1, *f_annexb))
-    {
-      printf ("Fatal: cannot write %d bytes to bitstream file, exit (-1)\n", 1);
-      exit (-1);
-    }
-    BitsWritten += 8;
-
-    first_byte = (unsigned char) (view_id >> 2);
-    if ( 1 != fwrite (&first_byte, 1, 1, *f_annexb))
-    {
-      printf ("Fatal: cannot write %d bytes to bitstream file, exit (-1)\n", 1);
-      exit (-1);
-    }
-    BitsWritten += 8;
-
-    first_byte = (unsigned char) (((view_id&3) << 6) | (n->temporal_id << 3) | (n->anchor_pic_flag << 2) | (n->inter_view_flag << 1) | n->reserved_one_bit);
-    if ( 1 != fwrite (&first_byte, 1, 1, *f_annexb))
-    {
-      printf ("Fatal: cannot write %d bytes to bitstream file, exit (-1)\n", 1);
-      exit (-1);
-    }
-    BitsWritten += 8;
+    printf ("Fatal: cannot write %d bytes to bitstream file, exit (-1)\n", length);
+    exit (-1);
   }
-#endif
+
+  BitsWritten = (length) << 3;
 
   if (n->len != fwrite (n->buf, 1, n->len, *f_annexb))
   {
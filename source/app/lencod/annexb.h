@@ -17,6 +17,9 @@
 
 #include "nalucommon.h"
 
+#define ANNEXB_HEADER_SIZE 8  //!< longest start code and NALU header (MVC extension)
+
+extern int AnnexbNALUHeader(VideoParameters *p_Vid, NALU_t *n, byte header[ANNEXB_HEADER_SIZE]);
 extern int WriteAnnexbNALU (VideoParameters *p_Vid, NALU_t *n, FILE **f_annexb);
 extern void OpenAnnexbFile (char *fn, FILE **f_annexb);
 extern void CloseAnnexbFile(FILE *f_annexb);
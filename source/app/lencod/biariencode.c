@@ -19,10 +19,55 @@
 
 #include "global.h"
 #include "biariencode.h"
+#include "rdopt_coding_state.h"
 
 // Range table for LPS
 static const byte renorm_table_32[32]={6,5,4,4,3,3,3,3,2,2,2,2,2,2,2,2,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1};
 
+// State transition tables
+static const byte AC_next_state_MPS_64[64] =
+{
+  1,2,3,4,5,6,7,8,9,10,
+  11,12,13,14,15,16,17,18,19,20,
+  21,22,23,24,25,26,27,28,29,30,
+  31,32,33,34,35,36,37,38,39,40,
+  41,42,43,44,45,46,47,48,49,50,
+  51,52,53,54,55,56,57,58,59,60,
+  61,62,62,63
+};
+
+static const byte AC_next_state_LPS_64[64] =
+{
+  0, 0, 1, 2, 2, 4, 4, 5, 6, 7,
+  8, 9, 9,11,11,12,13,13,15,15,
+  16,16,18,18,19,19,21,21,22,22,
+  23,24,24,25,26,26,27,27,28,29,
+  29,30,30,30,31,32,32,33,33,33,
+  34,34,35,35,35,36,36,36,37,37,
+  37,38,38,63
+};
+
+//! Estimated bits (in 1/32768 bit units) for coding a symbol in a given probability state
+const int entropyBits[128]= 
+{
+     895,    943,    994,   1048,   1105,   1165,   1228,   1294, 
+    1364,   1439,   1517,   1599,   1686,   1778,   1875,   1978, 
+    2086,   2200,   2321,   2448,   2583,   2725,   2876,   3034, 
+    3202,   3380,   3568,   3767,   3977,   4199,   4435,   4684, 
+    4948,   5228,   5525,   5840,   6173,   6527,   6903,   7303, 
+    7727,   8178,   8658,   9169,   9714,  10294,  10914,  11575, 
+   12282,  13038,  13849,  14717,  15650,  16653,  17734,  18899, 
+   20159,  21523,  23005,  24617,  26378,  28306,  30426,  32768, 
+   32768,  35232,  37696,  40159,  42623,  45087,  47551,  50015, 
+   52479,  54942,  57406,  59870,  62334,  64798,  67262,  69725, 
+   72189,  74653,  77117,  79581,  82044,  84508,  86972,  89436, 
+   91900,  94363,  96827,  99291, 101755, 104219, 106683, 109146, 
+  111610, 114074, 116538, 119002, 121465, 123929, 126393, 128857, 
+  131321, 133785, 136248, 138712, 141176, 143640, 146104, 148568, 
+  151031, 153495, 155959, 158423, 160887, 163351, 165814, 168278, 
+  170742, 173207, 175669, 178134, 180598, 183061, 185525, 187989
+};
+
 
 void reset_pic_bin_count(VideoParameters *p_Vid)
 {
@@ -69,11 +114,20 @@ void arienco_delete_encoding_environment(EncodingEnvironmentPtr eep)
 
 static inline void put_one_byte_final(EncodingEnvironmentPtr eep, unsigned int b)
 {
-  eep->Ecodestrm[(*eep->Ecodestrm_len)++] = (byte) b;
+  if (eep->rate_only)
+    ++(*eep->Ecodestrm_len);
+  else
+    eep->Ecodestrm[(*eep->Ecodestrm_len)++] = (byte) b;
 }
 
 static forceinline void put_buffer(EncodingEnvironmentPtr eep)
 {
+  if (eep->rate_only)
+  {
+    // only the number of code bytes is of interest
+    *eep->Ecodestrm_len += eep->Epbuf + 1;
+    eep->Epbuf = -1;
+  }
   while(eep->Epbuf>=0)
   {
     eep->Ecodestrm[(*eep->Ecodestrm_len)++] =  (byte) ((eep->Ebuffer>>((eep->Epbuf--)<<3))&0xFF); 
@@ -251,6 +305,32 @@ void arienco_done_encoding(Macroblock *currMB, EncodingEnvironmentPtr eep)
 }
 
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Rate estimation of one binary symbol from the probability state
+ *    of its context model (the arithmetic coder is not run)
+ ************************************************************************
+ */
+static void biari_estimate_symbol(EncodingEnvironmentPtr eep, int symbol, BiContextTypePtr bi_ct )
+{
+  eep->Efrac_bits += biari_no_bits((signed short) (symbol != 0), bi_ct);
+  bi_ct->count += eep->p_Vid->cabac_encoding;
+  if (eep->journal)
+    ctx_journal_log(eep->journal, bi_ct);
+
+  if ((symbol != 0) == bi_ct->MPS)
+  {
+    bi_ct->state = AC_next_state_MPS_64[bi_ct->state];
+  }
+  else
+  {
+    if (!bi_ct->state)
+      bi_ct->MPS ^= 0x01;
+    bi_ct->state = AC_next_state_LPS_64[bi_ct->state];
+  }
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -327,37 +407,26 @@ void biari_encode_symbol(EncodingEnvironmentPtr eep, int symbol, BiContextTypePt
     {   6,   7,   8,   9},
     {   2,   2,   2,   2}
   };
-  static const byte AC_next_state_MPS_64[64] =
-  {
-    1,2,3,4,5,6,7,8,9,10,
-    11,12,13,14,15,16,17,18,19,20,
-    21,22,23,24,25,26,27,28,29,30,
-    31,32,33,34,35,36,37,38,39,40,
-    41,42,43,44,45,46,47,48,49,50,
-    51,52,53,54,55,56,57,58,59,60,
-    61,62,62,63
-  };
+  unsigned int low, range, rLPS;
+  int bl;
 
-  static const byte AC_next_state_LPS_64[64] =
+  if (eep->rate_est)
   {
-    0, 0, 1, 2, 2, 4, 4, 5, 6, 7,
-    8, 9, 9,11,11,12,13,13,15,15,
-    16,16,18,18,19,19,21,21,22,22,
-    23,24,24,25,26,26,27,27,28,29,
-    29,30,30,30,31,32,32,33,33,33,
-    34,34,35,35,35,36,36,36,37,37,
-    37,38,38,63
-  };
+    biari_estimate_symbol(eep, symbol, bi_ct);
+    return;
+  }
 
-  unsigned int low = eep->Elow;
-  unsigned int range = eep->Erange;
-  int bl = eep->Ebits_to_go;
-  unsigned int rLPS = rLPS_table_64x4[bi_ct->state][(range>>6) & 3]; 
+  low   = eep->Elow;
+  range = eep->Erange;
+  bl    = eep->Ebits_to_go;
+  rLPS  = rLPS_table_64x4[bi_ct->state][(range>>6) & 3]; 
 
   range -= rLPS;
 
   ++(eep->C);
   bi_ct->count += eep->p_Vid->cabac_encoding;
+  if (eep->journal)
+    ctx_journal_log(eep->journal, bi_ct);
 
   /* covers all cases where code does not bother to shift down symbol to be 
   * either 0 or 1, e.g. in some cases for cbp, mb_Type etc the code simply 
@@ -438,6 +507,13 @@ void biari_encode_symbol(EncodingEnvironmentPtr eep, int symbol, BiContextTypePt
 void biari_encode_symbol_eq_prob(EncodingEnvironmentPtr eep, int symbol)
 {
   unsigned int low = eep->Elow;
+
+  if (eep->rate_est)
+  {
+    eep->Efrac_bits += 32768;
+    return;
+  }
+
   --(eep->Ebits_to_go);  
   ++(eep->C);
 
@@ -484,6 +560,14 @@ void biari_encode_symbol_final(EncodingEnvironmentPtr eep, int symbol)
   unsigned int low = eep->Elow;
   int bl = eep->Ebits_to_go; 
 
+  if (eep->rate_est)
+  {
+    // the terminating LPS costs 7 bits, the MPS is almost free
+    if (symbol != 0)
+      eep->Efrac_bits += (7 << 15);
+    return;
+  }
+
   ++(eep->C);
 
   if (symbol == 0) // MPS
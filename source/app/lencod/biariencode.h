@@ -54,6 +54,25 @@ extern void biari_encode_symbol   (EncodingEnvironmentPtr eep, int symbol, BiCon
 extern void biari_encode_symbol_eq_prob(EncodingEnvironmentPtr eep, int symbol);
 extern void biari_encode_symbol_final(EncodingEnvironmentPtr eep, int symbol);
 
+extern const int entropyBits[128];
+
+/*!
+************************************************************************
+* \brief
+*    Returns the estimated number of bits (in 1/32768 bit units) for
+*    coding symbol with the given context
+************************************************************************
+*/
+static inline int biari_no_bits(signed short symbol, BiContextTypePtr bi_ct )
+{
+  int ctx_state;
+
+  symbol = (short) (symbol != 0);
+  ctx_state = (symbol == bi_ct->MPS) ? 64 + bi_ct->state : 63 - bi_ct->state;
+
+  return entropyBits[127 - ctx_state];
+}
+
 /*!
 ************************************************************************
 * \brief
@@ -62,6 +81,9 @@ extern void biari_encode_symbol_final(EncodingEnvironmentPtr eep, int symbol);
 */
 static inline int arienco_bits_written(EncodingEnvironmentPtr eep)
 {
+  if (eep->rate_est)
+    return (int) ((eep->Efrac_bits + 16384) >> 15);
+
   return (((*eep->Ecodestrm_len) + eep->Epbuf + 1) << 3) + (eep->Echunks_outstanding * BITS_TO_LOAD) + BITS_TO_LOAD - eep->Ebits_to_go;
 }
 
@@ -1158,6 +1158,53 @@ static void PatchInp (VideoParameters *p_Vid, InputParameters *p_Inp)
     }
   }
 
+  // Two-pass rate control
+  if (p_Inp->RCPass)
+  {
+    if (p_Inp->PicInterlace || p_Inp->MbInterlace || p_Inp->num_of_views == 2)
+    {
+      snprintf(errortext, ET_SIZE, "RCPass is not supported with interlaced or MVC coding.");
+      error (errortext, 500);
+    }
+    if (p_Inp->RCPass == 2 && (!p_Inp->RCEnable || p_Inp->RCUpdateMode > MAX_RC_MODE))
+    {
+      snprintf(errortext, ET_SIZE, "RCPass = 2 requires RateControlEnable = 1 and RCUpdateMode = 0..3.");
+      error (errortext, 500);
+    }
+    if (p_Inp->RCPass == 1)
+    {
+      // fast first pass: low complexity mode decision, small search range, one coding pass per picture
+      printf("First rate control pass: RDOptimization = 0, SearchRange <= 8, RDPictureDecision = 0.\n");
+      p_Inp->rdopt = 0;
+      p_Inp->UseRDOQuant = 0;
+      p_Inp->RDPictureDecision = 0;
+      p_Inp->WPMCPrecision = 0;
+      p_Inp->MEErrorMetric[p_Inp->DisableSubpelME[0] ? F_PEL : Q_PEL] = p_Inp->ModeDecisionMetric;
+      p_Inp->search_range[0] = imin(p_Inp->search_range[0], 8);
+      p_Inp->BiPredMESearchRange[0] = imin(p_Inp->BiPredMESearchRange[0], p_Inp->search_range[0]);
+    }
+  }
+
+  if (p_Inp->MBTree)
+  {
+    if (!p_Inp->LookAheadDepth)
+    {
+      snprintf(errortext, ET_SIZE, "MBTree requires LookAheadDepth > 0.");
+      error (errortext, 500);
+    }
+    if (p_Inp->PicInterlace || p_Inp->MbInterlace)
+    {
+      snprintf(errortext, ET_SIZE, "MBTree is not supported with interlaced coding.");
+      error (errortext, 500);
+    }
+  }
+
+  if (strlen(p_Inp->QPMapFile) > 0 && (p_Inp->PicInterlace || p_Inp->MbInterlace))
+  {
+    snprintf(errortext, ET_SIZE, "QPMapFile is not supported with interlaced coding.");
+    error (errortext, 500);
+  }
+
   if ((p_Inp->NumberBFrames)&&(p_Inp->BRefPictures)&&(p_Inp->idr_period)&&(p_Inp->pic_order_cnt_type!=0))
   {
     error("Stored B pictures combined with IDR pictures only supported in Picture Order Count type 0\n",-1000);
@@ -1452,9 +1499,13 @@ static void PatchInp (VideoParameters *p_Vid, InputParameters *p_Inp)
     p_Inp->RDPictureMaxPassBSlice = 1;
     p_Inp->RDPictureDeblocking    = 0;
     p_Inp->RDPictureDirectMode    = 0;
+    p_Inp->RDPictureParallel      = 0;
     p_Inp->RDPictureFrameQPPSlice = 0;
     p_Inp->RDPictureFrameQPBSlice = 0;
   }
+
+  if (p_Inp->PicInterlace != ADAPTIVE_CODING)
+    p_Inp->PicInterlaceParallel = 0;
 }
 
 /*!
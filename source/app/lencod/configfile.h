@@ -37,6 +37,7 @@ Mapping Map[] = {
     {"Enable32Pulldown",         &cfgparams.enable_32_pulldown,           0,   0.0,                       1,  0.0,              2.0,                             },
     {"ResendSPS",                &cfgparams.ResendSPS,                    0,   0.0,                       1,  0.0,              3.0,                             },
     {"StartFrame",               &cfgparams.start_frame,                  0,   0.0,                       2,  0.0,              0.0,                             },
+    {"ReadAheadFrames",          &cfgparams.ReadAheadFrames,              0,   0.0,                       1,  0.0,            128.0,                             },
     {"IntraPeriod",              &cfgparams.intra_period,                 0,   0.0,                       2,  0.0,              0.0,                             },
     {"IDRPeriod",                &cfgparams.idr_period,                   0,   0.0,                       2,  0.0,              0.0,                             },
     {"IntraDelay",               &cfgparams.intra_delay,                  0,   0.0,                       2,  0.0,              0.0,                             },
@@ -67,6 +68,7 @@ Mapping Map[] = {
     {"NumberOfViews",            &cfgparams.num_of_views,                 0,   1.0,                       1,  1.0,              2.0,                             },
 #if (MVC_EXTENSION_ENABLE)
     {"View1ConfigFile",          &cfgparams.View1ConfigName,              1,   0.0,                       0,  0.0,              0.0,             FILE_NAME_SIZE, },
+    {"MVCViewParallel",          &cfgparams.MVCViewParallel,              0,   0.0,                       1,  0.0,              1.0,                             },
 #endif
     {"Log2MaxFNumMinus4",        &cfgparams.Log2MaxFNumMinus4,            0,   0.0,                       1, -1.0,             12.0,                             },
     {"Log2MaxPOCLsbMinus4",      &cfgparams.Log2MaxPOCLsbMinus4,          0,   2.0,                       1, -1.0,             12.0,                             },
@@ -89,6 +91,7 @@ Mapping Map[] = {
     {"ReconFile",                &cfgparams.ReconFile,                    1,   0.0,                       0,  0.0,              0.0,             FILE_NAME_SIZE, },
     {"TraceFile",                &cfgparams.TraceFile,                    1,   0.0,                       0,  0.0,              0.0,             FILE_NAME_SIZE, },
     {"StatsFile",                &cfgparams.StatsFile,                    1,   0.0,                       0,  0.0,              0.0,             FILE_NAME_SIZE, },
+    {"ModuleProfile",            &cfgparams.ModuleProfile,                0,   0.0,                       1,  0.0,              1.0,                             },
     {"DisposableP",              &cfgparams.DisposableP,                  0,   0.0,                       1,  0.0,              1.0,                             },
     {"SetFirstAsLongTerm",       &cfgparams.SetFirstAsLongTerm,           0,   0.0,                       1,  0.0,              1.0,                             },
     {"MultiSourceData",          &cfgparams.MultiSourceData,              0,   0.0,                       0,  0.0,              2.0,                             },
@@ -161,6 +164,7 @@ Mapping Map[] = {
     {"DistortionSSIM",           &cfgparams.Distortion[SSIM],             0,   0.0,                       1,  0.0,              1.0,                             },
     {"DistortionMS_SSIM",        &cfgparams.Distortion[MS_SSIM],          0,   0.0,                       1,  0.0,              1.0,                             },
     {"SSIMOverlapSize",          &cfgparams.SSIMOverlapSize,              0,   1.0,                       2,  1.0,              1.0,                             },
+    {"DistortionParallel",       &cfgparams.DistortionParallel,           0,   0.0,                       1,  0.0,              1.0,                             },
     {"DistortionYUVtoRGB",       &cfgparams.DistortionYUVtoRGB,           0,   0.0,                       1,  0.0,              1.0,                             },
     {"CtxAdptLagrangeMult",      &cfgparams.CtxAdptLagrangeMult,          0,   0.0,                       1,  0.0,              1.0,                             },
     {"FastCrIntraDecision",      &cfgparams.FastCrIntraDecision,          0,   0.0,                       1,  0.0,              1.0,                             },
@@ -168,12 +172,14 @@ Mapping Map[] = {
     {"DisableBSkipRDO",          &cfgparams.nobskip,                      0,   0.0,                       1,  0.0,              1.0,                             },
     {"BiasSkipRDO",              &cfgparams.BiasSkipRDO,                  0,   0.0,                       1,  0.0,              1.0,                             },
     {"ForceTrueRateRDO",         &cfgparams.ForceTrueRateRDO,             0,   0.0,                       1,  0.0,              2.0,                             },    
+    {"CABACRateEstimation",      &cfgparams.CABACRateEstimation,          0,   0.0,                       1,  0.0,              1.0,                             },
     {"LossRateA",                &cfgparams.LossRateA,                    2,   0.0,                       2,  0.0,              0.0,                             },
     {"LossRateB",                &cfgparams.LossRateB,                    2,   0.0,                       2,  0.0,              0.0,                             },
     {"LossRateC",                &cfgparams.LossRateC,                    2,   0.0,                       2,  0.0,              0.0,                             },
     {"FirstFrameCorrect",        &cfgparams.FirstFrameCorrect,            0,   0.0,                       2,  0.0,              0.0,                             },
     {"NumberOfDecoders",         &cfgparams.NoOfDecoders,                 0,   0.0,                       2,  0.0,              0.0,                             },
     {"ErrorConcealment",         &cfgparams.ErrorConcealment,             0,   0.0,                       2,  0.0,              0.0,                             },
+    {"ErrdoThreads",             &cfgparams.ErrdoThreads,                 0,   0.0,                       1,  0.0,             16.0,                             },
     {"RestrictRefFrames",        &cfgparams.RestrictRef ,                 0,   0.0,                       1,  0.0,              1.0,                             },
 #ifdef _LEAKYBUCKET_
     {"NumberofLeakyBuckets",     &cfgparams.NumberLeakyBuckets,           0,   2.0,                       1,  2.0,              255.0,                           },
@@ -182,6 +188,7 @@ Mapping Map[] = {
 #endif
     {"PicInterlace",             &cfgparams.PicInterlace,                 0,   0.0,                       1,  0.0,              3.0,                             },
     {"MbInterlace",              &cfgparams.MbInterlace,                  0,   0.0,                       1,  0.0,              3.0,                             },
+    {"PicInterlaceParallel",     &cfgparams.PicInterlaceParallel,         0,   0.0,                       1,  0.0,              1.0,                             },
 
     {"IntraBottom",              &cfgparams.IntraBottom,                  0,   0.0,                       1,  0.0,              1.0,                             },
 
@@ -202,6 +209,7 @@ Mapping Map[] = {
     {"RDPictureMaxPassBSlice",   &cfgparams.RDPictureMaxPassBSlice,       0,   3.0,                       1,  1.0,              6.0,                             },
     {"RDPictureDeblocking",      &cfgparams.RDPictureDeblocking,          0,   0.0,                       1,  0.0,              1.0,                             },
     {"RDPictureDirectMode",      &cfgparams.RDPictureDirectMode,          0,   0.0,                       1,  0.0,              1.0,                             },
+    {"RDPictureParallel",        &cfgparams.RDPictureParallel,            0,   0.0,                       1,  0.0,              1.0,                             },
     {"RDPictureFrameQPPSlice",   &cfgparams.RDPictureFrameQPPSlice,       0,   0.0,                       1,  0.0,              1.0,                             },
     {"RDPictureFrameQPBSlice",   &cfgparams.RDPictureFrameQPBSlice,       0,   0.0,                       1,  0.0,              1.0,                             },
     {"SkipIntraInInterSlices",   &cfgparams.SkipIntraInInterSlices,       0,   0.0,                       1,  0.0,              1.0,                             },
@@ -275,6 +283,8 @@ Mapping Map[] = {
     {"Verbose",                  &cfgparams.Verbose,                      0,   1.0,                       1,  0.0,              4.0,                             },
     {"SkipGlobalStats",          &cfgparams.skip_gl_stats,                0,   0.0,                       1,  0.0,              1.0,                             },
     {"OnTheFlyFractMCP",         &cfgparams.OnTheFlyFractMCP,             0,   0.0,                       1,  0.0,              3.0,                             },
+    {"LowMemory",                &cfgparams.LowMemory,                    0,   0.0,                       1,  0.0,              1.0,                             },
+    {"PlaneMemory",              &cfgparams.PlaneMemory,                  0,   0.0,                       1,  0.0,              3.0,                             },
     {"ChromaMCBuffer",           &cfgparams.ChromaMCBuffer,               0,   0.0,                       1,  0.0,              1.0,                             },
     {"ChromaMEEnable",           &cfgparams.ChromaMEEnable,               0,   0.0,                       1,  0.0,              2.0,                             },
     {"ChromaMEWeight",           &cfgparams.ChromaMEWeight,               0,   1.0,                       2,  0.0,              1.0,                             },    
@@ -311,6 +321,8 @@ Mapping Map[] = {
     {"RCMinQPSISlice",           &cfgparams.RCMinQP[SI_SLICE],            0,   (double) MIN_QP,           3,  (double) MIN_QP,  (double) MAX_QP,                 },
     {"RCMaxQPSISlice",           &cfgparams.RCMaxQP[SI_SLICE],            0,   (double) MAX_QP,           3,  (double) MIN_QP,  (double) MAX_QP,                 },
     {"RCMaxQPChange",            &cfgparams.RCMaxQPChange,                0,   4.0,                       1,  0.0,              51.0,                            },
+    {"RCPass",                   &cfgparams.RCPass,                       0,   0.0,                       1,  0.0,              2.0,                             },
+    {"RCStatsFile",              &cfgparams.RCStatsFile,                  1,   0.0,                       0,  0.0,              0.0,             FILE_NAME_SIZE, },
 
     // Q_Matrix
     {"QmatrixFile",              &cfgparams.QmatrixFile,                  1,   0.0,                       0,  0.0,              0.0,             FILE_NAME_SIZE, },
@@ -395,10 +407,20 @@ Mapping Map[] = {
     {"PreferDispOrder",          &cfgparams.PreferDispOrder,              0,   1.0,                       1,  0.0,              1.0,                             },
     {"PreferPowerOfTwo",         &cfgparams.PreferPowerOfTwo,             0,   0.0,                       1,  0.0,              1.0,                             },
     {"FrmStructBufferLength",    &cfgparams.FrmStructBufferLength,        0,  16.0,                       1,  1.0,            128.0,                             },
+    {"LookAheadDepth",           &cfgparams.LookAheadDepth,               0,   0.0,                       1,  0.0,            128.0,                             },
+    {"SceneCutThreshold",        &cfgparams.SceneCutThreshold,            0,  40.0,                       1,  0.0,            100.0,                             },
+    {"LookAheadBFrames",         &cfgparams.LookAheadBFrames,             0,   0.0,                       1,  0.0,              1.0,                             },
+    {"MBTree",                   &cfgparams.MBTree,                       0,   0.0,                       1,  0.0,              1.0,                             },
+    {"MBTreeStrength",           &cfgparams.MBTreeStrength,               2,   2.0,                       1,  0.0,             10.0,                             },
+    {"QPMapFile",                &cfgparams.QPMapFile,                    1,   0.0,                       0,  0.0,              0.0,             FILE_NAME_SIZE, },
+    {"QPOffsetFastThreshold",    &cfgparams.QPOffsetFastThreshold,        0,   0.0,                       1,  0.0,             12.0,                             },
 
     // Fast Mode Decision
     {"EarlySkipEnable",          &cfgparams.EarlySkipEnable,              0,   0.0,                       1,  0.0,              1.0,                             },
     {"SelectiveIntraEnable",     &cfgparams.SelectiveIntraEnable,         0,   0.0,                       1,  0.0,              1.0,                             },
+    {"MDPruning",                &cfgparams.MDPruning,                    0,   0.0,                       1,  0.0,             15.0,                             },
+    {"MDPruningScale",           &cfgparams.MDPruningScale,               0, 100.0,                       1,  1.0,           1000.0,                             },
+    {"MDPruningAudit",           &cfgparams.MDPruningAudit,               0,   0.0,                       1,  0.0,              1.0,                             },
 
     //================================
     // Motion Estimation (ME) Parameters
@@ -445,6 +467,7 @@ Mapping Map[] = {
     {"HMEEnable",                &cfgparams.HMEEnable,                    0,   0.0,                       1,  0.0,              1.0,                             },
     {"HMEDisableMMCO",           &cfgparams.HMEDisableMMCO,               0,   0.0,                       1,  0.0,              1.0,                             },
     {"PyramidLevels",            &cfgparams.PyramidLevels,                0,   0.0,                       1,  0.0,              6.0,                             },
+    {"HMEThreads",               &cfgparams.HMEThreads,                   0,   0.0,                       1,  0.0,             16.0,                             },
 
     // Tone mapping SEI cfg file
     {"ToneMappingSEIPresentFlag",&cfgparams.ToneMappingSEIPresentFlag,    0,   0.0,                       1,  0.0,              1.0,                             },
@@ -468,6 +491,7 @@ Mapping Map[] = {
     {"RDOQ_CP_Mode",             &cfgparams.RDOQ_CP_Mode,                 0,   0.0,                       1,  0.0,              1.0,                             },
     {"RDOQ_CP_MV",               &cfgparams.RDOQ_CP_MV,                   0,   0.0,                       1,  0.0,              1.0,                             },
     {"RDOQ_Fast",                &cfgparams.RDOQ_Fast,                    0,   0.0,                       1,  0.0,              1.0,                             },
+    {"RDOQ_Prune",               &cfgparams.RDOQ_Prune,                   0,   0.0,                       1,  0.0,              1.0,                             },
     // VUI parameters
     {"GenerateSEIMessage",       &cfgparams.GenerateSEIMessage,           0,   0.0,                       1,  0.0,              1.0,                             },
     {"EnableVUISupport",         &cfgparams.EnableVUISupport,             0,   0.0,                       1,  0.0,              1.0,                             },
@@ -633,6 +657,7 @@ extern Mapping MapView1[];
 
 extern void Configure            (VideoParameters *p_Vid, InputParameters *p_Inp, int ac, char *av[]);
 extern void get_number_of_frames (InputParameters *p_Inp, VideoDataFile *input_file);
+extern int64 getVideoFileSize    (int video_file);
 extern void read_slice_group_info(VideoParameters *p_Vid, InputParameters *p_Inp);
 
 #endif
@@ -27,7 +27,7 @@
  *  order of elements follow dependencies for picture reconstruction
  */
 
-#define MAXPARTITIONMODES 2 //!< maximum possible partition modes as defined in assignSE2partition[][]
+#define MAXPARTITIONMODES 2 //!< maximum possible partition modes as defined in assignSE2partition_DP[]
 
 /*!
  *  \brief  lookup-table to assign different elements to partition
@@ -81,7 +81,6 @@ typedef enum {
 //} SE_type;
 
 
-extern const int * assignSE2partition[2];
 extern const int assignSE2partition_NoDP[SE_MAX_ELEMENTS];
 extern const int assignSE2partition_DP[SE_MAX_ELEMENTS];
 
@@ -28,6 +28,8 @@
 #include "md_common.h"
 #include "errdo.h"
 #include "errdo_dist_mhyp.h"
+#include "errdo_threads.h"
+#include "loop_filter.h"
 
 /*!
 **************************************************************************************
@@ -72,6 +74,8 @@ int allocate_errdo_mem(VideoParameters *p_Vid, InputParameters *p_Inp)
   p_Vid->p_decs->second_moment_bestY_b8x8      = NULL;
   p_Vid->p_decs->second_moment_pred_bestY_b8x8      = NULL;
   p_Vid->p_decs->second_moment_pred      = NULL;
+  p_Vid->p_decs->p_threads     = NULL;
+  p_Vid->p_decs->deblock_edges = NULL;
 
   //Zhifeng 090630
   switch (p_Inp->de)
@@ -82,6 +86,10 @@ int allocate_errdo_mem(VideoParameters *p_Vid, InputParameters *p_Inp)
     memory_size += get_mem3Dpel(&p_Vid->p_decs->dec_mbY_best, p_Inp->NoOfDecoders, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
     memory_size += get_mem4Dpel(&p_Vid->p_decs->dec_mbY_best8x8, 2, p_Inp->NoOfDecoders, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
     memory_size += get_mem4Dpel(&p_Vid->p_decs->dec_mb_pred_best8x8, 2, p_Inp->NoOfDecoders, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+    if ((p_Vid->p_decs->deblock_edges = (DeblockMbEdges *) calloc(p_Vid->FrameSizeInMbs, sizeof(DeblockMbEdges))) == NULL)
+      no_mem_exit("allocate_errdo_mem: deblock_edges");
+    memory_size += p_Vid->FrameSizeInMbs * sizeof(DeblockMbEdges);
+    p_Vid->p_decs->p_threads = errdo_threads_create(p_Inp->ErrdoThreads);
     break;  
   default:
     ;
@@ -213,6 +221,9 @@ void free_errdo_mem(VideoParameters *p_Vid)
     p_Vid->p_decs->dec_mbY_best8x8     = NULL;
   }
 
+  errdo_threads_destroy(p_Vid->p_decs->p_threads);
+  free_pointer(p_Vid->p_decs->deblock_edges);
+
   //for ROPE
   if (p_Vid->p_decs->first_moment_bestY_mb)
   {
@@ -88,6 +88,8 @@ struct decoders
   imgpel ****dec_mb_pred_best8x8;    //!< Predicted pixel values for best 8x8 modes
   imgpel ***dec_mb_pred;             //!< Predicted pixel values for macroblock
   int rec_type;
+  struct errdo_threads *p_threads;   //!< Threads simulating the decoders (NULL: serial)
+  struct deblock_mb_edges *deblock_edges; //!< Luma edges of the picture, shared by the deblocking of the decoders
 
   //for ROPE algorithm
   imgpel **first_moment_bestY_mb;
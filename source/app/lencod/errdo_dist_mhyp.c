@@ -27,6 +27,24 @@
 #include "md_distortion.h"
 #include "md_common.h"
 #include "lln_mc_prediction.h"
+#include "loop_filter.h"
+#include "errdo_threads.h"
+
+//! macroblock mode of which the distortion is estimated
+typedef struct errdo_mb_mode
+{
+  Macroblock *currMB;
+  int         block;
+  short       mode;
+  short       pdir;
+} ErrdoMbMode;
+
+//! coded picture of which the decoders are updated
+typedef struct errdo_picture
+{
+  VideoParameters *p_Vid;
+  StorablePicture *enc_pic;
+} ErrdoPicture;
 
 static void add_residue     (Macroblock *currMB, StorablePicture *enc_pic, int decoder, int pl, int block8x8, int x_size, int y_size);
 static void Build_Status_Map(VideoParameters *p_Vid, InputParameters *p_Inp, byte **s_map);
@@ -38,6 +56,42 @@ static void decode_one_mb           (Macroblock* currMB, StorablePicture *enc, i
 extern void UpdateDecoders          (VideoParameters *p_Vid, InputParameters *p_Inp, StorablePicture *enc_pic);
 extern void DeblockFrame(VideoParameters *p_Vid, imgpel **, imgpel ***);
 
+/*!
+ *************************************************************************************
+ * \brief
+ *  Decodes an 8x8 partition in one decoder and returns its distortion.
+ *
+ *************************************************************************************
+ */
+static distblk b8block_distortion(void *arg, int decoder)
+{
+  ErrdoMbMode *mb_mode = (ErrdoMbMode *) arg;
+  Macroblock *currMB = mb_mode->currMB;
+  VideoParameters *p_Vid = currMB->p_Vid;
+  int  pax     = 8*(mb_mode->block & 0x01);
+  int  pay     = 8*(mb_mode->block >> 1);
+
+  decode_one_b8block (currMB, p_Vid->enc_picture, decoder, mb_mode->block, mb_mode->mode, mb_mode->pdir);
+  return compute_SSE8x8(&p_Vid->pCurImg[currMB->opix_y + pay], &p_Vid->enc_picture->de_mem->p_dec_img[0][decoder][currMB->opix_y + pay], currMB->pix_x + pax, currMB->pix_x + pax);
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *  Decodes a macroblock in one decoder and returns its luma distortion.
+ *
+ *************************************************************************************
+ */
+static distblk mb_distortion(void *arg, int decoder)
+{
+  ErrdoMbMode *mb_mode = (ErrdoMbMode *) arg;
+  Macroblock *currMB = mb_mode->currMB;
+  VideoParameters *p_Vid = currMB->p_Vid;
+
+  decode_one_mb (currMB, p_Vid->enc_picture, decoder);
+  return compute_SSE16x16(&p_Vid->pImgOrg[0][currMB->opix_y], &p_Vid->enc_picture->de_mem->p_dec_img[0][decoder][currMB->pix_y], currMB->pix_x, currMB->pix_x);
+}
+
 /*!
  *************************************************************************************
  * \brief
@@ -52,11 +106,15 @@ distblk errdo_distortion_estimation_multihyp(Macroblock *currMB, int block, int
   Slice *currSlice = currMB->p_Slice;
   seq_parameter_set_rbsp_t *active_sps = p_Vid->active_sps;
 
-  int  pax     = 8*(block & 0x01);
-  int  pay     = 8*(block >> 1);
   distblk distortion=0;
   distblk temp_dist, ddistortion = 0;
   int  k;
+  ErrdoMbMode mb_mode;
+
+  mb_mode.currMB = currMB;
+  mb_mode.block  = block;
+  mb_mode.mode   = mode;
+  mb_mode.pdir   = (short) pdir;
 
   //Note that in rdcost_for_8x8blocks() no chroma distortion is calculated
   //Refer to the function reset_adaptive_rounding(), 
@@ -80,47 +138,21 @@ distblk errdo_distortion_estimation_multihyp(Macroblock *currMB, int block, int
     distortion /= p_Inp->NoOfDecoders;
     */
 
-    for (k = 0; k < p_Inp->NoOfDecoders; k++)
-    {
-      decode_one_b8block (currMB, p_Vid->enc_picture, k, block, mode, pdir);
-      ddistortion += compute_SSE8x8(&p_Vid->pCurImg[currMB->opix_y + pay], &p_Vid->enc_picture->de_mem->p_dec_img[0][k][currMB->opix_y + pay], currMB->pix_x + pax, currMB->pix_x + pax);
-
-      {
-        temp_dist = min_rdcost * p_Inp->NoOfDecoders;
-      }
-      if (ddistortion > temp_dist)
-      {
-        //distortion = (distblk) ((ddistortion) / (k+1) + 0.5);
-        return DISTBLK_MAX;
-      }
-    }
+    temp_dist = min_rdcost * p_Inp->NoOfDecoders;
+    ddistortion = errdo_run_decoders(p_Vid->p_decs->p_threads, b8block_distortion, &mb_mode, p_Inp->NoOfDecoders, temp_dist);
+    if (ddistortion > temp_dist)
+      return DISTBLK_MAX;
 
     distortion = (distblk) (ddistortion / p_Inp->NoOfDecoders);
   }
   else if (mode != P8x8)  //to be called by RDCost_for_macroblocks()
   {
     errdo_compute_residue (currMB, &p_Vid->enc_picture->p_curr_img[currMB->pix_y], p_Vid->p_decs->res_img[0], mode == I16MB ? currSlice->mpr_16x16[0][ (short) currMB->i16mode] : currSlice->mb_pred[0], 0, 16);
-    for (k = 0; k<p_Inp->NoOfDecoders ;k++)
-    {
-      decode_one_mb (currMB, p_Vid->enc_picture, k);
-      ddistortion += compute_SSE16x16(&p_Vid->pImgOrg[0][currMB->opix_y], &p_Vid->enc_picture->de_mem->p_dec_img[0][k][currMB->pix_y], currMB->pix_x, currMB->pix_x);
-
-      //Use integer calculation
-      if (min_rdcost < DISTBLK_MAX)
-      {
-        {
-          temp_dist = min_rdcost * p_Inp->NoOfDecoders;
-        }
-      }
-      else
-        temp_dist = DISTBLK_MAX;
-
-      if (ddistortion > temp_dist)
-      {
-        //distortion = (distblk) ((ddistortion) / (k+1) + 0.5);
-        return DISTBLK_MAX;
-      }
-    }
+    //Use integer calculation
+    temp_dist = (min_rdcost < DISTBLK_MAX) ? min_rdcost * p_Inp->NoOfDecoders : DISTBLK_MAX;
+    ddistortion = errdo_run_decoders(p_Vid->p_decs->p_threads, mb_distortion, &mb_mode, p_Inp->NoOfDecoders, temp_dist);
+    if (ddistortion > temp_dist)
+      return DISTBLK_MAX;
 
     distortion = (distblk) (ddistortion / p_Inp->NoOfDecoders);
 
@@ -166,6 +198,26 @@ distblk errdo_distortion_estimation_multihyp(Macroblock *currMB, int block, int
   return distortion;
 }
 
+/*!
+ *************************************************************************************
+ * \brief
+ *    Conceals and deblocks the picture of one decoder with the edges of
+ *    GetDeblockEdges().
+ *
+ *************************************************************************************
+ */
+static distblk update_decoder(void *arg, int decoder)
+{
+  ErrdoPicture *pic = (ErrdoPicture *) arg;
+  VideoParameters *p_Vid = pic->p_Vid;
+  StorablePicture *enc_pic = pic->enc_pic;
+
+  p_Vid->error_conceal_picture(p_Vid, enc_pic, decoder); 
+  DeblockLumaEdges (p_Vid, enc_pic->de_mem->p_dec_img[0][decoder], p_Vid->p_decs->deblock_edges);
+
+  return 0;
+}
+
 /*!
  *************************************************************************************
  * \brief
@@ -177,11 +229,28 @@ distblk errdo_distortion_estimation_multihyp(Macroblock *currMB, int block, int
 void UpdateDecoders(VideoParameters *p_Vid, InputParameters *p_Inp, StorablePicture *enc_pic)
 {
   int k;
+  ErrdoPicture pic;
+
+  // the losses are drawn in decoder order, before any decoder is updated
   for (k = 0; k < p_Inp->NoOfDecoders; k++)
-  {
     Build_Status_Map(p_Vid, p_Inp, enc_pic->de_mem->mb_error_map[k]); // simulates the packet losses
-    p_Vid->error_conceal_picture(p_Vid, enc_pic, k); 
-    DeblockFrame (p_Vid, enc_pic->de_mem->p_dec_img[0][k], NULL);
+
+  if (p_Vid->structure == FRAME && !p_Vid->mb_aff_frame_flag)
+  {
+    // the deblocking edges do not depend on the losses: derive them once for all decoders
+    pic.p_Vid   = p_Vid;
+    pic.enc_pic = enc_pic;
+    GetDeblockEdges(p_Vid, p_Vid->p_decs->deblock_edges);
+    errdo_run_decoders(p_Vid->p_decs->p_threads, update_decoder, &pic, p_Inp->NoOfDecoders, DISTBLK_MAX);
+    ResetDeblockEdges(p_Vid);
+  }
+  else
+  {
+    for (k = 0; k < p_Inp->NoOfDecoders; k++)
+    {
+      p_Vid->error_conceal_picture(p_Vid, enc_pic, k); 
+      DeblockFrame (p_Vid, enc_pic->de_mem->p_dec_img[0][k], NULL);
+    }
   }
 }
 
@@ -601,21 +670,22 @@ static void get_predicted_concealment_mb(Macroblock* currMB, StorablePicture* en
 void copy_conceal_picture(VideoParameters *p_Vid, StorablePicture *enc_pic, int decoder)
 {
   unsigned int mb;
-  Macroblock* currMB;
+  Macroblock conceal_mb, *currMB = &conceal_mb;
   int mb_error;
   byte** mb_error_map = enc_pic->de_mem->mb_error_map[decoder];
   StorablePicture* refPic;
   BlockPos *PicPos = p_Vid->PicPos;
 
   refPic = find_nearest_ref_picture(p_Vid->p_Dpb_layer[0], enc_pic->poc); //Used for concealment if actual reference pic is not known.
+  // the macroblock is concealed on a copy, as the decoders may be concealed concurrently
   for (mb = 0; mb < p_Vid->PicSizeInMbs; mb++)
   {
-    currMB = &p_Vid->mb_data[mb];
-    currMB->mb_x = PicPos[mb].x;
-    currMB->mb_y = PicPos[mb].y;
-    mb_error = mb_error_map[currMB->mb_y][currMB->mb_x];
+    mb_error = mb_error_map[PicPos[mb].y][PicPos[mb].x];
     if (mb_error)
     {      
+      conceal_mb = p_Vid->mb_data[mb];
+      currMB->mb_x = PicPos[mb].x;
+      currMB->mb_y = PicPos[mb].y;
       currMB->block_x = currMB ->mb_x << 2;
       currMB->block_y = currMB->mb_y << 2;
       currMB->pix_x   = currMB->block_x << 2;
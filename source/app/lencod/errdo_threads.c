@@ -0,0 +1,189 @@
+/*!
+ *************************************************************************************
+ * \file errdo_threads.c
+ *
+ * \brief
+ *    Concurrent simulation of the decoders of the loss-aware rate-distortion
+ *    optimization (RDOptimization = 3).
+ *
+ *    The pool is created with the decoder buffers and lives for the whole
+ *    encoding. Every job runs on all decoders: the distortion of each
+ *    macroblock mode is the sum over the decoders and the decoders of a
+ *    coded picture are concealed and deblocked independently of each other.
+ *
+ *************************************************************************************
+ */
+
+#include "global.h"
+#include "errdo_threads.h"
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Run the current job on the decoders that are left, adding up the
+ *    distortions (called with the mutex held)
+ ************************************************************************
+ */
+static void errdo_work(ErrdoThreads *p_threads)
+{
+  while (p_threads->next_decoder < p_threads->num_decoders)
+  {
+    int decoder = p_threads->next_decoder++;
+    distblk distortion;
+
+    mutex_unlock(&p_threads->mutex);
+    distortion = p_threads->job(p_threads->arg, decoder);
+    mutex_lock(&p_threads->mutex);
+
+    p_threads->sum += distortion;
+    if (p_threads->sum > p_threads->limit)
+      p_threads->next_decoder = p_threads->num_decoders;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Pool thread: run the jobs until the pool is stopped
+ ************************************************************************
+ */
+static void errdo_worker_thread(void *arg)
+{
+  ErrdoThreads *p_threads = (ErrdoThreads *) arg;
+  int generation = 0;
+
+  mutex_lock(&p_threads->mutex);
+  for (;;)
+  {
+    while (!p_threads->stop && p_threads->generation == generation)
+      cond_wait(&p_threads->cond, &p_threads->mutex);
+    if (p_threads->stop)
+      break;
+    generation = p_threads->generation;
+
+    errdo_work(p_threads);
+
+    if (--p_threads->running == 0)
+      cond_signal(&p_threads->done);
+  }
+  mutex_unlock(&p_threads->mutex);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Create the pool with num_threads threads (including the caller)
+ * \return
+ *    the pool or NULL if no additional thread could be started
+ ************************************************************************
+ */
+ErrdoThreads *errdo_threads_create(int num_threads)
+{
+  ErrdoThreads *p_threads;
+  int i;
+
+  if (num_threads < 2)
+    return NULL;
+
+  if ((p_threads = (ErrdoThreads *) calloc(1, sizeof(ErrdoThreads))) == NULL)
+    no_mem_exit("errdo_threads_create: p_threads");
+  if ((p_threads->threads = (ThreadHandle *) calloc(num_threads, sizeof(ThreadHandle))) == NULL)
+    no_mem_exit("errdo_threads_create: p_threads->threads");
+
+  mutex_init(&p_threads->mutex);
+  cond_init(&p_threads->cond);
+  cond_init(&p_threads->done);
+
+  p_threads->num_workers = 1;
+  for (i = 1; i < num_threads; i++)
+  {
+    if (thread_create(&p_threads->threads[i], errdo_worker_thread, p_threads) != 0)
+      break;
+    p_threads->num_workers = i + 1;
+  }
+
+  if (p_threads->num_workers < 2)
+  {
+    errdo_threads_destroy(p_threads);
+    return NULL;
+  }
+
+  return p_threads;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Stop the threads of the pool and free it
+ ************************************************************************
+ */
+void errdo_threads_destroy(ErrdoThreads *p_threads)
+{
+  int i;
+
+  if (p_threads == NULL)
+    return;
+
+  mutex_lock(&p_threads->mutex);
+  p_threads->stop = 1;
+  cond_broadcast(&p_threads->cond);
+  mutex_unlock(&p_threads->mutex);
+
+  for (i = 1; i < p_threads->num_workers; i++)
+    thread_join(p_threads->threads[i]);
+
+  mutex_destroy(&p_threads->mutex);
+  cond_destroy(&p_threads->cond);
+  cond_destroy(&p_threads->done);
+
+  free(p_threads->threads);
+  free(p_threads);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Run job on decoders 0 .. num_decoders - 1, on the pool if there is
+ *    one and in decoder order otherwise
+ * \return
+ *    the sum of the distortions of the decoders; once it is above limit
+ *    the decoders that are left are skipped
+ ************************************************************************
+ */
+distblk errdo_run_decoders(ErrdoThreads *p_threads, ErrdoDecoderJob job, void *arg, int num_decoders, distblk limit)
+{
+  distblk sum = 0;
+
+  if (p_threads == NULL)
+  {
+    int decoder;
+
+    for (decoder = 0; decoder < num_decoders; decoder++)
+    {
+      sum += job(arg, decoder);
+      if (sum > limit)
+        break;
+    }
+    return sum;
+  }
+
+  mutex_lock(&p_threads->mutex);
+  p_threads->job          = job;
+  p_threads->arg          = arg;
+  p_threads->next_decoder = 0;
+  p_threads->num_decoders = num_decoders;
+  p_threads->sum          = 0;
+  p_threads->limit        = limit;
+  p_threads->running      = p_threads->num_workers - 1;
+  ++p_threads->generation;
+  cond_broadcast(&p_threads->cond);
+
+  errdo_work(p_threads);
+
+  while (p_threads->running)
+    cond_wait(&p_threads->done, &p_threads->mutex);
+  sum = p_threads->sum;
+  mutex_unlock(&p_threads->mutex);
+
+  return sum;
+}
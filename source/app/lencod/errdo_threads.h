@@ -0,0 +1,52 @@
+/*!
+ ***************************************************************************
+ * \file
+ *    errdo_threads.h
+ *
+ * \brief
+ *    Headerfile for the concurrent simulation of the decoders of the
+ *    loss-aware rate-distortion optimization.
+ *
+ *    A pool of ErrdoThreads threads (the encoder thread being one of them)
+ *    runs a job on every simulated decoder. The decoders are handed out in
+ *    increasing order and the distortions returned by the job are summed;
+ *    once the sum is above the limit of the job no further decoder is
+ *    started. The distortions are non negative, so that whether the sum
+ *    exceeds the limit does not depend on the threads.
+ **************************************************************************
+ */
+
+#ifndef _ERRDO_THREADS_H_
+#define _ERRDO_THREADS_H_
+
+#include "global.h"
+#include "thread_common.h"
+
+typedef distblk (*ErrdoDecoderJob)(void *arg, int decoder);
+
+typedef struct errdo_threads
+{
+  int             num_workers;    //!< including the encoder thread
+  ThreadHandle   *threads;
+
+  ThreadMutex     mutex;
+  ThreadCond      cond;           //!< new job
+  ThreadCond      done;           //!< job finished
+  int             generation;     //!< incremented for every job
+  int             running;        //!< threads working on the current job
+  int             stop;
+
+  // current job
+  ErrdoDecoderJob job;
+  void           *arg;
+  int             next_decoder;
+  int             num_decoders;
+  distblk         sum;
+  distblk         limit;
+} ErrdoThreads;
+
+extern ErrdoThreads *errdo_threads_create (int num_threads);
+extern void          errdo_threads_destroy(ErrdoThreads *p_threads);
+extern distblk       errdo_run_decoders   (ErrdoThreads *p_threads, ErrdoDecoderJob job, void *arg, int num_decoders, distblk limit);
+
+#endif
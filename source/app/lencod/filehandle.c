@@ -19,6 +19,7 @@
 
 #include "rtp.h"
 #include "annexb.h"
+#include "lencod_api_int.h"
 #include "parset.h"
 #include "mbuffer.h"
 
@@ -37,8 +38,12 @@
 void error(char *text, int code)
 {
   fprintf(stderr, "%s\n", text);
-  flush_dpb(p_Enc->p_Vid->p_Dpb_layer[0], &p_Enc->p_Inp->output);
-  flush_dpb(p_Enc->p_Vid->p_Dpb_layer[1], &p_Enc->p_Inp->output);
+  // instances of the library interface have no command line encoder
+  if (p_Enc)
+  {
+    flush_dpb(p_Enc->p_Vid->p_Dpb_layer[0], &p_Enc->p_Inp->output);
+    flush_dpb(p_Enc->p_Vid->p_Dpb_layer[1], &p_Enc->p_Inp->output);
+  }
   exit(code);
 }
 
@@ -72,21 +77,30 @@ int start_sequence(VideoParameters *p_Vid, InputParameters *p_Inp)
   int i,len=0, total_pps = (p_Inp->GenerateMultiplePPS) ? 3 : 1;
   NALU_t *nalu;
 
-  switch(p_Inp->of_mode)
+  if (p_Vid->p_api)
   {
-  case PAR_OF_ANNEXB:      
-    p_Vid->WriteNALU = WriteAnnexbNALU;
+    // the NALUs are queued for the caller of the library interface
+    p_Vid->WriteNALU = api_write_nalu;
     p_Vid->f_out = &p_Vid->f_annexb;
-    OpenAnnexbFile (p_Inp->outfile, p_Vid->f_out);
-    break;
-  case PAR_OF_RTP:      
-    p_Vid->WriteNALU = WriteRTPNALU;
-    p_Vid->f_out = &p_Vid->f_rtp;
-    OpenRTPFile (p_Inp->outfile, p_Vid->f_out);
-    break;
-  default:
-    snprintf(errortext, ET_SIZE, "Output File Mode %d not supported", p_Inp->of_mode);
-    error(errortext,1);
+  }
+  else
+  {
+    switch(p_Inp->of_mode)
+    {
+    case PAR_OF_ANNEXB:      
+      p_Vid->WriteNALU = WriteAnnexbNALU;
+      p_Vid->f_out = &p_Vid->f_annexb;
+      OpenAnnexbFile (p_Inp->outfile, p_Vid->f_out);
+      break;
+    case PAR_OF_RTP:      
+      p_Vid->WriteNALU = WriteRTPNALU;
+      p_Vid->f_out = &p_Vid->f_rtp;
+      OpenRTPFile (p_Inp->outfile, p_Vid->f_out);
+      break;
+    default:
+      snprintf(errortext, ET_SIZE, "Output File Mode %d not supported", p_Inp->of_mode);
+      error(errortext,1);
+    }
   }
 
   // Access Unit Delimiter NALU
@@ -243,6 +257,9 @@ int terminate_sequence(VideoParameters *p_Vid, InputParameters *p_Inp)
   // Mainly flushing of everything
   // Add termination symbol, etc.
 
+  if (p_Vid->p_api)
+    return 1;
+
   switch(p_Inp->of_mode)
   {
   case PAR_OF_ANNEXB:
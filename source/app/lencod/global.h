@@ -45,6 +45,7 @@ struct storable_picture;
 struct coding_state;
 struct pic_motion_params_old;
 struct pic_motion_params;
+struct jm_encoder;
 
 typedef struct image_structure ImageStructure;
 typedef struct info_8x8 Info8x8;
@@ -112,6 +113,10 @@ struct encoding_environment
   int           *Ecodestrm_len;
   int           C;
   int           E;
+  int           rate_only;      //!< only count the code bytes, do not store them (RD mode decision)
+  int           rate_est;       //!< estimate the rate from the context states instead of coding (RD mode decision)
+  int64         Efrac_bits;     //!< estimated rate in 1/32768 bit units
+  struct ctx_journal *journal;  //!< journal of changed contexts (NULL if not used)
 };
 
 //! struct for context management
@@ -122,6 +127,21 @@ struct bi_context_type
   unsigned char  MPS;           // Least Probable Symbol 0/1 CP  
 };
 
+//! journal of the contexts changed since the last coding state store/reset (RD mode decision)
+typedef struct ctx_journal
+{
+  BiContextType *mot_base;     //!< live motion info contexts (seen as a flat array)
+  BiContextType *tex_base;     //!< live texture info contexts (seen as a flat array)
+  unsigned int   mot_num;      //!< number of motion info contexts
+  unsigned int   tex_num;      //!< number of texture info contexts
+  unsigned int  *stamp;        //!< segment in which each context was last logged
+  int           *entry;        //!< logged contexts (texture contexts follow the motion contexts)
+  int            num;          //!< number of logged contexts
+  int            size;         //!< journal capacity
+  unsigned int   segment;      //!< current segment, incremented with every store/reset
+  int            epoch;        //!< incremented whenever the journal is cleared
+} CtxJournal;
+
 
 
 /**********************************************************************
@@ -286,6 +306,7 @@ typedef struct me_block
   PixelPos         block[4];
   struct slice    *p_Slice;
   struct search_window searchRange;
+  int              reduced_search;  //!< low priority macroblock, see qp_map_fast_mb()
   int              cost;           //!< Rate Distortion cost
   imgpel         **orig_pic;      //!< Block Data
   int              ChromaMEEnable;
@@ -602,6 +623,7 @@ typedef struct slice
   char                symbol_mode;
   short               NoResidueDirect;
   short               partition_mode;
+  const int          *partition_map;                          //!< data partition of each syntax element
   short               idr_flag;
   int                 frame_no;
   unsigned int        PicSizeInMbs;
@@ -619,6 +641,7 @@ typedef struct slice
   DataPartition       *partArr;     //!< array of partitions
   MotionInfoContexts  *mot_ctx;     //!< pointer to struct of context models for use in CABAC
   TextureInfoContexts *tex_ctx;     //!< pointer to struct of context models for use in CABAC
+  CtxJournal          *ctx_journal; //!< journal of changed contexts for RD coding state store/reset
 
   int                 mvscale[6][MAX_REFERENCE_PICTURES];
   char                direct_spatial_mv_pred_flag;              //!< Direct Mode type to be used (0: Temporal, 1: Spatial)
@@ -691,6 +714,8 @@ typedef struct slice
   double norm_factor_8x8;
   int    norm_shift_4x4;
   int    norm_shift_8x8;
+  double est_err_4x4[6][4][4];  //!< distortion weights estErr4x4 / norm_factor_4x4 per qp_rem
+  double est_err_8x8[6][8][8];  //!< distortion weights estErr8x8 / norm_factor_8x8 per qp_rem
 
   imgpel ****mpr_4x4;           //!< prediction samples for   4x4 intra prediction modes
   imgpel ****mpr_8x8;           //!< prediction samples for   8x8 intra prediction modes
@@ -1232,6 +1257,7 @@ typedef struct video_par
   // rate control variables
   int NumberofCodedMacroBlocks;
   int BasicUnitQP;
+  Macroblock *last_coded_mb;        //!< used to find whether a macroblock is re-encoded
   int NumberofMBTextureBits;
   int NumberofMBHeaderBits;
   unsigned int BasicUnit;
@@ -1332,6 +1358,15 @@ typedef struct video_par
   double *mb16x16_cost_frame;
   double mb16x16_cost;
 
+  struct md_prune_info *md_prune_info;   //!< per macroblock statistics of the mode decision pruning rules
+  int    *mb_qp_offset;                  //!< macroblock QP offsets of the current frame (MBTree, QPMapFile)
+  int    *mb_qp_offset_buf[2];           //!< mb_qp_offset of each view
+  struct qp_map *p_qp_map;               //!< QP offset map (NULL if QPMapFile is not set)
+  struct mem_usage *p_mem;               //!< memory accounting by subsystem
+  struct enc_profile *p_prof;            //!< module timing of the coding thread (NULL if ModuleProfile = 0)
+  struct wp_moments *p_wp_org;           //!< sample sums of the source picture for weighted prediction
+  int     use_mb_qp_offset;              //!< mb_qp_offset holds the offsets of the current frame
+
   int **lrec;
   int ***lrec_uv;
   Boolean sp2_frame_indicator;
@@ -1387,6 +1422,7 @@ typedef struct video_par
   //! incremented with all P and I frames
   uint16 CurrentRTPSequenceNumber;     //!< The RTP sequence number of the current packet
   //!< incremented by one for each sent packet
+  int CurrentRTPTr;                    //!< tr of the last timestamp update (-1 before the first one)
 
   // This should be the right location for this
   //struct storable_picture **listX[6];
@@ -1410,6 +1446,7 @@ typedef struct video_par
   RCGeneric   *p_rc_gen_init, *p_rc_gen_best;
   RCQuadratic *p_rc_quad;
   RCQuadratic *p_rc_quad_init, *p_rc_quad_best;
+  struct rc_stats *p_rc_stats;       //!< two-pass statistics (NULL if RCPass = 0)
 
   double entropy[128];
   double enorm  [128];
@@ -1436,6 +1473,10 @@ typedef struct video_par
   int wka0, wka1, wka2, wka3, wka4;
   int EvaluateDBOff;
   int TurnDBOff;
+  struct mp_threads *p_mp_threads;  //!< concurrent coding of RDPictureDecision passes (NULL if disabled)
+  struct view_threads *p_view_threads; //!< concurrent coding of the second view of an access unit (NULL if disabled)
+  struct input_reader *p_reader;    //!< background input reader (NULL if frames are read synchronously)
+  struct jm_encoder   *p_api;       //!< library interface instance (NULL for the command line encoder)
   // Note that these function pointers definitely affect now parallelization since they are only
   // allocated once. We need to add such info at maybe within picture information or at a lower level
   // RC
@@ -1586,11 +1627,22 @@ extern void select_plane               (VideoParameters *p_Vid, ColorPlane color
 extern void select_transform           (Macroblock *currMB);
 extern void set_slice_type             (VideoParameters *p_Vid, InputParameters *p_Inp, int slice_type);
 extern void free_encoder_memory        (VideoParameters *p_Vid, InputParameters *p_Inp);
+extern EncoderParams *open_encoder     (int argc, char **argv, struct jm_encoder *p_api);
+extern void close_encoder              (EncoderParams *p_Encoder);
+extern void encode_sequence            (VideoParameters *p_Vid, InputParameters *p_Inp);
+extern int  sequence_length            (InputParameters *p_Inp);
+extern int  set_sequence_position      (VideoParameters *p_Vid, InputParameters *p_Inp, int curr_frame_to_code, int rc_enable);
+extern void encode_sequence_position   (VideoParameters *p_Vid, InputParameters *p_Inp, int curr_frame_to_code);
+extern void finish_sequence_position   (VideoParameters *p_Vid, InputParameters *p_Inp, TIME_T *start_time);
 extern void output_SP_coefficients     (VideoParameters *p_Vid, InputParameters *p_Inp);
 extern void read_SP_coefficients       (VideoParameters *p_Vid, InputParameters *p_Inp);
 extern void init_redundant_frame       (VideoParameters *p_Vid, InputParameters *p_Inp);
 extern void set_redundant_frame        (VideoParameters *p_Vid, InputParameters *p_Inp);
 extern void encode_one_redundant_frame (VideoParameters *p_Vid, InputParameters *p_Inp);
+extern int  init_orig_buffers          (VideoParameters *p_Vid, ImageData *imgData);
+extern void free_orig_planes           (VideoParameters *p_Vid, ImageData *imgData);
+extern Picture *malloc_picture         (void);
+extern void free_picture               (Picture *pic);
 
 
 // struct with pointers to the sub-images
@@ -31,7 +31,6 @@
 #define SYMTRACESTRING(s) // do nothing
 #endif
 
-const int * assignSE2partition[2] ;
 const int assignSE2partition_NoDP[SE_MAX_ELEMENTS] =
   {  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 const int assignSE2partition_DP[SE_MAX_ELEMENTS] =
@@ -59,7 +58,7 @@ int SliceHeader(Slice* currSlice)
   seq_parameter_set_rbsp_t *active_sps = currSlice->active_sps;
   pic_parameter_set_rbsp_t *active_pps = currSlice->active_pps;
 
-  int dP_nr = assignSE2partition[currSlice->partition_mode][SE_HEADER];
+  int dP_nr = currSlice->partition_map[SE_HEADER];
   Bitstream *bitstream = currSlice->partArr[dP_nr].bitstream;   
   int len = 0;
   unsigned int field_pic_flag = 0; 
@@ -45,6 +45,9 @@
 #include "fast_memory.h"
 #include "nalu.h"
 #include "ratectl.h"
+#include "rc_stats.h"
+#include "qp_map.h"
+#include "lookahead.h"
 #include "mb_access.h"
 #include "context_ini.h"
 #include "biariencode.h"
@@ -55,6 +58,7 @@
 #include "q_matrix.h"
 #include "q_offsets.h"
 #include "wp.h"
+#include "wp_moments.h"
 #include "input.h"
 #include "image.h"
 #include "errdo.h"
@@ -68,13 +72,18 @@
 #include "md_common.h"
 #include "me_epzs_common.h"
 #include "me_hme.h"
+#include "me_hme_threads.h"
+#include "image_mp_threads.h"
+#include "input_reader.h"
+#include "lencod_api_int.h"
+#include "profile.h"
 
 extern void UpdateDecoders            (VideoParameters *p_Vid, InputParameters *p_Inp, StorablePicture *enc_pic);
 
 extern void DeblockFrame              (VideoParameters *p_Vid, imgpel **, imgpel ***);
 
 static void code_a_picture            (VideoParameters *p_Vid, Picture *pic);
-static void field_picture             (VideoParameters *p_Vid, Picture *top, Picture *bottom);
+static void field_picture             (VideoParameters *p_Vid, Picture *top, Picture *bottom, int frame_pass);
 static void prepare_enc_frame_picture (VideoParameters *p_Vid, StorablePicture **stored_pic);
 #if (MVC_EXTENSION_ENABLE)
 static void writeout_picture          (VideoParameters *p_Vid, Picture *pic, int is_bottom);
@@ -233,7 +242,9 @@ static void code_a_plane(VideoParameters *p_Vid, InputParameters *p_Inp)
     else
       distortion.value[0] = distortion.value[1] = distortion.value[2] = 0;
 
+    profile_enter(p_Vid->p_prof, PROF_DEBLOCK);
     DeblockFrame (p_Vid, p_Vid->enc_picture->imgY, p_Vid->enc_picture->imgUV); //comment out to disable deblocking filter
+    profile_leave(p_Vid->p_prof);
 
     if(p_Inp->RDPictureDeblocking && !p_Vid->TurnDBOff)
     {
@@ -734,6 +745,14 @@ static int read_input_data(VideoParameters *p_Vid)
     else
 #endif
     {
+      // frames pushed through the library interface are converted from the caller's planes
+      if (p_Vid->p_api)
+        return api_read_frame (p_Vid, p_Vid->frm_no_in_file, p_Vid->imgData0.frm_data);
+
+      // frames taken from the input reader are already padded
+      if (ir_get_frame (p_Vid->p_reader, p_Vid->frm_no_in_file, p_Vid->imgData0.frm_data))
+        return 1;
+
       file_read = read_one_frame (p_Vid, &p_Inp->input_file1, p_Vid->frm_no_in_file, p_Inp->infile_header, &p_Inp->source, &p_Inp->output, p_Vid->imgData0.frm_data);
       if ( !file_read )
       {
@@ -759,9 +778,9 @@ void perform_encode_field(VideoParameters *p_Vid)
   p_Vid->field_picture = 1;  // we encode fields
 
 #if (MVC_EXTENSION_ENABLE)
-  field_picture (p_Vid, p_Vid->field_pic_ptr[0], p_Vid->field_pic_ptr[1]);
+  field_picture (p_Vid, p_Vid->field_pic_ptr[0], p_Vid->field_pic_ptr[1], FALSE);
 #else
-  field_picture (p_Vid, p_Vid->field_pic[0], p_Vid->field_pic[1]);
+  field_picture (p_Vid, p_Vid->field_pic[0], p_Vid->field_pic[1], FALSE);
 #endif
   p_Vid->fld_flag = TRUE;
 }
@@ -774,6 +793,7 @@ void perform_encode_frame(VideoParameters *p_Vid)
   int num_ref_idx_l1 = 0;
 
   int frame_type;
+  int frame_pass = FALSE;
 
   //Rate control
   if ( p_Inp->RCEnable && p_Inp->RCUpdateMode <= MAX_RC_MODE )
@@ -783,13 +803,17 @@ void perform_encode_frame(VideoParameters *p_Vid)
 
   //Rate control
   if(p_Inp->RCEnable)
+  {
+    profile_enter(p_Vid->p_prof, PROF_RATE_CONTROL);
     rc_init_frame(p_Vid, p_Inp);
+    profile_leave(p_Vid->p_prof);
+  }
   // Ensure that p_Vid->p_curr_frm_struct->qp is properly set
   p_Vid->p_curr_frm_struct->qp = p_Vid->qp;
 
   p_Vid->active_pps = p_Vid->PicParSet[0];
 
-  // HME. Currently not supported for B slices
+  // HME (P and B slices, both lists for B)
   if(p_Inp->HMEEnable)
   {
     if (p_Vid->type!=I_SLICE && p_Vid->type!=SI_SLICE)
@@ -804,6 +828,13 @@ void perform_encode_frame(VideoParameters *p_Vid)
     {
       frame_picture_mp (p_Vid, p_Inp); 
     }
+    else if ((p_Vid->type == B_SLICE || p_Vid->type == P_SLICE || p_Vid->type==I_SLICE) && p_Inp->PicInterlaceParallel && p_Vid->p_mp_threads)
+    {
+      // the frame is coded in its own thread next to the top field (see field_picture())
+      mp_frame_pass_start(p_Vid);
+      p_Vid->p_frame_pic = p_Vid->frame_pic[0];
+      frame_pass = TRUE;
+    }
     else
     {
       frame_picture (p_Vid, p_Vid->frame_pic[0], &p_Vid->imgData, 0);
@@ -857,7 +888,7 @@ void perform_encode_frame(VideoParameters *p_Vid)
     }
 
 #if (MVC_EXTENSION_ENABLE)
-    field_picture (p_Vid, p_Vid->field_pic_ptr[0], p_Vid->field_pic_ptr[1]);
+    field_picture (p_Vid, p_Vid->field_pic_ptr[0], p_Vid->field_pic_ptr[1], frame_pass);
 
     if(p_Inp->num_of_views==1 || p_Vid->view_id==0)  // first view will make the decision
     {
@@ -875,7 +906,7 @@ void perform_encode_frame(VideoParameters *p_Vid)
       p_Vid->fld_flag = (byte) p_Vid->sec_view_force_fld;
     }
 #else
-    field_picture (p_Vid, p_Vid->field_pic[0], p_Vid->field_pic[1]);
+    field_picture (p_Vid, p_Vid->field_pic[0], p_Vid->field_pic[1], frame_pass);
 
     if(p_Vid->rd_pass == 0)
       p_Vid->fld_flag = picture_structure_decision (p_Vid, p_Vid->frame_pic[0], p_Vid->field_pic[0], p_Vid->field_pic[1]);
@@ -891,6 +922,15 @@ void perform_encode_frame(VideoParameters *p_Vid)
       num_ref_idx_l0 = p_Vid->num_ref_idx_l0_active;
       num_ref_idx_l1 = p_Vid->num_ref_idx_l1_active;
     }
+    else if (frame_pass)
+    {
+      VideoParameters *p_Frm = p_Vid->p_mp_threads->pass[0].p_Vid;
+
+      tmpFrameQP = p_Frm->SumFrameQP;
+      num_ref_idx_l0 = p_Frm->num_ref_idx_l0_active;
+      num_ref_idx_l1 = p_Frm->num_ref_idx_l1_active;
+      mp_frame_pass_adopt(p_Vid);
+    }
     
     if ( p_Vid->fld_flag==0 )
     {
@@ -1182,15 +1222,31 @@ int update_video_stats(VideoParameters *p_Vid)
  */
 int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
 {
-  int i;
-  int nplane;
+  TIME_T start_time;
 
-  //Rate control
-  int bits = 0;
+  gettime(&start_time);          // start time in ms
 
-  TIME_T start_time;
-  TIME_T end_time;
-  int64  tmp_time;
+  if (!start_one_frame(p_Vid, p_Inp))
+    return 0;
+
+  code_one_frame(p_Vid, p_Inp);
+  finish_one_frame(p_Vid, p_Inp, &start_time);
+
+  return 1;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Set up the coding of one frame: read and process its source picture
+ * \return
+ *    0 if the source picture could not be read
+ ************************************************************************
+ */
+int start_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  int i;
+  int nplane;
 
   p_Vid->me_time = 0;
   p_Vid->rd_pass = 0;
@@ -1205,8 +1261,6 @@ int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
   for (i = 0; i < 6; i++)
     p_Vid->enc_frame_picture[i]  = NULL;
 
-  gettime(&start_time);          // start time in ms
-
   //Rate control
   p_Vid->write_macroblock = FALSE;
   /*
@@ -1225,10 +1279,12 @@ int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
                                // (and not to one of the field structures)
   init_frame (p_Vid, p_Inp);
 
+  profile_enter(p_Vid->p_prof, PROF_INPUT);
   if (p_Inp->enable_32_pulldown)
   {
     if ( !read_input_data_32pulldown (p_Vid) )
     {
+      profile_leave(p_Vid->p_prof);
       return 0;
     }
   }
@@ -1236,12 +1292,15 @@ int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
   {
     if ( !read_input_data (p_Vid) )
     {
+      profile_leave(p_Vid->p_prof);
       return 0;
     }
   }
 
   process_image(p_Vid, p_Inp);
   pad_borders (p_Inp->output, p_Vid->width, p_Vid->height, p_Vid->width_cr, p_Vid->height_cr, p_Vid->imgData.frm_data);
+  profile_leave(p_Vid->p_prof);
+  wp_moments_org(p_Vid);
 
 #if (MVC_EXTENSION_ENABLE)
   if(p_Inp->num_of_views==1 || p_Vid->view_id==0)
@@ -1285,17 +1344,48 @@ int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
     p_Vid->pWPX->curr_wp_rd_pass->algorithm = WP_REGULAR;
   }
 
+  return 1;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Code the frame set up by start_one_frame()
+ ************************************************************************
+ */
+void code_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
+{
   if (p_Inp->PicInterlace == FIELD_CODING)
     perform_encode_field(p_Vid);
   else
     perform_encode_frame(p_Vid);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Write the frame coded by code_one_frame(), store its reconstruction
+ *    and report it
+ * \param start_time
+ *    time the coding of the frame was started
+ ************************************************************************
+ */
+void finish_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp, TIME_T *start_time)
+{
+  //Rate control
+  int bits = 0;
+
+  TIME_T end_time;
+  int64  tmp_time;
 
   p_Vid->p_Stats->frame_counter++;
   p_Vid->p_Stats->frame_ctr[p_Vid->type]++;
 
   // Here, p_Vid->structure may be either FRAME or BOTTOM FIELD depending on whether AFF coding is used
   // The picture structure decision changes really only the fld_flag
+  profile_enter(p_Vid->p_prof, PROF_OUTPUT);
   write_frame_picture(p_Vid);
+  profile_leave(p_Vid->p_prof);
 
 #if (MVC_EXTENSION_ENABLE)
   if(p_Inp->num_of_views==2)
@@ -1351,7 +1441,11 @@ int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
       + (int)( p_Vid->p_Stats->bit_ctr_filler_data - p_Vid->p_Stats->bit_ctr_filler_data_n );
 
     if ( p_Inp->RCUpdateMode <= MAX_RC_MODE )
+    {
+      profile_enter(p_Vid->p_prof, PROF_RATE_CONTROL);
       p_Vid->rc_update_pict_frame_ptr(p_Vid, p_Inp, p_Vid->p_rc_quad, p_Vid->p_rc_gen, bits);
+      profile_leave(p_Vid->p_prof);
+    }
 
   }
 
@@ -1372,6 +1466,10 @@ int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
   if ( p_Inp->RCEnable && p_Inp->RCUpdateMode <= MAX_RC_MODE && p_Vid->type != B_SLICE && p_Inp->basicunit < p_Vid->FrameSizeInMbs )
     p_Vid->p_rc_quad->CurrLastQP = p_Vid->AverageFrameQP + p_Vid->p_rc_quad->bitdepth_qp_scale;
 
+  if ( p_Inp->RCPass == 1 && !p_Vid->redundant_coding )
+    rc_stats_write_frame(p_Vid, (int)( p_Vid->p_Stats->bit_ctr - p_Vid->p_Stats->bit_ctr_n )
+      + (int)( p_Vid->p_Stats->bit_ctr_filler_data - p_Vid->p_Stats->bit_ctr_filler_data_n ));
+
 #ifdef _LEAKYBUCKET_
   // Store bits used for this frame and increment counter of no. of coded frames
   if (!p_Vid->redundant_coding)
@@ -1396,7 +1494,7 @@ int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
   }
 
   gettime(&end_time);    // end time in ms
-  tmp_time  = timediff(&start_time, &end_time);
+  tmp_time  = timediff(start_time, &end_time);
   p_Vid->tot_time += tmp_time;
   tmp_time  = timenorm(tmp_time);
   p_Vid->me_time   = timenorm(p_Vid->me_time);
@@ -1443,14 +1541,18 @@ int encode_one_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
 
   //Rate control
   if(p_Inp->RCEnable)
+  {
+    profile_enter(p_Vid->p_prof, PROF_RATE_CONTROL);
     p_Vid->rc_update_picture_ptr( p_Vid, p_Inp, bits );
+    profile_leave(p_Vid->p_prof);
+  }
 
   // update bit counters
   update_bitcounter_stats(p_Vid);
 
   update_idr_order_stats(p_Vid);
 
-  return 1;
+  profile_picture_done(p_Vid->p_prof, p_Vid->type, p_Vid->p_curr_frm_struct->layer);
 }
 
 
@@ -1617,10 +1719,11 @@ static void calc_picture_bits(Picture *frame)
 /*!
  ************************************************************************
  * \brief
- *    Encodes a frame picture
+ *    Set up the coding of a frame picture: picture level parameters,
+ *    weighted prediction and the encoded picture buffer of the pass
  ************************************************************************
  */
-void frame_picture (VideoParameters *p_Vid, Picture *frame, ImageData *imgData, int rd_pass)
+void start_frame_picture (VideoParameters *p_Vid, int rd_pass)
 {
   int nplane;
   InputParameters *p_Inp = p_Vid->p_Inp;
@@ -1649,6 +1752,17 @@ void frame_picture (VideoParameters *p_Vid, Picture *frame, ImageData *imgData,
   {
     prepare_enc_frame_picture( p_Vid, &p_Vid->enc_frame_picture[rd_pass] );
   }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Code a frame picture set up by start_frame_picture()
+ ************************************************************************
+ */
+void code_frame_picture (VideoParameters *p_Vid, Picture *frame, ImageData *imgData)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
 
   p_Vid->fld_flag = FALSE;
   code_a_picture(p_Vid, frame);
@@ -1667,14 +1781,28 @@ void frame_picture (VideoParameters *p_Vid, Picture *frame, ImageData *imgData,
   }
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Encodes a frame picture
+ ************************************************************************
+ */
+void frame_picture (VideoParameters *p_Vid, Picture *frame, ImageData *imgData, int rd_pass)
+{
+  start_frame_picture(p_Vid, rd_pass);
+  code_frame_picture (p_Vid, frame, imgData);
+}
+
 
 /*!
  ************************************************************************
  * \brief
- *    Encodes a field picture, consisting of top and bottom field
+ *    Encodes a field picture, consisting of top and bottom field.
+ *    With frame_pass set the frame is coded concurrently and has to be
+ *    finished before the top field enters the reference buffer.
  ************************************************************************
  */
-static void field_picture (VideoParameters *p_Vid, Picture *top, Picture *bottom)
+static void field_picture (VideoParameters *p_Vid, Picture *top, Picture *bottom, int frame_pass)
 {
   InputParameters *p_Inp = p_Vid->p_Inp;
   //Rate control
@@ -1722,6 +1850,9 @@ static void field_picture (VideoParameters *p_Vid, Picture *top, Picture *bottom
 
   code_a_picture(p_Vid, top);
   p_Vid->enc_picture->structure = TOP_FIELD;
+
+  if (frame_pass)
+    mp_frame_pass_finish(p_Vid);
   store_picture_in_dpb(p_Vid->p_Dpb_layer[p_Vid->view_id], p_Vid->enc_field_picture[0], &p_Inp->output);
 
 #if (MVC_EXTENSION_ENABLE)
@@ -2104,6 +2235,24 @@ static void init_frame (VideoParameters *p_Vid, InputParameters *p_Inp)
   }
 #endif
   p_Vid->AdaptiveRounding            = p_Inp->AdaptiveRounding; 
+
+  // macroblock tree QP offsets (reference frames of the base view only)
+  p_Vid->use_mb_qp_offset = 0;
+#if (MVC_EXTENSION_ENABLE)
+  if (p_Vid->mb_qp_offset_buf[1] != NULL)
+    p_Vid->mb_qp_offset = p_Vid->mb_qp_offset_buf[p_Vid->view_id];
+#endif
+  if (p_Inp->MBTree && p_Vid->nal_reference_idc)
+  {
+#if (MVC_EXTENSION_ENABLE)
+    if (p_Vid->view_id == 0)
+#endif
+      p_Vid->use_mb_qp_offset = la_mb_tree_offsets(p_Vid->p_pred->p_la, p_Vid->frame_no, p_Inp->MBTreeStrength,
+        p_Vid->mb_qp_offset, p_Vid->PicWidthInMbs, p_Vid->FrameHeightInMbs);
+  }
+  // region of interest offsets of all frames and views
+  if (p_Vid->p_qp_map != NULL)
+    p_Vid->use_mb_qp_offset = qp_map_offsets(p_Vid->p_qp_map, p_Vid->frame_no, p_Vid->mb_qp_offset, p_Vid->use_mb_qp_offset);
 }
 
 /*!
@@ -2154,7 +2303,7 @@ void GenerateImagePyramid(VideoParameters *p_Vid, int size_x, int size_y, imgpel
     iCurrWidth  = iPrevWidth  >>1;
     iCurrHeight = iPrevHeight >>1;
 
-    PyrDownG5x5_U8CnR((const imgpel *) *(p_hme_img[i-1]), (int) ((p_hme_img[i-1][1]-p_hme_img[i-1][0])*sizeof(imgpel)), iPrevWidth, iPrevHeight, *(p_hme_img[i]), (int) ((p_hme_img[i][1]-p_hme_img[i][0])*sizeof(imgpel)), 1);
+    hme_pyramid_level(p_Vid, (const imgpel *) *(p_hme_img[i-1]), (int) ((p_hme_img[i-1][1]-p_hme_img[i-1][0])*sizeof(imgpel)), iPrevWidth, iPrevHeight, *(p_hme_img[i]), (int) ((p_hme_img[i][1]-p_hme_img[i][0])*sizeof(imgpel)));
 
     // update image dimensions
     iPrevWidth = iCurrWidth;
@@ -2190,6 +2339,8 @@ void UnifiedOneForthPix ( VideoParameters *p_Vid, StorablePicture *s)
   if(s->bInterpolated)
     return;
   s->bInterpolated = 1;
+  profile_enter(p_Vid->p_prof, PROF_INTERPOLATION);
+  alloc_sub_pel_planes(p_Vid, s);
   // Y component
   s->p_img_sub[0] = s->imgY_sub;
   s->p_curr_img_sub = s->imgY_sub;
@@ -2236,6 +2387,7 @@ void UnifiedOneForthPix ( VideoParameters *p_Vid, StorablePicture *s)
     OtfCompatibility_copyWithPadding( s->imgUV[0], s->imgUV[0], s->size_x_cr, s->size_y_cr, p_Vid->pad_size_uv_x,p_Vid->pad_size_uv_y ) ;
     OtfCompatibility_copyWithPadding( s->imgUV[1], s->imgUV[1], s->size_x_cr, s->size_y_cr, p_Vid->pad_size_uv_x, p_Vid->pad_size_uv_y ) ;
   }
+  profile_leave(p_Vid->p_prof);
 }
 
 /*!
@@ -2257,6 +2409,7 @@ void UnifiedOneForthPix_JV (VideoParameters *p_Vid, int nplane, StorablePicture
     if(s->bInterpolated)
       return;
     s->bInterpolated = 1;
+    alloc_sub_pel_planes(p_Vid, s);
     s->p_img[0] = s->imgY;
     s->p_img[1] = s->imgUV[0];
     s->p_img[2] = s->imgUV[1];
@@ -2269,6 +2422,7 @@ void UnifiedOneForthPix_JV (VideoParameters *p_Vid, int nplane, StorablePicture
     }
   }
 
+  profile_enter(p_Vid->p_prof, PROF_INTERPOLATION);
   // derive the subpixel images for first component
   s->colour_plane_id = nplane;
   s->p_curr_img = s->p_img[nplane];
@@ -2283,6 +2437,7 @@ void UnifiedOneForthPix_JV (VideoParameters *p_Vid, int nplane, StorablePicture
     // perform  padding ( copying borders) that is implicitly done above if p_Inp->OnTheFlyFractMCP=0
      OtfCompatibility_copyWithPadding( s->p_img[nplane], s->p_img[nplane], s->size_x, s->size_y, IMG_PAD_SIZE_X, IMG_PAD_SIZE_Y ) ;
   }
+  profile_leave(p_Vid->p_prof);
 }
 
   /*!
@@ -29,6 +29,9 @@ typedef struct coding_info {
 } CodingInfo;
 
 extern int     encode_one_frame      ( VideoParameters *p_Vid, InputParameters *p_Inp);
+extern int     start_one_frame       ( VideoParameters *p_Vid, InputParameters *p_Inp);
+extern void    code_one_frame        ( VideoParameters *p_Vid, InputParameters *p_Inp);
+extern void    finish_one_frame      ( VideoParameters *p_Vid, InputParameters *p_Inp, TIME_T *start_time);
 extern Boolean dummy_slice_too_big   ( int bits_slice);
 extern void    copy_rdopt_data       ( Macroblock *currMB);       // For MB level field/frame coding tools
 extern void    UnifiedOneForthPix    ( VideoParameters *p_Vid, StorablePicture *s);
@@ -36,6 +39,8 @@ extern void    GenerateHMELayers     ( VideoParameters *p_Vid, StorablePicture *
 // For 4:4:4 independent mode
 extern void    UnifiedOneForthPix_JV ( VideoParameters *p_Vid, int nplane, StorablePicture *s);
 extern void    frame_picture         ( VideoParameters *p_Vid, Picture *frame, ImageData *imgData, int rd_pass);
+extern void    start_frame_picture   ( VideoParameters *p_Vid, int rd_pass);
+extern void    code_frame_picture    ( VideoParameters *p_Vid, Picture *frame, ImageData *imgData);
 extern byte    get_idr_flag          ( VideoParameters *p_Vid );
 extern byte    get_random_access_flag( VideoParameters *p_Vid );
 extern void    write_non_vcl_nalu    ( VideoParameters *p_Vid);
@@ -19,6 +19,8 @@
 #include "wp.h"
 #include "pred_struct.h"
 #include "slice.h"
+#include "image_mp_threads.h"
+#include "profile.h"
 
 #define DBG_IMAGE_MP  0
 
@@ -101,6 +103,161 @@ void frame_picture_mp_exit(VideoParameters *p_Vid, CodingInfo *coding_info)
 }
 
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Set up pass idx of the concurrent passes to code frame_pic[rd_pass]
+ *    with weighted prediction. The weights are tested on the parameters
+ *    of the pass; the pass is started if the test is positive.
+ * \return
+ *    1 if the pass was started
+ ************************************************************************
+ */
+static int mp_start_wp_pass(VideoParameters *p_Vid, int idx, int rd_pass, int implicit, Slice **dummy_slice)
+{
+  VideoParameters *w = mp_pass_begin(p_Vid, idx);
+  int wp_pass;
+
+  w->currentPicture = p_Vid->frame_pic[rd_pass];
+  w->currentPicture->idr_flag = get_idr_flag(w);
+  init_slice_lite(w, dummy_slice, 0);
+  w->currentSlice = *dummy_slice;
+
+  if (w->type == B_SLICE)
+    wp_pass = w->TestWPBSlice(*dummy_slice, implicit);
+  else
+    wp_pass = w->TestWPPSlice(*dummy_slice, 0);
+
+  if (wp_pass != 1)
+    return 0;
+
+  start_frame_picture(w, rd_pass);
+  w->active_pps = p_Vid->PicParSet[implicit ? 2 : 1];
+  w->write_macroblock = FALSE;
+  w->p_curr_frm_struct->qp = w->qp;
+  mp_pass_start(p_Vid, idx, p_Vid->frame_pic[rd_pass]);
+
+  return 1;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Code the first pass of a P or B picture and its weighted prediction
+ *    passes concurrently (P: explicit WP, B: implicit and explicit WP).
+ *    The decisions are taken in the order of the serial passes.
+ * \return
+ *    number of passes used
+ ************************************************************************
+ */
+static int frame_picture_mp_wp_threads(VideoParameters *p_Vid, InputParameters *p_Inp, int rd_qp, int max_pass, CodingInfo *coding_info, FrameCodingMethod *best_method, int *apply_wp)
+{
+  Slice *dummy_slice[MP_MAX_PASSES] = { NULL };
+  int   started[MP_MAX_PASSES] = { 0 };
+  int   num_tests = 1;
+  int   rd_pass = 1;
+  int   last = -1;
+  int   idx;
+
+  start_frame_picture(p_Vid, 0);
+
+  if (p_Vid->type == B_SLICE)
+  {
+    started[0] = mp_start_wp_pass(p_Vid, 0, 1, TRUE, &dummy_slice[0]);
+    if (1 + started[0] < max_pass)
+    {
+      started[1] = mp_start_wp_pass(p_Vid, 1, 1 + started[0], FALSE, &dummy_slice[1]);
+      num_tests = 2;
+    }
+  }
+  else
+    started[0] = mp_start_wp_pass(p_Vid, 0, 1, FALSE, &dummy_slice[0]);
+
+  code_frame_picture(p_Vid, p_Vid->frame_pic[0], &p_Vid->imgData);
+  store_coding_info(p_Vid, coding_info);
+
+  for (idx = 0; idx < num_tests; ++idx)
+  {
+    if (started[idx])
+      mp_pass_wait(p_Vid, idx);
+    free_slice(dummy_slice[idx]);
+  }
+
+  for (idx = 0; idx < num_tests; ++idx)
+  {
+    if (started[idx])
+    {
+      VideoParameters *w = p_Vid->p_mp_threads->pass[idx].p_Vid;
+
+      if (picture_coding_decision(p_Vid, p_Vid->frame_pic[0], p_Vid->frame_pic[rd_pass], rd_qp))
+      {
+        swap_frame_buffer(p_Vid, 0, rd_pass);
+        store_coding_info(w, coding_info);
+        *best_method = (p_Vid->type == B_SLICE && idx == 0) ? IMP_WP : EXP_WP;
+        *apply_wp = (p_Vid->type == B_SLICE) ? *best_method : 1;
+      }
+      p_Vid->write_macroblock = FALSE;
+      last = idx;
+      ++rd_pass;
+    }
+  }
+
+  // adaptive state and weights as left by the last serial weighted prediction pass
+  if (last >= 0)
+    mp_pass_adopt(p_Vid, last);
+  mp_pass_adopt_wp(p_Vid, num_tests - 1);
+
+  return rd_pass;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Code the QP-1 and QP+1 passes of an I picture concurrently with the
+ *    first pass
+ ************************************************************************
+ */
+static void frame_picture_mp_i_slice_threads(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  int   qp = p_Vid->qp;
+  int   num_passes = imin(p_Inp->RDPictureMaxPassISlice, MP_MAX_PASSES + 1);
+  int   rd_pass;
+  CodingInfo coding_info;
+
+  start_frame_picture(p_Vid, 0);
+
+  for (rd_pass = 1; rd_pass < num_passes; ++rd_pass)
+  {
+    VideoParameters *w = mp_pass_begin(p_Vid, rd_pass - 1);
+
+    w->qp = iClip3( p_Vid->RCMinQP, p_Vid->RCMaxQP, rd_pass == 1 ? qp - 1 : qp + 1 );
+    w->write_macroblock = FALSE;
+    w->p_curr_frm_struct->qp = w->qp;
+    start_frame_picture(w, rd_pass);
+    mp_pass_start(p_Vid, rd_pass - 1, p_Vid->frame_pic[rd_pass]);
+  }
+
+  code_frame_picture(p_Vid, p_Vid->frame_pic[0], &p_Vid->imgData);
+  store_coding_info(p_Vid, &coding_info);
+
+  for (rd_pass = 1; rd_pass < num_passes; ++rd_pass)
+    mp_pass_wait(p_Vid, rd_pass - 1);
+
+  for (rd_pass = 1; rd_pass < num_passes; ++rd_pass)
+  {
+    if (picture_coding_decision(p_Vid, p_Vid->frame_pic[0], p_Vid->frame_pic[rd_pass], qp))
+    {
+      swap_frame_buffer(p_Vid, 0, rd_pass);
+      store_coding_info(p_Vid->p_mp_threads->pass[rd_pass - 1].p_Vid, &coding_info);
+    }
+  }
+
+  // adaptive state and picture QP of the last pass, as in serial coding
+  mp_pass_adopt(p_Vid, num_passes - 2);
+  p_Vid->write_macroblock = FALSE;
+  frame_picture_mp_exit(p_Vid, &coding_info);
+}
+
 void frame_picture_mp_p_slice(VideoParameters *p_Vid, InputParameters *p_Inp)
 {
   int   rd_pass = 0;
@@ -114,137 +271,150 @@ void frame_picture_mp_p_slice(VideoParameters *p_Vid, InputParameters *p_Inp)
   int apply_wp = 0;
   int selection;
 
-  frame_picture (p_Vid, p_Vid->frame_pic[rd_pass], &p_Vid->imgData, rd_pass);
-  store_coding_and_rc_info(p_Vid, &coding_info);
-
-  if(p_Inp->WPIterMC)
-    p_Vid->frameOffsetAvail = 1; 
-
-#if (DBG_IMAGE_MP)
-    printf("rd_pass = %d: %d (%.0f, %.0f, %.0f)\n", rd_pass, 
-      p_Vid->frame_pic[0]->bits_per_picture, 
-      p_Vid->frame_pic[0]->distortion.value[0], p_Vid->frame_pic[0]->distortion.value[1], p_Vid->frame_pic[0]->distortion.value[2]);
-#endif
-
-  rd_pass++;
-  if(rd_pass >= p_Inp->RDPictureMaxPassPSlice)
+  if (p_Vid->p_mp_threads && p_Inp->RDPictureMaxPassPSlice > 1 && p_Inp->GenerateMultiplePPS
+    && p_Inp->WPMethod != 0 && !p_Inp->WPIterMC && !p_Inp->WPMCPrecision)
   {
-    frame_picture_mp_exit(p_Vid, &coding_info);
-    return;
+    // first pass and explicit WP pass coded concurrently
+    rd_pass = frame_picture_mp_wp_threads(p_Vid, p_Inp, rd_qp, p_Inp->RDPictureMaxPassPSlice, &coding_info, &best_method, &apply_wp);
+    if(rd_pass >= p_Inp->RDPictureMaxPassPSlice)
+    {
+      frame_picture_mp_exit(p_Vid, &coding_info);
+      return;
+    }
   }
-
-  // for P_Slice, consider WP  
-  wp_pass = 0;
-  if (p_Inp->GenerateMultiplePPS)
+  else
   {
-    Slice *dummy_slice = NULL;
+    frame_picture (p_Vid, p_Vid->frame_pic[rd_pass], &p_Vid->imgData, rd_pass);
+    store_coding_and_rc_info(p_Vid, &coding_info);
 
-    InitWP(p_Vid, p_Inp, 0);
-    if ( p_Inp->WPMCPrecision )
-      p_Vid->pWPX->curr_wp_rd_pass = p_Vid->pWPX->wp_rd_passes + 1;
-    init_slice_lite(p_Vid, &dummy_slice, 0);
+    if(p_Inp->WPIterMC)
+      p_Vid->frameOffsetAvail = 1; 
+
+  #if (DBG_IMAGE_MP)
+      printf("rd_pass = %d: %d (%.0f, %.0f, %.0f)\n", rd_pass, 
+        p_Vid->frame_pic[0]->bits_per_picture, 
+        p_Vid->frame_pic[0]->distortion.value[0], p_Vid->frame_pic[0]->distortion.value[1], p_Vid->frame_pic[0]->distortion.value[2]);
+  #endif
 
-    if (p_Vid->TestWPPSlice(dummy_slice, 0) == 1)
+    rd_pass++;
+    if(rd_pass >= p_Inp->RDPictureMaxPassPSlice)
     {
-      // regular WP pass
-      p_Vid->active_pps = p_Vid->PicParSet[1];
-      if ( p_Inp->WPMCPrecision )
-        p_Vid->pWPX->curr_wp_rd_pass->algorithm = WP_REGULAR;
-      wp_pass = 1;
+      frame_picture_mp_exit(p_Vid, &coding_info);
+      return;
     }
-    else if ( p_Inp->WPMCPrecision )
-    {
-      // WPMC pass
-      p_Vid->active_pps = p_Vid->PicParSet[1];
-      wp_pass = 1;
-    }  
-
-    // The way it is, the code would only reach here if prior conditional using 
-    // generatemultiplepps is satisfied
-    if(wp_pass)
+
+    // for P_Slice, consider WP  
+    wp_pass = 0;
+    if (p_Inp->GenerateMultiplePPS)
     {
-      p_Vid->write_macroblock = FALSE;
-      p_Vid->p_curr_frm_struct->qp = p_Vid->qp;
-      frame_picture (p_Vid, p_Vid->frame_pic[rd_pass], &p_Vid->imgData, rd_pass);
-      selection = picture_coding_decision(p_Vid, p_Vid->frame_pic[0], p_Vid->frame_pic[rd_pass], rd_qp);
-#if (DBG_IMAGE_MP)
-      printf("rd_pass = %d, selection = %d\n", rd_pass, selection);
-#endif
-#if (DBG_IMAGE_MP)
-      printf("rd_pass = %d: %d (%.0f, %.0f, %.0f)\n", rd_pass, 
-        p_Vid->frame_pic[rd_pass]->bits_per_picture, 
-        p_Vid->frame_pic[rd_pass]->distortion.value[0], p_Vid->frame_pic[rd_pass]->distortion.value[1], p_Vid->frame_pic[rd_pass]->distortion.value[2]);
-#endif
+      Slice *dummy_slice = NULL;
+
+      InitWP(p_Vid, p_Inp, 0);
+      if ( p_Inp->WPMCPrecision )
+        p_Vid->pWPX->curr_wp_rd_pass = p_Vid->pWPX->wp_rd_passes + 1;
+      init_slice_lite(p_Vid, &dummy_slice, 0);
 
-      if (selection)
+      if (p_Vid->TestWPPSlice(dummy_slice, 0) == 1)
       {
-        swap_frame_buffer(p_Vid, 0, rd_pass); 
-        store_coding_and_rc_info(p_Vid, &coding_info);
-        best_method = EXP_WP;
-        apply_wp = 1;
+        // regular WP pass
+        p_Vid->active_pps = p_Vid->PicParSet[1];
+        if ( p_Inp->WPMCPrecision )
+          p_Vid->pWPX->curr_wp_rd_pass->algorithm = WP_REGULAR;
+        wp_pass = 1;
       }
+      else if ( p_Inp->WPMCPrecision )
+      {
+        // WPMC pass
+        p_Vid->active_pps = p_Vid->PicParSet[1];
+        wp_pass = 1;
+      }  
 
-      if(p_Inp->WPMethod == 0 || p_Inp->WPMCPrecision) 
+      // The way it is, the code would only reach here if prior conditional using 
+      // generatemultiplepps is satisfied
+      if(wp_pass)
       {
-        wp_pass = 0;
-        if ( p_Inp->WPMCPrecision )
-          p_Vid->pWPX->curr_wp_rd_pass = p_Vid->pWPX->wp_rd_passes + 2;
-        if (p_Inp->WPMethod == 0 && p_Vid->TestWPPSlice(dummy_slice, 1) == 1)
-        {
-          // regular WP pass
-          p_Vid->active_pps = p_Vid->PicParSet[1];
-          if ( p_Inp->WPMCPrecision )
-            p_Vid->pWPX->curr_wp_rd_pass->algorithm = WP_REGULAR;
-          wp_pass = 1;
-        }
-        else if ( p_Inp->WPMCPrecision )
+        p_Vid->write_macroblock = FALSE;
+        p_Vid->p_curr_frm_struct->qp = p_Vid->qp;
+        frame_picture (p_Vid, p_Vid->frame_pic[rd_pass], &p_Vid->imgData, rd_pass);
+        selection = picture_coding_decision(p_Vid, p_Vid->frame_pic[0], p_Vid->frame_pic[rd_pass], rd_qp);
+  #if (DBG_IMAGE_MP)
+        printf("rd_pass = %d, selection = %d\n", rd_pass, selection);
+  #endif
+  #if (DBG_IMAGE_MP)
+        printf("rd_pass = %d: %d (%.0f, %.0f, %.0f)\n", rd_pass, 
+          p_Vid->frame_pic[rd_pass]->bits_per_picture, 
+          p_Vid->frame_pic[rd_pass]->distortion.value[0], p_Vid->frame_pic[rd_pass]->distortion.value[1], p_Vid->frame_pic[rd_pass]->distortion.value[2]);
+  #endif
+
+        if (selection)
         {
-          // WPMC pass
-          p_Vid->active_pps = p_Vid->PicParSet[1];
-          wp_pass = 1;
+          swap_frame_buffer(p_Vid, 0, rd_pass); 
+          store_coding_and_rc_info(p_Vid, &coding_info);
+          best_method = EXP_WP;
+          apply_wp = 1;
         }
 
-        if(wp_pass)
+        if(p_Inp->WPMethod == 0 || p_Inp->WPMCPrecision) 
         {
-          p_Vid->write_macroblock = FALSE;
-          p_Vid->p_curr_frm_struct->qp = p_Vid->qp;
-          free_slice_list(p_Vid->frame_pic[rd_pass]);
-          free_storable_picture(p_Vid, p_Vid->enc_frame_picture[rd_pass]);
-          frame_picture (p_Vid, p_Vid->frame_pic[rd_pass], &p_Vid->imgData, rd_pass);
-          selection = picture_coding_decision(p_Vid, p_Vid->frame_pic[0], p_Vid->frame_pic[rd_pass], rd_qp);
-#if (DBG_IMAGE_MP)
-          printf("rd_pass = %d, selection = %d\n", rd_pass, selection);
-#endif
-#if (DBG_IMAGE_MP)
-          printf("rd_pass = %d: %d (%.0f, %.0f, %.0f)\n", rd_pass, 
-            p_Vid->frame_pic[rd_pass]->bits_per_picture, 
-            p_Vid->frame_pic[rd_pass]->distortion.value[0], p_Vid->frame_pic[rd_pass]->distortion.value[1], p_Vid->frame_pic[rd_pass]->distortion.value[2]);
-#endif
+          wp_pass = 0;
+          if ( p_Inp->WPMCPrecision )
+            p_Vid->pWPX->curr_wp_rd_pass = p_Vid->pWPX->wp_rd_passes + 2;
+          if (p_Inp->WPMethod == 0 && p_Vid->TestWPPSlice(dummy_slice, 1) == 1)
+          {
+            // regular WP pass
+            p_Vid->active_pps = p_Vid->PicParSet[1];
+            if ( p_Inp->WPMCPrecision )
+              p_Vid->pWPX->curr_wp_rd_pass->algorithm = WP_REGULAR;
+            wp_pass = 1;
+          }
+          else if ( p_Inp->WPMCPrecision )
+          {
+            // WPMC pass
+            p_Vid->active_pps = p_Vid->PicParSet[1];
+            wp_pass = 1;
+          }
 
-          if (selection)
+          if(wp_pass)
           {
-            swap_frame_buffer(p_Vid, 0, rd_pass); 
-            store_coding_and_rc_info(p_Vid, &coding_info);
-            best_method = EXP_WP;
-            apply_wp = 1;
+            p_Vid->write_macroblock = FALSE;
+            p_Vid->p_curr_frm_struct->qp = p_Vid->qp;
+            free_slice_list(p_Vid->frame_pic[rd_pass]);
+            free_storable_picture(p_Vid, p_Vid->enc_frame_picture[rd_pass]);
+            frame_picture (p_Vid, p_Vid->frame_pic[rd_pass], &p_Vid->imgData, rd_pass);
+            selection = picture_coding_decision(p_Vid, p_Vid->frame_pic[0], p_Vid->frame_pic[rd_pass], rd_qp);
+  #if (DBG_IMAGE_MP)
+            printf("rd_pass = %d, selection = %d\n", rd_pass, selection);
+  #endif
+  #if (DBG_IMAGE_MP)
+            printf("rd_pass = %d: %d (%.0f, %.0f, %.0f)\n", rd_pass, 
+              p_Vid->frame_pic[rd_pass]->bits_per_picture, 
+              p_Vid->frame_pic[rd_pass]->distortion.value[0], p_Vid->frame_pic[rd_pass]->distortion.value[1], p_Vid->frame_pic[rd_pass]->distortion.value[2]);
+  #endif
+
+            if (selection)
+            {
+              swap_frame_buffer(p_Vid, 0, rd_pass); 
+              store_coding_and_rc_info(p_Vid, &coding_info);
+              best_method = EXP_WP;
+              apply_wp = 1;
+            }
           }
         }
-      }
 
-      rd_pass++;
-      //free_slice(dummy_slice);
+        rd_pass++;
+        //free_slice(dummy_slice);
 
-      if(rd_pass >= p_Inp->RDPictureMaxPassPSlice)
-      {
-        frame_picture_mp_exit(p_Vid, &coding_info);
-        free_slice(dummy_slice);
-        return;
+        if(rd_pass >= p_Inp->RDPictureMaxPassPSlice)
+        {
+          frame_picture_mp_exit(p_Vid, &coding_info);
+          free_slice(dummy_slice);
+          return;
+        }
       }
+      free_slice(dummy_slice);
     }
-    free_slice(dummy_slice);
   }
 
-
   // code as I? or maybe as B?
   frame_type_pass = 0;
   if(p_Inp->RDPSliceITest && (coding_info.intras * 100/p_Vid->FrameSizeInMbs) >= 75)
@@ -340,7 +510,9 @@ void frame_picture_mp_p_slice(VideoParameters *p_Vid, InputParameters *p_Inp)
     if ( p_Inp->RCEnable )
     {
       rateRatio = p_Vid->nal_reference_idc ? 1.15F : 0.85F;
+      profile_enter(p_Vid->p_prof, PROF_RATE_CONTROL);
       rc_init_frame_rdpic( p_Vid, p_Inp, rateRatio );
+      profile_leave(p_Vid->p_prof);
     }
     p_Vid->TurnDBOff = 0;
     p_Vid->write_macroblock = FALSE;
@@ -396,7 +568,9 @@ void frame_picture_mp_i_slice(VideoParameters *p_Vid, InputParameters *p_Inp)
     if ( p_Inp->RCEnable )
     {
       rateRatio = 1.15F;
+      profile_enter(p_Vid->p_prof, PROF_RATE_CONTROL);
       rc_init_frame_rdpic( p_Vid, p_Inp, rateRatio );
+      profile_leave(p_Vid->p_prof);
     }
 
     p_Vid->write_macroblock = FALSE;
@@ -425,7 +599,9 @@ void frame_picture_mp_i_slice(VideoParameters *p_Vid, InputParameters *p_Inp)
     if ( p_Inp->RCEnable )
     {
       rateRatio = 1.0F;
+      profile_enter(p_Vid->p_prof, PROF_RATE_CONTROL);
       rc_init_frame_rdpic( p_Vid, p_Inp, rateRatio );
+      profile_leave(p_Vid->p_prof);
     }
 
     p_Vid->qp = iClip3( p_Vid->RCMinQP, p_Vid->RCMaxQP, p_Vid->qp );
@@ -466,126 +642,140 @@ void frame_picture_mp_b_slice(VideoParameters *p_Vid, InputParameters *p_Inp)
   printf("pass0_wp = %d\n", p_Vid->pass0_wp);
 #endif  
 
-  frame_picture (p_Vid, p_Vid->frame_pic[rd_pass], &p_Vid->imgData, rd_pass);
-  store_coding_and_rc_info(p_Vid, &coding_info);
-  
-  if(p_Inp->WPIterMC)
-    p_Vid->frameOffsetAvail = 1; 
-
-  rd_pass++;
-  if(rd_pass >= p_Inp->RDPictureMaxPassBSlice)
+  if (p_Vid->p_mp_threads && p_Inp->RDPictureMaxPassBSlice > 1 && p_Inp->GenerateMultiplePPS
+    && !p_Inp->WPIterMC && !p_Inp->WPMCPrecision)
   {
-    frame_picture_mp_exit(p_Vid, &coding_info);
-    return;
+    // first pass and implicit/explicit WP passes coded concurrently
+    rd_pass = frame_picture_mp_wp_threads(p_Vid, p_Inp, rd_qp, p_Inp->RDPictureMaxPassBSlice, &coding_info, &best_method, &apply_wp);
+    if(rd_pass >= p_Inp->RDPictureMaxPassBSlice)
+    {
+      frame_picture_mp_exit(p_Vid, &coding_info);
+      return;
+    }
   }
+  else
+  {
+    frame_picture (p_Vid, p_Vid->frame_pic[rd_pass], &p_Vid->imgData, rd_pass);
+    store_coding_and_rc_info(p_Vid, &coding_info);
+  
+    if(p_Inp->WPIterMC)
+      p_Vid->frameOffsetAvail = 1; 
 
-  init_slice_lite(p_Vid, &dummy_slice, 0);
-
-#if (DBG_IMAGE_MP)
-    printf("rd_pass = %d: %d (%.0f, %.0f, %.0f)\n", rd_pass, 
-      p_Vid->frame_pic[0]->bits_per_picture, 
-      p_Vid->frame_pic[0]->distortion.value[0], p_Vid->frame_pic[0]->distortion.value[1], p_Vid->frame_pic[0]->distortion.value[2]);
-#endif
-
-  // for B_Slice, consider implicit WP 
-  wp_pass = 0;
-  {    
-    if (p_Inp->GenerateMultiplePPS)
+    rd_pass++;
+    if(rd_pass >= p_Inp->RDPictureMaxPassBSlice)
     {
-      InitWP(p_Vid, p_Inp, 0);
-      if ( p_Inp->WPMCPrecision )
-        p_Vid->pWPX->curr_wp_rd_pass = p_Vid->pWPX->wp_rd_passes + 1;
-
-      if (p_Vid->TestWPBSlice(dummy_slice, 1) == 1)
-      {
-        // regular WP pass
-        p_Vid->active_pps = p_Vid->PicParSet[2];
-        if(p_Inp->WPMCPrecision)
-          p_Vid->pWPX->curr_wp_rd_pass->algorithm = WP_REGULAR;
-        wp_pass = 1;
-      }
+      frame_picture_mp_exit(p_Vid, &coding_info);
+      return;
     }
 
-    if(wp_pass)
-    {
-      p_Vid->write_macroblock = FALSE;
-      p_Vid->p_curr_frm_struct->qp = p_Vid->qp;
-      frame_picture (p_Vid, p_Vid->frame_pic[rd_pass], &p_Vid->imgData, rd_pass);
-      selection = picture_coding_decision(p_Vid, p_Vid->frame_pic[0], p_Vid->frame_pic[rd_pass], rd_qp);
-#if (DBG_IMAGE_MP)
-      printf("IMP WP, rd_pass = %d, selection = %d\n", rd_pass, selection);
+    init_slice_lite(p_Vid, &dummy_slice, 0);
+
+  #if (DBG_IMAGE_MP)
       printf("rd_pass = %d: %d (%.0f, %.0f, %.0f)\n", rd_pass, 
-        p_Vid->frame_pic[rd_pass]->bits_per_picture, 
-        p_Vid->frame_pic[rd_pass]->distortion.value[0], p_Vid->frame_pic[rd_pass]->distortion.value[1], p_Vid->frame_pic[rd_pass]->distortion.value[2]);
-#endif
+        p_Vid->frame_pic[0]->bits_per_picture, 
+        p_Vid->frame_pic[0]->distortion.value[0], p_Vid->frame_pic[0]->distortion.value[1], p_Vid->frame_pic[0]->distortion.value[2]);
+  #endif
 
-      if (selection)
+    // for B_Slice, consider implicit WP 
+    wp_pass = 0;
+    {    
+      if (p_Inp->GenerateMultiplePPS)
       {
-        swap_frame_buffer(p_Vid, 0, rd_pass); 
-        store_coding_and_rc_info(p_Vid, &coding_info);
-        best_method = IMP_WP; 
-        apply_wp = IMP_WP;
+        InitWP(p_Vid, p_Inp, 0);
+        if ( p_Inp->WPMCPrecision )
+          p_Vid->pWPX->curr_wp_rd_pass = p_Vid->pWPX->wp_rd_passes + 1;
+
+        if (p_Vid->TestWPBSlice(dummy_slice, 1) == 1)
+        {
+          // regular WP pass
+          p_Vid->active_pps = p_Vid->PicParSet[2];
+          if(p_Inp->WPMCPrecision)
+            p_Vid->pWPX->curr_wp_rd_pass->algorithm = WP_REGULAR;
+          wp_pass = 1;
+        }
       }
 
-      rd_pass++;
-      if(rd_pass >= p_Inp->RDPictureMaxPassBSlice)
+      if(wp_pass)
       {
-        frame_picture_mp_exit(p_Vid, &coding_info);
-        free_slice(dummy_slice);
-        return;
-      }
-    }
+        p_Vid->write_macroblock = FALSE;
+        p_Vid->p_curr_frm_struct->qp = p_Vid->qp;
+        frame_picture (p_Vid, p_Vid->frame_pic[rd_pass], &p_Vid->imgData, rd_pass);
+        selection = picture_coding_decision(p_Vid, p_Vid->frame_pic[0], p_Vid->frame_pic[rd_pass], rd_qp);
+  #if (DBG_IMAGE_MP)
+        printf("IMP WP, rd_pass = %d, selection = %d\n", rd_pass, selection);
+        printf("rd_pass = %d: %d (%.0f, %.0f, %.0f)\n", rd_pass, 
+          p_Vid->frame_pic[rd_pass]->bits_per_picture, 
+          p_Vid->frame_pic[rd_pass]->distortion.value[0], p_Vid->frame_pic[rd_pass]->distortion.value[1], p_Vid->frame_pic[rd_pass]->distortion.value[2]);
+  #endif
+
+        if (selection)
+        {
+          swap_frame_buffer(p_Vid, 0, rd_pass); 
+          store_coding_and_rc_info(p_Vid, &coding_info);
+          best_method = IMP_WP; 
+          apply_wp = IMP_WP;
+        }
 
-    // for B_Slice, consider explicit WP 
-    wp_pass = 0;
-    if (p_Inp->GenerateMultiplePPS)
-    {
-      InitWP(p_Vid, p_Inp, 0);
-      if( p_Inp->WPMCPrecision )
-        p_Vid->pWPX->curr_wp_rd_pass = p_Vid->pWPX->wp_rd_passes + 1;
+        rd_pass++;
+        if(rd_pass >= p_Inp->RDPictureMaxPassBSlice)
+        {
+          frame_picture_mp_exit(p_Vid, &coding_info);
+          free_slice(dummy_slice);
+          return;
+        }
+      }
 
-      if (p_Vid->TestWPBSlice(dummy_slice, 0) == 1)
+      // for B_Slice, consider explicit WP 
+      wp_pass = 0;
+      if (p_Inp->GenerateMultiplePPS)
       {
-        // regular WP pass
-        p_Vid->active_pps = p_Vid->PicParSet[1];
+        InitWP(p_Vid, p_Inp, 0);
         if( p_Inp->WPMCPrecision )
-          p_Vid->pWPX->curr_wp_rd_pass->algorithm = WP_REGULAR;
-        wp_pass = 1;
-      }
-      else if ( p_Inp->WPMCPrecision == 2 && (p_Inp->WPMCPrecBSlice == 2 || (p_Inp->WPMCPrecBSlice == 1 && p_Vid->nal_reference_idc) ) )
-      {
-        p_Vid->active_pps = p_Vid->PicParSet[1];
-        wp_pass = 1;
-      }
-    }
-
-    if(wp_pass)
-    {
-      p_Vid->write_macroblock = FALSE;
-      p_Vid->p_curr_frm_struct->qp = p_Vid->qp;
-      frame_picture (p_Vid, p_Vid->frame_pic[rd_pass], &p_Vid->imgData, rd_pass);
-      selection = picture_coding_decision(p_Vid, p_Vid->frame_pic[0], p_Vid->frame_pic[rd_pass], rd_qp);
-#if (DBG_IMAGE_MP)
-      printf("EXP WP, rd_pass = %d, selection = %d\n", rd_pass, selection);
-      printf("rd_pass = %d: %d (%.0f, %.0f, %.0f)\n", rd_pass, 
-        p_Vid->frame_pic[rd_pass]->bits_per_picture, 
-        p_Vid->frame_pic[rd_pass]->distortion.value[0], p_Vid->frame_pic[rd_pass]->distortion.value[1], p_Vid->frame_pic[rd_pass]->distortion.value[2]);
-#endif
+          p_Vid->pWPX->curr_wp_rd_pass = p_Vid->pWPX->wp_rd_passes + 1;
 
-      if (selection)
-      {
-        swap_frame_buffer(p_Vid, 0, rd_pass); 
-        store_coding_and_rc_info(p_Vid, &coding_info);
-        best_method = EXP_WP;
-        apply_wp = EXP_WP;
+        if (p_Vid->TestWPBSlice(dummy_slice, 0) == 1)
+        {
+          // regular WP pass
+          p_Vid->active_pps = p_Vid->PicParSet[1];
+          if( p_Inp->WPMCPrecision )
+            p_Vid->pWPX->curr_wp_rd_pass->algorithm = WP_REGULAR;
+          wp_pass = 1;
+        }
+        else if ( p_Inp->WPMCPrecision == 2 && (p_Inp->WPMCPrecBSlice == 2 || (p_Inp->WPMCPrecBSlice == 1 && p_Vid->nal_reference_idc) ) )
+        {
+          p_Vid->active_pps = p_Vid->PicParSet[1];
+          wp_pass = 1;
+        }
       }
 
-      rd_pass++;
-      if(rd_pass >= p_Inp->RDPictureMaxPassBSlice)
+      if(wp_pass)
       {
-        frame_picture_mp_exit(p_Vid, &coding_info);
-        free_slice(dummy_slice);
-        return;
+        p_Vid->write_macroblock = FALSE;
+        p_Vid->p_curr_frm_struct->qp = p_Vid->qp;
+        frame_picture (p_Vid, p_Vid->frame_pic[rd_pass], &p_Vid->imgData, rd_pass);
+        selection = picture_coding_decision(p_Vid, p_Vid->frame_pic[0], p_Vid->frame_pic[rd_pass], rd_qp);
+  #if (DBG_IMAGE_MP)
+        printf("EXP WP, rd_pass = %d, selection = %d\n", rd_pass, selection);
+        printf("rd_pass = %d: %d (%.0f, %.0f, %.0f)\n", rd_pass, 
+          p_Vid->frame_pic[rd_pass]->bits_per_picture, 
+          p_Vid->frame_pic[rd_pass]->distortion.value[0], p_Vid->frame_pic[rd_pass]->distortion.value[1], p_Vid->frame_pic[rd_pass]->distortion.value[2]);
+  #endif
+
+        if (selection)
+        {
+          swap_frame_buffer(p_Vid, 0, rd_pass); 
+          store_coding_and_rc_info(p_Vid, &coding_info);
+          best_method = EXP_WP;
+          apply_wp = EXP_WP;
+        }
+
+        rd_pass++;
+        if(rd_pass >= p_Inp->RDPictureMaxPassBSlice)
+        {
+          frame_picture_mp_exit(p_Vid, &coding_info);
+          free_slice(dummy_slice);
+          return;
+        }
       }
     }
   }
@@ -600,7 +790,9 @@ void frame_picture_mp_b_slice(VideoParameters *p_Vid, InputParameters *p_Inp)
     if ( p_Inp->RCEnable )
     {
       rateRatio = p_Vid->nal_reference_idc ? 1.15F : 0.85F;
+      profile_enter(p_Vid->p_prof, PROF_RATE_CONTROL);
       rc_init_frame_rdpic( p_Vid, p_Inp, rateRatio );
+      profile_leave(p_Vid->p_prof);
     }
 
     p_Vid->write_macroblock = FALSE;
@@ -676,7 +868,10 @@ void frame_picture_mp(VideoParameters *p_Vid, InputParameters *p_Inp)
   p_Vid->TurnDBOff = 0;
   if(p_Vid->type == I_SLICE)
   {
-    frame_picture_mp_i_slice(p_Vid, p_Inp);
+    if (p_Vid->p_mp_threads && p_Inp->RDPictureMaxPassISlice > 1)
+      frame_picture_mp_i_slice_threads(p_Vid, p_Inp);
+    else
+      frame_picture_mp_i_slice(p_Vid, p_Inp);
   }
   else if(p_Vid->type == P_SLICE)
   {
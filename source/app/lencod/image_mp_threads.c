@@ -0,0 +1,559 @@
+
+/*!
+ *************************************************************************************
+ * \file image_mp_threads.c
+ *
+ * \brief
+ *    Concurrent coding of RDPictureDecision passes and of the frame pass of
+ *    adaptive frame/field (PAFF) pictures.
+ *
+ *    Each pass owns a VideoParameters structure that is synchronised with the
+ *    encoder state before the pass starts. Source and reference pictures and
+ *    the read-only tables are shared; everything that is written while a
+ *    picture is coded (macroblock data, lambdas, quantization offsets,
+ *    weights, context models, slice partition maps, distortion and
+ *    statistics) is private to the pass.
+ *    The adaptive state of the last pass is copied back into the encoder,
+ *    as serial passes leave it behind whatever the picture decision.
+ *
+ *    The passes do not write the shared reference buffer: mp_pass_begin()
+ *    numbers the reference frames before a pass starts, so the slices of
+ *    the passes find the numbers current and update_frame_pic_num() stores
+ *    nothing. Frame references keep a chroma vector adjustment of 0, and
+ *    the plane pointers of the references only change for 4:4:4 coding,
+ *    which is coded serially. The field pictures of PAFF coding only change
+ *    field references, which the concurrent frame pass does not use.
+ *
+ *************************************************************************************
+ */
+
+#include "global.h"
+#include "memalloc.h"
+#include "image.h"
+#include "context_ini.h"
+#include "macroblock.h"
+#include "md_prune.h"
+#include "fmo.h"
+#include "sei.h"
+#include "image_mp_threads.h"
+#include "profile.h"
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Check whether pictures can be coded on a private copy of the coding
+ *    parameters next to the encoder thread. Tools that keep state across
+ *    pictures or change the reference buffer while a slice is initialised
+ *    need serial coding.
+ *************************************************************************************
+ */
+int mp_pass_tools_supported(InputParameters *p_Inp)
+{
+  if (TRACE || p_Inp->output.yuv_format == YUV444 || p_Inp->MbInterlace)
+    return FALSE;
+  if (p_Inp->redundant_pic_flag || p_Inp->partition_mode || p_Inp->rdopt == 3)
+    return FALSE;
+  if (p_Inp->RCEnable || p_Inp->CtxAdptLagrangeMult || p_Inp->RandomIntraMBRefresh || p_Inp->RestrictRef)
+    return FALSE;
+  // serial passes start from the rounding offsets adapted by the previous pass
+  if (p_Inp->AdaptiveRounding)
+    return FALSE;
+  if (p_Inp->UseRDOQuant && p_Inp->RDOQ_QP_Num > 1)
+    return FALSE;
+  if (p_Inp->SearchMode[0] == UM_HEX || p_Inp->SearchMode[0] == UM_HEX_SIMPLE || p_Inp->SearchMode[0] == FAST_FULL_SEARCH)
+    return FALSE;
+  if (p_Inp->SetFirstAsLongTerm)
+    return FALSE;
+#if CRA
+  if (p_Inp->useCRA)
+    return FALSE;
+#endif
+#if HM50_LIKE_MMCO
+  if (p_Inp->HM50RefStructure)
+    return FALSE;
+#endif
+#if LD_REF_SETTING
+  if (p_Inp->LDRefSetting)
+    return FALSE;
+#endif
+
+  return TRUE;
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Check whether the passes of a picture can be coded concurrently
+ *************************************************************************************
+ */
+static int mp_threads_supported(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  if (p_Inp->num_of_views == 2)
+    return FALSE;
+
+  return mp_pass_tools_supported(p_Inp);
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Allocate the private buffers of a pass (see init_img())
+ *************************************************************************************
+ */
+void alloc_mp_pass(MPPass *pass, VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  VideoParameters *p_Priv;
+  int scale = p_Vid->bitdepth_luma_qp_scale;
+  int max_bitdepth = imax(p_Inp->output.bit_depth[0], p_Inp->output.bit_depth[1]);
+  int max_qp = (3 + 6 * max_bitdepth);
+
+  if ((pass->p_Vid = (VideoParameters *) calloc(1, sizeof(VideoParameters))) == NULL)
+    no_mem_exit("alloc_mp_pass: pass->p_Vid");
+  if ((pass->p_Priv = (VideoParameters *) calloc(1, sizeof(VideoParameters))) == NULL)
+    no_mem_exit("alloc_mp_pass: pass->p_Priv");
+  p_Priv = pass->p_Priv;
+
+  if ((p_Priv->mb_data = alloc_mbs(p_Vid, p_Vid->FrameSizeInMbs, 1)) == NULL)
+    no_mem_exit("alloc_mp_pass: p_Priv->mb_data");
+  if ((p_Priv->b8x8info = (Block8x8Info *) calloc(1, sizeof(Block8x8Info))) == NULL)
+    no_mem_exit("alloc_mp_pass: p_Priv->b8x8info");
+  if (p_Vid->intra_block)
+  {
+    if ((p_Priv->intra_block = (short*) calloc(p_Vid->FrameSizeInMbs, sizeof(short))) == NULL)
+      no_mem_exit("alloc_mp_pass: p_Priv->intra_block");
+  }
+  if (p_Vid->md_prune_info)
+  {
+    if ((p_Priv->md_prune_info = (MDPruneInfo *) calloc(p_Vid->FrameSizeInMbs, sizeof(MDPruneInfo))) == NULL)
+      no_mem_exit("alloc_mp_pass: p_Priv->md_prune_info");
+  }
+
+  get_mem2D((byte***)&(p_Priv->ipredmode), p_Vid->height_blk, p_Vid->width_blk);
+  get_mem2D((byte***)&(p_Priv->ipredmode8x8), p_Vid->height_blk, p_Vid->width_blk);
+  memset(&(p_Priv->ipredmode[0][0])   , -1, p_Vid->height_blk * p_Vid->width_blk *sizeof(char));
+  memset(&(p_Priv->ipredmode8x8[0][0]), -1, p_Vid->height_blk * p_Vid->width_blk *sizeof(char));
+  get_mem3Dint(&(p_Priv->nz_coeff), p_Vid->FrameSizeInMbs, 4, 4 + p_Vid->num_blk8x8_uv);
+
+  // lambdas are recomputed for every slice
+  get_mem2Dolm     (&(p_Priv->lambda)   , 10, 52 + scale, scale);
+  get_mem2Dodouble (&(p_Priv->lambda_md), 10, 52 + scale, scale);
+  get_mem3Dodouble (&(p_Priv->lambda_me), 10, 52 + scale, 3, scale);
+  get_mem3Doint    (&(p_Priv->lambda_mf), 10, 52 + scale, 3, scale);
+  if (p_Vid->lambda_rdoq)
+    get_mem2Dodouble (&(p_Priv->lambda_rdoq), 10, 52 + scale, scale);
+
+  if (p_Vid->ARCofAdj4x4)
+  {
+    int comp8x8 = (p_Vid->yuv_format != 0 && p_Vid->P444_joined) ? 3 : 1;
+    get_mem4Dint(&(p_Priv->ARCofAdj4x4), p_Vid->yuv_format != 0 ? 3 : 1, MAXMODE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+    get_mem4Dint(&(p_Priv->ARCofAdj8x8), comp8x8, MAXMODE, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  }
+
+  if (p_Vid->wp_weights)
+  {
+    get_mem4Dshort(&(p_Priv->wp_weights), 3, 2, MAX_REFERENCE_PICTURES, p_Vid->num_slices_wp);
+    get_mem4Dshort(&(p_Priv->wp_offsets), 3, 2, MAX_REFERENCE_PICTURES, p_Vid->num_slices_wp);
+    get_mem5Dshort(&(p_Priv->wbp_weight), 3, 2, MAX_REFERENCE_PICTURES, MAX_REFERENCE_PICTURES, p_Vid->num_slices_wp);
+  }
+
+  if (p_Vid->motion_cost)
+    get_mem4Ddistblk(&(p_Priv->motion_cost), 8, 2, p_Vid->max_num_references, 4);
+
+  get_mem3Dint(&(p_Priv->initialized), 3, FRAME_TYPES, p_Vid->number_of_slices);
+  get_mem3Dint(&(p_Priv->modelNumber), 3, FRAME_TYPES, p_Vid->number_of_slices);
+  p_Priv->p_prof = p_Vid->p_prof ? profile_create() : NULL;
+
+  get_mem5Dquant(&(pass->quant.q_params_4x4), 3, 2, max_qp + 1, 4, 4);
+  get_mem5Dquant(&(pass->quant.q_params_8x8), 3, 2, max_qp + 1, 8, 8);
+  get_mem3Dshort(&(pass->quant.OffsetList4x4), p_Inp->AdaptRoundingFixed ? 1 : max_qp + 1, 25, 16);
+  get_mem3Dshort(&(pass->quant.OffsetList8x8), p_Inp->AdaptRoundingFixed ? 1 : max_qp + 1, 15, 64);
+  pass->quant_size4x4 = (p_Inp->AdaptRoundingFixed ? 1 : max_qp + 1) * 25 * 16;
+  pass->quant_size8x8 = (p_Inp->AdaptRoundingFixed ? 1 : max_qp + 1) * 15 * 64;
+  pass->qparam_size   = 3 * 2 * (max_qp + 1);
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Free the private buffers of a pass
+ *************************************************************************************
+ */
+void free_mp_pass(MPPass *pass, VideoParameters *p_Vid)
+{
+  VideoParameters *p_Priv = pass->p_Priv;
+  int scale = p_Vid->bitdepth_luma_qp_scale;
+
+  free_mbs(p_Priv->mb_data, p_Vid->FrameSizeInMbs);
+  free_pointer(p_Priv->b8x8info);
+  free_pointer(p_Priv->intra_block);
+  free_pointer(p_Priv->md_prune_info);
+  free_mem2D((byte**)p_Priv->ipredmode);
+  free_mem2D((byte**)p_Priv->ipredmode8x8);
+  free_mem3Dint(p_Priv->nz_coeff);
+
+  free_mem2Dolm     (p_Priv->lambda, scale);
+  free_mem2Dodouble (p_Priv->lambda_md, scale);
+  free_mem3Dodouble (p_Priv->lambda_me, 10, 52 + scale, scale);
+  free_mem3Doint    (p_Priv->lambda_mf, 10, 52 + scale, scale);
+  if (p_Priv->lambda_rdoq)
+    free_mem2Dodouble (p_Priv->lambda_rdoq, scale);
+
+  if (p_Priv->ARCofAdj4x4)
+  {
+    free_mem4Dint(p_Priv->ARCofAdj4x4);
+    free_mem4Dint(p_Priv->ARCofAdj8x8);
+  }
+  if (p_Priv->wp_weights)
+  {
+    free_mem4Dshort(p_Priv->wp_weights);
+    free_mem4Dshort(p_Priv->wp_offsets);
+    free_mem5Dshort(p_Priv->wbp_weight);
+  }
+  if (p_Priv->motion_cost)
+    free_mem4Ddistblk(p_Priv->motion_cost);
+  free_mem3Dint(p_Priv->initialized);
+  free_mem3Dint(p_Priv->modelNumber);
+  profile_free(p_Priv->p_prof);
+
+  // slice group maps are (re)allocated by FmoInit() of the pass
+  if (pass->p_Vid->p_Inp != NULL)
+  {
+    p_Priv->MBAmap = pass->p_Vid->MBAmap;
+    p_Priv->MapUnitToSliceGroupMap = pass->p_Vid->MapUnitToSliceGroupMap;
+  }
+  FmoUninit(p_Priv);
+
+  free_mem5Dquant(pass->quant.q_params_4x4);
+  free_mem5Dquant(pass->quant.q_params_8x8);
+  free_mem3Dshort(pass->quant.OffsetList4x4);
+  free_mem3Dshort(pass->quant.OffsetList8x8);
+
+  free(pass->p_Priv);
+  free(pass->p_Vid);
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Set up concurrent coding of RDPictureDecision passes if it is enabled
+ *    and supported by the coding tools in use
+ *************************************************************************************
+ */
+void init_mp_threads(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  int i;
+
+  int supported = mp_threads_supported(p_Vid, p_Inp);
+  int rd_passes = p_Inp->RDPictureDecision && p_Inp->RDPictureParallel;
+  int paff      = p_Inp->PicInterlaceParallel;
+
+  p_Vid->p_mp_threads = NULL;
+  if (rd_passes && (!supported || p_Inp->PicInterlace != FRAME_CODING))
+  {
+    printf("RDPictureParallel: coding tools in use need serial RD picture passes, disabled.\n");
+    rd_passes = FALSE;
+  }
+  // the RDPictureDecision passes of the frame keep their own adaptive state
+  if (paff && (!supported || p_Inp->RDPictureDecision))
+  {
+    printf("PicInterlaceParallel: coding tools in use need serial frame and field coding, disabled.\n");
+    paff = FALSE;
+  }
+  if (!rd_passes && !paff)
+    return;
+
+  if ((p_Vid->p_mp_threads = (MPThreads *) calloc(1, sizeof(MPThreads))) == NULL)
+    no_mem_exit("init_mp_threads: p_Vid->p_mp_threads");
+
+  for (i = 0; i < MP_MAX_PASSES; ++i)
+    alloc_mp_pass(&p_Vid->p_mp_threads->pass[i], p_Vid, p_Inp);
+}
+
+void free_mp_threads(VideoParameters *p_Vid)
+{
+  int i;
+
+  if (p_Vid->p_mp_threads == NULL)
+    return;
+
+  for (i = 0; i < MP_MAX_PASSES; ++i)
+    free_mp_pass(&p_Vid->p_mp_threads->pass[i], p_Vid);
+
+  free(p_Vid->p_mp_threads);
+  p_Vid->p_mp_threads = NULL;
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Synchronise the parameters of a pass with the encoder state.
+ *    The picture coding state of the encoder is copied, the private buffers
+ *    of the pass are kept.
+ * \return
+ *    parameters to set up and code the pass with
+ *************************************************************************************
+ */
+VideoParameters *sync_mp_pass(MPPass *pass, VideoParameters *p_Vid)
+{
+  VideoParameters *w = pass->p_Vid;
+  VideoParameters *p_Priv = pass->p_Priv;
+  QuantParameters *p_Quant = p_Vid->p_Quant;
+
+  // keep the slice group maps of the previous picture (FmoInit() reallocates them)
+  if (w->p_Inp != NULL)
+  {
+    p_Priv->MBAmap = w->MBAmap;
+    p_Priv->MapUnitToSliceGroupMap = w->MapUnitToSliceGroupMap;
+  }
+
+  *w = *p_Vid;
+
+  w->mb_data       = p_Priv->mb_data;
+  w->b8x8info      = p_Priv->b8x8info;
+  w->intra_block   = p_Priv->intra_block;
+  w->md_prune_info = p_Priv->md_prune_info;
+  w->ipredmode     = p_Priv->ipredmode;
+  w->ipredmode8x8  = p_Priv->ipredmode8x8;
+  w->nz_coeff      = w->nz_coeff_buf[0] = w->nz_coeff_buf[1] = p_Priv->nz_coeff;
+
+  w->lambda      = w->lambda_buf[0]      = w->lambda_buf[1]      = p_Priv->lambda;
+  w->lambda_md   = w->lambda_md_buf[0]   = w->lambda_md_buf[1]   = p_Priv->lambda_md;
+  w->lambda_me   = w->lambda_me_buf[0]   = w->lambda_me_buf[1]   = p_Priv->lambda_me;
+  w->lambda_mf   = w->lambda_mf_buf[0]   = w->lambda_mf_buf[1]   = p_Priv->lambda_mf;
+  w->lambda_rdoq = w->lambda_rdoq_buf[0] = w->lambda_rdoq_buf[1] = p_Priv->lambda_rdoq;
+
+  w->ARCofAdj4x4 = p_Priv->ARCofAdj4x4;
+  w->ARCofAdj8x8 = p_Priv->ARCofAdj8x8;
+  w->motion_cost = p_Priv->motion_cost;
+
+  w->MBAmap = p_Priv->MBAmap;
+  w->MapUnitToSliceGroupMap = p_Priv->MapUnitToSliceGroupMap;
+
+  if (p_Vid->wp_weights)
+  {
+    w->wp_weights = p_Priv->wp_weights;
+    w->wp_offsets = p_Priv->wp_offsets;
+    w->wbp_weight = p_Priv->wbp_weight;
+    memcpy(&w->wp_weights[0][0][0][0], &p_Vid->wp_weights[0][0][0][0], 3 * 2 * MAX_REFERENCE_PICTURES * p_Vid->num_slices_wp * sizeof(short));
+    memcpy(&w->wp_offsets[0][0][0][0], &p_Vid->wp_offsets[0][0][0][0], 3 * 2 * MAX_REFERENCE_PICTURES * p_Vid->num_slices_wp * sizeof(short));
+    memcpy(&w->wbp_weight[0][0][0][0][0], &p_Vid->wbp_weight[0][0][0][0][0], 3 * 2 * MAX_REFERENCE_PICTURES * MAX_REFERENCE_PICTURES * p_Vid->num_slices_wp * sizeof(short));
+  }
+
+  w->initialized = p_Priv->initialized;
+  w->modelNumber = p_Priv->modelNumber;
+  memcpy(&w->initialized[0][0][0], &p_Vid->initialized[0][0][0], 3 * FRAME_TYPES * p_Vid->number_of_slices * sizeof(int));
+  memcpy(&w->modelNumber[0][0][0], &p_Vid->modelNumber[0][0][0], 3 * FRAME_TYPES * p_Vid->number_of_slices * sizeof(int));
+
+  pass->dist = *p_Vid->p_Dist;
+  w->p_Dist = &pass->dist;
+  pass->stats = pass->stats_start = *p_Vid->p_Stats;
+  w->p_Stats = &pass->stats;
+  w->p_prof = p_Priv->p_prof;
+  profile_resume(w->p_prof);
+
+  {
+    QuantParameters *q = &pass->quant;
+    LevelQuantParams *****q_params_4x4 = q->q_params_4x4, *****q_params_8x8 = q->q_params_8x8;
+    short ***OffsetList4x4 = q->OffsetList4x4, ***OffsetList8x8 = q->OffsetList8x8;
+
+    *q = *p_Quant;
+    q->q_params_4x4  = q_params_4x4;
+    q->q_params_8x8  = q_params_8x8;
+    q->OffsetList4x4 = OffsetList4x4;
+    q->OffsetList8x8 = OffsetList8x8;
+    memcpy(&q->q_params_4x4[0][0][0][0][0], &p_Quant->q_params_4x4[0][0][0][0][0], pass->qparam_size * 16 * sizeof(LevelQuantParams));
+    memcpy(&q->q_params_8x8[0][0][0][0][0], &p_Quant->q_params_8x8[0][0][0][0][0], pass->qparam_size * 64 * sizeof(LevelQuantParams));
+    memcpy(&q->OffsetList4x4[0][0][0], &p_Quant->OffsetList4x4[0][0][0], pass->quant_size4x4 * sizeof(short));
+    memcpy(&q->OffsetList8x8[0][0][0], &p_Quant->OffsetList8x8[0][0][0], pass->quant_size8x8 * sizeof(short));
+    w->p_Quant = q;
+  }
+
+  pass->frm_struct = *p_Vid->p_curr_frm_struct;
+  w->p_curr_frm_struct = &pass->frm_struct;
+
+  w->p_mp_threads  = NULL;
+  w->last_coded_mb = NULL;
+
+  return w;
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Synchronise the parameters of pass idx with the encoder state
+ * \return
+ *    parameters to set up and code the pass with
+ *************************************************************************************
+ */
+VideoParameters *mp_pass_begin(VideoParameters *p_Vid, int idx)
+{
+  // number the references before any pass initialises its slices on them
+  update_frame_pic_num(p_Vid->p_Dpb_layer[p_Vid->view_id], p_Vid->frame_num, p_Vid->max_frame_num);
+
+  return sync_mp_pass(&p_Vid->p_mp_threads->pass[idx], p_Vid);
+}
+
+static void mp_pass_code(void *arg)
+{
+  MPPass *pass = (MPPass *) arg;
+  VideoParameters *w = pass->p_Vid;
+
+  code_frame_picture(w, pass->frame, &w->imgData);
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Start coding pass idx into frame. The pass is coded in place if no
+ *    thread can be created.
+ *************************************************************************************
+ */
+void mp_pass_start(VideoParameters *p_Vid, int idx, Picture *frame)
+{
+  MPPass *pass = &p_Vid->p_mp_threads->pass[idx];
+
+  pass->frame = frame;
+  pass->threaded = (thread_create(&pass->thread, mp_pass_code, pass) == 0);
+  if (!pass->threaded)
+    mp_pass_code(pass);
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Wait for pass idx and merge its search statistics into the encoder
+ *************************************************************************************
+ */
+void mp_pass_wait(VideoParameters *p_Vid, int idx)
+{
+  MPPass *pass = &p_Vid->p_mp_threads->pass[idx];
+
+  if (pass->threaded)
+  {
+    thread_join(pass->thread);
+    pass->threaded = FALSE;
+  }
+
+  merge_mp_pass_stats(pass, p_Vid->p_Stats);
+  profile_merge(p_Vid->p_prof, pass->p_Vid->p_prof);
+
+  p_Vid->EvaluateDBOff |= pass->p_Vid->EvaluateDBOff;
+
+  // the pass built the same marking commands as the encoder thread, which keeps its own
+  if (pass->p_Vid->dec_ref_pic_marking_buffer != p_Vid->dec_ref_pic_marking_buffer)
+    free_drpm_buffer(pass->p_Vid->dec_ref_pic_marking_buffer);
+  pass->p_Vid->dec_ref_pic_marking_buffer = NULL;
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Add the search statistics gathered by a pass to p_Stats
+ *************************************************************************************
+ */
+void merge_mp_pass_stats(MPPass *pass, StatParameters *p_Stats)
+{
+  int i;
+
+  p_Stats->me_cand.searches += pass->stats.me_cand.searches - pass->stats_start.me_cand.searches;
+  p_Stats->me_cand.proposed += pass->stats.me_cand.proposed - pass->stats_start.me_cand.proposed;
+  p_Stats->me_cand.accepted += pass->stats.me_cand.accepted - pass->stats_start.me_cand.accepted;
+  p_Stats->me_cand.scored   += pass->stats.me_cand.scored   - pass->stats_start.me_cand.scored;
+  for (i = 0; i < MD_PRUNE_RULES; ++i)
+  {
+    p_Stats->md_prune.checked[i] += pass->stats.md_prune.checked[i] - pass->stats_start.md_prune.checked[i];
+    p_Stats->md_prune.hits[i]    += pass->stats.md_prune.hits[i]    - pass->stats_start.md_prune.hits[i];
+    p_Stats->md_prune.misses[i]  += pass->stats.md_prune.misses[i]  - pass->stats_start.md_prune.misses[i];
+  }
+}
+
+static void adopt_rounding_offsets(VideoParameters *p_Vid, MPPass *pass)
+{
+  memcpy(&p_Vid->p_Quant->OffsetList4x4[0][0][0], &pass->quant.OffsetList4x4[0][0][0], pass->quant_size4x4 * sizeof(short));
+  memcpy(&p_Vid->p_Quant->OffsetList8x8[0][0][0], &pass->quant.OffsetList8x8[0][0][0], pass->quant_size8x8 * sizeof(short));
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Take over the adaptive coding state left by pass idx. Serial passes
+ *    code on the encoder state one after the other, so the state of the last
+ *    pass survives whichever pass wins the picture decision.
+ *************************************************************************************
+ */
+void mp_pass_adopt(VideoParameters *p_Vid, int idx)
+{
+  MPPass *pass = &p_Vid->p_mp_threads->pass[idx];
+  VideoParameters *w = pass->p_Vid;
+
+  p_Vid->qp       = w->qp;
+  p_Vid->masterQP = w->masterQP;
+  adopt_rounding_offsets(p_Vid, pass);
+  memcpy(&p_Vid->initialized[0][0][0], &w->initialized[0][0][0], 3 * FRAME_TYPES * p_Vid->number_of_slices * sizeof(int));
+  memcpy(&p_Vid->modelNumber[0][0][0], &w->modelNumber[0][0][0], 3 * FRAME_TYPES * p_Vid->number_of_slices * sizeof(int));
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Take over the weighted prediction parameters estimated by pass idx
+ *************************************************************************************
+ */
+void mp_pass_adopt_wp(VideoParameters *p_Vid, int idx)
+{
+  VideoParameters *w = p_Vid->p_mp_threads->pass[idx].p_Vid;
+
+  if (p_Vid->wp_weights == NULL)
+    return;
+
+  memcpy(&p_Vid->wp_weights[0][0][0][0], &w->wp_weights[0][0][0][0], 3 * 2 * MAX_REFERENCE_PICTURES * p_Vid->num_slices_wp * sizeof(short));
+  memcpy(&p_Vid->wp_offsets[0][0][0][0], &w->wp_offsets[0][0][0][0], 3 * 2 * MAX_REFERENCE_PICTURES * p_Vid->num_slices_wp * sizeof(short));
+  memcpy(&p_Vid->wbp_weight[0][0][0][0][0], &w->wbp_weight[0][0][0][0][0], 3 * 2 * MAX_REFERENCE_PICTURES * MAX_REFERENCE_PICTURES * p_Vid->num_slices_wp * sizeof(short));
+  p_Vid->wp_parameters_set = w->wp_parameters_set;
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Start coding the current picture as frame (frame_pic[0]) in pass 0, next
+ *    to the field coding of an adaptive frame/field picture
+ *************************************************************************************
+ */
+void mp_frame_pass_start(VideoParameters *p_Vid)
+{
+  VideoParameters *w = mp_pass_begin(p_Vid, 0);
+
+  start_frame_picture(w, 0);
+  mp_pass_start(p_Vid, 0, p_Vid->frame_pic[0]);
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Wait for the frame pass and take over the coded frame. Frame and field
+ *    pictures keep their context models in separate rows, so the frame row
+ *    is copied as left by the frame pass.
+ *************************************************************************************
+ */
+void mp_frame_pass_finish(VideoParameters *p_Vid)
+{
+  VideoParameters *w = p_Vid->p_mp_threads->pass[0].p_Vid;
+
+  mp_pass_wait(p_Vid, 0);
+
+  p_Vid->enc_frame_picture[0] = w->enc_frame_picture[0];
+  memcpy(&p_Vid->initialized[0][0][0], &w->initialized[0][0][0], FRAME_TYPES * p_Vid->number_of_slices * sizeof(int));
+  memcpy(&p_Vid->modelNumber[0][0][0], &w->modelNumber[0][0][0], FRAME_TYPES * p_Vid->number_of_slices * sizeof(int));
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Take over the rounding offsets of the frame pass after the frame has
+ *    been selected by the picture structure decision
+ *************************************************************************************
+ */
+void mp_frame_pass_adopt(VideoParameters *p_Vid)
+{
+  adopt_rounding_offsets(p_Vid, &p_Vid->p_mp_threads->pass[0]);
+}
@@ -0,0 +1,68 @@
+
+/*!
+ ***************************************************************************
+ * \file
+ *    image_mp_threads.h
+ *
+ * \brief
+ *    Headerfile for the concurrent coding of RDPictureDecision passes.
+ *
+ *    Passes that do not depend on the outcome of the previous passes of
+ *    the same picture (the alternative QPs of I pictures and the weighted
+ *    prediction passes of P and B pictures) are coded in their own thread
+ *    on a private copy of the coding parameters, while the first pass is
+ *    coded in the encoder thread. With adaptive frame/field coding the
+ *    frame is coded in its own thread while the encoder codes the fields.
+ **************************************************************************
+ */
+
+#ifndef _IMAGE_MP_THREADS_H_
+#define _IMAGE_MP_THREADS_H_
+
+#include "thread_common.h"
+
+#define MP_MAX_PASSES  2      //!< passes coded next to the first pass
+
+//! one concurrently coded pass
+typedef struct mp_pass
+{
+  VideoParameters *p_Vid;         //!< coding parameters of the pass (private buffers, shared pictures)
+  VideoParameters *p_Priv;        //!< keeps the private buffers while p_Vid is synchronised
+  DistortionParams dist;
+  StatParameters   stats;
+  StatParameters   stats_start;   //!< statistics at the start of the pass
+  QuantParameters  quant;         //!< private quantization parameters and rounding offsets
+  int              qparam_size;   //!< number of 4x4/8x8 quantization parameter sets
+  int              quant_size4x4; //!< size of the rounding offset lists
+  int              quant_size8x8;
+  FrameUnitStruct  frm_struct;
+
+  Picture         *frame;         //!< picture coded by the pass
+  int              threaded;      //!< pass is coded in its own thread
+  ThreadHandle     thread;
+} MPPass;
+
+typedef struct mp_threads
+{
+  MPPass pass[MP_MAX_PASSES];
+} MPThreads;
+
+extern int              mp_pass_tools_supported(InputParameters *p_Inp);
+extern void             alloc_mp_pass     (MPPass *pass, VideoParameters *p_Vid, InputParameters *p_Inp);
+extern void             free_mp_pass      (MPPass *pass, VideoParameters *p_Vid);
+extern VideoParameters *sync_mp_pass      (MPPass *pass, VideoParameters *p_Vid);
+extern void             merge_mp_pass_stats(MPPass *pass, StatParameters *p_Stats);
+
+extern void             init_mp_threads   (VideoParameters *p_Vid, InputParameters *p_Inp);
+extern void             free_mp_threads   (VideoParameters *p_Vid);
+extern VideoParameters *mp_pass_begin     (VideoParameters *p_Vid, int idx);
+extern void             mp_pass_start     (VideoParameters *p_Vid, int idx, Picture *frame);
+extern void             mp_pass_wait      (VideoParameters *p_Vid, int idx);
+extern void             mp_pass_adopt     (VideoParameters *p_Vid, int idx);
+extern void             mp_pass_adopt_wp  (VideoParameters *p_Vid, int idx);
+
+extern void             mp_frame_pass_start  (VideoParameters *p_Vid);
+extern void             mp_frame_pass_finish (VideoParameters *p_Vid);
+extern void             mp_frame_pass_adopt  (VideoParameters *p_Vid);
+
+#endif
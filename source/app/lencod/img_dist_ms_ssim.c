@@ -17,6 +17,8 @@
 #include "contributors.h"
 #include "global.h"
 #include "img_distortion.h"
+#include "img_dist_ssim.h"
+#include "img_dist_ms_ssim.h"
 #include "enc_statistics.h"
 #include "memalloc.h"
 #include "math.h"
@@ -50,42 +52,30 @@ float compute_structural_components (VideoParameters *p_Vid, InputParameters *p_
 #endif
   float mb_ssim, meanOrg, meanEnc;
   float varOrg, varEnc, covOrgEnc;
-  int imeanOrg, imeanEnc, ivarOrg, ivarEnc, icovOrgEnc;
   float cur_distortion = 0.0;
-  int i, j, n, m, win_cnt = 0;
+  int i, j, win_cnt = 0;
   int overlapSize = p_Inp->SSIMOverlapSize;
+  SSIMWindows sw;
 
   max_pix_value_sqd = (float) (p_Vid->max_pel_value_comp[comp] * p_Vid->max_pel_value_comp[comp]);
   C2 = K2 * K2 * max_pix_value_sqd;
 
+  ssim_windows_init(&sw, width, win_width, win_height, overlapSize);
+
   for (j = 0; j <= height - win_height; j += overlapSize)
   {
-    for (i = 0; i <= width - win_width; i += overlapSize)
+    ssim_windows_row(&sw, refImg, encImg, j);
+
+    for (i = 0; i < sw.count; i++)
     {
-      imeanOrg = 0;
-      imeanEnc = 0; 
-      ivarOrg  = 0;
-      ivarEnc  = 0;
-      icovOrgEnc = 0;
-
-      for ( n = j;n < j + win_height;n ++)
-      {
-        for (m = i;m < i + win_width;m ++)
-        {
-          imeanOrg   += refImg[n][m];
-          imeanEnc   += encImg[n][m];
-          ivarOrg    += refImg[n][m] * refImg[n][m];
-          ivarEnc    += encImg[n][m] * encImg[n][m];
-          icovOrgEnc += refImg[n][m] * encImg[n][m];
-        }
-      }
-
-      meanOrg = (float) imeanOrg / win_pixels;
-      meanEnc = (float) imeanEnc / win_pixels;
-
-      varOrg    = ((float) ivarOrg - ((float) imeanOrg) * meanOrg) / win_pixels_bias;
-      varEnc    = ((float) ivarEnc - ((float) imeanEnc) * meanEnc) / win_pixels_bias;
-      covOrgEnc = ((float) icovOrgEnc - ((float) imeanOrg) * meanEnc) / win_pixels_bias;
+      SSIMWindow *win = &sw.win[i];
+
+      meanOrg = (float) win->sum_org / win_pixels;
+      meanEnc = (float) win->sum_enc / win_pixels;
+
+      varOrg    = ((float) win->sum_org2 - ((float) win->sum_org) * meanOrg) / win_pixels_bias;
+      varEnc    = ((float) win->sum_enc2 - ((float) win->sum_enc) * meanEnc) / win_pixels_bias;
+      covOrgEnc = ((float) win->sum_org_enc - ((float) win->sum_org) * meanEnc) / win_pixels_bias;
 
       mb_ssim  = (float) (2.0 * covOrgEnc + C2);
       mb_ssim /= (float) (varOrg + varEnc + C2);
@@ -95,6 +85,8 @@ float compute_structural_components (VideoParameters *p_Vid, InputParameters *p_
     }
   }
 
+  ssim_windows_free(&sw);
+
   cur_distortion /= (float) win_cnt;
 
   if (cur_distortion >= 1.0 && cur_distortion < 1.01) // avoid float accuracy problem at very low QP(e.g.2)
@@ -110,32 +102,24 @@ float compute_luminance_component (VideoParameters *p_Vid, InputParameters *p_In
   float C1;
   float win_pixels = (float) (win_width * win_height);
   float mb_ssim, meanOrg, meanEnc;
-  int imeanOrg, imeanEnc;
   float cur_distortion = 0.0;
-  int i, j, n, m, win_cnt = 0;
+  int i, j, win_cnt = 0;
   int overlapSize = p_Inp->SSIMOverlapSize;
+  SSIMWindows sw;
 
   max_pix_value_sqd = (float) (p_Vid->max_pel_value_comp[comp] * p_Vid->max_pel_value_comp[comp]);
   C1 = K1 * K1 * max_pix_value_sqd;
 
+  ssim_windows_init(&sw, width, win_width, win_height, overlapSize);
+
   for (j = 0; j <= height - win_height; j += overlapSize)
   {
-    for (i = 0; i <= width - win_width; i += overlapSize)
+    ssim_windows_row(&sw, refImg, encImg, j);
+
+    for (i = 0; i < sw.count; i++)
     {
-      imeanOrg = 0;
-      imeanEnc = 0; 
-      
-      for ( n = j;n < j + win_height;n ++)
-      {
-        for (m = i;m < i + win_width;m ++)
-        {
-          imeanOrg   += refImg[n][m];
-          imeanEnc   += encImg[n][m];
-        }
-      }
-
-      meanOrg = (float) imeanOrg / win_pixels;
-      meanEnc = (float) imeanEnc / win_pixels;
+      meanOrg = (float) sw.win[i].sum_org / win_pixels;
+      meanEnc = (float) sw.win[i].sum_enc / win_pixels;
 
       mb_ssim  = (float) (2.0 * meanOrg * meanEnc + C1);
       mb_ssim /= (float) (meanOrg * meanOrg + meanEnc * meanEnc + C1);
@@ -145,6 +129,8 @@ float compute_luminance_component (VideoParameters *p_Vid, InputParameters *p_In
     }
   }
 
+  ssim_windows_free(&sw);
+
   cur_distortion /= (float) win_cnt;
 
   if (cur_distortion >= 1.0 && cur_distortion < 1.01) // avoid float accuracy problem at very low QP(e.g.2)
@@ -329,18 +315,11 @@ float compute_ms_ssim(VideoParameters *p_Vid, InputParameters *p_Inp, imgpel **r
  *    Find MS-SSIM for all three components
  ************************************************************************
  */
-void find_ms_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *ref, ImageStructure *src, DistMetric *metricSSIM)
+void find_ms_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *ref, ImageStructure *src, DistMetric metricSSIM[3])
 {
   DistortionParams *p_Dist = p_Vid->p_Dist;
-  FrameFormat *format = &ref->format;
-
-  metricSSIM->value[0] = compute_ms_ssim (p_Vid, p_Inp, ref->data[0], src->data[0], format->height[0], format->width[0], BLOCK_SIZE_8x8, BLOCK_SIZE_8x8, 0);
-  // Chroma.
-  if (format->yuv_format != YUV400)
-  {     
-    metricSSIM->value[1]  = compute_ms_ssim (p_Vid, p_Inp, ref->data[1], src->data[1], format->height[1], format->width[1], p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x, 1);
-    metricSSIM->value[2]  = compute_ms_ssim (p_Vid, p_Inp, ref->data[2], src->data[2], format->height[1], format->width[1], p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x, 2);
-  }
+
+  find_ssim_planes(p_Vid, p_Inp, ref, src, metricSSIM, compute_ms_ssim);
 
   {
     accumulate_average(metricSSIM,  p_Dist->frame_ctr);
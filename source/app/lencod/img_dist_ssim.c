@@ -17,9 +17,162 @@
 #include "global.h"
 #include "img_distortion.h"
 #include "enc_statistics.h"
+#include "img_dist_ssim.h"
+#include "memalloc.h"
+#include "thread_common.h"
 
 //#define UNBIASED_VARIANCE // unbiased estimation of the variance
 
+//! one plane of find_ssim_planes
+typedef struct ssim_plane
+{
+  VideoParameters *p_Vid;
+  InputParameters *p_Inp;
+  SSIMFunc compute;
+  imgpel **refImg;
+  imgpel **encImg;
+  int height;
+  int width;
+  int win_height;
+  int win_width;
+  int comp;
+  float value;
+  int threaded;
+  ThreadHandle thread;
+} SSIMPlane;
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate the window statistics for a plane of the given width
+ ************************************************************************
+ */
+void ssim_windows_init (SSIMWindows *sw, int width, int win_width, int win_height, int step)
+{
+  sw->width      = width;
+  sw->win_width  = win_width;
+  sw->win_height = win_height;
+  sw->step       = step;
+  sw->row        = -1;
+  sw->count      = (width >= win_width) ? (width - win_width) / step + 1 : 0;
+
+  get_mem2Dint(&sw->col, 5, imax(width, 1));
+  if ((sw->win = (SSIMWindow *) calloc(imax(sw->count, 1), sizeof(SSIMWindow))) == NULL)
+    no_mem_exit("ssim_windows_init: sw->win");
+}
+
+void ssim_windows_free (SSIMWindows *sw)
+{
+  free_mem2Dint(sw->col);
+  free(sw->win);
+  sw->col = NULL;
+  sw->win = NULL;
+}
+
+static void ssim_add_row (SSIMWindows *sw, imgpel *org, imgpel *enc)
+{
+  int *sum_org = sw->col[0], *sum_enc = sw->col[1], *sum_org2 = sw->col[2], *sum_enc2 = sw->col[3], *sum_org_enc = sw->col[4];
+  int m;
+
+  for (m = 0; m < sw->width; m++)
+  {
+    int o = org[m];
+    int e = enc[m];
+    sum_org[m]     += o;
+    sum_enc[m]     += e;
+    sum_org2[m]    += o * o;
+    sum_enc2[m]    += e * e;
+    sum_org_enc[m] += o * e;
+  }
+}
+
+static void ssim_sub_row (SSIMWindows *sw, imgpel *org, imgpel *enc)
+{
+  int *sum_org = sw->col[0], *sum_enc = sw->col[1], *sum_org2 = sw->col[2], *sum_enc2 = sw->col[3], *sum_org_enc = sw->col[4];
+  int m;
+
+  for (m = 0; m < sw->width; m++)
+  {
+    int o = org[m];
+    int e = enc[m];
+    sum_org[m]     -= o;
+    sum_enc[m]     -= e;
+    sum_org2[m]    -= o * o;
+    sum_enc2[m]    -= e * e;
+    sum_org_enc[m] -= o * e;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Compute the integer statistics of the windows with top row "row"
+ *
+ *    The column sums of the window rows are carried over from the
+ *    previous window row, so that only the rows that enter and leave
+ *    the windows are visited, and the window sums slide along the
+ *    column sums in the same way. The sums are exact, so the SSIM
+ *    computed from them does not change.
+ ************************************************************************
+ */
+void ssim_windows_row (SSIMWindows *sw, imgpel **refImg, imgpel **encImg, int row)
+{
+  int win_width = sw->win_width;
+  int step = sw->step;
+  int **col = sw->col;
+  int n, m, k, i;
+  int s[5] = {0, 0, 0, 0, 0};
+
+  if (sw->row < 0 || row - sw->row >= sw->win_height)
+  {
+    for (k = 0; k < 5; k++)
+      memset(col[k], 0, sw->width * sizeof(int));
+    for (n = row; n < row + sw->win_height; n++)
+      ssim_add_row(sw, refImg[n], encImg[n]);
+  }
+  else
+  {
+    for (n = sw->row; n < row; n++)
+    {
+      ssim_sub_row(sw, refImg[n], encImg[n]);
+      ssim_add_row(sw, refImg[n + sw->win_height], encImg[n + sw->win_height]);
+    }
+  }
+  sw->row = row;
+
+  for (k = 0, i = 0; k < sw->count; k++, i += step)
+  {
+    if (k == 0 || step >= win_width)
+    {
+      s[0] = s[1] = s[2] = s[3] = s[4] = 0;
+      for (m = i; m < i + win_width; m++)
+      {
+        s[0] += col[0][m];
+        s[1] += col[1][m];
+        s[2] += col[2][m];
+        s[3] += col[3][m];
+        s[4] += col[4][m];
+      }
+    }
+    else
+    {
+      for (m = i - step; m < i; m++)
+      {
+        s[0] += col[0][m + win_width] - col[0][m];
+        s[1] += col[1][m + win_width] - col[1][m];
+        s[2] += col[2][m + win_width] - col[2][m];
+        s[3] += col[3][m + win_width] - col[3][m];
+        s[4] += col[4][m + win_width] - col[4][m];
+      }
+    }
+    sw->win[k].sum_org     = s[0];
+    sw->win[k].sum_enc     = s[1];
+    sw->win[k].sum_org2    = s[2];
+    sw->win[k].sum_enc2    = s[3];
+    sw->win[k].sum_org_enc = s[4];
+  }
+}
+
 float compute_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, imgpel **refImg, imgpel **encImg, int height, int width, int win_height, int win_width, int comp)
 {
 
@@ -34,43 +187,31 @@ float compute_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, imgpel **ref
 #endif
   float mb_ssim, meanOrg, meanEnc;
   float varOrg, varEnc, covOrgEnc;
-  int imeanOrg, imeanEnc, ivarOrg, ivarEnc, icovOrgEnc;
   float cur_distortion = 0.0;
-  int i, j, n, m, win_cnt = 0;
+  int i, j, win_cnt = 0;
   int overlapSize = p_Inp->SSIMOverlapSize;
+  SSIMWindows sw;
 
   max_pix_value_sqd = (float) (p_Vid->max_pel_value_comp[comp] * p_Vid->max_pel_value_comp[comp]);
   C1 = K1 * K1 * max_pix_value_sqd;
   C2 = K2 * K2 * max_pix_value_sqd;
 
+  ssim_windows_init(&sw, width, win_width, win_height, overlapSize);
+
   for (j = 0; j <= height - win_height; j += overlapSize)
   {
-    for (i = 0; i <= width - win_width; i += overlapSize)
-    {
-      imeanOrg = 0;
-      imeanEnc = 0; 
-      ivarOrg  = 0;
-      ivarEnc  = 0;
-      icovOrgEnc = 0;
+    ssim_windows_row(&sw, refImg, encImg, j);
 
-      for ( n = j;n < j + win_height;n ++)
-      {
-        for (m = i;m < i + win_width;m ++)
-        {
-          imeanOrg   += refImg[n][m];
-          imeanEnc   += encImg[n][m];
-          ivarOrg    += refImg[n][m] * refImg[n][m];
-          ivarEnc    += encImg[n][m] * encImg[n][m];
-          icovOrgEnc += refImg[n][m] * encImg[n][m];
-        }
-      }
+    for (i = 0; i < sw.count; i++)
+    {
+      SSIMWindow *win = &sw.win[i];
 
-      meanOrg = (float) imeanOrg / win_pixels;
-      meanEnc = (float) imeanEnc / win_pixels;
+      meanOrg = (float) win->sum_org / win_pixels;
+      meanEnc = (float) win->sum_enc / win_pixels;
 
-      varOrg    = ((float) ivarOrg - ((float) imeanOrg) * meanOrg) / win_pixels_bias;
-      varEnc    = ((float) ivarEnc - ((float) imeanEnc) * meanEnc) / win_pixels_bias;
-      covOrgEnc = ((float) icovOrgEnc - ((float) imeanOrg) * meanEnc) / win_pixels_bias;
+      varOrg    = ((float) win->sum_org2 - ((float) win->sum_org) * meanOrg) / win_pixels_bias;
+      varEnc    = ((float) win->sum_enc2 - ((float) win->sum_enc) * meanEnc) / win_pixels_bias;
+      covOrgEnc = ((float) win->sum_org_enc - ((float) win->sum_org) * meanEnc) / win_pixels_bias;
 
       mb_ssim  = (float) ((2.0 * meanOrg * meanEnc + C1) * (2.0 * covOrgEnc + C2));
       mb_ssim /= (float) (meanOrg * meanOrg + meanEnc * meanEnc + C1) * (varOrg + varEnc + C2);
@@ -80,6 +221,8 @@ float compute_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, imgpel **ref
     }
   }
 
+  ssim_windows_free(&sw);
+
   cur_distortion /= (float) win_cnt;
 
   if (cur_distortion >= 1.0 && cur_distortion < 1.01) // avoid float accuracy problem at very low QP(e.g.2)
@@ -88,25 +231,72 @@ float compute_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, imgpel **ref
   return cur_distortion;
 }
 
+static void ssim_plane_thread (void *arg)
+{
+  SSIMPlane *plane = (SSIMPlane *) arg;
+
+  plane->value = plane->compute(plane->p_Vid, plane->p_Inp, plane->refImg, plane->encImg, plane->height, plane->width, plane->win_height, plane->win_width, plane->comp);
+}
+
 /*!
  ************************************************************************
  * \brief
- *    Find SSIM for all three components
+ *    Compute an SSIM index of all components with compute().
+ *    With DistortionParallel the chroma planes are computed in their
+ *    own threads next to the luma plane.
  ************************************************************************
  */
-void find_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *ref, ImageStructure *src, DistMetric *metricSSIM)
+void find_ssim_planes (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *ref, ImageStructure *src, DistMetric *metric, SSIMFunc compute)
 {
-  DistortionParams *p_Dist = p_Vid->p_Dist;
   FrameFormat *format = &ref->format;
+  SSIMPlane plane[3];
+  int num_planes = (format->yuv_format != YUV400) ? 3 : 1;
+  int k;
+
+  for (k = 0; k < num_planes; k++)
+  {
+    plane[k].p_Vid      = p_Vid;
+    plane[k].p_Inp      = p_Inp;
+    plane[k].compute    = compute;
+    plane[k].refImg     = ref->data[k];
+    plane[k].encImg     = src->data[k];
+    plane[k].height     = format->height[k > 0];
+    plane[k].width      = format->width[k > 0];
+    // Chroma windows cover a macroblock.
+    plane[k].win_height = (k > 0) ? p_Vid->mb_cr_size_y : BLOCK_SIZE_8x8;
+    plane[k].win_width  = (k > 0) ? p_Vid->mb_cr_size_x : BLOCK_SIZE_8x8;
+    plane[k].comp       = k;
+    plane[k].threaded   = 0;
+  }
 
-  metricSSIM->value[0] = compute_ssim (p_Vid, p_Inp, ref->data[0], src->data[0], format->height[0], format->width[0], BLOCK_SIZE_8x8, BLOCK_SIZE_8x8, 0);
-  // Chroma.
-  if (format->yuv_format != YUV400)
-  {     
-    metricSSIM->value[1]  = compute_ssim (p_Vid, p_Inp, ref->data[1], src->data[1], format->height[1], format->width[1], p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x, 1);
-    metricSSIM->value[2]  = compute_ssim (p_Vid, p_Inp, ref->data[2], src->data[2], format->height[1], format->width[1], p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x, 2);
+  if (p_Inp->DistortionParallel)
+  {
+    for (k = 1; k < num_planes; k++)
+      plane[k].threaded = (thread_create(&plane[k].thread, ssim_plane_thread, &plane[k]) == 0);
   }
 
+  for (k = 0; k < num_planes; k++)
+  {
+    if (plane[k].threaded)
+      thread_join(plane[k].thread);
+    else
+      ssim_plane_thread(&plane[k]);
+    metric->value[k] = plane[k].value;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Find SSIM for all three components
+ ************************************************************************
+ */
+void find_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *ref, ImageStructure *src, DistMetric metricSSIM[3])
+{
+  DistortionParams *p_Dist = p_Vid->p_Dist;
+
+  find_ssim_planes(p_Vid, p_Inp, ref, src, metricSSIM, compute_ssim);
+
   {
     accumulate_average(metricSSIM,  p_Dist->frame_ctr);
     accumulate_avslice(metricSSIM,  p_Vid->type, p_Vid->p_Stats->frame_ctr[p_Vid->type]);
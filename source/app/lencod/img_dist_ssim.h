@@ -20,6 +20,37 @@
 #define _IMG_DIST_SSIM_H_
 #include "img_distortion.h"
 
+//! integer statistics of one SSIM window
+typedef struct ssim_window
+{
+  int sum_org;          //!< sum of the reference samples
+  int sum_enc;          //!< sum of the encoded samples
+  int sum_org2;         //!< sum of the squared reference samples
+  int sum_enc2;         //!< sum of the squared encoded samples
+  int sum_org_enc;      //!< sum of the products of the reference and encoded samples
+} SSIMWindow;
+
+//! window statistics of one row of SSIM windows, updated incrementally from row to row
+typedef struct ssim_windows
+{
+  int  width;
+  int  win_width;
+  int  win_height;
+  int  step;            //!< distance between neighbouring windows (SSIMOverlapSize)
+  int  row;             //!< top row of the current window row (-1: none yet)
+  int  count;           //!< number of windows in a row
+  int **col;            //!< column sums of the window rows [5][width], in SSIMWindow member order
+  SSIMWindow *win;      //!< statistics of the windows of the current row
+} SSIMWindows;
+
+//! computes the SSIM index of one plane
+typedef float (*SSIMFunc) (VideoParameters *p_Vid, InputParameters *p_Inp, imgpel **refImg, imgpel **encImg, int height, int width, int win_height, int win_width, int comp);
+
+extern void ssim_windows_init (SSIMWindows *sw, int width, int win_width, int win_height, int step);
+extern void ssim_windows_free (SSIMWindows *sw);
+extern void ssim_windows_row  (SSIMWindows *sw, imgpel **refImg, imgpel **encImg, int row);
+extern void find_ssim_planes  (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *ref, ImageStructure *src, DistMetric *metric, SSIMFunc compute);
+
 extern void find_ssim (VideoParameters *p_Vid, InputParameters *p_Inp, ImageStructure *imgREF, ImageStructure *imgSRC, DistMetric metricSSIM[3]);
 
 #endif
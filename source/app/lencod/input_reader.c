@@ -0,0 +1,244 @@
+
+/*!
+ ***************************************************************************
+ * \file input_reader.c
+ *
+ * \brief
+ *    Background input reader.
+ *
+ *    The reader thread reads the source frames in display order into a
+ *    ring of ReadAheadFrames frames, so that file I/O, deinterleaving,
+ *    bit depth conversion and padding overlap with the encoding of the
+ *    previous frames. A ring slot is only reused once the encoder has
+ *    taken its frame. Requests that cannot be served from the ring
+ *    (frames that are out of the ring window, 3:2 pulldown, the second
+ *    view) are read synchronously by the caller as before.
+ **************************************************************************
+ */
+
+#include "global.h"
+#include "memalloc.h"
+#include "input.h"
+#include "img_io.h"
+#include "input_reader.h"
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Read, convert and pad one frame (display order) into its ring slot
+ * \return
+ *    0 if the frame could not be read
+ *************************************************************************************
+ */
+static int ir_read_frame(InputReader *ir, int frame)
+{
+  InputParameters *p_Inp = ir->p_Inp;
+  IRFrame *frm = &ir->frames[frame % ir->size];
+
+  if (!read_one_frame(ir->p_Vid, &ir->input_file, (1 + p_Inp->frame_skip) * frame, p_Inp->infile_header, &p_Inp->source, &p_Inp->output, frm->frm_data))
+    return 0;
+
+  pad_borders (ir->output, ir->width, ir->height, ir->width_cr, ir->height_cr, frm->frm_data);
+  return 1;
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Reader thread: keep the ring filled
+ *************************************************************************************
+ */
+static void ir_thread(void *arg)
+{
+  InputReader *ir = (InputReader *) arg;
+  int frame;
+
+  mutex_lock(&ir->mutex);
+  for (;;)
+  {
+    while (!ir->stop && ir->read < ir->num_frames && ir->read >= ir->first + ir->size)
+      cond_wait(&ir->cond, &ir->mutex);
+    if (ir->stop || ir->read >= ir->num_frames)
+      break;
+
+    // frames the encoder has already read by itself are skipped
+    frame = ir->read = imax(ir->read, ir->first);
+    if (ir->taken[frame])
+    {
+      ++ir->read;
+      continue;
+    }
+    mutex_unlock(&ir->mutex);
+    if (ir_read_frame(ir, frame))
+    {
+      mutex_lock(&ir->mutex);
+      ++ir->read;
+    }
+    else
+    {
+      mutex_lock(&ir->mutex);
+      ir->num_frames = ir->read;
+    }
+    cond_broadcast(&ir->cond);
+  }
+  mutex_unlock(&ir->mutex);
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Create the input reader and start its thread
+ * \return
+ *    NULL if frames are read synchronously
+ *************************************************************************************
+ */
+InputReader *ir_create(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  InputReader *ir;
+  int i, k;
+
+  if (!p_Inp->ReadAheadFrames || p_Inp->enable_32_pulldown)
+    return NULL;
+
+  if ((ir = (InputReader *) calloc(1, sizeof(InputReader))) == NULL)
+    no_mem_exit("ir_create: ir");
+  if ((ir->p_Vid = (VideoParameters *) calloc(1, sizeof(VideoParameters))) == NULL)
+    no_mem_exit("ir_create: ir->p_Vid");
+
+  ir->p_Inp = p_Inp;
+  ir->p_Vid->p_Inp      = p_Inp;
+  ir->p_Vid->yuv_format = p_Vid->yuv_format;
+  ir->p_Vid->buf2img    = p_Vid->buf2img;
+  AllocateFrameMemory(ir->p_Vid, p_Inp, &p_Inp->source);
+
+  ir->input_file = p_Inp->input_file1;
+  ir->input_file.f_num = -1;
+  OpenFiles(&ir->input_file);
+
+  ir->output     = p_Inp->output;
+  ir->width      = p_Vid->width;
+  ir->height     = p_Vid->height;
+  ir->width_cr   = p_Vid->width_cr;
+  ir->height_cr  = p_Vid->height_cr;
+  ir->num_planes = (p_Vid->yuv_format != YUV400) ? 3 : 1;
+#if (ALLOW_GRAYSCALE)
+  // the chroma planes of the encoder keep their constant value
+  if (p_Inp->grayscale)
+    ir->num_planes = 1;
+#endif
+
+  ir->size = p_Inp->ReadAheadFrames;
+  if ((ir->frames = (IRFrame *) calloc(ir->size, sizeof(IRFrame))) == NULL)
+    no_mem_exit("ir_create: ir->frames");
+  for (i = 0; i < ir->size; ++i)
+  {
+    get_mem2Dpel(&ir->frames[i].frm_data[0], ir->height, ir->width);
+    for (k = 1; k < ir->num_planes; ++k)
+      get_mem2Dpel(&ir->frames[i].frm_data[k], ir->height_cr, ir->width_cr);
+  }
+
+  ir->num_frames = p_Inp->no_frames;
+  if ((ir->taken = (byte *) calloc(imax(1, ir->num_frames), sizeof(byte))) == NULL)
+    no_mem_exit("ir_create: ir->taken");
+  mutex_init(&ir->mutex);
+  cond_init(&ir->cond);
+  ir->threaded = (thread_create(&ir->thread, ir_thread, ir) == 0);
+
+  return ir;
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Stop the reader thread and free the input reader
+ *************************************************************************************
+ */
+void ir_destroy(InputReader *ir)
+{
+  int i, k;
+
+  if (ir == NULL)
+    return;
+
+  if (ir->threaded)
+  {
+    mutex_lock(&ir->mutex);
+    ir->stop = 1;
+    cond_broadcast(&ir->cond);
+    mutex_unlock(&ir->mutex);
+    thread_join(ir->thread);
+  }
+  mutex_destroy(&ir->mutex);
+  cond_destroy(&ir->cond);
+
+  CloseFiles(&ir->input_file);
+  DeleteFrameMemory(ir->p_Vid);
+  free(ir->p_Vid);
+
+  for (i = 0; i < ir->size; ++i)
+  {
+    for (k = 0; k < ir->num_planes; ++k)
+      free_mem2Dpel(ir->frames[i].frm_data[k]);
+  }
+  free(ir->frames);
+  free(ir->taken);
+  free(ir);
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Copy a source frame from the ring into pImage (coded picture size),
+ *    waiting for the reader if needed
+ * \return
+ *    0 if the frame is not served by the reader and has to be read by the caller
+ *************************************************************************************
+ */
+int ir_get_frame(InputReader *ir, int frm_no_in_file, imgpel **pImage[3])
+{
+  IRFrame *frm;
+  int frame, k;
+
+  if (ir == NULL || !ir->threaded || frm_no_in_file % (1 + ir->p_Inp->frame_skip))
+    return 0;
+
+  frame = frm_no_in_file / (1 + ir->p_Inp->frame_skip);
+
+  mutex_lock(&ir->mutex);
+  if (frame >= ir->num_frames || frame < ir->first || ir->taken[frame])
+  {
+    mutex_unlock(&ir->mutex);
+    return 0;
+  }
+  // a frame beyond the ring window is read by the caller, waiting for it
+  // would block on frames that are taken later
+  if (frame >= ir->first + ir->size)
+  {
+    ir->taken[frame] = 1;
+    mutex_unlock(&ir->mutex);
+    return 0;
+  }
+  while (frame < ir->num_frames && ir->read <= frame)
+    cond_wait(&ir->cond, &ir->mutex);
+  if (frame >= ir->num_frames)
+  {
+    mutex_unlock(&ir->mutex);
+    return 0;
+  }
+  mutex_unlock(&ir->mutex);
+
+  // the slot is not reused before ir->first has passed the frame
+  frm = &ir->frames[frame % ir->size];
+  memcpy(&pImage[0][0][0], &frm->frm_data[0][0][0], ir->height * ir->width * sizeof(imgpel));
+  for (k = 1; k < ir->num_planes; ++k)
+    memcpy(&pImage[k][0][0], &frm->frm_data[k][0][0], ir->height_cr * ir->width_cr * sizeof(imgpel));
+
+  mutex_lock(&ir->mutex);
+  ir->taken[frame] = 1;
+  while (ir->first < ir->num_frames && ir->taken[ir->first])
+    ++ir->first;
+  cond_broadcast(&ir->cond);
+  mutex_unlock(&ir->mutex);
+
+  return 1;
+}
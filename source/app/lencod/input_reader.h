@@ -0,0 +1,61 @@
+
+/*!
+ ***************************************************************************
+ * \file
+ *    input_reader.h
+ *
+ * \brief
+ *    Headerfile for the background input reader.
+ *
+ *    A separate thread reads the source frames ahead of the encoder
+ *    through its own file handle, converts them to the internal sample
+ *    format and pads them to the coded picture size. The encoder takes
+ *    the frames from a bounded ring instead of reading them itself.
+ **************************************************************************
+ */
+
+#ifndef _INPUT_READER_H_
+#define _INPUT_READER_H_
+
+#include "thread_common.h"
+
+//! one frame of the ring
+typedef struct ir_frame
+{
+  imgpel **frm_data[3];         //!< converted and padded source frame
+} IRFrame;
+
+typedef struct input_reader
+{
+  VideoParameters *p_Vid;       //!< private parameters for read_one_frame (own read buffers)
+  InputParameters *p_Inp;
+  VideoDataFile    input_file;  //!< copy of the input file description with its own file handle
+
+  FrameFormat output;           //!< output format of the source frames
+  int   width;                  //!< coded picture size
+  int   height;
+  int   width_cr;
+  int   height_cr;
+  int   num_planes;
+
+  int   size;                   //!< number of frames in the ring
+  IRFrame *frames;              //!< frame f is kept in frames[f % size]
+
+  // shared with the reader thread
+  byte *taken;                  //!< per frame: taken by the encoder (from the ring or read by itself)
+  int   first;                  //!< oldest frame that has not been taken yet
+  int   read;                   //!< frames [first, read) are in the ring
+  int   num_frames;             //!< number of frames that can be read
+  int   stop;
+  int   threaded;               //!< reader runs in its own thread
+  ThreadHandle thread;
+  ThreadMutex  mutex;
+  ThreadCond   cond;
+} InputReader;
+
+extern InputReader *ir_create     (VideoParameters *p_Vid, InputParameters *p_Inp);
+extern void         ir_destroy    (InputReader *ir);
+extern int          ir_get_frame  (InputReader *ir, int frm_no_in_file, imgpel **pImage[3]);
+
+#endif
+
@@ -24,7 +24,7 @@
  *  \file
  *     lencod.c
  *  \brief
- *     H.264/AVC reference encoder project main()
+ *     H.264/AVC reference encoder: set up, sequence coding and clean up
  *  \author
  *   Main contributors (see contributors.h for copyright, address and affiliation details)
  *   - Inge Lille-Langoy               <inge.lille-langoy@telenor.com>
@@ -71,11 +71,16 @@
 #include "me_umhex.h"
 #include "me_umhexsmp.h"
 #include "me_hme.h"
+#include "md_prune.h"
 #include "output.h"
 #include "parset.h"
 #include "q_matrix.h"
 #include "q_offsets.h"
 #include "ratectl.h"
+#include "rc_stats.h"
+#include "qp_map.h"
+#include "mem_usage.h"
+#include "profile.h"
 #include "report.h"
 #include "rdoq.h"
 #include "errdo.h"
@@ -103,6 +108,11 @@
 #include "get_block_otf.h"
 
 #include "wp.h"
+#include "image_mp_threads.h"
+#include "view_threads.h"
+#include "input_reader.h"
+#include "lencod_api_int.h"
+#include "thread_common.h"
 
 //check the scaling factor to avoid overflow;
 #if !IMGTYPE
@@ -124,8 +134,6 @@ static void free_global_buffers (VideoParameters *p_Vid, InputParameters *p_Inp)
 static void free_img            (VideoParameters *p_Vid, InputParameters *p_Inp);
 static void free_params         (InputParameters *p_Inp);
 
-static void encode_sequence     (VideoParameters *p_Vid, InputParameters *p_Inp);
-
 
 static void generate_encode_parameters(VideoParameters *p_Vid);
 static void free_encode_parameters(VideoParameters *p_Vid);
@@ -187,6 +195,7 @@ static void alloc_video_params( VideoParameters **p_Vid)
   (*p_Vid)->f_rtp = NULL;
   (*p_Vid)->CurrentRTPTimestamp = 0;         
   (*p_Vid)->CurrentRTPSequenceNumber = 0;
+  (*p_Vid)->CurrentRTPTr = -1;
 }
 
 /*!
@@ -242,42 +251,66 @@ static void free_encoder (EncoderParams *p_Enc)
 /*!
  ***********************************************************************
  * \brief
- *    Main function for encoder.
+ *    Configure and initialize an encoder
  * \param argc
  *    number of command line arguments
  * \param argv
  *    command line arguments
+ * \param p_api
+ *    library interface the encoder is driven by (NULL for the command
+ *    line encoder, which becomes p_Enc)
  * \return
- *    exit code
+ *    the encoder
  ***********************************************************************
  */
-int main(int argc, char **argv)
+EncoderParams *open_encoder(int argc, char **argv, struct jm_encoder *p_api)
 {
-  init_time();
-#if MEMORY_DEBUG
-  _CrtSetDbgFlag ( _CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF );
-#endif
+  EncoderParams *p_Encoder;
+  int plane_memory;
+
+  alloc_encoder(&p_Encoder);
+  if (p_api == NULL)
+    p_Enc = p_Encoder;
+  p_Encoder->p_Vid->p_api = p_api;
 
-  alloc_encoder(&p_Enc);
+  // the parameter tables of the configuration are global
+  global_lock_acquire();
+  Configure (p_Encoder->p_Vid, p_Encoder->p_Inp, argc, argv);
+  // as is the allocation backend of the sample planes
+  plane_memory = mem_set_planes_backend(p_Encoder->p_Inp->PlaneMemory);
+  if (plane_memory != p_Encoder->p_Inp->PlaneMemory)
+  {
+    printf("Warning: PlaneMemory=%d is ignored, the planes of the process use PlaneMemory=%d.\n", p_Encoder->p_Inp->PlaneMemory, plane_memory);
+    p_Encoder->p_Inp->PlaneMemory = plane_memory;
+  }
+  global_lock_release();
 
-  Configure (p_Enc->p_Vid, p_Enc->p_Inp, argc, argv);
+  if (p_api)
+    api_init_params(p_Encoder->p_Vid, p_Encoder->p_Inp);
 
   // init encoder
-  init_encoder(p_Enc->p_Vid, p_Enc->p_Inp);
+  init_encoder(p_Encoder->p_Vid, p_Encoder->p_Inp);
 
-  // encode sequence
-  encode_sequence(p_Enc->p_Vid, p_Enc->p_Inp);
+  return p_Encoder;
+}
 
-  // terminate sequence
-  free_encoder_memory(p_Enc->p_Vid, p_Enc->p_Inp);
+/*!
+ ***********************************************************************
+ * \brief
+ *    Terminate the sequence and free the encoder
+ ***********************************************************************
+ */
+void close_encoder(EncoderParams *p_Encoder)
+{
+  free_encoder_memory(p_Encoder->p_Vid, p_Encoder->p_Inp);
 
-  free_params (p_Enc->p_Inp);  
-  free_encoder(p_Enc);
+  if (p_Encoder == p_Enc)
+    p_Enc = NULL;
 
-  return 0;
+  free_params (p_Encoder->p_Inp);  
+  free_encoder(p_Encoder);
 }
 
-
 /*!
  ************************************************************************
  * \brief
@@ -663,6 +696,12 @@ static void init_encoder(VideoParameters *p_Vid, InputParameters *p_Inp)
   {
     setup_dpb_layer(p_Vid->p_Dpb_layer[i], p_Vid, p_Inp);
   }
+
+  init_mp_threads(p_Vid, p_Inp);
+#if (MVC_EXTENSION_ENABLE)
+  init_view_threads(p_Vid, p_Inp);
+#endif
+  p_Vid->p_reader = ir_create(p_Vid, p_Inp);
 }
 
 void setup_coding_layer(VideoParameters *p_Vid)
@@ -879,147 +918,265 @@ static void prepare_frame_params(VideoParameters *p_Vid, InputParameters *p_Inp,
 /*!
  ***********************************************************************
  * \brief
- *    Encode a sequence
+ *    Number of coding steps of the sequence
  ***********************************************************************
  */
-static void encode_sequence(VideoParameters *p_Vid, InputParameters *p_Inp)
+int sequence_length(InputParameters *p_Inp)
 {
-  int curr_frame_to_code;
-  int frames_to_code;
-  int frame_num_bak = 0, frame_coded;
+#if (MVC_EXTENSION_ENABLE)
+  if ( p_Inp->num_of_views == 2 )
+    return p_Inp->no_frames << 1;
+#endif
+  return p_Inp->no_frames;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Set the frame structure of coding step curr_frame_to_code of the
+ *    sequence, populating the prediction structure as needed. Repeated
+ *    calls for the same step have no further effect.
+ * \param rc_enable
+ *    rate control setting of the sequence (it is switched off for the
+ *    second view)
+ * \return
+ *    FALSE if the frame of the step lies beyond the sequence
+ ***********************************************************************
+ */
+int set_sequence_position(VideoParameters *p_Vid, InputParameters *p_Inp, int curr_frame_to_code, int rc_enable)
+{
+  int frames_to_code = sequence_length(p_Inp);
   int frm_struct_buffer;
   SeqStructure *p_seq_struct = p_Vid->p_pred;
   FrameUnitStruct *p_frm;
 
 #if (MVC_EXTENSION_ENABLE)
-  int tmp_rate_control_enable = p_Inp->RCEnable;
-
   if ( p_Inp->num_of_views == 2 )
   {
-    frames_to_code = p_Inp->no_frames << 1;
     p_frm = p_seq_struct->p_frm_mvc;
     frm_struct_buffer = p_seq_struct->num_frames_mvc;
-  }
-  else
-#endif
-  {
-    frames_to_code = p_Inp->no_frames;
-    p_frm = p_seq_struct->p_frm;
-    frm_struct_buffer = p_Vid->frm_struct_buffer;
-  }
-  
-  for (curr_frame_to_code = 0; curr_frame_to_code < frames_to_code; curr_frame_to_code++)
-  {
-#if (MVC_EXTENSION_ENABLE)
-    if ( p_Inp->num_of_views == 2 )
+
+    if ( (curr_frame_to_code & 1) == 0 ) // call only for view_id 0
     {
-      if ( (curr_frame_to_code & 1) == 0 ) // call only for view_id 0
+      // determine whether to populate additional frames in the prediction structure
+      if ( (curr_frame_to_code >> 1) >= p_Vid->p_pred->pop_start_frame )
       {
-        // determine whether to populate additional frames in the prediction structure
-        if ( (curr_frame_to_code >> 1) >= p_Vid->p_pred->pop_start_frame )
-        {
-          int start = p_seq_struct->pop_start_frame, end;
+        int start = p_seq_struct->pop_start_frame, end;
 
-          populate_frm_struct( p_Vid, p_Inp, p_seq_struct, p_Inp->FrmStructBufferLength, frames_to_code >> 1 );
-          end = p_seq_struct->pop_start_frame;
-          populate_frm_struct_mvc( p_Vid, p_Inp, p_seq_struct, start, end );
-        }
+        populate_frm_struct( p_Vid, p_Inp, p_seq_struct, p_Inp->FrmStructBufferLength, frames_to_code >> 1 );
+        end = p_seq_struct->pop_start_frame;
+        populate_frm_struct_mvc( p_Vid, p_Inp, p_seq_struct, start, end );
       }
+    }
 
-      p_Vid->curr_frm_idx = curr_frame_to_code;
-      p_Vid->p_curr_frm_struct = p_frm + ( p_Vid->curr_frm_idx % frm_struct_buffer ); // pointer to current frame structure
-      p_Vid->number = curr_frame_to_code;
+    p_Vid->curr_frm_idx = curr_frame_to_code;
+    p_Vid->p_curr_frm_struct = p_frm + ( p_Vid->curr_frm_idx % frm_struct_buffer ); // pointer to current frame structure
+    p_Vid->number = curr_frame_to_code;
 
-      p_Vid->view_id = p_Vid->p_curr_frm_struct->view_id;
-      set_dpb_layer_id(p_Vid, p_Vid->view_id);
-      if ( p_Vid->view_id == 1 )
-      {
-        p_Vid->curr_frm_idx = p_Vid->number = (curr_frame_to_code - 1) >> 1;
-        p_Vid->p_curr_frm_struct->qp = p_Vid->qp = iClip3( -p_Vid->bitdepth_luma_qp_scale, MAX_QP, p_Vid->AverageFrameQP + p_Inp->View1QPOffset );
-      }
-      else
-      {
-        p_Vid->curr_frm_idx = p_Vid->number = curr_frame_to_code >> 1;
-      }
-      if ( p_Vid->view_id == 1 && tmp_rate_control_enable )
-      {
-        p_Inp->RCEnable = 0;        
-      }
-      else
-      {
-        p_Inp->RCEnable = tmp_rate_control_enable;
-      }
+    p_Vid->view_id = p_Vid->p_curr_frm_struct->view_id;
+    set_dpb_layer_id(p_Vid, p_Vid->view_id);
+    if ( p_Vid->view_id == 1 )
+    {
+      p_Vid->curr_frm_idx = p_Vid->number = (curr_frame_to_code - 1) >> 1;
+      p_Vid->p_curr_frm_struct->qp = p_Vid->qp = iClip3( -p_Vid->bitdepth_luma_qp_scale, MAX_QP, p_Vid->AverageFrameQP + p_Inp->View1QPOffset );
     }
     else
+    {
+      p_Vid->curr_frm_idx = p_Vid->number = curr_frame_to_code >> 1;
+    }
+    // only written on a change: the parameters are read by a concurrently coded view 1
+    if ( p_Vid->view_id == 1 && rc_enable )
+    {
+      if ( p_Inp->RCEnable )
+        p_Inp->RCEnable = 0;
+    }
+    else if ( p_Inp->RCEnable != rc_enable )
+    {
+      p_Inp->RCEnable = rc_enable;
+    }
+  }
+  else
 #endif
+  {
+    p_frm = p_seq_struct->p_frm;
+    frm_struct_buffer = p_Vid->frm_struct_buffer;
+
+    // determine whether to populate additional frames in the prediction structure
+    if ( curr_frame_to_code >= p_Vid->p_pred->pop_start_frame )
     {
-      // determine whether to populate additional frames in the prediction structure
-      if ( curr_frame_to_code >= p_Vid->p_pred->pop_start_frame )
-      {
-        populate_frm_struct( p_Vid, p_Inp, p_seq_struct, p_Inp->FrmStructBufferLength, frames_to_code );
-      }
+      populate_frm_struct( p_Vid, p_Inp, p_seq_struct, p_Inp->FrmStructBufferLength, frames_to_code );
+    }
     p_Vid->curr_frm_idx = curr_frame_to_code;
     p_Vid->p_curr_frm_struct = p_frm + ( p_Vid->curr_frm_idx % frm_struct_buffer ); // pointer to current frame structure
     p_Vid->number = curr_frame_to_code;
+  }
 
-    }
+  return ( p_Vid->p_curr_frm_struct->frame_no < p_Inp->no_frames );
+}
 
-    if ( p_Vid->p_curr_frm_struct->frame_no >= p_Inp->no_frames )
-    {
-      continue;
-    }
+/*!
+ ***********************************************************************
+ * \brief
+ *    Set up the frame of coding step curr_frame_to_code, which has been
+ *    set by set_sequence_position(), and read its source picture
+ * \param start_time
+ *    returns the time the coding of the frame was started
+ * \return
+ *    0 if the frame is not coded
+ ***********************************************************************
+ */
+static int start_sequence_position(VideoParameters *p_Vid, InputParameters *p_Inp, int curr_frame_to_code, TIME_T *start_time)
+{
+  int frame_num_bak = 0;
 
-    // Update frame_num counter
-    frame_num_bak = p_Vid->p_EncodePar[p_Vid->dpb_layer_id]->frame_num;
+  // Update frame_num counter
+  frame_num_bak = p_Vid->p_EncodePar[p_Vid->dpb_layer_id]->frame_num;
 
-    prepare_frame_params(p_Vid, p_Inp, curr_frame_to_code);
+  prepare_frame_params(p_Vid, p_Inp, curr_frame_to_code);
 
-    // redundant frame initialization and allocation
-    if (p_Inp->redundant_pic_flag)
-    {
-      init_redundant_frame(p_Vid, p_Inp);
-      set_redundant_frame(p_Vid, p_Inp);
-    }
+  // redundant frame initialization and allocation
+  if (p_Inp->redundant_pic_flag)
+  {
+    init_redundant_frame(p_Vid, p_Inp);
+    set_redundant_frame(p_Vid, p_Inp);
+  }
 
-    frame_coded = encode_one_frame(p_Vid, p_Inp); // encode one frame;
-    if ( !frame_coded )
-    {
-      p_Vid->frame_num = p_Vid->p_CurrEncodePar->frame_num = frame_num_bak;
-      continue;
-    }
+  gettime(start_time);
+  if ( !start_one_frame(p_Vid, p_Inp) )
+  {
+    p_Vid->frame_num = p_Vid->p_CurrEncodePar->frame_num = frame_num_bak;
+    return 0;
+  }
+  return 1;
+}
 
-    p_Vid->p_CurrEncodePar->last_ref_idc = p_Vid->nal_reference_idc ? 1 : 0;
+/*!
+ ***********************************************************************
+ * \brief
+ *    Encode the frame of coding step curr_frame_to_code, which has been
+ *    set by set_sequence_position()
+ ***********************************************************************
+ */
+void encode_sequence_position(VideoParameters *p_Vid, InputParameters *p_Inp, int curr_frame_to_code)
+{
+  TIME_T start_time;
 
-    // if key frame is encoded, encode one redundant frame
-    if (p_Inp->redundant_pic_flag && p_Vid->key_frame)
-    {
-      encode_one_redundant_frame(p_Vid, p_Inp);
-    }
+  if (start_sequence_position(p_Vid, p_Inp, curr_frame_to_code, &start_time))
+  {
+    code_one_frame(p_Vid, p_Inp);
+    finish_sequence_position(p_Vid, p_Inp, &start_time);
+  }
+}
 
-    if (p_Inp->EnableOpenGOP && p_Vid->p_curr_frm_struct->random_access)
+#if (MVC_EXTENSION_ENABLE)
+/*!
+ ***********************************************************************
+ * \brief
+ *    Encode the frame of coding step curr_frame_to_code with pipelined
+ *    views: view 1 is started and left to code in its own thread, the
+ *    base view is coded next to the pending view 1, which is finished
+ *    before the base view (see view_threads.c)
+ ***********************************************************************
+ */
+static void encode_sequence_position_pipelined(VideoParameters *p_Vid, InputParameters *p_Inp, int curr_frame_to_code)
+{
+  TIME_T start_time;
+  int frame_coded;
+
+  if (p_Vid->view_id == 1)
+  {
+    if (start_sequence_position(p_Vid, p_Inp, curr_frame_to_code, &start_time))
+      view_threads_start(p_Vid, &start_time);
+    return;
+  }
+
+  frame_coded = start_sequence_position(p_Vid, p_Inp, curr_frame_to_code, &start_time);
+  if (frame_coded)
+    code_one_frame(p_Vid, p_Inp);
+
+  view_threads_finish(p_Vid);
+
+  if (frame_coded)
+    finish_sequence_position(p_Vid, p_Inp, &start_time);
+}
+#endif
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Finish the frame of a coding step after it has been coded: write,
+ *    store and report it and code its redundant picture
+ * \param start_time
+ *    time the coding of the frame was started
+ ***********************************************************************
+ */
+void finish_sequence_position(VideoParameters *p_Vid, InputParameters *p_Inp, TIME_T *start_time)
+{
+  finish_one_frame(p_Vid, p_Inp, start_time);
+
+  p_Vid->p_CurrEncodePar->last_ref_idc = p_Vid->nal_reference_idc ? 1 : 0;
+
+  // if key frame is encoded, encode one redundant frame
+  if (p_Inp->redundant_pic_flag && p_Vid->key_frame)
+  {
+    encode_one_redundant_frame(p_Vid, p_Inp);
+  }
+
+  if (p_Inp->EnableOpenGOP && p_Vid->p_curr_frm_struct->random_access)
+  {
+    if (p_Inp->PicInterlace)
     {
-      if (p_Inp->PicInterlace)
+      if (p_Vid->p_curr_frm_struct->p_top_fld_pic->p_Slice[0].type == I_SLICE && p_Vid->p_curr_frm_struct->random_access) //Currently encoder always codes top field as I
       {
-        if (p_Vid->p_curr_frm_struct->p_top_fld_pic->p_Slice[0].type == I_SLICE && p_Vid->p_curr_frm_struct->random_access) //Currently encoder always codes top field as I
-        {
-          p_Vid->last_valid_reference = p_Vid->ThisPOC & (~( (signed int)1 ));
-          //printf("last valid ref: %d", p_Vid->last_valid_reference);
-        }
-      }
-      else if (p_Vid->type == I_SLICE)
-      {
-        p_Vid->last_valid_reference = p_Vid->ThisPOC;
+        p_Vid->last_valid_reference = p_Vid->ThisPOC & (~( (signed int)1 ));
         //printf("last valid ref: %d", p_Vid->last_valid_reference);
       }
     }
-
-    if (p_Inp->ReportFrameStats)
+    else if (p_Vid->type == I_SLICE)
     {
-      report_frame_statistic(p_Vid, p_Inp);
+      p_Vid->last_valid_reference = p_Vid->ThisPOC;
+      //printf("last valid ref: %d", p_Vid->last_valid_reference);
     }
+  }
 
+  if (p_Inp->ReportFrameStats)
+  {
+    global_lock_acquire();
+    report_frame_statistic(p_Vid, p_Inp);
+    global_lock_release();
+  }
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Encode a sequence
+ ***********************************************************************
+ */
+void encode_sequence(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  int curr_frame_to_code;
+  int frames_to_code = sequence_length(p_Inp);
+  int tmp_rate_control_enable = p_Inp->RCEnable;
+
+  for (curr_frame_to_code = 0; curr_frame_to_code < frames_to_code; curr_frame_to_code++)
+  {
+    if ( set_sequence_position(p_Vid, p_Inp, curr_frame_to_code, tmp_rate_control_enable) )
+    {
+#if (MVC_EXTENSION_ENABLE)
+      if (p_Vid->p_view_threads != NULL)
+        encode_sequence_position_pipelined(p_Vid, p_Inp, curr_frame_to_code);
+      else
+#endif
+      encode_sequence_position(p_Vid, p_Inp, curr_frame_to_code);
+    }
   }
 
+#if (MVC_EXTENSION_ENABLE)
+  // the view 1 of the last access unit
+  view_threads_finish(p_Vid);
+#endif
+
 #if EOS_OUTPUT
   end_of_stream(p_Vid);
 #endif
@@ -1057,13 +1214,21 @@ void free_encoder_memory(VideoParameters *p_Vid, InputParameters *p_Inp)
     close(p_Vid->p_dec2);
 #endif
   
+#if TRACE
   if (p_Enc->p_trace)
     fclose(p_Enc->p_trace);
+#endif
 
   clear_motion_search_module (p_Vid, p_Inp);
 
   RandomIntraUninit(p_Vid);
   FmoUninit(p_Vid);
+  free_mp_threads(p_Vid);
+#if (MVC_EXTENSION_ENABLE)
+  free_view_threads(p_Vid);
+#endif
+  ir_destroy(p_Vid->p_reader);
+  p_Vid->p_reader = NULL;
 
   if (p_Inp->NumberBFrames && p_Inp->HierarchicalCoding == 3)
   {
@@ -1074,8 +1239,10 @@ void free_encoder_memory(VideoParameters *p_Vid, InputParameters *p_Inp)
   calc_buffer(p_Vid, p_Inp);
 #endif
 
-  // report everything
+  // report everything (the log files are shared by all encoders of the process)
+  global_lock_acquire();
   report(p_Vid, p_Inp, p_Vid->p_Stats);
+  global_lock_release();
 
 #ifdef _LEAKYBUCKET_
   free_pointer(p_Vid->Bit_Buffer);
@@ -1228,7 +1395,7 @@ static void init_img( VideoParameters *p_Vid)
   p_Vid->height        = (p_Inp->output.height[0] + p_Vid->auto_crop_bottom);
   p_Vid->width_blk     = p_Vid->width  / BLOCK_SIZE;
   p_Vid->height_blk    = p_Vid->height / BLOCK_SIZE;
-  p_Vid->width_padded  = p_Vid->width  + 2 * IMG_PAD_SIZE_X;
+  p_Vid->width_padded  = get_pel_stride(p_Vid->width, IMG_PAD_SIZE_X);
   p_Vid->height_padded = p_Vid->height + 2 * IMG_PAD_SIZE_Y;
 
   if (p_Vid->yuv_format != YUV400)
@@ -1285,6 +1452,25 @@ static void init_img( VideoParameters *p_Vid)
       no_mem_exit("init p_Vid->mb16x16_cost_frame");
     }
   }
+
+  if (p_Inp->MDPruning && (p_Inp->rdopt == 1 || p_Inp->rdopt == 2))
+  {
+    if ((p_Vid->md_prune_info = (MDPruneInfo *) calloc(p_Vid->FrameSizeInMbs, sizeof(MDPruneInfo))) == NULL)
+      no_mem_exit("init_img: p_Vid->md_prune_info");
+  }
+
+  if (p_Inp->MBTree || strlen(p_Inp->QPMapFile) > 0)
+  {
+    if ((p_Vid->mb_qp_offset_buf[0] = (int *) calloc(p_Vid->FrameSizeInMbs, sizeof(int))) == NULL)
+      no_mem_exit("init_img: p_Vid->mb_qp_offset_buf");
+    // the map offsets of view 1 are kept apart while the next base view is set up
+    if (strlen(p_Inp->QPMapFile) > 0 && p_Inp->num_of_views == 2)
+    {
+      if ((p_Vid->mb_qp_offset_buf[1] = (int *) calloc(p_Vid->FrameSizeInMbs, sizeof(int))) == NULL)
+        no_mem_exit("init_img: p_Vid->mb_qp_offset_buf");
+    }
+    p_Vid->mb_qp_offset = p_Vid->mb_qp_offset_buf[0];
+  }
   get_mem2D((byte***)&(p_Vid->ipredmode), p_Vid->height_blk, p_Vid->width_blk);        //need two extra rows at right and bottom
   get_mem2D((byte***)&(p_Vid->ipredmode8x8), p_Vid->height_blk, p_Vid->width_blk);     // help storage for ipredmode 8x8, inserted by YV
   memset(&(p_Vid->ipredmode[0][0])   , -1, p_Vid->height_blk * p_Vid->width_blk *sizeof(char));
@@ -1640,6 +1826,9 @@ static int init_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
 {
   int j, memory_size=0;
 
+  p_Vid->p_mem = mem_usage_create();
+  p_Vid->p_prof = p_Inp->ModuleProfile ? profile_create() : NULL;
+
   if ((p_Vid->enc_frame_picture = (StorablePicture**)malloc(6 * sizeof(StorablePicture*))) == NULL)
     no_mem_exit("init_global_buffers: *p_Vid->enc_frame_picture");
 
@@ -1703,21 +1892,21 @@ static int init_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
 #endif
 
   // Init memory data for input & encoded images
-  memory_size += init_orig_buffers(p_Vid, &p_Vid->imgData);
+  memory_size += mem_usage_add(p_Vid->p_mem, MEM_SOURCE, init_orig_buffers(p_Vid, &p_Vid->imgData));
 
   if ( p_Inp->MDReference[0] || p_Inp->MDReference[1] )
   {
-    memory_size += init_orig_buffers(p_Vid, &p_Vid->imgRefData);
+    memory_size += mem_usage_add(p_Vid->p_mem, MEM_SOURCE, init_orig_buffers(p_Vid, &p_Vid->imgRefData));
   }
 
-  memory_size += init_orig_buffers(p_Vid, &p_Vid->imgData0);
+  memory_size += mem_usage_add(p_Vid->p_mem, MEM_SOURCE, init_orig_buffers(p_Vid, &p_Vid->imgData0));
 
   if (p_Inp->enable_32_pulldown)
   {
-    memory_size += init_orig_buffers(p_Vid, &p_Vid->imgData32);
-    memory_size += init_orig_buffers(p_Vid, &p_Vid->imgData4);
-    memory_size += init_orig_buffers(p_Vid, &p_Vid->imgData5);
-    memory_size += init_orig_buffers(p_Vid, &p_Vid->imgData6);
+    memory_size += mem_usage_add(p_Vid->p_mem, MEM_SOURCE, init_orig_buffers(p_Vid, &p_Vid->imgData32));
+    memory_size += mem_usage_add(p_Vid->p_mem, MEM_SOURCE, init_orig_buffers(p_Vid, &p_Vid->imgData4));
+    memory_size += mem_usage_add(p_Vid->p_mem, MEM_SOURCE, init_orig_buffers(p_Vid, &p_Vid->imgData5));
+    memory_size += mem_usage_add(p_Vid->p_mem, MEM_SOURCE, init_orig_buffers(p_Vid, &p_Vid->imgData6));
   }
 
 
@@ -1733,7 +1922,7 @@ static int init_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
 
   if (p_Inp->rdopt == 3)
   {
-    memory_size += allocate_errdo_mem(p_Vid, p_Inp);
+    memory_size += mem_usage_add(p_Vid->p_mem, MEM_ERRDO, allocate_errdo_mem(p_Vid, p_Inp));
   }
 
   if (p_Inp->RestrictRef)
@@ -1767,7 +1956,7 @@ static int init_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
     {
       if ((p_Vid->p_UMHex = (UMHexStruct*)calloc(1, sizeof(UMHexStruct))) == NULL)
         no_mem_exit("init_mv_block: p_Vid->p_UMHex");
-      memory_size += UMHEX_get_mem(p_Vid, p_Inp);
+      memory_size += mem_usage_add(p_Vid->p_mem, MEM_MOTION_SEARCH, UMHEX_get_mem(p_Vid, p_Inp));
     }
     if (p_Inp->SearchMode[0] == UM_HEX_SIMPLE || p_Inp->SearchMode[1] == UM_HEX_SIMPLE)
     {
@@ -1775,16 +1964,20 @@ static int init_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
         no_mem_exit("init_mv_block: p_Vid->p_UMHexSMP");
 
       smpUMHEX_init(p_Vid);
-      memory_size += smpUMHEX_get_mem(p_Vid);
+      memory_size += mem_usage_add(p_Vid->p_mem, MEM_MOTION_SEARCH, smpUMHEX_get_mem(p_Vid));
     }
     if (p_Inp->SearchMode[0] == EPZS || p_Inp->SearchMode[1] == EPZS)
     {
-      memory_size += EPZSInit(p_Vid);
+      memory_size += mem_usage_add(p_Vid->p_mem, MEM_MOTION_SEARCH, EPZSInit(p_Vid));
     }
   }
 
   if (p_Inp->RCEnable)
     rc_allocate_memory(p_Vid, p_Inp);
+  if (p_Inp->RCPass)
+    p_Vid->p_rc_stats = rc_stats_open(p_Vid, p_Inp);
+  if (strlen(p_Inp->QPMapFile) > 0)
+    p_Vid->p_qp_map = qp_map_open(p_Vid, p_Inp);
 
   if (p_Inp->redundant_pic_flag)
   {
@@ -1808,10 +2001,10 @@ static int init_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
   //if ( p_Inp->ChromaMCBuffer )
     chroma_mc_setup(p_Vid);
 
-  p_Vid->padded_size_x       = (p_Vid->width + 2 * IMG_PAD_SIZE_X);
+  p_Vid->padded_size_x       = get_pel_stride(p_Vid->width, IMG_PAD_SIZE_X);
   p_Vid->padded_size_x_m8x8  = (p_Vid->padded_size_x - BLOCK_SIZE_8x8);
   p_Vid->padded_size_x_m4x4  = (p_Vid->padded_size_x - BLOCK_SIZE);
-  p_Vid->cr_padded_size_x    = (p_Vid->width_cr + 2 * p_Vid->pad_size_uv_x);
+  p_Vid->cr_padded_size_x    = get_pel_stride(p_Vid->width_cr, p_Vid->pad_size_uv_x);
   p_Vid->cr_padded_size_x2   = (p_Vid->cr_padded_size_x << 1);
   p_Vid->cr_padded_size_x4   = (p_Vid->cr_padded_size_x << 2);
   p_Vid->cr_padded_size_x_m8 = (p_Vid->cr_padded_size_x - 8);
@@ -1834,6 +2027,9 @@ static int init_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
 
   p_Vid->p_pred = init_seq_structure( p_Vid, p_Inp, &memory_size );
 
+  // what is not accounted to a subsystem above
+  mem_usage_add(p_Vid->p_mem, MEM_OTHER, (int) (memory_size - mem_usage_total(p_Vid->p_mem)));
+
   return memory_size;
 }
 
@@ -2030,6 +2226,15 @@ static void free_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
     free_pointer(p_Vid->mb16x16_cost_frame);
   }
 
+  free_pointer(p_Vid->md_prune_info);
+  p_Vid->md_prune_info = NULL;
+
+  free_pointer(p_Vid->mb_qp_offset_buf[0]);
+  free_pointer(p_Vid->mb_qp_offset_buf[1]);
+  p_Vid->mb_qp_offset = NULL;
+  wp_moments_free(p_Vid->p_wp_org);
+  p_Vid->p_wp_org = NULL;
+
   if (p_Inp->rdopt == 3)
   {
     free_errdo_mem(p_Vid);
@@ -2105,6 +2310,10 @@ static void free_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
 
   if (p_Inp->RCEnable)
     rc_free_memory(p_Vid, p_Inp);
+  rc_stats_close(p_Vid->p_rc_stats);
+  p_Vid->p_rc_stats = NULL;
+  qp_map_close(p_Vid->p_qp_map);
+  p_Vid->p_qp_map = NULL;
 
   if (p_Inp->redundant_pic_flag)
   {
@@ -2128,6 +2337,11 @@ static void free_global_buffers(VideoParameters *p_Vid, InputParameters *p_Inp)
 
   clear_process_image( p_Vid, p_Inp );
   free_seq_structure( p_Vid->p_pred );
+
+  mem_usage_free(p_Vid->p_mem);
+  p_Vid->p_mem = NULL;
+  profile_free(p_Vid->p_prof);
+  p_Vid->p_prof = NULL;
 }
 
 
@@ -2449,7 +2663,7 @@ static void gen_enc_par(VideoParameters *p_Vid, int layer_idx)
   cps->height        = (p_Inp->output.height[0] + p_Vid->auto_crop_bottom);
   cps->width_blk     = cps->width  / BLOCK_SIZE;
   cps->height_blk    = cps->height / BLOCK_SIZE;
-  cps->width_padded  = cps->width  + 2 * IMG_PAD_SIZE_X;
+  cps->width_padded  = get_pel_stride(cps->width, IMG_PAD_SIZE_X);
   cps->height_padded = cps->height + 2 * IMG_PAD_SIZE_Y;
 
   if (cps->yuv_format != YUV400)
@@ -2502,10 +2716,10 @@ static void gen_enc_par(VideoParameters *p_Vid, int layer_idx)
   cps->shift_cr_y  = cps->chroma_shift_y - 2;
   cps->shift_cr_x  = cps->chroma_shift_x - 2;
 
-  cps->padded_size_x       = (cps->width + 2 * IMG_PAD_SIZE_X);
+  cps->padded_size_x       = get_pel_stride(cps->width, IMG_PAD_SIZE_X);
   cps->padded_size_x_m8x8  = (cps->padded_size_x - BLOCK_SIZE_8x8);
   cps->padded_size_x_m4x4  = (cps->padded_size_x - BLOCK_SIZE);
-  cps->cr_padded_size_x    = (cps->width_cr + 2 * cps->pad_size_uv_x);
+  cps->cr_padded_size_x    = get_pel_stride(cps->width_cr, cps->pad_size_uv_x);
   cps->cr_padded_size_x2   = (cps->cr_padded_size_x << 1);
   cps->cr_padded_size_x4   = (cps->cr_padded_size_x << 2);
   cps->cr_padded_size_x_m8 = (cps->cr_padded_size_x - 8);
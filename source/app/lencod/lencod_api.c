@@ -0,0 +1,349 @@
+/*!
+ *************************************************************************************
+ * \file lencod_api.c
+ *
+ * \brief
+ *    Library interface of the encoder: push frames, pull NAL units.
+ *
+ *    The coding steps of the sequence are the ones of encode_sequence().
+ *    A step is coded as soon as the frame it needs has been pushed, so
+ *    that with hierarchical B frames the frames of a GOP are held until
+ *    its anchor frame arrives. Source frames are converted directly from
+ *    the caller's planes and the NAL units are queued as Annex B bytes.
+ *
+ *************************************************************************************
+ */
+
+#include "contributors.h"
+
+#include "global.h"
+#include "annexb.h"
+#include "filehandle.h"
+#include "img_convert.h"
+#include "memalloc.h"
+#include "thread_common.h"
+#include "win32.h"
+#include "lencod_api_int.h"
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Adjust the configuration of an encoder of the library interface.
+ *    Frames are only available once they have been pushed, so nothing
+ *    may read ahead of the coding order.
+ ************************************************************************
+ */
+void api_init_params(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  if (p_Inp->num_of_views == 2)
+    error ("MVC coding is not supported through the library interface.", 500);
+  if (p_Inp->enable_32_pulldown)
+    error ("Enable32Pulldown is not supported through the library interface.", 500);
+  if (p_Inp->ExplicitSeqCoding)
+    error ("ExplicitSeqCoding is not supported through the library interface.", 500);
+  if (p_Inp->source.pic_unit_size_shift3 > 2)
+    error ("Source samples of more than 16 bits are not supported through the library interface.", 500);
+
+  if (p_Inp->LookAheadDepth)
+  {
+    printf("\nWarning: LookAheadDepth is set to 0 for the library interface.\n");
+    p_Inp->LookAheadDepth = 0;
+    p_Inp->MBTree = 0;
+  }
+  if (p_Inp->of_mode != PAR_OF_ANNEXB)
+  {
+    printf("\nWarning: OutFileMode is set to Annex B for the library interface.\n");
+    p_Inp->of_mode = PAR_OF_ANNEXB;
+  }
+  p_Inp->ReadAheadFrames = 0;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Queue a NALU for encoder_pull_nalus()
+ * \return
+ *    number of bits written
+ ************************************************************************
+ */
+int api_write_nalu (VideoParameters *p_Vid, NALU_t *n, FILE **f_out)
+{
+  JMEncoder *enc = p_Vid->p_api;
+  JMQueuedNalu *nalu;
+  byte header[ANNEXB_HEADER_SIZE];
+  int length = AnnexbNALUHeader (p_Vid, n, header);
+  size_t size = length + n->len;
+
+  if (enc->buf_used + size > enc->buf_size)
+  {
+    enc->buf_size = imax((int) (enc->buf_used + size), (int) (enc->buf_size << 1));
+    if ((enc->buf = (byte *) realloc(enc->buf, enc->buf_size)) == NULL)
+      no_mem_exit("api_write_nalu: buf");
+  }
+  if (enc->num_nalus == enc->max_nalus)
+  {
+    enc->max_nalus = imax(16, enc->max_nalus << 1);
+    if ((enc->nalus = (JMQueuedNalu *) realloc(enc->nalus, enc->max_nalus * sizeof(JMQueuedNalu))) == NULL)
+      no_mem_exit("api_write_nalu: nalus");
+  }
+
+  nalu = &enc->nalus[enc->num_nalus++];
+  nalu->offset  = enc->buf_used;
+  nalu->size    = size;
+  nalu->type    = n->nal_unit_type;
+  nalu->ref_idc = n->nal_reference_idc;
+  nalu->pts     = enc->curr_pts;
+
+  memcpy(enc->buf + enc->buf_used, header, length);
+  memcpy(enc->buf + enc->buf_used + length, n->buf, n->len);
+  enc->buf_used += size;
+
+  return (int) (size << 3);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Convert a pushed frame to the source picture planes
+ * \return
+ *    0 if the frame has not been pushed
+ ************************************************************************
+ */
+int api_read_frame (VideoParameters *p_Vid, int frm_no_in_file, imgpel **pImage[3])
+{
+  JMEncoder *enc = p_Vid->p_api;
+  InputParameters *p_Inp = p_Vid->p_Inp;
+  FrameFormat *source = &p_Inp->source;
+  FrameFormat *output = &p_Inp->output;
+  int symbol_size_in_bytes = source->pic_unit_size_shift3;
+  // RGB planes are coded in G, B, R order
+  static const int rgb_order[3] = { 1, 2, 0 };
+  static const int yuv_order[3] = { 0, 1, 2 };
+  const int *order = (source->color_model == CM_RGB && source->yuv_format == YUV444) ? rgb_order : yuv_order;
+  JMFrame *frm;
+  int k;
+
+  if (frm_no_in_file >= enc->num_pushed || !enc->frames[frm_no_in_file].held)
+    return 0;
+  frm = &enc->frames[frm_no_in_file];
+
+  plane2img(pImage[0], frm->planes[order[0]], frm->strides[order[0]], source->width[0], source->height[0], output->width[0], output->height[0],
+    symbol_size_in_bytes, source->bit_depth[0] - output->bit_depth[0]);
+
+  if (p_Vid->yuv_format != YUV400)
+  {
+#if (ALLOW_GRAYSCALE)
+    if (!p_Inp->grayscale)
+#endif
+    {
+      for (k = 1; k < 3; k++)
+        plane2img(pImage[k], frm->planes[order[k]], frm->strides[order[k]], source->width[1], source->height[1], output->width[1], output->height[1],
+          symbol_size_in_bytes, source->bit_depth[k] - output->bit_depth[k]);
+    }
+  }
+
+  pad_borders (p_Inp->output, p_Vid->width, p_Vid->height, p_Vid->width_cr, p_Vid->height_cr, pImage);
+
+  return 1;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Hand a frame back to the caller
+ ************************************************************************
+ */
+static void api_release_frame(JMEncoder *enc, int frm_no_in_file)
+{
+  JMFrame *frm = &enc->frames[frm_no_in_file];
+
+  if (frm->held)
+  {
+    frm->held = 0;
+    if (enc->frame_release)
+      enc->frame_release(enc->opaque, frm->pts, frm->planes);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Code the steps of the sequence whose frames have been pushed
+ ************************************************************************
+ */
+static void api_encode_pushed(JMEncoder *enc)
+{
+  VideoParameters *p_Vid = enc->p_Enc->p_Vid;
+  InputParameters *p_Inp = enc->p_Enc->p_Inp;
+
+  while (enc->curr_frame_to_code < enc->frames_to_code)
+  {
+    if (set_sequence_position(p_Vid, p_Inp, enc->curr_frame_to_code, p_Inp->RCEnable))
+    {
+      int frm_no_in_file = (1 + p_Inp->frame_skip) * p_Vid->p_curr_frm_struct->frame_no;
+
+      if (frm_no_in_file >= enc->num_pushed)
+        return;
+
+      enc->curr_pts = enc->frames[frm_no_in_file].pts;
+      encode_sequence_position(p_Vid, p_Inp, enc->curr_frame_to_code);
+      api_release_frame(enc, frm_no_in_file);
+    }
+    enc->curr_frame_to_code++;
+  }
+
+#if EOS_OUTPUT
+  end_of_stream(p_Vid);
+#endif
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Open an encoder
+ ************************************************************************
+ */
+JMEncoder *encoder_open(const JMEncoderConfig *config)
+{
+  JMEncoder *enc;
+  InputParameters *p_Inp;
+  char **argv;
+  int argc = 1, i;
+
+#if TRACE
+  fprintf(stderr, "The library interface is not supported with TRACE.\n");
+  return NULL;
+#endif
+  if (config == NULL || config->num_params < 0 || (config->num_params > 0 && config->params == NULL))
+    return NULL;
+
+  // command line of the configuration: lencod [-d file] {-p Name=Value}
+  if ((argv = (char **) calloc(3 + 2 * config->num_params, sizeof(char *))) == NULL)
+    no_mem_exit("encoder_open: argv");
+  argv[0] = "lencod";
+  if (config->config_file)
+  {
+    argv[argc++] = "-d";
+    argv[argc++] = (char *) config->config_file;
+  }
+  for (i = 0; i < config->num_params; i++)
+  {
+    argv[argc++] = "-p";
+    argv[argc++] = (char *) config->params[i];
+  }
+
+  if ((enc = (JMEncoder *) calloc(1, sizeof(JMEncoder))) == NULL)
+    no_mem_exit("encoder_open: enc");
+  enc->frame_release = config->frame_release;
+  enc->opaque        = config->opaque;
+  enc->curr_pts      = JM_NO_PTS;
+
+  global_lock_acquire();
+  init_time();
+  global_lock_release();
+
+  enc->p_Enc = open_encoder(argc, argv, enc);
+  free(argv);
+
+  p_Inp = enc->p_Enc->p_Inp;
+  enc->frames_to_code = sequence_length(p_Inp);
+  enc->num_frames = (1 + p_Inp->frame_skip) * (p_Inp->no_frames - 1) + 1;
+  if ((enc->frames = (JMFrame *) calloc(enc->num_frames, sizeof(JMFrame))) == NULL)
+    no_mem_exit("encoder_open: frames");
+
+  return enc;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Push the next frame and code what can be coded
+ ************************************************************************
+ */
+int encoder_push_frame(JMEncoder *enc, const void *const planes[3], const int strides[3], int64_t pts)
+{
+  JMFrame *frm;
+  int k, num_planes = (enc->p_Enc->p_Vid->yuv_format != YUV400) ? 3 : 1;
+
+  if (enc->num_pushed >= enc->num_frames || planes == NULL || strides == NULL)
+    return -1;
+  for (k = 0; k < num_planes; k++)
+  {
+    if (planes[k] == NULL)
+      return -1;
+  }
+
+  frm = &enc->frames[enc->num_pushed];
+  for (k = 0; k < 3; k++)
+  {
+    frm->planes[k]  = (k < num_planes) ? planes[k]  : NULL;
+    frm->strides[k] = (k < num_planes) ? strides[k] : 0;
+  }
+  frm->pts  = pts;
+  frm->held = 1;
+
+  // frames dropped by FrameSkip are not coded at all
+  if (enc->num_pushed++ % (1 + enc->p_Enc->p_Inp->frame_skip))
+    api_release_frame(enc, enc->num_pushed - 1);
+  else
+    api_encode_pushed(enc);
+
+  return 0;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Hand the queued NAL units to callback
+ ************************************************************************
+ */
+int encoder_pull_nalus(JMEncoder *enc, JMNaluCallback callback, void *opaque)
+{
+  int i, num_nalus = enc->num_nalus;
+
+  for (i = 0; i < num_nalus; i++)
+  {
+    JMQueuedNalu *q = &enc->nalus[i];
+    JMNalu nalu;
+
+    nalu.data    = enc->buf + q->offset;
+    nalu.size    = q->size;
+    nalu.type    = q->type;
+    nalu.ref_idc = q->ref_idc;
+    nalu.pts     = q->pts;
+    callback(opaque, &nalu);
+  }
+
+  enc->num_nalus = 0;
+  enc->buf_used  = 0;
+
+  return num_nalus;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Free an encoder
+ ************************************************************************
+ */
+int encoder_close(JMEncoder *enc)
+{
+  int complete, i;
+
+  if (enc == NULL)
+    return -1;
+
+  complete = (enc->curr_frame_to_code == enc->frames_to_code);
+
+  for (i = 0; i < enc->num_pushed; i++)
+    api_release_frame(enc, i);
+
+  close_encoder(enc->p_Enc);
+
+  free(enc->frames);
+  free(enc->buf);
+  free(enc->nalus);
+  free(enc);
+
+  return complete ? 0 : -1;
+}
@@ -0,0 +1,99 @@
+/*!
+ ***************************************************************************
+ * \file
+ *    lencod_api.h
+ *
+ * \brief
+ *    Library interface of the encoder (lencodlib).
+ *
+ *    An encoder is opened with a configuration file and "Name=Value"
+ *    parameters exactly like the command line encoder (lencod -d file
+ *    -p Name=Value ...). The caller pushes the source frames in display
+ *    order and pulls the coded NAL units as Annex B byte stream. Each
+ *    instance is independent of the others, so that several encoders can
+ *    run on separate threads; one instance must only be used by one
+ *    thread at a time.
+ *
+ *    Frames are not copied: the encoder keeps the pointers to the planes
+ *    until the frame has been coded and then hands them back through the
+ *    frame_release callback. The planes hold the source samples of
+ *    SourceWidth x SourceHeight (chroma subsampled per YUVFormat) with one
+ *    byte per sample for SourceBitDepth up to 8 and a host order uint16_t
+ *    per sample otherwise. RGB sources are passed in R, G, B plane order.
+ *
+ *    FramesToBeEncoded must be set to the number of frames the stream
+ *    will have, since the prediction structure of the sequence is planned
+ *    with it. Configuration errors still terminate the process like in
+ *    the command line encoder.
+ ***************************************************************************
+ */
+
+#ifndef _LENCOD_API_H_
+#define _LENCOD_API_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define JM_NO_PTS INT64_MIN     //!< pts of the NAL units written before the first frame
+
+typedef struct jm_encoder JMEncoder;
+
+//! coded NAL unit
+typedef struct jm_nalu
+{
+  const uint8_t *data;          //!< start code, NAL unit header and payload
+  size_t         size;
+  int            type;          //!< nal_unit_type
+  int            ref_idc;       //!< nal_ref_idc
+  int64_t        pts;           //!< pts of the frame the NAL unit belongs to
+} JMNalu;
+
+typedef void (*JMNaluCallback)  (void *opaque, const JMNalu *nalu);
+typedef void (*JMFrameRelease)  (void *opaque, int64_t pts, const void *const planes[3]);
+
+//! encoder configuration
+typedef struct jm_encoder_config
+{
+  const char          *config_file;    //!< configuration file (NULL: encoder.cfg as for lencod)
+  int                  num_params;
+  const char *const   *params;         //!< "Name=Value" parameters applied after the file
+  JMFrameRelease       frame_release;  //!< called once the encoder is done with a frame (may be NULL)
+  void                *opaque;         //!< passed to frame_release
+} JMEncoderConfig;
+
+/*!
+ * Open an encoder and code the sequence header.
+ * \return the encoder or NULL if the configuration can not be used
+ */
+extern JMEncoder *encoder_open       (const JMEncoderConfig *config);
+
+/*!
+ * Push the next frame in display order and code all frames that can be
+ * coded with it. planes[1] and planes[2] are ignored for 4:0:0 sources.
+ * \return 0 on success, -1 if the frame is invalid or beyond FramesToBeEncoded
+ */
+extern int        encoder_push_frame (JMEncoder *enc, const void *const planes[3], const int strides[3], int64_t pts);
+
+/*!
+ * Hand all NAL units coded so far to callback in stream order. The data
+ * is only valid during the call.
+ * \return number of NAL units
+ */
+extern int        encoder_pull_nalus (JMEncoder *enc, JMNaluCallback callback, void *opaque);
+
+/*!
+ * Release all frames still held, report the statistics and free the
+ * encoder. NAL units not pulled yet are dropped.
+ * \return 0 if the whole sequence was coded, -1 if frames were missing
+ */
+extern int        encoder_close      (JMEncoder *enc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,62 @@
+/*!
+ ***************************************************************************
+ * \file
+ *    lencod_api_int.h
+ *
+ * \brief
+ *    Encoder side hooks of the library interface (lencod_api.h).
+ ***************************************************************************
+ */
+
+#ifndef _LENCOD_API_INT_H_
+#define _LENCOD_API_INT_H_
+
+#include "global.h"
+#include "lencod_api.h"
+
+//! frame pushed by the caller
+typedef struct jm_frame
+{
+  const void *planes[3];
+  int         strides[3];
+  int64_t     pts;
+  int         held;             //!< the encoder still holds the frame
+} JMFrame;
+
+//! NAL unit in the output queue
+typedef struct jm_queued_nalu
+{
+  size_t      offset;           //!< position in the NAL unit buffer
+  size_t      size;
+  int         type;
+  int         ref_idc;
+  int64_t     pts;
+} JMQueuedNalu;
+
+struct jm_encoder
+{
+  EncoderParams  *p_Enc;
+  JMFrameRelease  frame_release;
+  void           *opaque;
+
+  JMFrame        *frames;       //!< all frames of the sequence (in file numbering)
+  int             num_frames;
+  int             num_pushed;
+
+  int             curr_frame_to_code;   //!< next coding step of the sequence
+  int             frames_to_code;
+  int64_t         curr_pts;             //!< pts of the frame being coded
+
+  byte           *buf;          //!< Annex B bytes of the queued NAL units
+  size_t          buf_size;
+  size_t          buf_used;
+  JMQueuedNalu   *nalus;
+  int             max_nalus;
+  int             num_nalus;
+};
+
+extern void api_init_params (VideoParameters *p_Vid, InputParameters *p_Inp);
+extern int  api_write_nalu  (VideoParameters *p_Vid, NALU_t *n, FILE **f_out);
+extern int  api_read_frame  (VideoParameters *p_Vid, int frm_no_in_file, imgpel **pImage[3]);
+
+#endif
@@ -0,0 +1,44 @@
+/*!
+ *  \file
+ *     lencod_main.c
+ *  \brief
+ *     H.264/AVC reference encoder project main()
+ *
+ *     The encoder itself is the library lencodlib, see lencod.c for the
+ *     sequence coding and lencod_api.h for the library interface.
+ */
+
+#include "contributors.h"
+
+#include "win32.h"
+#include "global.h"
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Main function for encoder.
+ * \param argc
+ *    number of command line arguments
+ * \param argv
+ *    command line arguments
+ * \return
+ *    exit code
+ ***********************************************************************
+ */
+int main(int argc, char **argv)
+{
+  init_time();
+#if MEMORY_DEBUG
+  _CrtSetDbgFlag ( _CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF );
+#endif
+
+  open_encoder(argc, argv, NULL);
+
+  // encode sequence
+  encode_sequence(p_Enc->p_Vid, p_Enc->p_Inp);
+
+  // terminate sequence
+  close_encoder(p_Enc);
+
+  return 0;
+}
@@ -0,0 +1,678 @@
+
+/*!
+ ***************************************************************************
+ * \file lookahead.c
+ *
+ * \brief
+ *    Look-ahead analysis stage.
+ *
+ *    Source frames are read through their own file handle and analysed
+ *    in a separate thread on a half resolution luma picture (8x8 blocks):
+ *     - intra cost: Hadamard SAD of the best of DC, vertical and horizontal
+ *       prediction from the (original) neighbouring samples
+ *     - inter cost: Hadamard SAD after a small diamond search against the
+ *       previous frame, limited by the intra cost of the block
+ *    The encoder queries the results while it builds the frame structure
+ *    and before rate control of each frame; a query blocks until the
+ *    requested frame has been analysed.
+ **************************************************************************
+ */
+
+#include "global.h"
+#include "memalloc.h"
+#include "input.h"
+#include "img_io.h"
+#include "configfile.h"
+#include "me_distortion.h"
+#include "resize.h"
+#include "lookahead.h"
+
+#define LA_BLOCK_SIZE    8
+#define LA_SEARCH_RANGE  16     //!< in half resolution samples
+#define LA_MB_TREE_MAX_OFFSET 10 //!< largest macroblock tree QP offset
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Intra cost of a half resolution 8x8 block
+ *************************************************************************************
+ */
+static int la_intra_cost(LookAhead *la, imgpel **img, int x0, int y0)
+{
+  short diff[LA_BLOCK_SIZE * LA_BLOCK_SIZE];
+  int i, j, dc;
+  int sum = 0, num = 0;
+  int cost;
+
+  if (y0)
+  {
+    for (i = 0; i < LA_BLOCK_SIZE; ++i)
+      sum += img[y0 - 1][x0 + i];
+    num += LA_BLOCK_SIZE;
+  }
+  if (x0)
+  {
+    for (j = 0; j < LA_BLOCK_SIZE; ++j)
+      sum += img[y0 + j][x0 - 1];
+    num += LA_BLOCK_SIZE;
+  }
+  dc = num ? (sum + (num >> 1)) / num : la->dc_value;
+
+  for (j = 0; j < LA_BLOCK_SIZE; ++j)
+    for (i = 0; i < LA_BLOCK_SIZE; ++i)
+      diff[j * LA_BLOCK_SIZE + i] = (short) (img[y0 + j][x0 + i] - dc);
+  cost = HadamardSAD8x8(diff);
+
+  if (y0)
+  {
+    for (j = 0; j < LA_BLOCK_SIZE; ++j)
+      for (i = 0; i < LA_BLOCK_SIZE; ++i)
+        diff[j * LA_BLOCK_SIZE + i] = (short) (img[y0 + j][x0 + i] - img[y0 - 1][x0 + i]);
+    cost = imin(cost, HadamardSAD8x8(diff));
+  }
+  if (x0)
+  {
+    for (j = 0; j < LA_BLOCK_SIZE; ++j)
+      for (i = 0; i < LA_BLOCK_SIZE; ++i)
+        diff[j * LA_BLOCK_SIZE + i] = (short) (img[y0 + j][x0 + i] - img[y0 + j][x0 - 1]);
+    cost = imin(cost, HadamardSAD8x8(diff));
+  }
+
+  return cost;
+}
+
+static int la_block_sad(imgpel **cur, imgpel **ref, int x0, int y0, int mv_x, int mv_y)
+{
+  int i, j, sad = 0;
+
+  for (j = 0; j < LA_BLOCK_SIZE; ++j)
+  {
+    imgpel *cur_line = &cur[y0 + j][x0];
+    imgpel *ref_line = &ref[y0 + mv_y + j][x0 + mv_x];
+    for (i = 0; i < LA_BLOCK_SIZE; ++i)
+      sad += iabs(cur_line[i] - ref_line[i]);
+  }
+  return sad;
+}
+
+static inline int la_valid_mv(LookAhead *la, int x0, int y0, int mv_x, int mv_y)
+{
+  return (iabs(mv_x) <= LA_SEARCH_RANGE && iabs(mv_y) <= LA_SEARCH_RANGE
+    && x0 + mv_x >= 0 && x0 + mv_x + LA_BLOCK_SIZE <= la->lr_width
+    && y0 + mv_y >= 0 && y0 + mv_y + LA_BLOCK_SIZE <= la->lr_height);
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Inter cost of a half resolution 8x8 block: SAD diamond search starting
+ *    from the zero vector and the motion of the left and upper blocks,
+ *    Hadamard SAD at the best position
+ *************************************************************************************
+ */
+static int la_inter_cost(LookAhead *la, imgpel **cur, imgpel **ref, int bx, int by, int blk_width)
+{
+  static const int diamond[4][2] = { { 0, -1 }, { -1, 0 }, { 1, 0 }, { 0, 1 } };
+  short diff[LA_BLOCK_SIZE * LA_BLOCK_SIZE];
+  MotionVector *mv = &la->mv[by * blk_width + bx];
+  int x0 = bx * LA_BLOCK_SIZE;
+  int y0 = by * LA_BLOCK_SIZE;
+  int best_x = 0, best_y = 0;
+  int best_sad = la_block_sad(cur, ref, x0, y0, 0, 0);
+  int i, j, k, sad;
+
+  // predictors
+  for (k = 0; k < 2; ++k)
+  {
+    MotionVector *pred = (k == 0) ? (bx ? mv - 1 : NULL) : (by ? mv - blk_width : NULL);
+
+    if (pred && (pred->mv_x || pred->mv_y) && la_valid_mv(la, x0, y0, pred->mv_x, pred->mv_y))
+    {
+      sad = la_block_sad(cur, ref, x0, y0, pred->mv_x, pred->mv_y);
+      if (sad < best_sad)
+      {
+        best_sad = sad;
+        best_x = pred->mv_x;
+        best_y = pred->mv_y;
+      }
+    }
+  }
+
+  // small diamond refinement
+  for (i = 0; i < LA_SEARCH_RANGE; ++i)
+  {
+    int center_x = best_x, center_y = best_y;
+
+    for (k = 0; k < 4; ++k)
+    {
+      int mv_x = center_x + diamond[k][0];
+      int mv_y = center_y + diamond[k][1];
+
+      if (la_valid_mv(la, x0, y0, mv_x, mv_y))
+      {
+        sad = la_block_sad(cur, ref, x0, y0, mv_x, mv_y);
+        if (sad < best_sad)
+        {
+          best_sad = sad;
+          best_x = mv_x;
+          best_y = mv_y;
+        }
+      }
+    }
+    if (best_x == center_x && best_y == center_y)
+      break;
+  }
+
+  mv->mv_x = (short) best_x;
+  mv->mv_y = (short) best_y;
+
+  for (j = 0; j < LA_BLOCK_SIZE; ++j)
+    for (i = 0; i < LA_BLOCK_SIZE; ++i)
+      diff[j * LA_BLOCK_SIZE + i] = (short) (cur[y0 + j][x0 + i] - ref[y0 + best_y + j][x0 + best_x + i]);
+
+  return HadamardSAD8x8(diff);
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Read and analyse one frame (display order)
+ * \return
+ *    0 if the frame could not be read
+ *************************************************************************************
+ */
+static int la_analyse_frame(LookAhead *la, int frame)
+{
+  InputParameters *p_Inp = la->p_Inp;
+  LAFrameStats *stats = &la->stats[frame];
+  imgpel **cur = la->lowres[frame & 0x01];
+  imgpel **ref = la->lowres[(frame - 1) & 0x01];
+  int blk_width  = la->blk_width;
+  int blk_height = la->blk_height;
+  int frm_no_in_file = (1 + p_Inp->frame_skip) * frame;
+  int bx, by;
+
+  if (p_Inp->enable_32_pulldown)
+    frm_no_in_file = (frm_no_in_file * 4 + (p_Inp->enable_32_pulldown == 1 ? 1 : 2)) / 5;
+
+  if (!read_one_frame(la->p_Vid, &la->input_file, frm_no_in_file, p_Inp->infile_header, &p_Inp->source, &p_Inp->output, la->frm_data))
+    return 0;
+
+  PyrDownG5x5_U8CnR(&la->frm_data[0][0][0], la->width * sizeof(imgpel), la->width, la->height, &cur[0][0], la->lr_width * sizeof(imgpel), 1);
+
+  stats->intra_cost = 0;
+  stats->inter_cost = 0;
+  stats->scene_cut  = 0;
+
+  if (la->mb_tree && stats->blk_intra == NULL)
+  {
+    int num_blocks = imax(1, blk_width * blk_height);
+
+    if ((stats->blk_intra = (int *) calloc(num_blocks, sizeof(int))) == NULL)
+      no_mem_exit("la_analyse_frame: stats->blk_intra");
+    if ((stats->blk_inter = (int *) calloc(num_blocks, sizeof(int))) == NULL)
+      no_mem_exit("la_analyse_frame: stats->blk_inter");
+    if ((stats->blk_mv = (MotionVector *) calloc(num_blocks, sizeof(MotionVector))) == NULL)
+      no_mem_exit("la_analyse_frame: stats->blk_mv");
+  }
+
+  for (by = 0; by < blk_height; ++by)
+  {
+    for (bx = 0; bx < blk_width; ++bx)
+    {
+      int intra = la_intra_cost(la, cur, bx * LA_BLOCK_SIZE, by * LA_BLOCK_SIZE);
+      int inter = frame ? imin(intra, la_inter_cost(la, cur, ref, bx, by, blk_width)) : intra;
+
+      stats->intra_cost += intra;
+      stats->inter_cost += inter;
+      if (la->mb_tree)
+      {
+        stats->blk_intra[by * blk_width + bx] = intra;
+        stats->blk_inter[by * blk_width + bx] = inter;
+      }
+    }
+  }
+  if (la->mb_tree && frame)
+    memcpy(stats->blk_mv, la->mv, blk_width * blk_height * sizeof(MotionVector));
+
+  // scene cut: prediction from the previous frame does not pay off
+  if (frame && la->threshold && (frame - la->last_cut) >= la->min_distance
+    && stats->inter_cost * 100 >= stats->intra_cost * (100 - la->threshold))
+  {
+    stats->scene_cut = 1;
+    la->last_cut = frame;
+    ++la->num_cuts;
+  }
+
+  return 1;
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Look-ahead thread: analyse frames up to the requested horizon
+ *************************************************************************************
+ */
+static void la_thread(void *arg)
+{
+  LookAhead *la = (LookAhead *) arg;
+  int frame;
+
+  mutex_lock(&la->mutex);
+  for (;;)
+  {
+    while (!la->stop && la->analysed < la->num_frames && la->analysed >= la->horizon)
+      cond_wait(&la->cond, &la->mutex);
+    if (la->stop || la->analysed >= la->num_frames)
+      break;
+
+    frame = la->analysed;
+    mutex_unlock(&la->mutex);
+    if (la_analyse_frame(la, frame))
+    {
+      mutex_lock(&la->mutex);
+      ++la->analysed;
+    }
+    else
+    {
+      mutex_lock(&la->mutex);
+      la->num_frames = la->analysed;
+    }
+    cond_broadcast(&la->cond);
+  }
+  mutex_unlock(&la->mutex);
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Get the look-ahead costs of a frame, waiting for its analysis if needed
+ * \return
+ *    NULL if the frame is not available
+ *************************************************************************************
+ */
+static LAFrameStats *la_get_stats(LookAhead *la, int frame)
+{
+  int available;
+
+  if (la == NULL || frame < 0)
+    return NULL;
+
+  if (la->threaded)
+  {
+    mutex_lock(&la->mutex);
+    if (la->horizon < frame + 1 + la->depth)
+    {
+      la->horizon = frame + 1 + la->depth;
+      cond_broadcast(&la->cond);
+    }
+    while (frame < la->num_frames && la->analysed <= frame)
+      cond_wait(&la->cond, &la->mutex);
+    available = (frame < la->num_frames);
+    mutex_unlock(&la->mutex);
+  }
+  else
+  {
+    while (frame < la->num_frames && la->analysed <= frame)
+    {
+      if (la_analyse_frame(la, la->analysed))
+        ++la->analysed;
+      else
+        la->num_frames = la->analysed;
+    }
+    available = (frame < la->num_frames);
+  }
+
+  return available ? &la->stats[frame] : NULL;
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Number of source frames that can be read from a concatenated input file
+ *************************************************************************************
+ */
+static int la_frames_in_file(InputParameters *p_Inp, VideoDataFile *input_file, int num_frames)
+{
+  int64 isize = (int64) p_Inp->source.size;
+  int64 avail;
+
+  if (!input_file->is_concatenated || p_Inp->enable_32_pulldown)
+    return num_frames;
+
+  isize <<= (imax(p_Inp->source.bit_depth[0], p_Inp->source.bit_depth[1]) > 8) ? 1 : 0;
+  avail = (getVideoFileSize(input_file->f_num) - p_Inp->infile_header) / isize - p_Inp->start_frame;
+  if (avail <= 0)
+    return 0;
+
+  return (int) imin(num_frames, (int) ((avail - 1) / (1 + p_Inp->frame_skip) + 1));
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Create the look-ahead and start its thread (analysis is done on demand
+ *    in the encoder thread if the thread cannot be created)
+ *************************************************************************************
+ */
+LookAhead *la_create(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  LookAhead *la = (LookAhead *) calloc(1, sizeof(LookAhead));
+
+  if (la == NULL)
+    no_mem_exit("la_create: la");
+  if ((la->p_Vid = (VideoParameters *) calloc(1, sizeof(VideoParameters))) == NULL)
+    no_mem_exit("la_create: la->p_Vid");
+
+  la->p_Inp = p_Inp;
+  la->p_Vid->p_Inp      = p_Inp;
+  la->p_Vid->yuv_format = p_Vid->yuv_format;
+  la->p_Vid->buf2img    = p_Vid->buf2img;
+  AllocateFrameMemory(la->p_Vid, p_Inp, &p_Inp->source);
+
+  la->input_file = p_Inp->input_file1;
+  la->input_file.f_num = -1;
+  OpenFiles(&la->input_file);
+
+  la->width     = p_Inp->output.width[0];
+  la->height    = p_Inp->output.height[0];
+  la->lr_width  = la->width >> 1;
+  la->lr_height = (la->height + 1) >> 1;
+  la->blk_width  = la->lr_width  / LA_BLOCK_SIZE;
+  la->blk_height = la->lr_height / LA_BLOCK_SIZE;
+  la->dc_value  = 1 << (p_Inp->output.bit_depth[0] - 1);
+
+  get_mem2Dpel(&la->frm_data[0], la->height, la->width);
+  if (p_Vid->yuv_format != YUV400)
+  {
+    get_mem2Dpel(&la->frm_data[1], p_Inp->output.height[1], p_Inp->output.width[1]);
+    get_mem2Dpel(&la->frm_data[2], p_Inp->output.height[1], p_Inp->output.width[1]);
+  }
+  get_mem2Dpel(&la->lowres[0], la->lr_height, la->lr_width);
+  get_mem2Dpel(&la->lowres[1], la->lr_height, la->lr_width);
+  if ((la->mv = (MotionVector *) calloc(imax(1, la->blk_width * la->blk_height), sizeof(MotionVector))) == NULL)
+    no_mem_exit("la_create: la->mv");
+  la->mb_tree = p_Inp->MBTree;
+  if (la->mb_tree)
+  {
+    if ((la->propagate[0] = (double *) calloc(imax(1, la->blk_width * la->blk_height), sizeof(double))) == NULL)
+      no_mem_exit("la_create: la->propagate[0]");
+    if ((la->propagate[1] = (double *) calloc(imax(1, la->blk_width * la->blk_height), sizeof(double))) == NULL)
+      no_mem_exit("la_create: la->propagate[1]");
+  }
+
+  la->depth        = p_Inp->LookAheadDepth;
+  // scene cuts are coded as single IDR frames: not supported with IntraDelay and IDR GOPs
+  la->threshold    = (p_Inp->intra_delay || p_Inp->EnableIDRGOP) ? 0 : p_Inp->SceneCutThreshold;
+  la->min_distance = imax(1, p_Inp->MinIDRDistance);
+  la->num_frames   = la_frames_in_file(p_Inp, &la->input_file, p_Inp->no_frames);
+  if ((la->stats = (LAFrameStats *) calloc(imax(1, la->num_frames), sizeof(LAFrameStats))) == NULL)
+    no_mem_exit("la_create: la->stats");
+
+  la->horizon = la->depth;
+  mutex_init(&la->mutex);
+  cond_init(&la->cond);
+  la->threaded = (thread_create(&la->thread, la_thread, la) == 0);
+
+  return la;
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Stop the look-ahead thread and free the look-ahead
+ *************************************************************************************
+ */
+void la_destroy(LookAhead *la)
+{
+  if (la == NULL)
+    return;
+
+  if (la->threaded)
+  {
+    mutex_lock(&la->mutex);
+    la->stop = 1;
+    cond_broadcast(&la->cond);
+    mutex_unlock(&la->mutex);
+    thread_join(la->thread);
+  }
+  mutex_destroy(&la->mutex);
+  cond_destroy(&la->cond);
+
+  CloseFiles(&la->input_file);
+  DeleteFrameMemory(la->p_Vid);
+  free(la->p_Vid);
+
+  free_mem2Dpel(la->frm_data[0]);
+  if (la->frm_data[1])
+  {
+    free_mem2Dpel(la->frm_data[1]);
+    free_mem2Dpel(la->frm_data[2]);
+  }
+  free_mem2Dpel(la->lowres[0]);
+  free_mem2Dpel(la->lowres[1]);
+  free(la->mv);
+  if (la->mb_tree)
+  {
+    int k;
+
+    for (k = 0; k < la->num_frames; ++k)
+    {
+      free(la->stats[k].blk_intra);
+      free(la->stats[k].blk_inter);
+      free(la->stats[k].blk_mv);
+    }
+    free(la->propagate[0]);
+    free(la->propagate[1]);
+  }
+  free(la->stats);
+  free(la);
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Check whether a frame (display order) starts a new scene
+ *************************************************************************************
+ */
+int la_is_scene_cut(LookAhead *la, int frame)
+{
+  LAFrameStats *stats;
+
+  if (la == NULL || !la->threshold || frame <= 0)
+    return 0;
+
+  stats = la_get_stats(la, frame);
+  return stats ? stats->scene_cut : 0;
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Longest prediction structure starting at frame (display order): the
+ *    anchor frame of the structure is predicted across all frames in between,
+ *    so the structure is cut once the accumulated motion cost exceeds the
+ *    intra cost of the anchor frame
+ *************************************************************************************
+ */
+int la_max_prd_length(LookAhead *la, int frame, int max_length)
+{
+  LAFrameStats *stats;
+  int64 sum = 0;
+  int length = 1;
+  int k;
+
+  for (k = 0; k < max_length; ++k)
+  {
+    if ((stats = la_get_stats(la, frame + k)) == NULL || (k && stats->scene_cut))
+      break;
+    sum += stats->inter_cost;
+    if (k && sum > stats->intra_cost)
+      break;
+    length = k + 1;
+  }
+
+  return length;
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Relative complexity of a frame with respect to the look-ahead window,
+ *    used to scale the rate control target bits
+ *************************************************************************************
+ */
+float la_rate_factor(LookAhead *la, int frame, int is_intra)
+{
+  LAFrameStats *stats = la_get_stats(la, frame);
+  LAFrameStats *window;
+  int64 cost, sum = 0;
+  int k, num = 0;
+  double ratio;
+
+  if (stats == NULL)
+    return 1.0F;
+
+  cost = is_intra ? stats->intra_cost : stats->inter_cost;
+  for (k = 0; k < imax(1, la->depth); ++k)
+  {
+    if ((window = la_get_stats(la, frame + k)) == NULL)
+      break;
+    sum += is_intra ? window->intra_cost : window->inter_cost;
+    ++num;
+  }
+  if (sum <= 0 || cost <= 0)
+    return 1.0F;
+
+  ratio = sqrt((double) cost * num / (double) sum);
+  return (float) dClip3(0.5, 2.0, ratio);
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Number of scene cuts detected so far
+ *************************************************************************************
+ */
+int la_num_scene_cuts(LookAhead *la)
+{
+  int num_cuts;
+
+  mutex_lock(&la->mutex);
+  num_cuts = la->num_cuts;
+  mutex_unlock(&la->mutex);
+
+  return num_cuts;
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Add the cost propagated from a block of a frame to the blocks of the
+ *    previous frame covered by its motion compensated position
+ *************************************************************************************
+ */
+static void la_propagate_block(LookAhead *la, double *propagate, int bx, int by, MotionVector *mv, double amount)
+{
+  int x = bx * LA_BLOCK_SIZE + mv->mv_x;
+  int y = by * LA_BLOCK_SIZE + mv->mv_y;
+  int ix = x / LA_BLOCK_SIZE, fx = x % LA_BLOCK_SIZE;
+  int iy = y / LA_BLOCK_SIZE, fy = y % LA_BLOCK_SIZE;
+  int i, j;
+
+  for (j = 0; j < 2; ++j)
+  {
+    int weight_y = j ? fy : LA_BLOCK_SIZE - fy;
+
+    if (weight_y == 0 || iy + j >= la->blk_height)
+      continue;
+    for (i = 0; i < 2; ++i)
+    {
+      int weight_x = i ? fx : LA_BLOCK_SIZE - fx;
+
+      if (weight_x && ix + i < la->blk_width)
+        propagate[(iy + j) * la->blk_width + ix + i] += amount * weight_x * weight_y / (LA_BLOCK_SIZE * LA_BLOCK_SIZE);
+    }
+  }
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Macroblock QP offsets of a frame from the macroblock tree: the cost of
+ *    each block that is predicted from the previous frame is carried back
+ *    along the motion through the look-ahead window (stopping at a scene
+ *    cut), and blocks that much of the following frames depend on get a
+ *    lower QP than blocks that are soon replaced. The offsets are relative
+ *    to the frame mean, so that the frame QP is kept on average.
+ * \return
+ *    0 (and all offsets 0) if no look-ahead data is available for the frame
+ *************************************************************************************
+ */
+int la_mb_tree_offsets(LookAhead *la, int frame, double strength, int *qp_offset, int width_in_mbs, int height_in_mbs)
+{
+  LAFrameStats *stats = la_get_stats(la, frame);
+  LAFrameStats *next;
+  double *prop_next, *prop_cur, *tmp;
+  double sum = 0.0, mean;
+  int num_blocks, last = frame;
+  int b, k, mb_x, mb_y;
+
+  memset(qp_offset, 0, width_in_mbs * height_in_mbs * sizeof(int));
+  if (stats == NULL || !la->mb_tree || stats->blk_intra == NULL)
+    return 0;
+
+  num_blocks = la->blk_width * la->blk_height;
+  prop_next  = la->propagate[0];
+  prop_cur   = la->propagate[1];
+
+  for (k = 1; k <= la->depth; ++k)
+  {
+    if ((next = la_get_stats(la, frame + k)) == NULL || next->scene_cut)
+      break;
+    last = frame + k;
+  }
+
+  memset(prop_next, 0, num_blocks * sizeof(double));
+  for (k = last; k > frame; --k)
+  {
+    next = &la->stats[k];
+    memset(prop_cur, 0, num_blocks * sizeof(double));
+    for (b = 0; b < num_blocks; ++b)
+    {
+      int intra = next->blk_intra[b];
+
+      if (intra > 0)
+      {
+        double amount = (intra + prop_next[b]) * (intra - next->blk_inter[b]) / intra;
+
+        if (amount > 0.0)
+          la_propagate_block(la, prop_cur, b % la->blk_width, b / la->blk_width, &next->blk_mv[b], amount);
+      }
+    }
+    tmp = prop_next;
+    prop_next = prop_cur;
+    prop_cur = tmp;
+  }
+
+  // prop_next now holds the cost propagated into frame
+  for (b = 0; b < num_blocks; ++b)
+  {
+    int intra = imax(1, stats->blk_intra[b]);
+
+    prop_cur[b] = -strength * log((intra + prop_next[b]) / intra) / log(2.0);
+    sum += prop_cur[b];
+  }
+  mean = sum / num_blocks;
+
+  for (mb_y = 0; mb_y < height_in_mbs; ++mb_y)
+  {
+    for (mb_x = 0; mb_x < width_in_mbs; ++mb_x)
+    {
+      b = imin(mb_y, la->blk_height - 1) * la->blk_width + imin(mb_x, la->blk_width - 1);
+      qp_offset[mb_y * width_in_mbs + mb_x] = iClip3(-LA_MB_TREE_MAX_OFFSET, LA_MB_TREE_MAX_OFFSET, (int) floor(prop_cur[b] - mean + 0.5));
+    }
+  }
+
+  return 1;
+}
@@ -0,0 +1,84 @@
+
+/*!
+ ***************************************************************************
+ * \file
+ *    lookahead.h
+ *
+ * \brief
+ *    Headerfile for the look-ahead analysis stage.
+ *
+ *    A separate thread reads the source frames ahead of the encoder and
+ *    estimates intra and inter costs on a half resolution luma picture.
+ *    The costs drive scene cut (IDR) insertion and the choice of the
+ *    prediction structure length while building the frame structure, and
+ *    are handed to rate control as a relative frame complexity. With
+ *    MBTree the block costs and motion are kept to derive macroblock QP
+ *    offsets from the propagation of each block into the following frames.
+ **************************************************************************
+ */
+
+#ifndef _LOOKAHEAD_H_
+#define _LOOKAHEAD_H_
+
+#include "thread_common.h"
+
+//! look-ahead costs of one source frame (display order)
+typedef struct la_frame_stats
+{
+  int64 intra_cost;     //!< sum of the intra block costs
+  int64 inter_cost;     //!< sum of the per block minimum of the inter and intra costs
+  int   scene_cut;      //!< frame starts a new scene
+  // per block data (MBTree only)
+  int  *blk_intra;      //!< intra cost of each block
+  int  *blk_inter;      //!< minimum of the inter and intra cost of each block
+  MotionVector *blk_mv; //!< motion of each block against the previous frame
+} LAFrameStats;
+
+typedef struct look_ahead
+{
+  VideoParameters *p_Vid;       //!< private parameters for read_one_frame (own read buffers)
+  InputParameters *p_Inp;
+  VideoDataFile    input_file;  //!< copy of the input file description with its own file handle
+
+  imgpel **frm_data[3];         //!< full resolution source frame
+  imgpel **lowres[2];           //!< half resolution luma of the current and the previous frame
+  MotionVector *mv;             //!< low resolution block motion of the current frame
+  int   width;                  //!< full resolution luma size
+  int   height;
+  int   lr_width;               //!< half resolution luma size
+  int   lr_height;
+  int   blk_width;              //!< size in 8x8 blocks of the half resolution picture
+  int   blk_height;
+  int   dc_value;               //!< intra prediction value if no neighbour is available
+
+  int   depth;                  //!< frames analysed ahead of the last requested frame
+  int   threshold;              //!< scene cut threshold in percent (0: no scene cuts)
+  int   min_distance;           //!< minimum distance between scene cuts
+  int   last_cut;               //!< last detected scene cut
+  int   num_cuts;               //!< number of detected scene cuts
+
+  int   num_frames;             //!< number of frames that can be analysed
+  LAFrameStats *stats;          //!< per frame costs
+
+  int   mb_tree;                //!< keep the per block data for the macroblock tree
+  double *propagate[2];         //!< propagated costs of two consecutive frames (encoder thread)
+
+  // shared with the look-ahead thread
+  int   analysed;               //!< frames [0, analysed) are done
+  int   horizon;                //!< analyse up to this frame (exclusive)
+  int   stop;
+  int   threaded;               //!< analysis runs in its own thread
+  ThreadHandle thread;
+  ThreadMutex  mutex;
+  ThreadCond   cond;
+} LookAhead;
+
+extern LookAhead *la_create          (VideoParameters *p_Vid, InputParameters *p_Inp);
+extern void       la_destroy         (LookAhead *la);
+extern int        la_is_scene_cut    (LookAhead *la, int frame);
+extern int        la_max_prd_length  (LookAhead *la, int frame, int max_length);
+extern float      la_rate_factor     (LookAhead *la, int frame, int is_intra);
+extern int        la_num_scene_cuts  (LookAhead *la);
+extern int        la_mb_tree_offsets (LookAhead *la, int frame, double strength, int *qp_offset, int width_in_mbs, int height_in_mbs);
+
+#endif
@@ -30,6 +30,8 @@ extern void set_loop_filter_functions_normal(VideoParameters *p_Vid);
 
 static void DeblockMb(VideoParameters *p_Vid, imgpel **imgY, imgpel ***imgUV, int MbQAddr);
 
+static const byte zero_strength[MB_BLOCK_SIZE] = { 0 };
+
 static void  init_Deblock(VideoParameters *p_Vid)
 {
   unsigned int i;
@@ -110,6 +112,158 @@ void DeblockFrame(VideoParameters *p_Vid, imgpel **imgY, imgpel ***imgUV)
 }
 #endif
 
+/*!
+ *****************************************************************************************
+ * \brief
+ *    Luma edges of one macroblock that are filtered, with their strengths.
+ *    Follows the edge decisions of DeblockMb() for a frame without MBAFF.
+ *****************************************************************************************
+ */
+static void GetMbLumaEdges(VideoParameters *p_Vid, int MbQAddr, DeblockMbEdges *edges)
+{
+  int           edge;
+  short         mb_x, mb_y;
+  int           filterNon8x8LumaEdgesFlag[4] = {1,1,1,1};
+  int           filterLeftMbEdgeFlag;
+  int           filterTopMbEdgeFlag;
+  Macroblock    *MbQ = &(p_Vid->mb_data[MbQAddr]) ; // current Mb
+  Slice  *currSlice = MbQ->p_Slice;
+  int           mvlimit = (p_Vid->structure!=FRAME) ? 2 : 4;
+  seq_parameter_set_rbsp_t *active_sps = p_Vid->active_sps;
+
+  memset(edges->filter, 0, sizeof(edges->filter));
+
+  if (MbQ->DFDisableIdc == 1) 
+    return;
+
+  MbQ->DeblockCall = 1;
+  get_mb_pos (p_Vid, MbQAddr, p_Vid->mb_size[IS_LUMA], &mb_x, &mb_y);
+
+  filterNon8x8LumaEdgesFlag[1] =
+    filterNon8x8LumaEdgesFlag[3] = !(MbQ->luma_transform_size_8x8_flag);
+
+  filterLeftMbEdgeFlag = (mb_x != 0);
+  filterTopMbEdgeFlag  = (mb_y != 0);
+
+  if (MbQ->DFDisableIdc==2)
+  {
+    // don't filter at slice boundaries
+    filterLeftMbEdgeFlag = MbQ->mbAvailA;
+    filterTopMbEdgeFlag  = MbQ->mbAvailB;
+  }
+
+  CheckAvailabilityOfNeighbors(MbQ);
+
+  // Vertical edges
+  for (edge = 0; edge < 4 ; ++edge )
+  {
+    if (MbQ->cbp == 0)
+    {
+      if (filterNon8x8LumaEdgesFlag[edge] == 0 && active_sps->chroma_format_idc!=YUV444)
+        continue;
+      else if (edge > 0 && (currSlice->slice_type == P_SLICE || currSlice->slice_type == B_SLICE))
+      {
+        if ((MbQ->mb_type == 0 && currSlice->slice_type == P_SLICE) || (MbQ->mb_type == 1) || (MbQ->mb_type == 2))
+          continue;
+        else if ((edge & 0x01) && ((MbQ->mb_type == 3) || ((edge & 0x01) && MbQ->mb_type == 0 && currSlice->slice_type == B_SLICE && active_sps->direct_8x8_inference_flag)))
+          continue;
+      }
+    }
+
+    if( (edge || filterLeftMbEdgeFlag) && filterNon8x8LumaEdgesFlag[edge] )
+    {
+      p_Vid->GetStrengthVer(edges->Strength[0][edge], MbQ, edge << 2, mvlimit);
+      edges->filter[0][edge] = (byte) (memcmp(edges->Strength[0][edge], zero_strength, MB_BLOCK_SIZE) != 0);
+    }
+  }
+
+  // Horizontal edges
+  for( edge = 0; edge < 4 ; ++edge )
+  {
+    if (MbQ->cbp == 0)
+    {
+      if (filterNon8x8LumaEdgesFlag[edge] == 0 && active_sps->chroma_format_idc==YUV420)
+        continue;
+      else if (edge > 0 && (currSlice->slice_type == P_SLICE || currSlice->slice_type == B_SLICE))
+      {
+        if (((MbQ->mb_type == PSKIP && currSlice->slice_type == P_SLICE) || (MbQ->mb_type == P16x16) || (MbQ->mb_type == P8x16)))
+          continue;
+        else if ((edge & 0x01) && (( MbQ->mb_type == P16x8) || (currSlice->slice_type == B_SLICE && MbQ->mb_type == BSKIP_DIRECT && active_sps->direct_8x8_inference_flag)))
+          continue;
+      }
+    }
+
+    if( (edge || filterTopMbEdgeFlag) && filterNon8x8LumaEdgesFlag[edge] )
+    {
+      p_Vid->GetStrengthHor(edges->Strength[1][edge], MbQ, edge << 2, mvlimit);
+      edges->filter[1][edge] = (byte) (memcmp(edges->Strength[1][edge], zero_strength, MB_BLOCK_SIZE) != 0);
+    }
+  }
+}
+
+/*!
+ *****************************************************************************************
+ * \brief
+ *    Prepare the luma deblocking of several pictures of the current frame (no MBAFF):
+ *    the edges and strengths of all macroblocks are derived once, and the macroblocks
+ *    are left set up for DeblockLumaEdges(), which then only reads the macroblock data
+ *    and can filter different pictures concurrently. ResetDeblockEdges() ends it.
+ *****************************************************************************************
+ */
+void GetDeblockEdges(VideoParameters *p_Vid, DeblockMbEdges *edges)
+{
+  unsigned int i;
+
+  init_Deblock(p_Vid);
+  p_Vid->mixedModeEdgeFlag = 0;
+
+  for (i = 0; i < p_Vid->PicSizeInMbs; i++)
+    GetMbLumaEdges(p_Vid, i, &edges[i]);
+}
+
+/*!
+ *****************************************************************************************
+ * \brief
+ *    Filter the luma edges found by GetDeblockEdges() in one picture.
+ *****************************************************************************************
+ */
+void DeblockLumaEdges(VideoParameters *p_Vid, imgpel **imgY, const DeblockMbEdges *edges)
+{
+  unsigned int i;
+  int edge;
+
+  for (i = 0; i < p_Vid->PicSizeInMbs; i++)
+  {
+    Macroblock *MbQ = &p_Vid->mb_data[i];
+    const DeblockMbEdges *e = &edges[i];
+
+    for (edge = 0; edge < 4; ++edge)
+    {
+      if (e->filter[0][edge])
+        p_Vid->EdgeLoopLumaVer(PLANE_Y, imgY, (byte *) e->Strength[0][edge], MbQ, edge << 2);
+    }
+    for (edge = 0; edge < 4; ++edge)
+    {
+      if (e->filter[1][edge])
+        p_Vid->EdgeLoopLumaHor(PLANE_Y, imgY, (byte *) e->Strength[1][edge], MbQ, edge << 2, p_Vid->width_padded);
+    }
+  }
+}
+
+/*!
+ *****************************************************************************************
+ * \brief
+ *    Restore the macroblocks after DeblockLumaEdges().
+ *****************************************************************************************
+ */
+void ResetDeblockEdges(VideoParameters *p_Vid)
+{
+  unsigned int i;
+
+  for (i = 0; i < p_Vid->PicSizeInMbs; i++)
+    p_Vid->mb_data[i].DeblockCall = 0;
+}
+
 /*!
  *****************************************************************************************
  * \brief
@@ -256,8 +410,8 @@ static void DeblockMb(VideoParameters *p_Vid, imgpel **imgY, imgpel ***imgUV, in
           edge_cr = chroma_edge[1][edge][p_Vid->yuv_format];
           if( (imgUV != NULL) && (edge_cr >= 0))
           {
-            p_Vid->EdgeLoopChromaHor( imgUV[0], Strength, MbQ, edge_cr, p_Vid->width_cr + p_Vid->pad_size_uv_x * 2, 0);
-            p_Vid->EdgeLoopChromaHor( imgUV[1], Strength, MbQ, edge_cr, p_Vid->width_cr + p_Vid->pad_size_uv_x * 2, 1);
+            p_Vid->EdgeLoopChromaHor( imgUV[0], Strength, MbQ, edge_cr, p_Vid->cr_padded_size_x, 0);
+            p_Vid->EdgeLoopChromaHor( imgUV[1], Strength, MbQ, edge_cr, p_Vid->cr_padded_size_x, 1);
           }
         }
       }
@@ -283,8 +437,8 @@ static void DeblockMb(VideoParameters *p_Vid, imgpel **imgY, imgpel ***imgUV, in
             edge_cr = chroma_edge[1][edge][p_Vid->yuv_format];
             if( (imgUV != NULL) && (edge_cr >= 0))
             {
-              p_Vid->EdgeLoopChromaHor( imgUV[0], Strength, MbQ, MB_BLOCK_SIZE, p_Vid->width_cr+p_Vid->pad_size_uv_x*2, 0) ;
-              p_Vid->EdgeLoopChromaHor( imgUV[1], Strength, MbQ, MB_BLOCK_SIZE, p_Vid->width_cr+p_Vid->pad_size_uv_x*2, 1) ;
+              p_Vid->EdgeLoopChromaHor( imgUV[0], Strength, MbQ, MB_BLOCK_SIZE, p_Vid->cr_padded_size_x, 0) ;
+              p_Vid->EdgeLoopChromaHor( imgUV[1], Strength, MbQ, MB_BLOCK_SIZE, p_Vid->cr_padded_size_x, 1) ;
             }
           }
         }
@@ -64,4 +64,15 @@ static inline int compare_mvs(const MotionVector *mv0, const MotionVector *mv1,
   return ((iabs( mv0->mv_x - mv1->mv_x) >= 4) | (iabs( mv0->mv_y - mv1->mv_y) >= mvlimit));
 }
 
+//! luma edges of a macroblock filtered by DeblockLumaEdges()
+typedef struct deblock_mb_edges
+{
+  byte Strength[2][4][MB_BLOCK_SIZE];   //!< [vertical/horizontal][edge]
+  byte filter[2][4];                    //!< the edge is filtered
+} DeblockMbEdges;
+
+extern void GetDeblockEdges  (VideoParameters *p_Vid, DeblockMbEdges *edges);
+extern void DeblockLumaEdges (VideoParameters *p_Vid, imgpel **imgY, const DeblockMbEdges *edges);
+extern void ResetDeblockEdges(VideoParameters *p_Vid);
+
 #endif
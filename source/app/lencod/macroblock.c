@@ -37,6 +37,7 @@
 #include "image.h"
 #include "mb_access.h"
 #include "ratectl.h"              // header file for rate control
+#include "rc_stats.h"
 #include "cabac.h"
 #include "biariencode.h"
 #include "me_fullsearch.h"
@@ -47,6 +48,7 @@
 #include "mv_prediction.h"
 #include "rdopt.h"
 #include "transform.h"
+#include "profile.h"
 
 
 #if TRACE
@@ -324,6 +326,30 @@ void reset_macroblock(Macroblock *currMB)
 }
 
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Switch the CABAC engines of all partitions between rate estimation
+ *    (RD mode decision, code bytes are only counted or, with
+ *    CABACRateEstimation, estimated from the context states) and normal
+ *    coding. All symbols coded during RD mode decision are discarded by a
+ *    coding state reset before the macroblock is written.
+ ************************************************************************
+ */
+static void set_cabac_rate_only(Slice *currSlice, int rate_only)
+{
+  int i;
+
+  if (currSlice->symbol_mode == CABAC && currSlice->p_Inp->rdopt != 0)
+  {
+    for (i = 0; i < currSlice->max_part_nr; ++i)
+    {
+      currSlice->partArr[i].ee_cabac.rate_only = rate_only;
+      currSlice->partArr[i].ee_cabac.rate_est  = rate_only && currSlice->p_Inp->CABACRateEstimation;
+    }
+  }
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -346,8 +372,6 @@ void start_macroblock(Slice *currSlice, Macroblock **currMB, int mb_addr, Boolea
   int i, mb_qp;
   int use_bitstream_backing = (p_Inp->slice_mode == FIXED_RATE || p_Inp->slice_mode == CALL_BACK);
 
-  static Macroblock *last_coded_mb = NULL;    // used to find whether this is recoding an MB
-
   DataPartition *dataPart;
   Bitstream *currStream;
   int prev_mb;
@@ -423,21 +447,29 @@ void start_macroblock(Slice *currSlice, Macroblock **currMB, int mb_addr, Boolea
     (*currMB)->prev_dqp = 0;
   }
 
-  if(p_Inp->RCEnable && (last_coded_mb != *currMB))   //!< avoid decreasing the NumberofbasicUnit for the same MB twice
+  // the macroblock tree offset of the previous macroblock is not carried over
+  if (p_Vid->use_mb_qp_offset)
+    p_Vid->qp = currSlice->qp;
+
+  if(p_Inp->RCEnable && (p_Vid->last_coded_mb != *currMB))   //!< avoid decreasing the NumberofbasicUnit for the same MB twice
   {
+    profile_enter(p_Vid->p_prof, PROF_RATE_CONTROL);
     mb_qp = rc_handle_mb( *currMB, prev_mb);
+    profile_leave(p_Vid->p_prof);
   }
   else
   {
     mb_qp = p_Vid->qp;
   }
 
-  last_coded_mb = *currMB;   // save the address of the last coded MB
+  p_Vid->last_coded_mb = *currMB;   // save the address of the last coded MB
   
   if ((*currMB)->mbAddrX == 0)
     p_Vid->BasicUnitQP = mb_qp;
 
   mb_qp = iClip3(-currSlice->bitdepth_luma_qp_scale, 51, mb_qp);
+  if (p_Vid->use_mb_qp_offset)
+    mb_qp = iClip3(-currSlice->bitdepth_luma_qp_scale, 51, mb_qp + p_Vid->mb_qp_offset[(*currMB)->mbAddrX]);
   (*currMB)->qp = (short) mb_qp;
   p_Vid->qp = mb_qp;
   
@@ -493,6 +525,8 @@ void start_macroblock(Slice *currSlice, Macroblock **currMB, int mb_addr, Boolea
   if ((p_Inp->SearchMode[p_Vid->view_id] == FAST_FULL_SEARCH) && (!p_Inp->IntraProfile))
     reset_fast_full_search (p_Vid);
 
+  set_cabac_rate_only(currSlice, TRUE);
+
   // disable writing of trace file
 #if TRACE
   for (i=0; i<currSlice->max_part_nr; ++i )
@@ -519,7 +553,7 @@ void end_macroblock(Macroblock *currMB,         //!< Current Macroblock
   InputParameters *p_Inp = currMB->p_Inp;
   int i;
   SyntaxElement se;
-  const int *partMap = assignSE2partition[currSlice->partition_mode];
+  const int *partMap = currSlice->partition_map;
   DataPartition *dataPart;
   Bitstream *currStream;
   int rlc_bits=0;
@@ -1775,7 +1809,7 @@ static int writeIntra4x4Modes(Macroblock *currMB)
   int i;
   SyntaxElement se;
   BitCounter    *mbBits     = &currMB->bits;
-  const int     *partMap    = assignSE2partition[currSlice->partition_mode];
+  const int     *partMap    = currSlice->partition_map;
   DataPartition *dataPart   = &(currSlice->partArr[partMap[SE_INTRAPREDMODE]]);
 
   int rate = 0;
@@ -1821,7 +1855,7 @@ static int writeIntra8x8Modes(Macroblock *currMB)
   int block8x8;
   SyntaxElement se;
   BitCounter    *mbBits     = &currMB->bits;
-  const int     *partMap    = assignSE2partition[currSlice->partition_mode];
+  const int     *partMap    = currSlice->partition_map;
   DataPartition *dataPart   = &(currSlice->partArr[partMap[SE_INTRAPREDMODE]]);
 
   int rate = 0;
@@ -2023,7 +2057,7 @@ int write_b_slice_MB_layer (Macroblock *currMB, int rdopt, int *coeff_rate)
   
   SyntaxElement   se;
   BitCounter      *mbBits    = &currMB->bits;  
-  const int*      partMap    = assignSE2partition[currSlice->partition_mode];
+  const int*      partMap    = currSlice->partition_map;
   // choose the appropriate data partition
   DataPartition*  dataPart   = &(currSlice->partArr[partMap[SE_MBTYPE]]);
   Bitstream      *currStream;
@@ -2308,7 +2342,7 @@ int write_p_slice_MB_layer (Macroblock *currMB, int rdopt, int *coeff_rate)
   
   SyntaxElement   se;
   BitCounter      *mbBits    = &currMB->bits;  
-  const int*      partMap    = assignSE2partition[currSlice->partition_mode];
+  const int*      partMap    = currSlice->partition_map;
   // choose the appropriate data partition
   DataPartition*  dataPart   = &(currSlice->partArr[partMap[SE_MBTYPE]]);
   Bitstream      *currStream;
@@ -2580,7 +2614,7 @@ int write_i_slice_MB_layer (Macroblock *currMB, int rdopt, int *coeff_rate)
 
   SyntaxElement   se;
   BitCounter      *mbBits    = &currMB->bits;  
-  const int*      partMap    = assignSE2partition[currSlice->partition_mode];
+  const int*      partMap    = currSlice->partition_map;
   // choose the appropriate data partition
   DataPartition*  dataPart   = &(currSlice->partArr[partMap[SE_MBTYPE]]);
 
@@ -2695,7 +2729,7 @@ int write_i_slice_MB_layer (Macroblock *currMB, int rdopt, int *coeff_rate)
 
 void write_terminating_bit (Slice *currSlice, int bit)
 {
-  const int*     partMap  = assignSE2partition[currSlice->partition_mode];
+  const int*     partMap  = currSlice->partition_map;
   //--- write non-slice termination symbol if the macroblock is not the first one in its slice ---
   DataPartition* dataPart = &(currSlice->partArr[partMap[SE_MBTYPE]]);
   dataPart->bitstream->write_flag = 1;
@@ -2717,7 +2751,7 @@ int write_chroma_intra_pred_mode(Macroblock* currMB)
 {
   Slice* currSlice = currMB->p_Slice;
   SyntaxElement   se;
-  const int*      partMap   = assignSE2partition[currSlice->partition_mode];
+  const int*      partMap   = currSlice->partition_map;
   DataPartition*  dataPart = &(currSlice->partArr[partMap[SE_INTRAPREDMODE]]);
   int             rate      = 0;
   
@@ -2815,6 +2849,8 @@ void write_macroblock (Macroblock* currMB, int eos_bit)
   BitCounter *mbBits = &currMB->bits;
   int i;
 
+  set_cabac_rate_only(currSlice, FALSE);
+
   // enable writing of trace file
 #if TRACE
   if ( currMB->prev_recode_mb == FALSE )
@@ -2869,7 +2905,9 @@ void write_macroblock (Macroblock* currMB, int eos_bit)
 
   currMB->write_mb = TRUE;
   //--- write macroblock ---
+  profile_enter(p_Vid->p_prof, PROF_ENTROPY);
   currSlice->write_MB_layer (currMB, 0, &i); // i is temporary
+  profile_leave(p_Vid->p_prof);
 
   if (!((currMB->mb_type !=0 ) || ((currSlice->slice_type==B_SLICE) && currMB->cbp != 0) ))
   {
@@ -2887,7 +2925,13 @@ void write_macroblock (Macroblock* currMB, int eos_bit)
     + mbBits->mb_cr_coeff;
 
   if ( p_Inp->RCEnable )
+  {
+    profile_enter(p_Vid->p_prof, PROF_RATE_CONTROL);
     rc_update_mb_stats(currMB);  
+    profile_leave(p_Vid->p_prof);
+  }
+  if ( p_Inp->RCPass == 1 )
+    rc_stats_store_bits(currMB);
 
   /*record the total number of MBs*/
   ++(p_Vid->NumberofCodedMacroBlocks);
@@ -2908,7 +2952,7 @@ int writeReferenceFrame (Macroblock* currMB, int i, int j, int list_idx, int  re
 {
   BitCounter      *mbBits   = &currMB->bits;
   Slice *currSlice = currMB->p_Slice;
-  const int*      partMap   = assignSE2partition[currSlice->partition_mode];
+  const int*      partMap   = currSlice->partition_map;
   DataPartition*  dataPart  = &(currSlice->partArr[partMap[SE_REFFRAME]]);
   int             list      = list_idx + currMB->list_offset;
   SyntaxElement   se;   
@@ -2965,7 +3009,7 @@ int writeMotionVector8x8 (Macroblock *currMB,
   SyntaxElement  se;
   BitCounter      *mbBits   = &currMB->bits;
   
-  const int*     partMap    = assignSE2partition[currSlice->partition_mode];    
+  const int*     partMap    = currSlice->partition_map;    
   DataPartition* dataPart = &(currSlice->partArr[partMap[SE_MVD]]);        
   int            refindex   = refframe;
 
@@ -3187,7 +3231,7 @@ static int write_chroma_coeff (Macroblock* currMB)
   int             rate       = 0;
   int             block_rate = 0;
   SyntaxElement   se;
-  const int*      partMap   = assignSE2partition[currSlice->partition_mode];
+  const int*      partMap   = currSlice->partition_map;
   int             cbp       = currMB->cbp;
   DataPartition*  dataPart;
 
@@ -3361,7 +3405,7 @@ int writeCoeff4x4_CABAC (Macroblock* currMB, ColorPlane plane, int b8, int b4, i
 
   int             rate = 0;
   SyntaxElement   se;
-  const int*      partMap   = assignSE2partition[currSlice->partition_mode];
+  const int*      partMap   = currSlice->partition_map;
   DataPartition*  dataPart;
 
   int level;
@@ -3427,7 +3471,7 @@ int writeCoeff8x8_CABAC (Macroblock* currMB, ColorPlane plane, int b8, int intra
 
   int             rate      = 0;
   SyntaxElement   se;   
-  const int*      partMap   = assignSE2partition[currSlice->partition_mode];
+  const int*      partMap   = currSlice->partition_map;
   DataPartition*  dataPart;
 
   int   level;
@@ -3535,7 +3579,7 @@ int write_CBP_and_Dquant (Macroblock* currMB)
   int             rate      = 0;
   BitCounter      *mbBits = &currMB->bits;
   SyntaxElement   se;
-  const int*      partMap   = assignSE2partition[currSlice->partition_mode];
+  const int*      partMap   = currSlice->partition_map;
   int             cbp       = currMB->cbp;
   DataPartition*  dataPart;  
   
@@ -3720,7 +3764,7 @@ int writeCoeff16x16_CABAC (Macroblock* currMB, ColorPlane plane)
   int             rate      = 0;
   int             block_rate = 0;  
   SyntaxElement   se;
-  const int*      partMap   = assignSE2partition[currSlice->partition_mode];
+  const int*      partMap   = currSlice->partition_map;
   int   pl_off = plane<<2; 
   DataPartition*  dataPart;
 
@@ -4038,7 +4082,7 @@ int writeCoeff4x4_CAVLC_normal (Macroblock* currMB, int block_type, int b8, int
   int           no_bits    = 0;
   SyntaxElement se;
   DataPartition *dataPart;
-  const int           *partMap   = assignSE2partition[currSlice->partition_mode];
+  const int           *partMap   = currSlice->partition_map;
 
   int k,level = 1,run = 0, vlcnum;
   int numcoeff = 0, lastcoeff = 0, numtrailingones = 0; 
@@ -4372,7 +4416,7 @@ int writeCoeff4x4_CAVLC_444 (Macroblock* currMB, int block_type, int b8, int b4,
   int      no_bits    = 0;
   SyntaxElement se;
   DataPartition *dataPart;
-  const int *partMap   = assignSE2partition[currSlice->partition_mode];
+  const int *partMap   = currSlice->partition_map;
 
   int k,level = 1,run = 0, vlcnum;
   int numcoeff = 0, lastcoeff = 0, numtrailingones = 0; 
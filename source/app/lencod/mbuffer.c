@@ -27,6 +27,9 @@
 #include "img_chroma.h"
 #include "errdo.h"
 #include "me_hme.h"
+#include "wp_moments.h"
+#include "mem_usage.h"
+#include "profile.h"
 
 extern void SbSMuxBasic(ImageData *imgOut, ImageData *imgIn0, ImageData *imgIn1, int offset);
 extern void init_stats                   (InputParameters *p_Inp, StatParameters *stats);
@@ -382,6 +385,69 @@ void alloc_pic_motion(PicMotionParamsOld *motion, int size_y, int size_x)
     no_mem_exit("alloc_storable_picture: motion->mb_field");
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate the sample planes of a picture, with the sub-pel planes
+ *    of the on-the-fly interpolation mode in use if sub_pel is set
+ *
+ * \return
+ *    number of allocated bytes
+ ************************************************************************
+ */
+static int alloc_pic_planes(VideoParameters *p_Vid, StorablePicture *s, int sub_pel, int size_x, int size_y, int size_x_cr, int size_y_cr)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+  int mem_size = 0;
+
+  if (sub_pel && p_Inp->OnTheFlyFractMCP != OTF_L2)
+  {
+    // OTF_L1 (JLT) stores the full and half pel positions only
+    int otf_shift = (p_Inp->OnTheFlyFractMCP == OTF_L1) ? 1 : 0;
+
+    mem_size += get_mem4Dpel_pad(&(s->imgY_sub), 4 >> otf_shift, 4 >> otf_shift, size_y, size_x, IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X);
+    s->imgY = s->imgY_sub[0][0];
+
+    if ( p_Inp->ChromaMCBuffer || p_Vid->P444_joined || (p_Inp->yuv_format==YUV444 && !p_Vid->P444_joined))
+    {
+      // UV components
+      if ( p_Vid->yuv_format != YUV400 )
+      {
+        int sub_y = (p_Vid->yuv_format == YUV420) ? 8 : 4;
+        int sub_x = (p_Vid->yuv_format == YUV444) ? 4 : 8;
+
+        mem_size += get_mem5Dpel_pad(&(s->imgUV_sub), 2, sub_y >> otf_shift, sub_x >> otf_shift, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
+        s->p_img_sub[1] = s->imgUV_sub[0];
+        s->p_img_sub[2] = s->imgUV_sub[1];
+        s->imgUV = (imgpel ***)malloc(2*sizeof(imgpel**));
+        s->imgUV[0] = s->imgUV_sub[0][0][0];
+        s->imgUV[1] = s->imgUV_sub[1][0][0];
+      }
+    }
+    else
+    {
+      mem_size += get_mem3Dpel_pad(&(s->imgUV), 2, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
+    }
+  }
+  else
+  {
+    mem_size += get_mem2Dpel_pad(&(s->imgY), size_y, size_x, IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X);
+    mem_size += get_mem3Dpel_pad(&(s->imgUV), 2, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
+  }
+
+  s->p_img[0] = s->imgY;
+  s->p_curr_img = s->p_img[0];
+  s->p_curr_img_sub = s->p_img_sub[0];
+
+  if (p_Vid->yuv_format != YUV400)
+  {
+    s->p_img[1] = s->imgUV[0];
+    s->p_img[2] = s->imgUV[1];
+  }
+
+  return mem_size;
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -408,6 +474,7 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
 {
   StorablePicture *s;
   int   nplane;
+  int   sub_pel = 0;
   InputParameters *p_Inp = p_Vid->p_Inp;
 
   //printf ("Allocating (%s) picture (x=%d, y=%d, x_cr=%d, y_cr=%d)\n", (type == FRAME)?"FRAME":(type == TOP_FIELD)?"TOP_FIELD":"BOTTOM_FIELD", size_x, size_y, size_x_cr, size_y_cr);
@@ -432,106 +499,19 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
 #else
   if (p_Vid->nal_reference_idc != NALU_PRIORITY_DISPOSABLE)
 #endif
-  {
-    if (!p_Inp->OnTheFlyFractMCP) // JLT : on-the-fly flag
-    {
-      get_mem4Dpel_pad(&(s->imgY_sub), 4, 4, size_y, size_x, IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X);
-      s->imgY = s->imgY_sub[0][0];
-
-      if ( p_Inp->ChromaMCBuffer || p_Vid->P444_joined || (p_Inp->yuv_format==YUV444 && !p_Vid->P444_joined))
-      {
-        // UV components
-        if ( p_Vid->yuv_format != YUV400 )
-        {
-          if ( p_Vid->yuv_format == YUV420 )
-          {
-            get_mem5Dpel_pad(&(s->imgUV_sub), 2, 8, 8, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
-          }
-          else if ( p_Vid->yuv_format == YUV422 )
-          {
-            get_mem5Dpel_pad(&(s->imgUV_sub), 2, 4, 8, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
-          }
-          else
-          { // YUV444
-            get_mem5Dpel_pad(&(s->imgUV_sub), 2, 4, 4, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
-          }
-          s->p_img_sub[1] = s->imgUV_sub[0];
-          s->p_img_sub[2] = s->imgUV_sub[1];
-          s->imgUV = (imgpel ***)malloc(2*sizeof(imgpel**));
-          s->imgUV[0] = s->imgUV_sub[0][0][0];
-          s->imgUV[1] = s->imgUV_sub[1][0][0];
-        }
-      }
-      else
-      {
-        get_mem3Dpel_pad(&(s->imgUV), 2, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
-      }
-    }
-    else if ( p_Inp->OnTheFlyFractMCP == OTF_L1 ) // OTF L1
-    {
-      get_mem4Dpel_pad(&(s->imgY_sub), 2, 2, size_y, size_x, IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X);
-      s->imgY = s->imgY_sub[0][0];
+    sub_pel = !p_Inp->LowMemory;
 
-      if ( p_Inp->ChromaMCBuffer || p_Vid->P444_joined || (p_Inp->yuv_format==YUV444 && !p_Vid->P444_joined))
-      {
-        // UV components
-        if ( p_Vid->yuv_format != YUV400 )
-        {
-          if ( p_Vid->yuv_format == YUV420 )
-          {
-            get_mem5Dpel_pad(&(s->imgUV_sub), 2, 4, 4, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
-          }
-          else if ( p_Vid->yuv_format == YUV422 )
-          {
-            get_mem5Dpel_pad(&(s->imgUV_sub), 2, 2, 4, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
-          }
-          else
-          { // YUV444
-            get_mem5Dpel_pad(&(s->imgUV_sub), 2, 2, 2, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
-          }
-          s->p_img_sub[1] = s->imgUV_sub[0];
-          s->p_img_sub[2] = s->imgUV_sub[1];
-          s->imgUV = (imgpel ***)malloc(2*sizeof(imgpel**));
-          s->imgUV[0] = s->imgUV_sub[0][0][0];
-          s->imgUV[1] = s->imgUV_sub[1][0][0];
-        }
-      }
-      else
-      {
-        get_mem3Dpel_pad(&(s->imgUV), 2, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
-      }
-    }
-    else // OTF_L2
-    {
-      get_mem2Dpel_pad(&(s->imgY), size_y, size_x, IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X);
-      get_mem3Dpel_pad(&(s->imgUV), 2, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
-    }
-  }
-  else
-  {
-    get_mem2Dpel_pad(&(s->imgY), size_y, size_x, IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X);
-    get_mem3Dpel_pad(&(s->imgUV), 2, size_y_cr, size_x_cr, p_Vid->pad_size_uv_y, p_Vid->pad_size_uv_x);
-  }  
-    
-  s->p_img[0] = s->imgY;
-  s->p_curr_img = s->p_img[0];    
-  s->p_curr_img_sub = s->p_img_sub[0];
+  s->mem_planes = alloc_pic_planes(p_Vid, s, sub_pel, size_x, size_y, size_x_cr, size_y_cr);
+  s->mem_size   = s->mem_planes;
 
-  if (p_Vid->yuv_format != YUV400)
-  {
-    //get_mem3Dpel (&(s->imgUV), 2, size_y_cr, size_x_cr);
-    s->p_img[1] = s->imgUV[0];
-    s->p_img[2] = s->imgUV[1];
-  }
-
-  get_mem2Dmp (&s->mv_info, (size_y >> BLOCK_SHIFT), (size_x >> BLOCK_SHIFT));
+  s->mem_size += get_mem2Dmp (&s->mv_info, (size_y >> BLOCK_SHIFT), (size_x >> BLOCK_SHIFT));
   alloc_pic_motion(&s->motion, (size_y >> BLOCK_SHIFT), (size_x >> BLOCK_SHIFT));
 
   if( (p_Inp->separate_colour_plane_flag != 0) )
   {
     for( nplane=0; nplane<MAX_PLANE; nplane++ )
     {
-      get_mem2Dmp (&s->JVmv_info[nplane], (size_y >> BLOCK_SHIFT), (size_x >> BLOCK_SHIFT));
+      s->mem_size += get_mem2Dmp (&s->JVmv_info[nplane], (size_y >> BLOCK_SHIFT), (size_x >> BLOCK_SHIFT));
       alloc_pic_motion(&s->JVmotion[nplane], (size_y >> BLOCK_SHIFT), (size_x >> BLOCK_SHIFT));
     }
   }
@@ -580,9 +560,58 @@ StorablePicture* alloc_storable_picture(VideoParameters *p_Vid, PictureStructure
   memset(s->ref_pic_na, 0xff, sizeof(int)*6);
 
   init_stats(p_Inp, &s->stats);
+  mem_usage_add(p_Vid->p_mem, MEM_PICTURES, s->mem_size);
   return s;
 }
 
+static void copy_plane(imgpel **dst, imgpel **src, int size_x, int size_y)
+{
+  int j;
+
+  for (j = 0; j < size_y; ++j)
+    memcpy(dst[j], src[j], size_x * sizeof(imgpel));
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocate the sub-pel planes of a picture allocated without them
+ *    (LowMemory) before it is interpolated. The sample planes are
+ *    reallocated in the sub-pel layout and the reconstruction is copied.
+ ************************************************************************
+ */
+void alloc_sub_pel_planes(VideoParameters *p_Vid, StorablePicture *s)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+  imgpel **imgY   = s->imgY;
+  imgpel ***imgUV = s->imgUV;
+  int mem_planes;
+
+  if (s->imgY_sub != NULL || p_Inp->OnTheFlyFractMCP == OTF_L2)
+    return;
+
+  s->imgY  = NULL;
+  s->imgUV = NULL;
+  mem_planes = alloc_pic_planes(p_Vid, s, 1, s->size_x, s->size_y, s->size_x_cr, s->size_y_cr);
+  s->otf_flag = p_Inp->OnTheFlyFractMCP;
+
+  copy_plane(s->imgY, imgY, s->size_x, s->size_y);
+  free_mem2Dpel_pad(imgY, IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X);
+  if (imgUV != NULL)
+  {
+    if (s->imgUV != NULL)
+    {
+      copy_plane(s->imgUV[0], imgUV[0], s->size_x_cr, s->size_y_cr);
+      copy_plane(s->imgUV[1], imgUV[1], s->size_x_cr, s->size_y_cr);
+    }
+    free_mem3Dpel_pad(imgUV, 2, s->pad_size_uv_y, s->pad_size_uv_x);
+  }
+
+  mem_usage_add(p_Vid->p_mem, MEM_PICTURES, mem_planes - s->mem_planes);
+  s->mem_size  += mem_planes - s->mem_planes;
+  s->mem_planes = mem_planes;
+}
+
 
 /*!
  ************************************************************************
@@ -778,6 +807,9 @@ void free_storable_picture(VideoParameters *p_Vid, StorablePicture* p)
     {
       FreeHMEMemory(&(p->pHmeImage), p_Vid, 1, IMG_PAD_SIZE_Y, IMG_PAD_SIZE_X);
     }
+
+    wp_moments_free(p->wp_moments);
+    mem_usage_add(p_Vid->p_mem, MEM_PICTURES, -p->mem_size);
     
     free(p);
     p = NULL;
@@ -873,49 +905,65 @@ void unmark_for_long_term_reference(FrameStore* fs)
 
 
 
-void update_pic_num(Slice *currSlice)
+/*!
+ ************************************************************************
+ * \brief
+ *    Update the frame numbers and frame picture numbers of the reference
+ *    frames for coding frame_num.
+ *    Only changed numbers are stored, see image_mp_threads.c.
+ ************************************************************************
+ */
+void update_frame_pic_num(DecodedPictureBuffer *p_Dpb, int frame_num, int max_frame_num)
 {
   unsigned int i;
-  //VideoParameters *p_Vid = currSlice->p_Vid;
-  DecodedPictureBuffer *p_Dpb = currSlice->p_Dpb;
-
-  int add_top = 0, add_bottom = 0;
-
-  int max_frame_num = currSlice->max_frame_num;
 
-
-  if (currSlice->structure == FRAME)
+  for (i=0; i<p_Dpb->ref_frames_in_buffer; i++)
   {
-    for (i=0; i<p_Dpb->ref_frames_in_buffer; i++)
+    if ( p_Dpb->fs_ref[i]->is_used==3 )
     {
-      if ( p_Dpb->fs_ref[i]->is_used==3 )
+      if ((p_Dpb->fs_ref[i]->frame->used_for_reference)&&(!p_Dpb->fs_ref[i]->frame->is_long_term))
       {
-        if ((p_Dpb->fs_ref[i]->frame->used_for_reference)&&(!p_Dpb->fs_ref[i]->frame->is_long_term))
+        int frame_num_wrap = p_Dpb->fs_ref[i]->frame_num;
+
+        if( p_Dpb->fs_ref[i]->frame_num > frame_num )
         {
-          if( p_Dpb->fs_ref[i]->frame_num > currSlice->frame_num )
-          {
-            p_Dpb->fs_ref[i]->frame_num_wrap = p_Dpb->fs_ref[i]->frame_num - max_frame_num;
-          }
-          else
-          {
-            p_Dpb->fs_ref[i]->frame_num_wrap = p_Dpb->fs_ref[i]->frame_num;
-          }
-          p_Dpb->fs_ref[i]->frame->pic_num = p_Dpb->fs_ref[i]->frame_num_wrap;
+          frame_num_wrap -= max_frame_num;
         }
+        if (p_Dpb->fs_ref[i]->frame_num_wrap != frame_num_wrap)
+          p_Dpb->fs_ref[i]->frame_num_wrap = frame_num_wrap;
+        if (p_Dpb->fs_ref[i]->frame->pic_num != frame_num_wrap)
+          p_Dpb->fs_ref[i]->frame->pic_num = frame_num_wrap;
       }
     }
-    // update long_term_pic_num
-    for (i = 0; i < p_Dpb->ltref_frames_in_buffer; i++)
+  }
+  // update long_term_pic_num
+  for (i = 0; i < p_Dpb->ltref_frames_in_buffer; i++)
+  {
+    if (p_Dpb->fs_ltref[i]->is_used==3)
     {
-      if (p_Dpb->fs_ltref[i]->is_used==3)
+      if (p_Dpb->fs_ltref[i]->frame->is_long_term && p_Dpb->fs_ltref[i]->frame->long_term_pic_num != p_Dpb->fs_ltref[i]->frame->long_term_frame_idx)
       {
-        if (p_Dpb->fs_ltref[i]->frame->is_long_term)
-        {
-          p_Dpb->fs_ltref[i]->frame->long_term_pic_num = p_Dpb->fs_ltref[i]->frame->long_term_frame_idx;
-        }
+        p_Dpb->fs_ltref[i]->frame->long_term_pic_num = p_Dpb->fs_ltref[i]->frame->long_term_frame_idx;
       }
     }
   }
+}
+
+void update_pic_num(Slice *currSlice)
+{
+  unsigned int i;
+  //VideoParameters *p_Vid = currSlice->p_Vid;
+  DecodedPictureBuffer *p_Dpb = currSlice->p_Dpb;
+
+  int add_top = 0, add_bottom = 0;
+
+  int max_frame_num = currSlice->max_frame_num;
+
+
+  if (currSlice->structure == FRAME)
+  {
+    update_frame_pic_num(p_Dpb, currSlice->frame_num, max_frame_num);
+  }
   else
   {
     if (currSlice->structure == TOP_FIELD)
@@ -933,14 +981,14 @@ void update_pic_num(Slice *currSlice)
     {
       if (p_Dpb->fs_ref[i]->is_reference)
       {
+        int frame_num_wrap = p_Dpb->fs_ref[i]->frame_num;
+
         if( p_Dpb->fs_ref[i]->frame_num > currSlice->frame_num )
         {
-          p_Dpb->fs_ref[i]->frame_num_wrap = p_Dpb->fs_ref[i]->frame_num - max_frame_num;
-        }
-        else
-        {
-          p_Dpb->fs_ref[i]->frame_num_wrap = p_Dpb->fs_ref[i]->frame_num;
+          frame_num_wrap -= max_frame_num;
         }
+        if (p_Dpb->fs_ref[i]->frame_num_wrap != frame_num_wrap)
+          p_Dpb->fs_ref[i]->frame_num_wrap = frame_num_wrap;
         if (p_Dpb->fs_ref[i]->is_reference & 1)
         {
           p_Dpb->fs_ref[i]->top_field->pic_num = (2 * p_Dpb->fs_ref[i]->frame_num_wrap) + add_top;
@@ -2043,7 +2091,9 @@ void store_picture_in_dpb(DecodedPictureBuffer *p_Dpb, StorablePicture* p, Frame
       {
         if (((-1==pos) || (p->poc < poc)))
         {
+          profile_enter(p_Vid->p_prof, PROF_OUTPUT);
           direct_output(p_Vid, p, output, (p_Dpb->layer_id ? p_Vid->p_dec2: p_Vid->p_dec));
+          profile_leave(p_Vid->p_prof);
           return;
         }
       }
@@ -2052,7 +2102,9 @@ void store_picture_in_dpb(DecodedPictureBuffer *p_Dpb, StorablePicture* p, Frame
       {
         if ((-1==pos) || (p->poc < poc))
         {
+          profile_enter(p_Vid->p_prof, PROF_OUTPUT);
           direct_output(p_Vid, p, output, p_Vid->p_dec);
+          profile_leave(p_Vid->p_prof);
           return;
         }
       }
@@ -2448,6 +2500,8 @@ static void insert_picture_in_dpb(VideoParameters *p_Vid, FrameStore* fs, Storab
   fs->is_output = p->is_output;
   fs->is_inter_layer = FALSE;
 
+  wp_moments_store(p_Vid, fs);
+
 #if (MVC_EXTENSION_ENABLE)
   fs->view_id = p->view_id;
 #endif
@@ -2560,6 +2614,7 @@ static void output_one_frame_from_dpb(DecodedPictureBuffer *p_Dpb, FrameFormat *
 
   // call the output function
   //  printf ("output frame with frame_num #%d, poc %d (p_Dpb-> p_Dpb->size=%d, p_Dpb->used_size=%d)\n", p_Dpb->fs[pos]->frame_num, p_Dpb->fs[pos]->frame->poc, p_Dpb->size, p_Dpb->used_size);
+  profile_enter(p_Vid->p_prof, PROF_OUTPUT);
 #if (MVC_EXTENSION_ENABLE)
   if(p_Inp->num_of_views==2)
   {
@@ -2571,6 +2626,7 @@ static void output_one_frame_from_dpb(DecodedPictureBuffer *p_Dpb, FrameFormat *
   else
 #endif
     write_stored_frame(p_Vid, p_Dpb->fs[pos], output, p_Vid->p_dec);
+  profile_leave(p_Vid->p_prof);
 
   // if redundant picture in use, output POC may be not in ascending order
   if(p_Inp->redundant_pic_flag == 0)
@@ -2925,7 +2981,8 @@ void dpb_combine_field(VideoParameters *p_Vid, FrameStore *fs)
   int i,j, jj, jj4;
 
   dpb_combine_field_yuv(p_Vid, fs);
-  if (fs->frame->used_for_reference)
+  // with field coding only the fields are referenced, the frame is kept for output
+  if (fs->frame->used_for_reference && !(p_Vid->p_Inp->LowMemory && p_Vid->p_Inp->PicInterlace == FIELD_CODING))
   {
     if( (p_Vid->p_Inp->separate_colour_plane_flag != 0) )
     {
@@ -3173,8 +3230,8 @@ static void process_picture_in_dpb_s(VideoParameters *p_Vid, StorablePicture *p_
   imgpel***  d_img;
   int i;
 
-  img_in.frm_stride[0] = p_pic->size_x_padded;
-  img_in.frm_stride[1] = img_in.frm_stride[2] = p_pic->size_x_cr + (p_pic->pad_size_uv_x << 1);
+  img_in.frm_stride[0] = get_pel_stride(p_pic->size_x, IMG_PAD_SIZE_X);
+  img_in.frm_stride[1] = img_in.frm_stride[2] = get_pel_stride(p_pic->size_x_cr, p_pic->pad_size_uv_x);
 
   if (p_pic->structure == FRAME)
   {
@@ -135,8 +135,11 @@ typedef struct storable_picture
 #endif
 
   int  bInterpolated;
+  struct wp_moments *wp_moments;   //!< sample sums for weighted prediction (NULL if not computed)
   int  ref_pic_na[6];
   int  otf_flag;
+  int  mem_size;                   //!< bytes of the sample and motion buffers
+  int  mem_planes;                 //!< bytes of the sample planes (in mem_size)
   //int  separate_colour_plane_flag;
 } StorablePicture;
 
@@ -231,6 +234,7 @@ extern FrameStore*      alloc_frame_store(void);
 extern void             free_frame_store          (VideoParameters *p_Vid, FrameStore* f);
 extern StorablePicture* alloc_storable_picture    (VideoParameters *p_Vid, PictureStructure type, int size_x, int size_y, int size_x_cr, int size_y_cr);
 extern void             free_storable_picture     (VideoParameters *p_Vid, StorablePicture* p);
+extern void             alloc_sub_pel_planes      (VideoParameters *p_Vid, StorablePicture *s);
 extern void             store_picture_in_dpb      (DecodedPictureBuffer *p_Dpb, StorablePicture* p, FrameFormat *output);
 extern void             replace_top_pic_with_frame(DecodedPictureBuffer *p_Dpb, StorablePicture* p, FrameFormat *output);
 extern void             flush_dpb                 (DecodedPictureBuffer *p_Dpb, FrameFormat *output);
@@ -240,6 +244,7 @@ extern void             dpb_combine_field_yuv     (VideoParameters *p_Vid, Frame
 extern void             init_lists_p_slice        (Slice *currSlice);
 extern void             init_lists_b_slice        (Slice *currSlice);
 extern void             init_lists_i_slice        (Slice *currSlice);
+extern void             update_frame_pic_num      (DecodedPictureBuffer *p_Dpb, int frame_num, int max_frame_num);
 extern void             update_pic_num            (Slice *currSlice);
 extern void             reorder_ref_pic_list      (Slice *currSlice, int cur_list);
 extern void             init_mbaff_lists          (Slice *currSlice);
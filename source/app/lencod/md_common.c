@@ -17,6 +17,7 @@
 #include "image.h"
 #include "macroblock.h"
 #include "mc_prediction.h"
+#include "profile.h"
 
 /*!
  *************************************************************************************
@@ -484,11 +485,15 @@ void set_chroma_pred_mode(Macroblock *currMB, RD_PARAMS enc_mb, int *mb_availabl
   {
     Slice *currSlice = currMB->p_Slice;
     // precompute all new chroma intra prediction modes
+    profile_enter(p_Vid->p_prof, PROF_INTRA);
     currSlice->intra_chroma_prediction(currMB, &mb_available[0], &mb_available[1], &mb_available[2]);
+    profile_leave(p_Vid->p_prof);
 
     if (p_Inp->FastCrIntraDecision) 
     {          
+      profile_enter(p_Vid->p_prof, PROF_INTRA);
       currSlice->intra_chroma_RD_decision(currMB, &enc_mb);
+      profile_leave(p_Vid->p_prof);
 
       chroma_pred_mode_range[0] = currMB->c_ipred_mode;
       chroma_pred_mode_range[1] = currMB->c_ipred_mode;
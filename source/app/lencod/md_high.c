@@ -28,6 +28,7 @@
 #include "vlc.h"
 #include "rdopt.h"
 #include "mv_search.h"
+#include "md_prune.h"
 
 /*!
 *************************************************************************************
@@ -64,6 +65,7 @@ void encode_one_macroblock_high (Macroblock *currMB)
   short       inter_skip = 0;
   BestMode    md_best;
   Info8x8     best;
+  MDPrune     prune;
 
 
   init_md_best(&md_best);
@@ -78,6 +80,7 @@ void encode_one_macroblock_high (Macroblock *currMB)
 
   //===== Setup Macroblock encoding parameters =====
   init_enc_mb_params(currMB, &enc_mb, intra);
+  md_prune_init(currMB, &prune, intra);
   if (p_Inp->AdaptiveRounding)
   {
     reset_adaptive_rounding(p_Vid);
@@ -167,6 +170,11 @@ void encode_one_macroblock_high (Macroblock *currMB)
           if (mode>1 && block == 0)
             currSlice->set_ref_and_motion_vectors (currMB, motion, &best, block);
         } // for (block=0; block<(mode==1?1:2); block++)
+
+        prune.cost[mode] = cost;
+        if (mode == 1)
+          md_prune_16x16(currMB, &prune, &enc_mb);
+
         if (cost < min_cost)
         {
           md_best.mode = (byte) mode;
@@ -181,6 +189,8 @@ void encode_one_macroblock_high (Macroblock *currMB)
       } // if (enc_mb.valid[mode])
     } // for (mode=1; mode<4; mode++)
 
+    md_prune_partition(currMB, &prune, &enc_mb);
+
     if (enc_mb.valid[P8x8])
     {    
       currMB->valid_8x8 = FALSE;
@@ -253,6 +263,8 @@ void encode_one_macroblock_high (Macroblock *currMB)
     {
       mode = mb_mode_table[index];
       //printf("mode %d %7.3f", mode, (double) currMB->min_rdcost);
+      if (mode == I16MB)
+        md_prune_intra(currMB, &prune, &enc_mb);
       if (enc_mb.valid[mode])
       {
         //printf(" mode %d is valid", mode);
@@ -301,6 +313,7 @@ void encode_one_macroblock_high (Macroblock *currMB)
   //---------------------------------------------------------------------------
   update_qp_cbp_tmp(currMB, p_RDO->cbp);
   currSlice->set_stored_mb_parameters (currMB);
+  md_prune_store(currMB, &prune);
 
   // Rate control
   if(p_Inp->RCEnable && p_Inp->RCUpdateMode <= MAX_RC_MODE)
@@ -29,6 +29,7 @@
 #include "vlc.h"
 #include "rdopt.h"
 #include "mv_search.h"
+#include "md_prune.h"
 
 /*!
 *************************************************************************************
@@ -130,6 +131,7 @@ void encode_one_macroblock_highfast (Macroblock *currMB)
   distblk RDCost16 = DISTBLK_MAX;
   BestMode    md_best;
   Info8x8     best;
+  MDPrune     prune;
 
   init_md_best(&md_best);
 
@@ -143,6 +145,7 @@ void encode_one_macroblock_highfast (Macroblock *currMB)
 
   //===== Setup Macroblock encoding parameters =====
   init_enc_mb_params(currMB, &enc_mb, intra);
+  md_prune_init(currMB, &prune, intra);
   if (p_Inp->AdaptiveRounding)
   {
     reset_adaptive_rounding(p_Vid);
@@ -234,6 +237,7 @@ void encode_one_macroblock_highfast (Macroblock *currMB)
             currSlice->set_ref_and_motion_vectors (currMB, motion, &best, block);
         } // for (block=0; block<(mode==1?1:2); block++)
 
+        prune.cost[mode] = cost;
 
         if(mode == 1)
         {
@@ -261,6 +265,9 @@ void encode_one_macroblock_highfast (Macroblock *currMB)
             } // if(p_Inp->EarlySkipEnable)
           }
 
+          if (!inter_skip)
+            md_prune_16x16(currMB, &prune, &enc_mb);
+
           // store variables.
           RDCost16 = currMB->min_rdcost;
           mode16 = currMB->best_mode;
@@ -280,6 +287,9 @@ void encode_one_macroblock_highfast (Macroblock *currMB)
       } // if (enc_mb.valid[mode])
     } // for (mode=1; mode<4; mode++)
 
+    if (!inter_skip)
+      md_prune_partition(currMB, &prune, &enc_mb);
+
     if ((!inter_skip) && enc_mb.valid[P8x8])
     {
       currMB->valid_8x8 = FALSE;
@@ -368,6 +378,8 @@ void encode_one_macroblock_highfast (Macroblock *currMB)
           mode = mb_mode_table[index];
           if (mode == 1)
             continue;
+          if (mode == I16MB)
+            md_prune_intra(currMB, &prune, &enc_mb);
           if (enc_mb.valid[mode])
           {
             if (p_Vid->yuv_format != YUV400)
@@ -421,6 +433,8 @@ void encode_one_macroblock_highfast (Macroblock *currMB)
             for (index = 5; index < max_index; index++)
             {
               mode = mb_mode_table[index];
+              if (mode == I16MB)
+                md_prune_intra(currMB, &prune, &enc_mb);
 
               // Skip intra modes in inter slices if best mode is inter <P8x8 with cbp equal to 0
               if (p_Inp->SkipIntraInInterSlices && !intra && mode >= I4MB && currMB->best_mode <=3 && currMB->best_cbp == 0)
@@ -451,6 +465,7 @@ void encode_one_macroblock_highfast (Macroblock *currMB)
   //---------------------------------------------------------------------------
   update_qp_cbp_tmp(currMB, p_RDO->cbp);
   currSlice->set_stored_mb_parameters (currMB);
+  md_prune_store(currMB, &prune);
 
   // Rate control
   if(p_Inp->RCEnable && p_Inp->RCUpdateMode <= MAX_RC_MODE)
@@ -20,6 +20,7 @@
 #include "image.h"
 #include "transform8x8.h"
 #include "ratectl.h"
+#include "rc_stats.h"
 #include "mode_decision.h"
 #include "mode_decision_p8x8.h"
 #include "fmo.h"
@@ -33,6 +34,7 @@
 #include "memalloc.h"
 #include "mc_prediction.h"
 #include "rd_intra_jm.h"
+#include "profile.h"
 
 /*!
  ************************************************************************
@@ -305,7 +307,7 @@ void encode_one_macroblock_low (Macroblock *currMB)
         }
       }// if (p_Inp->Transform8x8Mode != 2)
 
-      if (p_Inp->RCEnable)
+      if (p_Inp->RCEnable || p_Inp->RCPass == 1)
         rc_store_diff(currSlice->diffy, &p_Vid->pCurImg[currMB->opix_y], currMB->pix_x, mb_pred);
 
       //check cost for P8x8 for non-rdopt mode
@@ -368,8 +370,12 @@ void encode_one_macroblock_low (Macroblock *currMB)
   tmp_8x8_flag  = currMB->luma_transform_size_8x8_flag;  //save 8x8_flag
   tmp_no_mbpart = currMB->NoMbPartLessThan8x8Flag;      //save no-part-less
   if ((p_Vid->yuv_format != YUV400) && (p_Vid->yuv_format != YUV444))
+  {
     // precompute all chroma intra prediction modes
+    profile_enter(p_Vid->p_prof, PROF_INTRA);
     currSlice->intra_chroma_prediction(currMB, NULL, NULL, NULL);
+    profile_leave(p_Vid->p_prof);
+  }
 
   if (enc_mb.valid[0] && bslice) // check DIRECT MODE
   {
@@ -416,7 +422,7 @@ void encode_one_macroblock_low (Macroblock *currMB)
         currMB->luma_transform_size_8x8_flag = FALSE;
 
       //Rate control
-      if (p_Inp->RCEnable)
+      if (p_Inp->RCEnable || p_Inp->RCPass == 1)
         rc_store_diff(currSlice->diffy, &p_Vid->pCurImg[currMB->opix_y], currMB->pix_x, mb_pred);
 
       min_cost  = cost;
@@ -435,7 +441,9 @@ void encode_one_macroblock_low (Macroblock *currMB)
     currMB->luma_transform_size_8x8_flag = TRUE; // at this point cost will ALWAYS be less than min_cost
 
     currMB->mb_type = currMB->ar_mode = I8MB;
+    profile_enter(p_Vid->p_prof, PROF_INTRA);
     temp_cpb = mode_decision_for_I8x8_MB (currMB, enc_mb.lambda_mdfp, &rd_cost);
+    profile_leave(p_Vid->p_prof);
 
     if (rd_cost <= currMB->min_rdcost) //HYU_NOTE. bug fix. 08/15/07
     {
@@ -466,7 +474,7 @@ void encode_one_macroblock_low (Macroblock *currMB)
       }
 
       //Rate control
-      if (p_Inp->RCEnable)
+      if (p_Inp->RCEnable || p_Inp->RCPass == 1)
         rc_store_diff(currSlice->diffy, &p_Vid->pCurImg[currMB->opix_y], currMB->pix_x, mb_pred);
 
       currMB->min_rdcost  = rd_cost; 
@@ -490,13 +498,15 @@ void encode_one_macroblock_low (Macroblock *currMB)
   {
     currMB->luma_transform_size_8x8_flag = FALSE;
     currMB->mb_type = currMB->ar_mode = I4MB;
+    profile_enter(p_Vid->p_prof, PROF_INTRA);
     temp_cpb = mode_decision_for_I4x4_MB (currMB, enc_mb.lambda_mdfp, &rd_cost);
+    profile_leave(p_Vid->p_prof);
     if (rd_cost <= currMB->min_rdcost) 
     {
       currMB->cbp = temp_cpb;
 
       //Rate control
-      if (p_Inp->RCEnable)
+      if (p_Inp->RCEnable || p_Inp->RCPass == 1)
         rc_store_diff(currSlice->diffy, &p_Vid->pCurImg[currMB->opix_y], currMB->pix_x, mb_pred);
 
       currMB->min_rdcost  = rd_cost; 
@@ -521,16 +531,19 @@ void encode_one_macroblock_low (Macroblock *currMB)
   }
   if (enc_mb.valid[I16MB]) // check INTRA16x16
   {
+    profile_enter(p_Vid->p_prof, PROF_INTRA);
     rd_cost = find_best_mode_I16x16_MB (currMB, enc_mb.lambda_mdfp, currMB->min_rdcost);
+    profile_leave(p_Vid->p_prof);
 
     if (rd_cost < currMB->min_rdcost)
     {
       //Rate control      
-      if (p_Inp->RCEnable)
+      if (p_Inp->RCEnable || p_Inp->RCPass == 1)
         rc_store_diff(currSlice->diffy, &p_Vid->pCurImg[currMB->opix_y], currMB->pix_x, currSlice->mpr_16x16[0][(short) currMB->i16mode]);
 
       currMB->best_mode   = I16MB;      
       currMB->min_rdcost  = rd_cost; 
+      profile_enter(p_Vid->p_prof, PROF_TRANSFORM);
       currMB->cbp = currMB->residual_transform_quant_luma_16x16 (currMB, PLANE_Y);
 
       if (p_Vid->P444_joined)
@@ -546,7 +559,7 @@ void encode_one_macroblock_low (Macroblock *currMB)
         currSlice->cmp_cbp[1] = currMB->cbp;   
         currSlice->cmp_cbp[2] = currMB->cbp;
       }
-
+      profile_leave(p_Vid->p_prof);
     }
     else
     {
@@ -568,7 +581,9 @@ void encode_one_macroblock_low (Macroblock *currMB)
       if (currMB->luma_transform_size_8x8_flag && (p_RDO->tr8x8->cbp8x8 == 0) && p_Inp->Transform8x8Mode != 2)
         currMB->luma_transform_size_8x8_flag = FALSE;
 
+      profile_enter(p_Vid->p_prof, PROF_TRANSFORM);
       currSlice->set_coeff_and_recon_8x8 (currMB);
+      profile_leave(p_Vid->p_prof);
 
       memset(currMB->intra_pred_modes, DC_PRED, MB_BLOCK_PARTITIONS * sizeof(char));
       for (j = currMB->block_y; j < currMB->block_y + BLOCK_MULTIPLE; j++)
@@ -605,7 +620,9 @@ void encode_one_macroblock_low (Macroblock *currMB)
           if((currMB->best_mode >= 1) && (currMB->best_mode <= 3))
             currMB->luma_transform_size_8x8_flag = best_transform_flag;
           
+          profile_enter(p_Vid->p_prof, PROF_TRANSFORM);
           currSlice->luma_residual_coding(currMB);
+          profile_leave(p_Vid->p_prof);
           if (currSlice->P444_joined)
           {            
             if((currMB->cbp==0 && currSlice->cmp_cbp[1] == 0 && currSlice->cmp_cbp[2] == 0) &&(currMB->best_mode == 0))
@@ -618,7 +635,7 @@ void encode_one_macroblock_low (Macroblock *currMB)
           }
 
           //Rate control
-          if (p_Inp->RCEnable)
+          if (p_Inp->RCEnable || p_Inp->RCPass == 1)
             rc_store_diff(currSlice->diffy, &p_Vid->pCurImg[currMB->opix_y], currMB->pix_x, mb_pred);
         }
       }
@@ -629,12 +646,20 @@ void encode_one_macroblock_low (Macroblock *currMB)
 
     // precompute all chroma intra prediction modes
     if ((p_Vid->yuv_format != YUV400) && (p_Vid->yuv_format != YUV444))
+    {
+      profile_enter(p_Vid->p_prof, PROF_INTRA);
       currSlice->intra_chroma_prediction(currMB, NULL, NULL, NULL);
+      profile_leave(p_Vid->p_prof);
+    }
 
     currMB->i16offset = 0;
 
     if ((p_Vid->yuv_format != YUV400) && (p_Vid->yuv_format != YUV444))
+    {
+      profile_enter(p_Vid->p_prof, PROF_TRANSFORM);
       currSlice->chroma_residual_coding (currMB);
+      profile_leave(p_Vid->p_prof);
+    }
 
     if (currMB->best_mode == I16MB)
     {
@@ -671,6 +696,8 @@ void encode_one_macroblock_low (Macroblock *currMB)
   // Rate control
   if(p_Inp->RCEnable && p_Inp->RCUpdateMode <= MAX_RC_MODE)
     rc_store_mad(currMB);
+  if (p_Inp->RCPass == 1)
+    rc_stats_store_mad(currMB);
 
   //===== Decide if this MB will restrict the reference frames =====
   if (p_Inp->RestrictRef)
@@ -0,0 +1,262 @@
+/*!
+ ***************************************************************************
+ * \file md_prune.c
+ *
+ * \brief
+ *    Mode decision pruning rules for the high complexity mode decision.
+ *
+ *    The rules only use information that is already available at the
+ *    point where they are checked: the motion search costs of the
+ *    current macroblock and the statistics (16x16 motion cost, RD cost,
+ *    selected mode) of the left and upper neighbours.
+ **************************************************************************
+ */
+
+#include "global.h"
+#include "mbuffer.h"
+#include "md_prune.h"
+
+#define MODE_BIT(mode)  (1 << (mode))
+
+//! modes dropped by each rule
+static const int prune_modes[MD_PRUNE_RULES] =
+{
+  MODE_BIT(2) | MODE_BIT(3) | MODE_BIT(P8x8) | MODE_BIT(I16MB) | MODE_BIT(I4MB) | MODE_BIT(I8MB) | MODE_BIT(IPCM),
+  MODE_BIT(2) | MODE_BIT(3) | MODE_BIT(P8x8),
+  MODE_BIT(P8x8),
+  MODE_BIT(I16MB) | MODE_BIT(I4MB) | MODE_BIT(I8MB) | MODE_BIT(IPCM)
+};
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Collect the left and upper neighbours of the current macroblock
+ *************************************************************************************
+ */
+static int get_prune_neighbours(Macroblock *currMB, Macroblock **nb, int *addr)
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  int num = 0;
+
+  if (currMB->mbAvailA)
+  {
+    addr[num] = currMB->mbAddrA;
+    nb[num++] = &p_Vid->mb_data[currMB->mbAddrA];
+  }
+  if (currMB->mbAvailB)
+  {
+    addr[num] = currMB->mbAddrB;
+    nb[num++] = &p_Vid->mb_data[currMB->mbAddrB];
+  }
+  return num;
+}
+
+static inline int is_skip_neighbour(Macroblock *nb)
+{
+  return (nb->mb_type == 0 && nb->cbp == 0);
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    A rule fired: remove its modes from the decision (or only remember
+ *    them in audit mode)
+ *************************************************************************************
+ */
+static void prune_apply(Macroblock *currMB, MDPrune *prune, RD_PARAMS *enc_mb, int rule)
+{
+  int mode;
+  int modes = 0;
+
+  for (mode = 0; mode < MAXMODE; ++mode)
+  {
+    if ((prune_modes[rule] & MODE_BIT(mode)) && enc_mb->valid[mode])
+      modes |= MODE_BIT(mode);
+  }
+
+  if (modes)
+  {
+    ++currMB->p_Vid->p_Stats->md_prune.hits[rule];
+    prune->mask[rule] = modes;
+    if (!prune->audit)
+    {
+      for (mode = 0; mode < MAXMODE; ++mode)
+      {
+        if (modes & MODE_BIT(mode))
+          enc_mb->valid[mode] = 0;
+      }
+    }
+  }
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Initialize the pruning state of the current macroblock
+ *************************************************************************************
+ */
+void md_prune_init(Macroblock *currMB, MDPrune *prune, short intra)
+{
+  InputParameters *p_Inp = currMB->p_Inp;
+
+  prune->rules = (intra || currMB->p_Vid->md_prune_info == NULL) ? 0 : p_Inp->MDPruning;
+  prune->audit = p_Inp->MDPruningAudit;
+  prune->scale = p_Inp->MDPruningScale;
+  prune->checked = 0;
+  memset(prune->mask, 0, MD_PRUNE_RULES * sizeof(int));
+  prune->cost[0] = prune->cost[1] = prune->cost[2] = prune->cost[3] = DISTBLK_MAX;
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Early SKIP and early 16x16 decision, checked once the 16x16 motion
+ *    search is done and its cost is stored in prune->cost[1]
+ *************************************************************************************
+ */
+void md_prune_16x16(Macroblock *currMB, MDPrune *prune, RD_PARAMS *enc_mb)
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  MDPruneStats *stats = &p_Vid->p_Stats->md_prune;
+  distblk cost16 = prune->cost[1];
+  Macroblock *nb[2];
+  int addr[2];
+  int num, k;
+
+  if (!prune->rules || cost16 == DISTBLK_MAX)
+    return;
+
+  num = get_prune_neighbours(currMB, nb, addr);
+
+  if ((prune->rules & MODE_BIT(MDP_EARLY_SKIP)) && enc_mb->valid[0])
+  {
+    Slice *currSlice = currMB->p_Slice;
+    int num_skip = 0;
+    int64 sum = 0;
+
+    ++stats->checked[MDP_EARLY_SKIP];
+    for (k = 0; k < num; ++k)
+    {
+      if (is_skip_neighbour(nb[k]) && p_Vid->md_prune_info[addr[k]].cost16 != DISTBLK_MAX)
+      {
+        sum += p_Vid->md_prune_info[addr[k]].cost16;
+        ++num_skip;
+      }
+    }
+
+    if (currSlice->slice_type == B_SLICE)
+    {
+      // no skip motion vector to compare with: require both neighbours to be skipped
+      if (num_skip < 2)
+        num_skip = 0;
+    }
+    else
+    {
+      // 16x16 motion must match the SKIP motion
+      PicMotionParams *mv_info = &p_Vid->enc_picture->mv_info[currMB->block_y][currMB->block_x];
+      MotionVector *skip_mv = &currSlice->all_mv[LIST_0][0][0][0][0];
+
+      if (mv_info->ref_idx[LIST_0] != 0 || mv_info->mv[LIST_0].mv_x != skip_mv->mv_x || mv_info->mv[LIST_0].mv_y != skip_mv->mv_y)
+        num_skip = 0;
+    }
+
+    if (num_skip && (int64) cost16 * num_skip * 100 <= sum * prune->scale)
+      prune_apply(currMB, prune, enc_mb, MDP_EARLY_SKIP);
+  }
+
+  if ((prune->rules & MODE_BIT(MDP_EARLY_16x16)) && (enc_mb->valid[2] || enc_mb->valid[3] || enc_mb->valid[P8x8]))
+  {
+    distblk min_nb = DISTBLK_MAX;
+
+    ++stats->checked[MDP_EARLY_16x16];
+    // both neighbours must be available and coded as SKIP or 16x16
+    for (k = 0; k < num; ++k)
+    {
+      if (nb[k]->mb_type > 1)
+        break;
+      min_nb = distblkmin(min_nb, p_Vid->md_prune_info[addr[k]].cost16);
+    }
+
+    if (num == 2 && k == num && min_nb != DISTBLK_MAX && (int64) cost16 * 100 <= (int64) min_nb * prune->scale)
+      prune_apply(currMB, prune, enc_mb, MDP_EARLY_16x16);
+  }
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Drop P8x8 if splitting the 16x16 block into halves does not pay off
+ *************************************************************************************
+ */
+void md_prune_partition(Macroblock *currMB, MDPrune *prune, RD_PARAMS *enc_mb)
+{
+  distblk split_cost = distblkmin(prune->cost[2], prune->cost[3]);
+
+  if (!(prune->rules & MODE_BIT(MDP_PARTITION)) || !enc_mb->valid[P8x8] || prune->cost[1] == DISTBLK_MAX || split_cost == DISTBLK_MAX)
+    return;
+
+  ++currMB->p_Vid->p_Stats->md_prune.checked[MDP_PARTITION];
+  if ((int64) split_cost * prune->scale >= (int64) prune->cost[1] * 100)
+    prune_apply(currMB, prune, enc_mb, MDP_PARTITION);
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Drop the intra modes if the best inter RD cost is below the RD cost
+ *    of the (inter coded) neighbours. Must be called once all inter modes
+ *    have been evaluated; only the first call per macroblock is effective.
+ *************************************************************************************
+ */
+void md_prune_intra(Macroblock *currMB, MDPrune *prune, RD_PARAMS *enc_mb)
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  Macroblock *nb[2];
+  int addr[2];
+  int num, k;
+  int64 sum = 0;
+
+  if (!(prune->rules & MODE_BIT(MDP_INTRA)) || (prune->checked & MODE_BIT(MDP_INTRA)) || currMB->min_rdcost == DISTBLK_MAX
+    || !(enc_mb->valid[I16MB] || enc_mb->valid[I4MB] || enc_mb->valid[I8MB] || enc_mb->valid[IPCM]))
+    return;
+
+  prune->checked |= MODE_BIT(MDP_INTRA);
+  ++p_Vid->p_Stats->md_prune.checked[MDP_INTRA];
+  num = get_prune_neighbours(currMB, nb, addr);
+  for (k = 0; k < num; ++k)
+  {
+    if (is_intra(nb[k]))
+      return;
+    sum += p_Vid->md_prune_info[addr[k]].rdcost;
+  }
+
+  if (num && (int64) currMB->min_rdcost * num * 100 <= sum * prune->scale)
+    prune_apply(currMB, prune, enc_mb, MDP_INTRA);
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Keep the statistics of the current macroblock for its neighbours
+ *    and account for audit misses
+ *************************************************************************************
+ */
+void md_prune_store(Macroblock *currMB, MDPrune *prune)
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  MDPruneInfo *info;
+  int rule;
+
+  if (p_Vid->md_prune_info == NULL)
+    return;
+
+  info = &p_Vid->md_prune_info[currMB->mbAddrX];
+  info->cost16 = prune->cost[1];
+  info->rdcost = currMB->min_rdcost;
+
+  for (rule = 0; rule < MD_PRUNE_RULES; ++rule)
+  {
+    if (prune->mask[rule] & MODE_BIT(currMB->best_mode))
+      ++p_Vid->p_Stats->md_prune.misses[rule];
+  }
+}
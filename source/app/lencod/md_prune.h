@@ -0,0 +1,56 @@
+/*!
+ ***************************************************************************
+ * \file
+ *    md_prune.h
+ *
+ * \brief
+ *    Headerfile for the mode decision pruning rules used by the
+ *    high complexity mode decision (RDOptimization 1 and 2).
+ *
+ *    Each rule removes a set of macroblock modes from the RD decision
+ *    of the current macroblock. Rules are enabled through the MDPruning
+ *    bit mask and made more or less aggressive through MDPruningScale.
+ *    With MDPruningAudit the rules are only evaluated: nothing is pruned
+ *    and a miss is counted whenever a mode that would have been pruned
+ *    is selected.
+ **************************************************************************
+ */
+
+#ifndef _MD_PRUNE_H_
+#define _MD_PRUNE_H_
+
+#include "enc_statistics.h"
+
+//! pruning rules (bit index in MDPruning)
+enum {
+  MDP_EARLY_SKIP  = 0,  //!< skip like 16x16 motion with cheap skip neighbours: keep only SKIP/16x16
+  MDP_EARLY_16x16 = 1,  //!< 16x16 cheaper than its 16x16/skip neighbours: drop 16x8, 8x16 and P8x8
+  MDP_PARTITION   = 2,  //!< 16x8/8x16 do not improve on 16x16: drop P8x8
+  MDP_INTRA       = 3   //!< best inter cost below the cost of inter neighbours: drop intra modes
+};
+
+//! per macroblock statistics kept for the neighbour based rules
+typedef struct md_prune_info
+{
+  distblk cost16;       //!< 16x16 motion search cost (DISTBLK_MAX if not available)
+  distblk rdcost;       //!< RD cost of the selected mode
+} MDPruneInfo;
+
+//! pruning state of the current mode decision
+typedef struct md_prune
+{
+  int      rules;                   //!< enabled rules (0 if pruning is disabled for this macroblock)
+  int      audit;                   //!< evaluate rules without pruning
+  int      checked;                 //!< rules already evaluated for this macroblock
+  int      scale;                   //!< threshold scale in percent
+  int      mask[MD_PRUNE_RULES];    //!< modes selected for pruning by each rule that fired
+  distblk  cost[4];                 //!< motion search cost of modes 1 to 3 (set by the caller)
+} MDPrune;
+
+extern void md_prune_init      (Macroblock *currMB, MDPrune *prune, short intra);
+extern void md_prune_16x16     (Macroblock *currMB, MDPrune *prune, RD_PARAMS *enc_mb);
+extern void md_prune_partition (Macroblock *currMB, MDPrune *prune, RD_PARAMS *enc_mb);
+extern void md_prune_intra     (Macroblock *currMB, MDPrune *prune, RD_PARAMS *enc_mb);
+extern void md_prune_store     (Macroblock *currMB, MDPrune *prune);
+
+#endif
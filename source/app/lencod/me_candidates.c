@@ -0,0 +1,224 @@
+/*!
+*************************************************************************************
+* \file me_candidates.c
+*
+* \brief
+*    Candidate batch evaluation for the integer pel motion search engines
+*    (EPZS and UMHexagonS).
+*
+*    Each search step first gathers its predictors or pattern points into
+*    an MECandBatch. The motion vector costs of the whole batch are then
+*    computed in a single pass over the mvbits table, and the batch is scored
+*    in gathering order so that the results are identical to evaluating the
+*    candidates one at a time.
+*
+*************************************************************************************
+*/
+
+#include "contributors.h"
+
+#include "global.h"
+#include "memalloc.h"
+#include "mv_search.h"
+#include "me_candidates.h"
+
+/*!
+************************************************************************
+* \brief
+*    Allocate a candidate batch of given capacity
+************************************************************************
+*/
+int alloc_me_cand_batch(MECandBatch **batch, int size, MECandStats *stats)
+{
+  MECandBatch *cur;
+
+  if ((*batch = (MECandBatch *) mem_calloc(1, sizeof(MECandBatch))) == NULL)
+    no_mem_exit("alloc_me_cand_batch: batch");
+
+  cur = *batch;
+  cur->size  = size;
+  cur->stats = stats;
+
+  cur->mv   = (MotionVector *) mem_calloc(size, sizeof(MotionVector));
+  cur->pos  = (MotionVector *) mem_calloc(size, sizeof(MotionVector));
+  cur->cost = (distblk *)      mem_calloc(size, sizeof(distblk));
+  cur->idx  = (short *)        mem_calloc(size, sizeof(short));
+
+  me_batch_reset(cur);
+
+  return (int) (sizeof(MECandBatch) + size * (2 * sizeof(MotionVector) + sizeof(distblk) + sizeof(short)));
+}
+
+/*!
+************************************************************************
+* \brief
+*    Free a candidate batch
+************************************************************************
+*/
+void free_me_cand_batch(MECandBatch *batch)
+{
+  if (batch)
+  {
+    mem_free(batch->idx);
+    mem_free(batch->cost);
+    mem_free(batch->pos);
+    mem_free(batch->mv);
+    mem_free(batch);
+  }
+}
+
+/*!
+************************************************************************
+* \brief
+*    Compute the motion vector cost of all candidates in the batch.
+*    base_cost is added to every entry (e.g. cost of the fixed vector
+*    in bi-predictive searches).
+************************************************************************
+*/
+void me_batch_mv_cost(VideoParameters *p_Vid, MECandBatch *batch, int lambda_factor, const MotionVector *pred, distblk base_cost)
+{
+  const MotionVector *pos = batch->pos;
+  distblk *cost = batch->cost;
+  int i;
+
+  for (i = 0; i < batch->num; ++i)
+    cost[i] = base_cost + mv_cost (p_Vid, lambda_factor, &pos[i], pred);
+
+  if (batch->stats)
+    batch->stats->accepted += batch->num;
+}
+
+/*!
+************************************************************************
+* \brief
+*    Score a batch of single list candidates in gathering order.
+*
+*    If second is NULL only the best candidate is tracked (pattern refinement),
+*    otherwise the best and second best candidates are tracked and the second
+*    best cost is used as the early termination threshold (predictor checking).
+*    Scoring of the remaining candidates stops once the best cost drops below
+*    batch->stop_cost.
+*
+* \return
+*    number of times best or second best were updated
+************************************************************************
+*/
+int me_score_batch(MECandBatch *batch, MEBlock *mv_block, StorablePicture *ref_picture,
+                   MotionVector *best, distblk *min_mcost, MotionVector *second, distblk *second_mcost)
+{
+  int i, updates = 0, scored = 0;
+  distblk mcost;
+
+  if (second == NULL)
+  {
+    for (i = 0; i < batch->num; ++i)
+    {
+      mcost = batch->cost[i];
+      if (mcost < *min_mcost)
+      {
+        mcost += mv_block->computePredFPel (ref_picture, mv_block, *min_mcost - mcost, &batch->pos[i]);
+        ++scored;
+
+        if (mcost < *min_mcost)
+        {
+          *best = batch->mv[i];
+          *min_mcost = mcost;
+          batch->best = i;
+          ++updates;
+        }
+      }
+    }
+  }
+  else
+  {
+    for (i = 0; i < batch->num; ++i)
+    {
+      mcost = batch->cost[i];
+      if (mcost < *second_mcost)
+      {
+        mcost += mv_block->computePredFPel (ref_picture, mv_block, *second_mcost - mcost, &batch->pos[i]);
+        ++scored;
+
+        if (mcost < *min_mcost)
+        {
+          *second = *best;
+          *best = batch->mv[i];
+          *second_mcost = *min_mcost;
+          *min_mcost = mcost;
+          batch->best = i;
+          ++updates;
+        }
+        else if (mcost < *second_mcost)
+        {
+          *second = batch->mv[i];
+          *second_mcost = mcost;
+          ++updates;
+        }
+      }
+      if (*min_mcost < batch->stop_cost)
+        break;
+    }
+  }
+
+  if (batch->stats)
+    batch->stats->scored += scored;
+
+  return updates;
+}
+
+/*!
+************************************************************************
+* \brief
+*    Score a batch of bi-predictive candidates in gathering order.
+*    The batch candidates are placed in list cand_list of the bi-predictive
+*    distortion call, fixed_pos in the other one.
+*
+* \return
+*    number of times best or second best were updated
+************************************************************************
+*/
+int me_score_bipred_batch(MECandBatch *batch, MEBlock *mv_block, StorablePicture *ref_picture1, StorablePicture *ref_picture2,
+                          MotionVector *fixed_pos, int cand_list,
+                          MotionVector *best, distblk *min_mcost, MotionVector *second, distblk *second_mcost)
+{
+  int i, updates = 0, scored = 0;
+  distblk mcost;
+  distblk *threshold = (second == NULL) ? min_mcost : second_mcost;
+
+  for (i = 0; i < batch->num; ++i)
+  {
+    mcost = batch->cost[i];
+    if (mcost < *threshold)
+    {
+      if (cand_list == LIST_0)
+        mcost += mv_block->computeBiPredFPel (ref_picture1, ref_picture2, mv_block, *threshold - mcost, &batch->pos[i], fixed_pos);
+      else
+        mcost += mv_block->computeBiPredFPel (ref_picture1, ref_picture2, mv_block, *threshold - mcost, fixed_pos, &batch->pos[i]);
+      ++scored;
+
+      if (mcost < *min_mcost)
+      {
+        if (second != NULL)
+        {
+          *second = *best;
+          *second_mcost = *min_mcost;
+        }
+        *best = batch->mv[i];
+        *min_mcost = mcost;
+        batch->best = i;
+        ++updates;
+      }
+      else if (second != NULL && mcost < *second_mcost)
+      {
+        *second = batch->mv[i];
+        *second_mcost = mcost;
+        ++updates;
+      }
+    }
+  }
+
+  if (batch->stats)
+    batch->stats->scored += scored;
+
+  return updates;
+}
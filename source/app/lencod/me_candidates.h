@@ -0,0 +1,86 @@
+/*!
+ ************************************************************************
+ * \file me_candidates.h
+ *
+ * \brief
+ *    Candidate batch used by the integer pel motion search engines.
+ *    Candidates are first gathered (range check and duplicate removal
+ *    are done by the engine specific add functions), then motion vector
+ *    costs are computed for the whole batch and finally the batch is
+ *    scored in gathering order.
+ *
+ ************************************************************************
+ */
+
+#ifndef _ME_CANDIDATES_H_
+#define _ME_CANDIDATES_H_
+
+#include "enc_statistics.h"
+
+typedef struct me_cand_batch
+{
+  int           num;    //!< candidates currently in the batch
+  int           size;   //!< allocated capacity
+  MotionVector *mv;     //!< candidate as reported back to the search engine
+  MotionVector *pos;    //!< candidate position passed to the distortion function
+  distblk      *cost;   //!< motion vector cost of each candidate
+  short        *idx;    //!< predictor / pattern point the candidate originated from
+  int           best;   //!< batch index of the last candidate that improved the best cost (-1 if none)
+  distblk       stop_cost; //!< predictor checking stops once the best cost drops below this value (0: disabled)
+  MECandStats  *stats;  //!< candidate counters (may be NULL)
+} MECandBatch;
+
+extern int  alloc_me_cand_batch   (MECandBatch **batch, int size, MECandStats *stats);
+extern void free_me_cand_batch    (MECandBatch *batch);
+
+extern void me_batch_mv_cost      (VideoParameters *p_Vid, MECandBatch *batch, int lambda_factor, const MotionVector *pred, distblk base_cost);
+extern int  me_score_batch        (MECandBatch *batch, MEBlock *mv_block, StorablePicture *ref_picture,
+                                   MotionVector *best, distblk *min_mcost, MotionVector *second, distblk *second_mcost);
+extern int  me_score_bipred_batch (MECandBatch *batch, MEBlock *mv_block, StorablePicture *ref_picture1, StorablePicture *ref_picture2,
+                                   MotionVector *fixed_pos, int cand_list,
+                                   MotionVector *best, distblk *min_mcost, MotionVector *second, distblk *second_mcost);
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Start a new candidate batch
+ ***********************************************************************
+ */
+static inline void me_batch_reset(MECandBatch *batch)
+{
+  batch->num  = 0;
+  batch->best = -1;
+  batch->stop_cost = 0;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Append a candidate that already passed range and duplicate checks.
+ *    The capacity of the batch has to cover all candidates of a stage.
+ ***********************************************************************
+ */
+static inline void me_batch_push(MECandBatch *batch, MotionVector mv, MotionVector pos, int idx)
+{
+  int i = batch->num++;
+
+  assert(i < batch->size);
+  batch->mv [i] = mv;
+  batch->pos[i] = pos;
+  batch->idx[i] = (short) idx;
+}
+
+/*!
+ ***********************************************************************
+ * \brief
+ *    Account for a new integer pel search
+ ***********************************************************************
+ */
+static inline void me_batch_new_search(MECandBatch *batch)
+{
+  if (batch->stats)
+    ++batch->stats->searches;
+}
+
+#endif
+
@@ -62,6 +62,7 @@ EPZS_motion_estimation (Macroblock * currMB,     // <--  current Macroblock
   VideoParameters *p_Vid = currMB->p_Vid;
   InputParameters *p_Inp = currMB->p_Inp;
   EPZSParameters *p_EPZS = currSlice->p_EPZS;
+  MECandBatch *batch = p_EPZS->batch;
   PicMotionParams **motion = p_Vid->enc_picture->mv_info;
 
   int blocktype = mv_block->blocktype;
@@ -92,6 +93,7 @@ EPZS_motion_estimation (Macroblock * currMB,     // <--  current Macroblock
   ++p_EPZS->BlkCount;
   if (p_EPZS->BlkCount == 0)
     ++p_EPZS->BlkCount;
+  me_batch_new_search (batch);
 
   if (p_Inp->EPZSSpatialMem)
   {
@@ -135,7 +137,6 @@ EPZS_motion_estimation (Macroblock * currMB,     // <--  current Macroblock
     SPoint *p_EPZS_point = p_EPZS->predictor->point;
     Boolean checkMedian = FALSE;
     distblk second_mcost = DISTBLK_MAX;
-    distblk mcost;
     int prednum = 5;
     int conditionEPZS;
     MotionVector tmp2 = {0, 0}, tmv;
@@ -216,48 +217,18 @@ EPZS_motion_estimation (Macroblock * currMB,     // <--  current Macroblock
     if (conditionEPZS && currMB->mbAddrX != 0 && p_Inp->EPZSBlockType)
       EPZSBlockTypePredictorsMB (currSlice, mv_block, p_EPZS_point, &prednum);
 
-    //! Check all predictors
+    //! Gather all predictors into a batch (range check and EPZSMap based duplicate removal)
+    //! and score them in one call
+    me_batch_reset (batch);
     for (pos = 0; pos < prednum; ++pos)
     {
       tmv = p_EPZS_point[pos].motion;
-      set_integer_mv(&tmv);
-
-      //if (((iabs (tmv.mv_x - mv->mv_x) > searchRange->max_x || iabs (tmv.mv_y - mv->mv_y) > searchRange->max_y)) && (tmv.mv_x || tmv.mv_y))
-      if ((iabs (tmv.mv_x - mv->mv_x) - searchRange->max_x <= 0) && (iabs (tmv.mv_y - mv->mv_y) - searchRange->max_y <= 0))
-      {
-        EPZSPoint = &EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x];
-        if (*EPZSPoint != p_EPZS->BlkCount)
-        {
-          *EPZSPoint = p_EPZS->BlkCount;
-          cand = pad_MVs (tmv, mv_block);
-
-          //--- set motion cost (cost for motion vector) and check ---
-          mcost = mv_cost (p_Vid, lambda_factor, &cand, &pred);
-
-          if (mcost < second_mcost)
-          {
-            mcost += mv_block->computePredFPel (ref_picture, mv_block, second_mcost - mcost, &cand);
-
-            //--- check if motion cost is less than minimum cost ---
-            if (mcost < min_mcost)
-            {
-              tmp2 = tmp;
-              tmp = tmv;
-              second_mcost = min_mcost;
-              min_mcost = mcost;
-              checkMedian = TRUE;
-            }
-            //else if (mcost < second_mcost && (tmp.mv_x != tmv.mv_x || tmp.mv_y != tmv.mv_y))
-            else if (mcost < second_mcost)
-            {
-              tmp2 = tmv;
-              second_mcost = mcost;
-              checkMedian = TRUE;
-            }
-          }
-        }
-      }
+      set_integer_mv (&tmv);
+      EPZS_add_candidate (p_EPZS, EPZSMap, mapCenter_x, mv, searchRange->max_x, searchRange->max_y, tmv, mv_block, pos);
     }
+    me_batch_mv_cost (p_Vid, batch, lambda_factor, &pred, 0);
+    if (me_score_batch (batch, mv_block, ref_picture, &tmp, &min_mcost, &tmp2, &second_mcost))
+      checkMedian = TRUE;
 
     //! Refine using EPZS pattern if needed
     //! Note that we are using a conservative threshold method. Threshold
@@ -295,39 +266,19 @@ EPZS_motion_estimation (Macroblock * currMB,     // <--  current Macroblock
         do
         {
           checkPts = totalCheckPts;
+          me_batch_reset (batch);
           do
           {
-            tmv = add_MVs (center, &(searchPatternF->point[pointNumber].motion));
-
-            if (((iabs (tmv.mv_x - mv->mv_x) - searchRange->max_x) <= 0) && ((iabs (tmv.mv_y - mv->mv_y) - searchRange->max_y) <= 0))
-            {
-              EPZSPoint = &EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x];
-              if (*EPZSPoint != p_EPZS->BlkCount)
-              {
-                *EPZSPoint = p_EPZS->BlkCount;
-                cand = pad_MVs (tmv, mv_block);
-
-                mcost = mv_cost (p_Vid, lambda_factor, &cand, &pred);
-
-                if (mcost < min_mcost)
-                {
-                  mcost += mv_block->computePredFPel (ref_picture, mv_block, min_mcost - mcost, &cand);
-
-                  if (mcost < min_mcost)
-                  {
-                    tmp = tmv;
-                    min_mcost = mcost;
-                    motionDirection = pointNumber;
-                  }
-                }
-              }
-            }
+            EPZS_add_candidate (p_EPZS, EPZSMap, mapCenter_x, mv, searchRange->max_x, searchRange->max_y, add_MVs (center, &(searchPatternF->point[pointNumber].motion)), mv_block, pointNumber);
             ++pointNumber;
             if (pointNumber >= searchPatternF->searchPoints)
               pointNumber -= searchPatternF->searchPoints;
             checkPts--;
           }
           while (checkPts > 0);
+          me_batch_mv_cost (p_Vid, batch, lambda_factor, &pred, 0);
+          if (me_score_batch (batch, mv_block, ref_picture, &tmp, &min_mcost, NULL, NULL))
+            motionDirection = batch->idx[batch->best];
 
           if (nextLast || ((tmp.mv_x == center.mv_x) && (tmp.mv_y == center.mv_y)))
           {
@@ -430,6 +381,7 @@ EPZS_subMB_motion_estimation  (Macroblock * currMB,     // <--  current Macroblo
   VideoParameters *p_Vid = currMB->p_Vid;
   InputParameters *p_Inp = currMB->p_Inp;
   EPZSParameters *p_EPZS = currSlice->p_EPZS;
+  MECandBatch *batch = p_EPZS->batch;
   PicMotionParams **motion = p_Vid->enc_picture->mv_info;
 
   int blocktype = mv_block->blocktype;
@@ -459,6 +411,7 @@ EPZS_subMB_motion_estimation  (Macroblock * currMB,     // <--  current Macroblo
   ++p_EPZS->BlkCount;
   if (p_EPZS->BlkCount == 0)
     ++p_EPZS->BlkCount;
+  me_batch_new_search (batch);
 
   if (p_Inp->EPZSSpatialMem)
   {
@@ -503,7 +456,6 @@ EPZS_subMB_motion_estimation  (Macroblock * currMB,     // <--  current Macroblo
     SPoint *p_EPZS_point = p_EPZS->predictor->point;
     Boolean checkMedian = FALSE;
     distblk second_mcost = DISTBLK_MAX;
-    distblk mcost;
     int prednum = 5;
     int conditionEPZS;
 
@@ -542,65 +494,38 @@ EPZS_subMB_motion_estimation  (Macroblock * currMB,     // <--  current Macroblo
     if (conditionEPZS && currMB->mbAddrX != 0 && p_Inp->EPZSBlockType)
       EPZSBlockTypePredictors (currSlice, mv_block, p_EPZS_point, &prednum);
 
-    //! Check all predictors
+    //! Gather all predictors into a batch (range check and EPZSMap based duplicate removal)
+    //! and score them in one call
+    me_batch_reset (batch);
+
+    // At this point, let us add an early termination criterion
+    // after checking each predictor. This can help speed up a lot.
+    batch->stop_cost = (3 * stopCriterion) >> 2;
+    if (min_mcost < batch->stop_cost)
+      prednum = 1;
+
     for (pos = 0; pos < prednum; ++pos)
     {
       tmv = p_EPZS_point[pos].motion;
-      set_integer_mv(&tmv);
-
-      //if (((iabs (tmv.mv_x - mv->mv_x) > searchRange->max_x || iabs (tmv.mv_y - mv->mv_y) > searchRange->max_y)) && (tmv.mv_x || tmv.mv_y))
-      if ((iabs (tmv.mv_x - mv->mv_x) - searchRange->max_x <= 0) && (iabs (tmv.mv_y - mv->mv_y) - searchRange->max_y <= 0))
-      {
-
-        if (EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] != p_EPZS->BlkCount)
-        {
-          EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] = p_EPZS->BlkCount;
-
-          cand = pad_MVs (tmv, mv_block);
-
-          //--- set motion cost (cost for motion vector) and check ---
-          mcost = mv_cost (p_Vid, lambda_factor, &cand, &pred);
-
-          if (mcost < second_mcost)
-          {
-            mcost += mv_block->computePredFPel (ref_picture, mv_block, second_mcost - mcost, &cand);
-
-            //--- check if motion cost is less than minimum cost ---
-            if (mcost < min_mcost)
-            {
-              tmp2 = tmp;
-              tmp = tmv;
-              second_mcost = min_mcost;
-              min_mcost = mcost;
-              checkMedian = TRUE;
-            }
-            //else if (mcost < second_mcost && (tmp.mv_x != tmv.mv_x || tmp.mv_y != tmv.mv_y))
-            else if (mcost < second_mcost)
-            {
-              tmp2 = tmv;
-              second_mcost = mcost;
-              checkMedian = TRUE;
-            }
-          }
-        }
-      }
-
+      set_integer_mv (&tmv);
+      EPZS_add_candidate (p_EPZS, EPZSMap, mapCenter_x, mv, searchRange->max_x, searchRange->max_y, tmv, mv_block, pos);
+    }
+    me_batch_mv_cost (p_Vid, batch, lambda_factor, &pred, 0);
+    if (me_score_batch (batch, mv_block, ref_picture, &tmp, &min_mcost, &tmp2, &second_mcost))
+      checkMedian = TRUE;
 
-      // At this point, let us add an early termination criterion
-      // after checking each predictor. This can help speed up a lot.
-      if (min_mcost < ((3 * stopCriterion) >> 2))
-      {
+    if (min_mcost < batch->stop_cost)
+    {
 #if EPZSREF
-        if (p_Inp->EPZSSpatialMem)
+      if (p_Inp->EPZSSpatialMem)
 #else 
-        if (p_Inp->EPZSSpatialMem && ref == 0)
+      if (p_Inp->EPZSSpatialMem && ref == 0)
 #endif 
-        {
-          *p_motion = tmp;
-        }
-        *mv = tmp;
-        return min_mcost;
+      {
+        *p_motion = tmp;
       }
+      *mv = tmp;
+      return min_mcost;
     }
 
     //! Refine using EPZS pattern if needed
@@ -635,38 +560,19 @@ EPZS_subMB_motion_estimation  (Macroblock * currMB,     // <--  current Macroblo
         do
         {
           checkPts = totalCheckPts;
+          me_batch_reset (batch);
           do
           {
-            tmv = add_MVs (center, &(searchPatternF->point[pointNumber].motion));
-
-            if ((iabs (tmv.mv_x - mv->mv_x) <= searchRange->max_x) && (iabs (tmv.mv_y - mv->mv_y) <= searchRange->max_y))
-            {
-              if (EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] != p_EPZS->BlkCount)
-              {
-                EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] = p_EPZS->BlkCount;
-                cand = pad_MVs(tmv, mv_block);
-
-                mcost = mv_cost (p_Vid, lambda_factor, &cand, &pred);
-                if (mcost < min_mcost)
-                {
-
-                  mcost += mv_block->computePredFPel (ref_picture, mv_block, min_mcost - mcost, &cand);
-
-                  if (mcost < min_mcost)
-                  {
-                    tmp = tmv;
-                    min_mcost = mcost;
-                    motionDirection = pointNumber;
-                  }
-                }
-              }
-            }
+            EPZS_add_candidate (p_EPZS, EPZSMap, mapCenter_x, mv, searchRange->max_x, searchRange->max_y, add_MVs (center, &(searchPatternF->point[pointNumber].motion)), mv_block, pointNumber);
             ++pointNumber;
             if (pointNumber >= searchPatternF->searchPoints)
               pointNumber -= searchPatternF->searchPoints;
             checkPts--;
           }
           while (checkPts > 0);
+          me_batch_mv_cost (p_Vid, batch, lambda_factor, &pred, 0);
+          if (me_score_batch (batch, mv_block, ref_picture, &tmp, &min_mcost, NULL, NULL))
+            motionDirection = batch->idx[batch->best];
 
           if (nextLast || ((tmp.mv_x == center.mv_x) && (tmp.mv_y == center.mv_y)))
           {
@@ -775,6 +681,7 @@ EPZS_bipred_motion_estimation (Macroblock * currMB,     // <--  Current Macroblo
   VideoParameters *p_Vid = currMB->p_Vid;
   InputParameters *p_Inp = currMB->p_Inp;
   EPZSParameters *p_EPZS = currSlice->p_EPZS;
+  MECandBatch *batch = p_EPZS->batch;
   PicMotionParams **motion = p_Vid->enc_picture->mv_info;
 
   int blocktype = mv_block->blocktype;
@@ -802,6 +709,7 @@ EPZS_bipred_motion_estimation (Macroblock * currMB,     // <--  Current Macroblo
   ++p_EPZS->BlkCount;
   if (p_EPZS->BlkCount == 0)
     ++p_EPZS->BlkCount;
+  me_batch_new_search (batch);
 
 
   // Clear p_EPZS->EPZSMap
@@ -823,7 +731,6 @@ EPZS_bipred_motion_estimation (Macroblock * currMB,     // <--  Current Macroblo
     SPoint *p_EPZS_point = p_EPZS->predictor->point;
     Boolean checkMedian = FALSE;
     distblk second_mcost = DISTBLK_MAX;
-    distblk mcost;
     int prednum = 5;
     MotionVector tmv, tmp2 = { 0, 0 };
     int pos;
@@ -835,48 +742,18 @@ EPZS_bipred_motion_estimation (Macroblock * currMB,     // <--  Current Macroblo
     //! in terms of performance and could be removed with little penalty if any.
     EPZS_spatial_predictors (p_EPZS, mv_block/*->block*/, list, currMB->list_offset, ref, motion);
 
-    //! Check all predictors
+    //! Gather all predictors into a batch (range check and EPZSMap based duplicate removal)
+    //! and score them in one call
+    me_batch_reset (batch);
     for (pos = 0; pos < prednum; ++pos)
     {
       tmv = p_EPZS_point[pos].motion;
-      set_integer_mv(&tmv);
-      //if ((iabs (tmv.mv_x - mv1->mv_x) > search_range || iabs (tmv.mv_y - mv1->mv_y) > search_range) && (tmv.mv_x || tmv.mv_y))
-      if (iabs (tmv.mv_x - mv1->mv_x) <= search_range && iabs (tmv.mv_y - mv1->mv_y) <= search_range)
-      {
-        if (EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] != p_EPZS->BlkCount)
-        {
-          EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] = p_EPZS->BlkCount;
-
-          cand1 = pad_MVs (tmv, mv_block);
-
-          //--- set motion cost (cost for motion vector) and check ---
-          mcost  = mv_cost (p_Vid, lambda_factor, &cand1, &pred1);
-          mcost += mv_cost (p_Vid, lambda_factor, &cand2, &pred2);
-
-          if (mcost >= second_mcost)
-            continue;
-
-          mcost += mv_block->computeBiPredFPel (ref_picture1, ref_picture2, mv_block, second_mcost - mcost, &cand1, &cand2);
-
-          //--- check if motion cost is less than minimum cost ---
-          if (mcost < min_mcost)
-          {
-            tmp2 = tmp;
-            tmp = tmv;
-            second_mcost = min_mcost;
-            min_mcost = mcost;
-            checkMedian = TRUE;
-          }
-          //else if (mcost < second_mcost && (tmp.mv_x != tmv.mv_x || tmp.mv_y != tmv.mv_y))
-          else if (mcost < second_mcost)
-          {
-            tmp2 = tmv;
-            second_mcost = mcost;
-            checkMedian = TRUE;
-          }
-        }
-      }
+      set_integer_mv (&tmv);
+      EPZS_add_candidate (p_EPZS, EPZSMap, mapCenter_x, mv1, search_range, search_range, tmv, mv_block, pos);
     }
+    me_batch_mv_cost (p_Vid, batch, lambda_factor, &pred1, mv_cost (p_Vid, lambda_factor, &cand2, &pred2));
+    if (me_score_bipred_batch (batch, mv_block, ref_picture1, ref_picture2, &cand2, LIST_0, &tmp, &min_mcost, &tmp2, &second_mcost))
+      checkMedian = TRUE;
 
     //! Refine using EPZS pattern if needed
     //! Note that we are using a conservative threshold method. Threshold
@@ -914,39 +791,19 @@ EPZS_bipred_motion_estimation (Macroblock * currMB,     // <--  Current Macroblo
         do
         {
           checkPts = totalCheckPts;
+          me_batch_reset (batch);
           do
           {
-            tmv = add_MVs (center1, &(searchPatternF->point[pointNumber].motion));
-
-            if ((iabs (tmv.mv_x - mv1->mv_x) <= search_range) && (iabs (tmv.mv_y - mv1->mv_y) <= search_range))
-            {
-              if (EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] != p_EPZS->BlkCount)
-              {
-                EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] = p_EPZS->BlkCount;
-                cand1 = pad_MVs (tmv, mv_block);
-
-                mcost  = mv_cost (p_Vid, lambda_factor, &cand1, &pred1);
-                mcost += mv_cost (p_Vid, lambda_factor, &cand2, &pred2);
-
-                if (mcost < min_mcost)
-                {
-                  mcost += mv_block->computeBiPredFPel (ref_picture1, ref_picture2, mv_block, min_mcost - mcost, &cand1, &cand2);
-
-                  if (mcost < min_mcost)
-                  {
-                    tmp = tmv;
-                    min_mcost = mcost;
-                    motionDirection = pointNumber;
-                  }
-                }
-              }
-            }
+            EPZS_add_candidate (p_EPZS, EPZSMap, mapCenter_x, mv1, search_range, search_range, add_MVs (center1, &(searchPatternF->point[pointNumber].motion)), mv_block, pointNumber);
             ++pointNumber;
             if (pointNumber >= searchPatternF->searchPoints)
               pointNumber -= searchPatternF->searchPoints;
             checkPts--;
           }
           while (checkPts > 0);
+          me_batch_mv_cost (p_Vid, batch, lambda_factor, &pred1, mv_cost (p_Vid, lambda_factor, &cand2, &pred2));
+          if (me_score_bipred_batch (batch, mv_block, ref_picture1, ref_picture2, &cand2, LIST_0, &tmp, &min_mcost, NULL, NULL))
+            motionDirection = batch->idx[batch->best];
 
           if (nextLast || ((tmp.mv_x == center1.mv_x) && (tmp.mv_y == center1.mv_y)))
           {
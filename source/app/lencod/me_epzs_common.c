@@ -498,6 +498,7 @@ EPZSStructInit (Slice * currSlice)
     memory_size += get_mem3Ddistblk (&(p_EPZS->bi_distortion), max_list_number, 7, (p_Vid->width + MB_BLOCK_SIZE) / BLOCK_SIZE);
   memory_size += get_mem3Ddistblk (&(p_EPZS->distortion_hpel), max_list_number, 7, (p_Vid->width + MB_BLOCK_SIZE)/ BLOCK_SIZE);
   memory_size += get_mem2Dshort ((short ***) &(p_EPZS->EPZSMap), searcharray, searcharray);
+  memory_size += alloc_me_cand_batch (&(p_EPZS->batch), imax (p_EPZS->predictor->searchPoints, 32), &p_Vid->p_Stats->me_cand);
 
   if (p_Inp->EPZSSpatialMem)
   {
@@ -586,6 +587,7 @@ EPZSStructDelete (Slice * currSlice)
 
   //free_offset_mem2Dshort(EPZSMap, searcharray, (searcharray>>1), (searcharray>>1));
   free_mem2Dshort ((short **) p_EPZS->EPZSMap);
+  free_me_cand_batch (p_EPZS->batch);
   free_mem3Ddistblk (p_EPZS->distortion);
   free_mem3Ddistblk (p_EPZS->distortion_hpel);
 
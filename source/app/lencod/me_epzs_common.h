@@ -19,6 +19,9 @@
 #ifndef _ME_EPZS_COMMON_H_
 #define _ME_EPZS_COMMON_H_
 
+#include "mv_search.h"
+#include "me_candidates.h"
+
 // Structure definitions
 typedef struct
 {
@@ -75,6 +78,7 @@ typedef struct epzs_params {
   int mv_scale_update[6][MAX_REFERENCE_PICTURES][MAX_REFERENCE_PICTURES];
 
   uint16 **EPZSMap;  //!< Memory Map definition
+  MECandBatch *batch; //!< candidate batch for predictor and pattern evaluation
 
 #if EPZSREF
   MotionVector *****p_motion;  //!< Array for storing Motion Vectors
@@ -130,6 +134,32 @@ static inline int add_predictor(MotionVector *cur_mv, MotionVector prd_mv, int m
   return (*((int*) cur_mv) != 0);
 }
 
+/*!
+***********************************************************************
+* \brief
+*    Add candidate to the batch if it lies within the search window
+*    and was not already tested for the current block (EPZSMap)
+***********************************************************************
+*/
+static inline void EPZS_add_candidate(EPZSParameters *p_EPZS, uint16 **EPZSMap, int mapCenter_x, const MotionVector *center,
+                                      int max_x, int max_y, MotionVector tmv, MEBlock *mv_block, int idx)
+{
+  MECandBatch *batch = p_EPZS->batch;
+
+  if (batch->stats)
+    ++batch->stats->proposed;
+
+  if ((iabs (tmv.mv_x - center->mv_x) <= max_x) && (iabs (tmv.mv_y - center->mv_y) <= max_y))
+  {
+    uint16 *EPZSPoint = &EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x];
+    if (*EPZSPoint != p_EPZS->BlkCount)
+    {
+      *EPZSPoint = p_EPZS->BlkCount;
+      me_batch_push(batch, tmv, pad_MVs (tmv, mv_block), idx);
+    }
+  }
+}
+
 static inline void scale_mv(MotionVector *out_mv, int scale, const MotionVector *mv, int shift_mv)
 {
   out_mv->mv_x = (short) rshift_rnd_sf((scale * mv->mv_x), shift_mv);
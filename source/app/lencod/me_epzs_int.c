@@ -50,6 +50,7 @@ EPZS_integer_motion_estimation (Macroblock * currMB,     // <--  current Macrobl
   VideoParameters *p_Vid = currMB->p_Vid;
   InputParameters *p_Inp = currMB->p_Inp;
   EPZSParameters *p_EPZS = currSlice->p_EPZS;
+  MECandBatch *batch = p_EPZS->batch;
   PicMotionParams **motion = p_Vid->enc_picture->mv_info;
 
   int blocktype = mv_block->blocktype;
@@ -80,6 +81,7 @@ EPZS_integer_motion_estimation (Macroblock * currMB,     // <--  current Macrobl
   ++p_EPZS->BlkCount;
   if (p_EPZS->BlkCount == 0)
     ++p_EPZS->BlkCount;
+  me_batch_new_search (batch);
 
   if (p_Inp->EPZSSpatialMem)
   {
@@ -126,10 +128,9 @@ EPZS_integer_motion_estimation (Macroblock * currMB,     // <--  current Macrobl
     SPoint *p_EPZS_point = p_EPZS->predictor->point;
     Boolean checkMedian = FALSE;
     distblk second_mcost = DISTBLK_MAX;
-    distblk mcost;
     int prednum = 5;
     int conditionEPZS;
-    MotionVector tmp2 = {0, 0}, tmv;
+    MotionVector tmp2 = {0, 0};
     int pos;
     short invalid_refs = 0;
 
@@ -212,46 +213,14 @@ EPZS_integer_motion_estimation (Macroblock * currMB,     // <--  current Macrobl
     if (conditionEPZS && currMB->mbAddrX != 0 && p_Inp->EPZSBlockType)
       EPZSBlockTypePredictorsMB (currSlice, mv_block, p_EPZS_point, &prednum);
 
-    //! Check all predictors
+    //! Gather all predictors into a batch (range check and EPZSMap based duplicate removal)
+    //! and score them in one call
+    me_batch_reset (batch);
     for (pos = 0; pos < prednum; ++pos)
-    {
-      tmv = p_EPZS_point[pos].motion;
-      //if (((iabs (tmv.mv_x - mv->mv_x) > searchRange->max_x || iabs (tmv.mv_y - mv->mv_y) > searchRange->max_y)) && (tmv.mv_x || tmv.mv_y))
-      if ((iabs (tmv.mv_x - mv->mv_x) - searchRange->max_x <= 0) && (iabs (tmv.mv_y - mv->mv_y) - searchRange->max_y <= 0))
-      {
-        EPZSPoint = &EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x];
-        if (*EPZSPoint != p_EPZS->BlkCount)
-        {
-          *EPZSPoint = p_EPZS->BlkCount;
-          cand = pad_MVs (tmv, mv_block);
-
-          //--- set motion cost (cost for motion vector) and check ---
-          mcost = mv_cost (p_Vid, lambda_factor, &cand, &pred);
-
-          if (mcost < second_mcost)
-          {
-            mcost += mv_block->computePredFPel (ref_picture, mv_block, second_mcost - mcost, &cand);
-
-            //--- check if motion cost is less than minimum cost ---
-            if (mcost < min_mcost)
-            {
-              tmp2 = tmp;
-              tmp = tmv;
-              second_mcost = min_mcost;
-              min_mcost = mcost;
-              checkMedian = TRUE;
-            }
-            //else if (mcost < second_mcost && (tmp.mv_x != tmv.mv_x || tmp.mv_y != tmv.mv_y))
-            else if (mcost < second_mcost)
-            {
-              tmp2 = tmv;
-              second_mcost = mcost;
-              checkMedian = TRUE;
-            }
-          }
-        }
-      }
-    }
+      EPZS_add_candidate (p_EPZS, EPZSMap, mapCenter_x, mv, searchRange->max_x, searchRange->max_y, p_EPZS_point[pos].motion, mv_block, pos);
+    me_batch_mv_cost (p_Vid, batch, lambda_factor, &pred, 0);
+    if (me_score_batch (batch, mv_block, ref_picture, &tmp, &min_mcost, &tmp2, &second_mcost))
+      checkMedian = TRUE;
 
     if ((ref > 0 && currSlice->structure == FRAME) && (*prevSad * 3 < min_mcost))
     {  
@@ -309,39 +278,19 @@ EPZS_integer_motion_estimation (Macroblock * currMB,     // <--  current Macrobl
         do
         {
           checkPts = totalCheckPts;
+          me_batch_reset (batch);
           do
           {
-            tmv = add_MVs (center, &(searchPatternF->point[pointNumber].motion));
-
-            if (((iabs (tmv.mv_x - mv->mv_x) - searchRange->max_x) <= 0) && ((iabs (tmv.mv_y - mv->mv_y) - searchRange->max_y) <= 0))
-            {
-              EPZSPoint = &EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x];
-              if (*EPZSPoint != p_EPZS->BlkCount)
-              {
-                *EPZSPoint = p_EPZS->BlkCount;
-                cand = pad_MVs (tmv, mv_block);
-
-                mcost = mv_cost (p_Vid, lambda_factor, &cand, &pred);
-
-                if (mcost < min_mcost)
-                {
-                  mcost += mv_block->computePredFPel (ref_picture, mv_block, min_mcost - mcost, &cand);
-
-                  if (mcost < min_mcost)
-                  {
-                    tmp = tmv;
-                    min_mcost = mcost;
-                    motionDirection = pointNumber;
-                  }
-                }
-              }
-            }
+            EPZS_add_candidate (p_EPZS, EPZSMap, mapCenter_x, mv, searchRange->max_x, searchRange->max_y, add_MVs (center, &(searchPatternF->point[pointNumber].motion)), mv_block, pointNumber);
             ++pointNumber;
             if (pointNumber >= searchPatternF->searchPoints)
               pointNumber -= searchPatternF->searchPoints;
             checkPts--;
           }
           while (checkPts > 0);
+          me_batch_mv_cost (p_Vid, batch, lambda_factor, &pred, 0);
+          if (me_score_batch (batch, mv_block, ref_picture, &tmp, &min_mcost, NULL, NULL))
+            motionDirection = batch->idx[batch->best];
 
           if (nextLast || ((tmp.mv_x == center.mv_x) && (tmp.mv_y == center.mv_y)))
           {
@@ -445,6 +394,7 @@ EPZS_integer_subMB_motion_estimation (Macroblock * currMB,    // <--  current Ma
   VideoParameters *p_Vid = currMB->p_Vid;
   InputParameters *p_Inp = currMB->p_Inp;
   EPZSParameters *p_EPZS = currSlice->p_EPZS;
+  MECandBatch *batch = p_EPZS->batch;
   PicMotionParams **motion = p_Vid->enc_picture->mv_info;
 
   int blocktype = mv_block->blocktype;
@@ -474,6 +424,7 @@ EPZS_integer_subMB_motion_estimation (Macroblock * currMB,    // <--  current Ma
   ++p_EPZS->BlkCount;
   if (p_EPZS->BlkCount == 0)
     ++p_EPZS->BlkCount;
+  me_batch_new_search (batch);
 
   if (p_Inp->EPZSSpatialMem)
   {
@@ -519,12 +470,11 @@ EPZS_integer_subMB_motion_estimation (Macroblock * currMB,    // <--  current Ma
     SPoint *p_EPZS_point = p_EPZS->predictor->point;
     Boolean checkMedian = FALSE;
     distblk second_mcost = DISTBLK_MAX;
-    distblk mcost;
     int prednum = 5;
     int conditionEPZS;
 
-    MotionVector tmv, tmp2 = {0,0};
-    int pos;
+    MotionVector tmp2 = {0,0};
+    int pos, first, last;
 
     stopCriterion = EPZSDetermineStopCriterion (p_EPZS, prevSad, mv_block, lambda_dist);
 
@@ -558,46 +508,24 @@ EPZS_integer_subMB_motion_estimation (Macroblock * currMB,    // <--  current Ma
     if (conditionEPZS && currMB->mbAddrX != 0 && p_Inp->EPZSBlockType)
       EPZSBlockTypePredictors (currSlice, mv_block, p_EPZS_point, &prednum);
 
-    //! Check all predictors
-    for (pos = 0; pos < prednum; ++pos)
+    //! Gather the predictors into batches (range check and EPZSMap based duplicate removal)
+    //! and score them: the first predictor alone, then all others in one call.
+    //! The reference criterion below holds while min_mcost exceeds 3 * prevSad. As
+    //! min_mcost never increases, it fires after the first predictor or not at all.
+    for (first = 0; first < prednum; first = last)
     {
-      tmv = p_EPZS_point[pos].motion;
-      //if (((iabs (tmv.mv_x - mv->mv_x) > searchRange->max_x || iabs (tmv.mv_y - mv->mv_y) > searchRange->max_y)) && (tmv.mv_x || tmv.mv_y))
-      if ((iabs (tmv.mv_x - mv->mv_x) - searchRange->max_x <= 0) && (iabs (tmv.mv_y - mv->mv_y) - searchRange->max_y <= 0))
-      {
-
-        if (EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] != p_EPZS->BlkCount)
-        {
-          EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] = p_EPZS->BlkCount;
+      last = (first == 0) ? 1 : prednum;
 
-          cand = pad_MVs (tmv, mv_block);
+      me_batch_reset (batch);
+      // At this point, let us add an early termination criterion
+      // after checking each predictor. This can help speed up a lot.
+      batch->stop_cost = (3 * stopCriterion) >> 2;
 
-          //--- set motion cost (cost for motion vector) and check ---
-          mcost = mv_cost (p_Vid, lambda_factor, &cand, &pred);
-
-          if (mcost < second_mcost)
-          {
-            mcost += mv_block->computePredFPel (ref_picture, mv_block, second_mcost - mcost, &cand);
-
-            //--- check if motion cost is less than minimum cost ---
-            if (mcost < min_mcost)
-            {
-              tmp2 = tmp;
-              tmp = tmv;
-              second_mcost = min_mcost;
-              min_mcost = mcost;
-              checkMedian = TRUE;
-            }
-            //else if (mcost < second_mcost && (tmp.mv_x != tmv.mv_x || tmp.mv_y != tmv.mv_y))
-            else if (mcost < second_mcost)
-            {
-              tmp2 = tmv;
-              second_mcost = mcost;
-              checkMedian = TRUE;
-            }
-          }
-        }
-      }
+      for (pos = first; pos < last; ++pos)
+        EPZS_add_candidate (p_EPZS, EPZSMap, mapCenter_x, mv, searchRange->max_x, searchRange->max_y, p_EPZS_point[pos].motion, mv_block, pos);
+      me_batch_mv_cost (p_Vid, batch, lambda_factor, &pred, 0);
+      if (me_score_batch (batch, mv_block, ref_picture, &tmp, &min_mcost, &tmp2, &second_mcost))
+        checkMedian = TRUE;
 
       if ((ref > 0 && currSlice->structure == FRAME) && (*prevSad * 3 < min_mcost))
       {  
@@ -612,9 +540,7 @@ EPZS_integer_subMB_motion_estimation (Macroblock * currMB,    // <--  current Ma
         return min_mcost;
       }
 
-      // At this point, let us add an early termination criterion
-      // after checking each predictor. This can help speed up a lot.
-      if (min_mcost < ((3 * stopCriterion) >> 2))
+      if (min_mcost < batch->stop_cost)
       {
 #if EPZSREF
         if (p_Inp->EPZSSpatialMem)
@@ -662,38 +588,19 @@ EPZS_integer_subMB_motion_estimation (Macroblock * currMB,    // <--  current Ma
         do
         {
           checkPts = totalCheckPts;
+          me_batch_reset (batch);
           do
           {
-            tmv = add_MVs (center, &(searchPatternF->point[pointNumber].motion));
-
-            if ((iabs (tmv.mv_x - mv->mv_x) <= searchRange->max_x) && (iabs (tmv.mv_y - mv->mv_y) <= searchRange->max_y))
-            {
-              if (EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] != p_EPZS->BlkCount)
-              {
-                EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] = p_EPZS->BlkCount;
-                cand = pad_MVs(tmv, mv_block);
-
-                mcost = mv_cost (p_Vid, lambda_factor, &cand, &pred);
-                if (mcost < min_mcost)
-                {
-
-                  mcost += mv_block->computePredFPel (ref_picture, mv_block, min_mcost - mcost, &cand);
-
-                  if (mcost < min_mcost)
-                  {
-                    tmp = tmv;
-                    min_mcost = mcost;
-                    motionDirection = pointNumber;
-                  }
-                }
-              }
-            }
+            EPZS_add_candidate (p_EPZS, EPZSMap, mapCenter_x, mv, searchRange->max_x, searchRange->max_y, add_MVs (center, &(searchPatternF->point[pointNumber].motion)), mv_block, pointNumber);
             ++pointNumber;
             if (pointNumber >= searchPatternF->searchPoints)
               pointNumber -= searchPatternF->searchPoints;
             checkPts--;
           }
           while (checkPts > 0);
+          me_batch_mv_cost (p_Vid, batch, lambda_factor, &pred, 0);
+          if (me_score_batch (batch, mv_block, ref_picture, &tmp, &min_mcost, NULL, NULL))
+            motionDirection = batch->idx[batch->best];
 
           if (nextLast || ((tmp.mv_x == center.mv_x) && (tmp.mv_y == center.mv_y)))
           {
@@ -803,6 +710,7 @@ EPZS_integer_bipred_motion_estimation (Macroblock * currMB,      // <--  Current
   VideoParameters *p_Vid = currMB->p_Vid;
   InputParameters *p_Inp = currMB->p_Inp;
   EPZSParameters *p_EPZS = currSlice->p_EPZS;
+  MECandBatch *batch = p_EPZS->batch;
   PicMotionParams **motion = p_Vid->enc_picture->mv_info;
 
   int blocktype = mv_block->blocktype;
@@ -830,6 +738,7 @@ EPZS_integer_bipred_motion_estimation (Macroblock * currMB,      // <--  Current
   ++p_EPZS->BlkCount;
   if (p_EPZS->BlkCount == 0)
     ++p_EPZS->BlkCount;
+  me_batch_new_search (batch);
 
 
   // Clear p_EPZS->EPZSMap
@@ -851,9 +760,8 @@ EPZS_integer_bipred_motion_estimation (Macroblock * currMB,      // <--  Current
     SPoint *p_EPZS_point = p_EPZS->predictor->point;
     Boolean checkMedian = FALSE;
     distblk second_mcost = DISTBLK_MAX;
-    distblk mcost;
     int prednum = 5;
-    MotionVector tmv, tmp2 = { 0, 0 };
+    MotionVector tmp2 = { 0, 0 };
     int pos;
 
     stopCriterion = EPZSDetermineStopCriterion (p_EPZS, prevSad, mv_block, lambda_dist);
@@ -864,47 +772,14 @@ EPZS_integer_bipred_motion_estimation (Macroblock * currMB,      // <--  Current
     //! in terms of performance and could be removed with little penalty if any.
     EPZS_spatial_predictors (p_EPZS, mv_block, list, currMB->list_offset, ref, motion);
 
-    //! Check all predictors
+    //! Gather all predictors into a batch (range check and EPZSMap based duplicate removal)
+    //! and score them in one call
+    me_batch_reset (batch);
     for (pos = 0; pos < prednum; ++pos)
-    {
-      tmv = p_EPZS_point[pos].motion;
-      //if ((iabs (tmv.mv_x - mv1->mv_x) > search_range || iabs (tmv.mv_y - mv1->mv_y) > search_range) && (tmv.mv_x || tmv.mv_y))
-      if (iabs (tmv.mv_x - mv1->mv_x) <= search_range && iabs (tmv.mv_y - mv1->mv_y) <= search_range)
-      {
-        if (EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] != p_EPZS->BlkCount)
-        {
-          EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] = p_EPZS->BlkCount;
-
-          cand1 = pad_MVs (tmv, mv_block);
-
-          //--- set motion cost (cost for motion vector) and check ---
-          mcost  = mv_cost (p_Vid, lambda_factor, &cand1, &pred1);
-          mcost += mv_cost (p_Vid, lambda_factor, &cand2, &pred2);
-
-          if (mcost >= second_mcost)
-            continue;
-
-          mcost += mv_block->computeBiPredFPel (ref_picture1, ref_picture2, mv_block, second_mcost - mcost, &cand1, &cand2);
-
-          //--- check if motion cost is less than minimum cost ---
-          if (mcost < min_mcost)
-          {
-            tmp2 = tmp;
-            tmp = tmv;
-            second_mcost = min_mcost;
-            min_mcost = mcost;
-            checkMedian = TRUE;
-          }
-          //else if (mcost < second_mcost && (tmp.mv_x != tmv.mv_x || tmp.mv_y != tmv.mv_y))
-          else if (mcost < second_mcost)
-          {
-            tmp2 = tmv;
-            second_mcost = mcost;
-            checkMedian = TRUE;
-          }
-        }
-      }
-    }
+      EPZS_add_candidate (p_EPZS, EPZSMap, mapCenter_x, mv1, search_range, search_range, p_EPZS_point[pos].motion, mv_block, pos);
+    me_batch_mv_cost (p_Vid, batch, lambda_factor, &pred1, mv_cost (p_Vid, lambda_factor, &cand2, &pred2));
+    if (me_score_bipred_batch (batch, mv_block, ref_picture1, ref_picture2, &cand2, LIST_0, &tmp, &min_mcost, &tmp2, &second_mcost))
+      checkMedian = TRUE;
 
     //! Refine using EPZS pattern if needed
     //! Note that we are using a conservative threshold method. Threshold
@@ -942,39 +817,19 @@ EPZS_integer_bipred_motion_estimation (Macroblock * currMB,      // <--  Current
         do
         {
           checkPts = totalCheckPts;
+          me_batch_reset (batch);
           do
           {
-            tmv = add_MVs (center1, &(searchPatternF->point[pointNumber].motion));
-
-            if ((iabs (tmv.mv_x - mv1->mv_x) <= search_range) && (iabs (tmv.mv_y - mv1->mv_y) <= search_range))
-            {
-              if (EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] != p_EPZS->BlkCount)
-              {
-                EPZSMap[tmv.mv_y][mapCenter_x + tmv.mv_x] = p_EPZS->BlkCount;
-                cand1 = pad_MVs (tmv, mv_block);
-
-                mcost  = mv_cost (p_Vid, lambda_factor, &cand1, &pred1);
-                mcost += mv_cost (p_Vid, lambda_factor, &cand2, &pred2);
-
-                if (mcost < min_mcost)
-                {
-                  mcost += mv_block->computeBiPredFPel (ref_picture1, ref_picture2, mv_block, min_mcost - mcost, &cand1, &cand2);
-
-                  if (mcost < min_mcost)
-                  {
-                    tmp = tmv;
-                    min_mcost = mcost;
-                    motionDirection = pointNumber;
-                  }
-                }
-              }
-            }
+            EPZS_add_candidate (p_EPZS, EPZSMap, mapCenter_x, mv1, search_range, search_range, add_MVs (center1, &(searchPatternF->point[pointNumber].motion)), mv_block, pointNumber);
             ++pointNumber;
             if (pointNumber >= searchPatternF->searchPoints)
               pointNumber -= searchPatternF->searchPoints;
             checkPts--;
           }
           while (checkPts > 0);
+          me_batch_mv_cost (p_Vid, batch, lambda_factor, &pred1, mv_cost (p_Vid, lambda_factor, &cand2, &pred2));
+          if (me_score_bipred_batch (batch, mv_block, ref_picture1, ref_picture2, &cand2, LIST_0, &tmp, &min_mcost, NULL, NULL))
+            motionDirection = batch->idx[batch->best];
 
           if (nextLast || ((tmp.mv_x == center1.mv_x) && (tmp.mv_y == center1.mv_y)))
           {
@@ -29,19 +29,21 @@
 #include "mv_search.h"
 
 #include "me_hme.h"
+#include "me_hme_threads.h"
 #include "hme_distortion.h"
 #include "resize.h"
 
 #include "wp.h"
 #include "slice.h"
 #include "list_reorder.h"
+#include "profile.h"
 
 
 // private
 static void SetMVFromUpperLevel (Slice *currSlice, int pyr_level);
 static void HMEPicMotionSearch  (Slice *currSlice, MEBlock *mv_block, int *lambda_factor);
-static distblk HMEBlockMotionSearch(MotionVector **p_pic_mv, distblk **p_pic_mcost, distblk **p_pic_mdist, MEBlock *mv_block, int *lambda_factor);
-static distblk HME_EPZSIntPelBlockMotionSearch_Enh (MotionVector *pred_mv, MEBlock *mv_block, MotionVector **pic_mv, distblk **pic_mcost, int lambda_factor);
+static distblk HMEBlockMotionSearch(EPZSParameters *p_EPZS, MotionVector **p_pic_mv, distblk **p_pic_mcost, distblk **p_pic_mdist, MEBlock *mv_block, int *lambda_factor);
+static distblk HME_EPZSIntPelBlockMotionSearch_Enh (EPZSParameters *p_EPZS, MotionVector *pred_mv, MEBlock *mv_block, MotionVector **pic_mv, distblk **pic_mcost, int lambda_factor);
 
 static void prepare_enc_frame_picture_hme (VideoParameters *p_Vid)
 {
@@ -344,6 +346,8 @@ int InitHMEInfo(VideoParameters *p_Vid, InputParameters *p_Inp)
     pHMEInfo->perform_reorder_pass = NULL;
   }
 
+  pHMEInfo->p_threads = hme_threads_create(p_Vid, p_Inp->HMEThreads);
+
   return 0; 
 }
 
@@ -352,6 +356,9 @@ void FreeHMEInfo(VideoParameters *p_Vid)
   HMEInfo_t *pHMEInfo = p_Vid->pHMEInfo;
   if(pHMEInfo)
   {
+    hme_threads_destroy(pHMEInfo->p_threads);
+    pHMEInfo->p_threads = NULL;
+
     if(p_Vid->p_Inp->num_of_views==2)
     {
       if(pHMEInfo->p_orig_img_pointer_layers[0] != pHMEInfo->p_orig_img_pointer_layers[1])
@@ -447,6 +454,7 @@ void HMEResizeSearchRange(VideoParameters *p_Vid, HMEInfo_t *pHMEInfo)
   }
   get_mem2Dshort ((short ***) &EPZSMap, iSearchRangeY, iSearchRangeX);
 	pHMEInfo->pTmpSlice->p_EPZS->EPZSMap = EPZSMap;
+  pHMEInfo->pTmpSlice->p_EPZS->searcharray = iSearchRangeX;
 	
 }
 
@@ -537,7 +545,9 @@ void HMESearch(Slice *currSlice)
   hme_init_mv_block(p_Vid, &mv_block, (short) blocktype);
 
   // Motion estimation for current picture 
+  profile_enter(p_Vid->p_prof, PROF_INT_ME);
   HMEPicMotionSearch (currSlice, &mv_block, lambda_factor);
+  profile_leave(p_Vid->p_prof);
 
   free_mv_block(&mv_block);
 
@@ -838,20 +848,71 @@ void hme_SetSearchRange(MEBlock *mv_block, MotionVector *mv)
     }
 }
 
-void HMELevelMotionSearch(Slice *currSlice, MEBlock *mv_block, int *lambda_factor)
+/*!
+ ************************************************************************
+ * \brief
+ *    HME search of block row "by" of the current level for one reference.
+ *    With a wavefront the search of each block waits for the upper right
+ *    neighbour, so that rows can be searched concurrently with the same
+ *    result as in raster order.
+ * \return
+ *    sum of the block costs of the row
+ ************************************************************************
+ */
+int64 HMERowMotionSearch(Slice *currSlice, EPZSParameters *p_EPZS, MEBlock *mv_block, int by, int *lambda_factor, HMEWavefront *wf, int row)
 {
   VideoParameters *p_Vid = currSlice->p_Vid;
   HMEInfo_t *pHMEInfo = p_Vid->pHMEInfo;
-  distblk **p_pic_mcost; 
-  MotionVector **p_pic_mv;
-  distblk **p_pic_mdist; 
   SearchWindow *currPicSW = pHMEInfo->p_HMESW;
   SearchWindow *currPicSWMin = pHMEInfo->p_HMESWMin;
+  int pyr_level = mv_block->hme_level;
+  int list = mv_block->list;
+  int ref  = mv_block->ref_idx;
+  int blk_width = (pHMEInfo->iImageWidth >> pyr_level) >> 3;
+  MotionVector **p_pic_mv = pHMEInfo->p_hme_mv[pyr_level][list][ref];
+  distblk **p_pic_mcost   = pHMEInfo->p_hme_mcost[pyr_level][list][ref];
+  distblk **p_pic_mdist   = pHMEInfo->p_hme_mdist[pyr_level][list][ref];
+  int64 distortion = 0;
+  int bx;
+
+  for(bx=0; bx<blk_width; bx++)
+  {
+    if (wf)
+      hme_wavefront_wait(wf, row, imin(bx + 2, blk_width));
+
+    //set position;
+    mv_block->pos_x2 = (short) bx;
+    mv_block->pos_y2 = (short) by;
+    mv_block->pos_x = (short) (bx << 3);
+    mv_block->pos_y = (short) (by << 3);
+    mv_block->pos_x_padded = (short) (mv_block->pos_x << 2); // + IMG_PAD_SIZE_X_TIMES4;
+    mv_block->pos_y_padded = (short) (mv_block->pos_y << 2); // + IMG_PAD_SIZE_Y_TIMES4;
+    hme_get_neighbors(mv_block->block, bx, by, blk_width);
+
+    hme_get_original_block(pHMEInfo, pyr_level, mv_block);
+
+    PrepareMEParams(currSlice, mv_block, FALSE, list, ref);
+
+    HMESetSearchRange(currPicSW+ref, pyr_level, &(mv_block->searchRange), currPicSWMin+ref);
+
+    distortion += HMEBlockMotionSearch(p_EPZS, p_pic_mv, p_pic_mcost, p_pic_mdist, mv_block, lambda_factor);
+
+    if (wf)
+      hme_wavefront_done(wf, row, bx + 1);
+  }
+
+  return distortion;
+}
+
+void HMELevelMotionSearch(Slice *currSlice, MEBlock *mv_block, int *lambda_factor)
+{
+  VideoParameters *p_Vid = currSlice->p_Vid;
+  HMEInfo_t *pHMEInfo = p_Vid->pHMEInfo;
 
   int pyr_level = mv_block->hme_level;
 
-  int by, bx;
-  int pic_size_x, pic_size_y;
+  int by;
+  int pic_size_y;
   int list, ref; 
   int numlists  = (currSlice->slice_type == B_SLICE) ? 2 : 1;
 
@@ -864,7 +925,10 @@ void HMELevelMotionSearch(Slice *currSlice, MEBlock *mv_block, int *lambda_facto
      }
   }
 
-  pic_size_x = pHMEInfo->iImageWidth  >> pyr_level;
+  // rows of all references are searched concurrently
+  if (pHMEInfo->p_threads && hme_threads_level_search(pHMEInfo->p_threads, currSlice, mv_block, lambda_factor))
+    return;
+
   pic_size_y = pHMEInfo->iImageHeight >> pyr_level;
   
   for (list = 0; list < numlists; list++)
@@ -879,32 +943,8 @@ void HMELevelMotionSearch(Slice *currSlice, MEBlock *mv_block, int *lambda_facto
        mv_block->ref_idx = (char) ref;
        for(by=0; by<(pic_size_y>>3); by++)
        {
-         for(bx=0; bx<(pic_size_x>>3); bx++)
-         {
-          //set position;
-          mv_block->pos_x2 = (short) bx;
-          mv_block->pos_y2 = (short) by;
-          mv_block->pos_x = (short) (bx << 3);
-          mv_block->pos_y = (short) (by << 3);
-          mv_block->pos_x_padded = (short) (mv_block->pos_x << 2); // + IMG_PAD_SIZE_X_TIMES4;
-          mv_block->pos_y_padded = (short) (mv_block->pos_y << 2); // + IMG_PAD_SIZE_Y_TIMES4;
-          hme_get_neighbors(mv_block->block, bx, by, (pic_size_x>>3));
-
-          hme_get_original_block(pHMEInfo, pyr_level, mv_block);
-
-
-          PrepareMEParams(p_Vid->currentSlice, mv_block, FALSE, list, ref);
-
-          p_pic_mv    = pHMEInfo->p_hme_mv[pyr_level][list][ref];
-          p_pic_mcost = pHMEInfo->p_hme_mcost[pyr_level][list][ref];
-          p_pic_mdist = pHMEInfo->p_hme_mdist[pyr_level][list][ref];
-
-
-          HMESetSearchRange(currPicSW+ref, pyr_level, &(mv_block->searchRange), currPicSWMin+ref);
-
-          pHMEInfo->hme_distortion[pyr_level][list][ref] += HMEBlockMotionSearch(p_pic_mv, p_pic_mcost, p_pic_mdist, mv_block, lambda_factor);
-        }
-      }
+         pHMEInfo->hme_distortion[pyr_level][list][ref] += HMERowMotionSearch(currSlice, currSlice->p_EPZS, mv_block, by, lambda_factor, NULL, 0);
+       }
     }
   }
   
@@ -941,7 +981,7 @@ static void HMEPicMotionSearch(Slice *currSlice, MEBlock *mv_block, int *lambda_
      SetMVFromUpperLevel(currSlice, pyr_level);
      
      mv_block->hme_level = (short) pyr_level;
-     mv_block->hme_ref_size_x_pad = pic_size_x+IMG_PAD_SIZE_X*2;
+     mv_block->hme_ref_size_x_pad = get_pel_stride(pic_size_x, IMG_PAD_SIZE_X);
      mv_block->hme_ref_size_y_pad = pic_size_y+IMG_PAD_SIZE_Y*2;
      mv_block->hme_ref_size_x_max = pic_size_x+IMG_PAD_SIZE_X-mv_block->blocksize_x;
      mv_block->hme_ref_size_y_max = pic_size_y+IMG_PAD_SIZE_Y-mv_block->blocksize_y;
@@ -951,7 +991,7 @@ static void HMEPicMotionSearch(Slice *currSlice, MEBlock *mv_block, int *lambda_
   }
 }
 
-static distblk HMEBlockMotionSearch(MotionVector **p_pic_mv, distblk **p_pic_mcost, distblk **p_pic_mdist, MEBlock *mv_block, int *lambda_factor)
+static distblk HMEBlockMotionSearch(EPZSParameters *p_EPZS, MotionVector **p_pic_mv, distblk **p_pic_mcost, distblk **p_pic_mdist, MEBlock *mv_block, int *lambda_factor)
 {
   VideoParameters *p_Vid = mv_block->p_Vid;
   int list = mv_block->list;
@@ -969,7 +1009,7 @@ static distblk HMEBlockMotionSearch(MotionVector **p_pic_mv, distblk **p_pic_mco
   mv->mv_y = ((pred.mv_y+1)>>2)<<2;
 
   //do integer search;
-  min_mcost = HME_EPZSIntPelBlockMotionSearch_Enh(&pred, mv_block, p_pic_mv, p_pic_mcost, lambda_factor[F_PEL] / 2);
+  min_mcost = HME_EPZSIntPelBlockMotionSearch_Enh(p_EPZS, &pred, mv_block, p_pic_mv, p_pic_mcost, lambda_factor[F_PEL] / 2);
 
   //set the cost and mv;
   p_pic_mv[by][bx] = *mv;
@@ -1120,6 +1160,7 @@ hme_EPZSWindowPredictors (MotionVector * mv, EPZSStructure * predictor, int *pre
 
 static distblk                             //  ==> minimum motion cost after search
 HME_EPZSIntPelBlockMotionSearch_Enh (
+                                     EPZSParameters *p_EPZS,  // <--  EPZS parameters of the searching thread
                                      MotionVector * pred_mv,  // <--  motion vector predictor in sub-pel units
                                      MEBlock * mv_block,      // <--  motion vector information
                                      MotionVector **pic_mv,
@@ -1128,9 +1169,8 @@ HME_EPZSIntPelBlockMotionSearch_Enh (
                                      )
 {
   VideoParameters *p_Vid = mv_block->p_Vid;
-  Slice *currSlice = p_Vid->currentSlice;
+  Slice *currSlice = mv_block->p_Slice;
   InputParameters *p_Inp = p_Vid->p_Inp;
-  EPZSParameters *p_EPZS = currSlice->p_EPZS;
 
   int blocktype = mv_block->blocktype;
 
@@ -1166,6 +1206,8 @@ HME_EPZSIntPelBlockMotionSearch_Enh (
   ++p_EPZS->BlkCount;
   if (p_EPZS->BlkCount == 0)
   {
+    // clear the map, otherwise a stale entry could match the restarted count
+    memset(p_EPZS->EPZSMap[0], 0, p_EPZS->searcharray * p_EPZS->searcharray * sizeof(uint16));
     ++p_EPZS->BlkCount;
   }
 
@@ -20,6 +20,10 @@
 #define _ME_HME_H_
 #include "defines.h"
 
+struct epzs_params;
+struct hme_threads;
+struct hme_wavefront;
+
 typedef enum 
 {
   MECOST_CALC_RDNORM = 0,
@@ -105,6 +109,8 @@ typedef struct hme_info
   int hme_ref_pic_removal_flag[2][MAX_REFERENCE_PICTURES];
   int hme_ref_pic_removal_cnt[2];
 
+  struct hme_threads *p_threads;  //!< concurrent pyramid generation and level search (HMEThreads)
+
   //function;
   distblk (*pf_computeSAD8x8_hme)(StorablePicture *ref1,
                                   MEBlock *mv_block,
@@ -153,6 +159,7 @@ extern void HMEStoreInfo  (VideoParameters *p_Vid, HMEInfo_t *pHMEInfo);
 extern void HMERestoreInfo(VideoParameters *p_Vid, HMEInfo_t *pHMEInfo);
 extern void HMESearch     (Slice *currSlice);
 extern void HMELevelMotionSearch(Slice *currSlice, MEBlock *mv_block, int *lambda_factor);
+extern int64 HMERowMotionSearch(Slice *currSlice, struct epzs_params *p_EPZS, MEBlock *mv_block, int by, int *lambda_factor, struct hme_wavefront *wf, int row);
 extern void hme_get_neighbors(PixelPos *pBlkPos, int bx, int by, int iMaxBlkX);
 extern void hme_get_neighbors2(PixelPos *pBlkPos, int bx, int by, int iMaxBlkX, int iMaxBlkY);
 extern void reduce_ref_pic_with_hme_info(Slice *currSlice, HMEInfo_t *pHMEInfo, int *lambda_factor);
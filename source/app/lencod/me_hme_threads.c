@@ -0,0 +1,442 @@
+/*!
+ *************************************************************************************
+ * \file me_hme_threads.c
+ *
+ * \brief
+ *    Concurrent hierarchical motion estimation.
+ *
+ *    The pool is created with the HME information and lives for the whole
+ *    encoding. A job is split in items that the threads take in increasing
+ *    order, the encoder thread working on the job as well:
+ *     - pyramid levels are built in bands of destination rows,
+ *     - a level search hands out the block rows of all references of the
+ *       level. Every thread searches with its own copy of the block and of
+ *       the EPZS predictors and map; a block waits until the row above has
+ *       finished the block above right of it, so that the spatial
+ *       predictors are the ones of the raster order search.
+ *
+ *************************************************************************************
+ */
+
+#include "global.h"
+#include "memalloc.h"
+#include "resize.h"
+#include "me_epzs_common.h"
+#include "me_hme.h"
+#include "me_hme_threads.h"
+
+//! destination rows of a pyramid level per band
+#define HME_PYR_BAND  16
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Take the next item of the current job (-1 once all are taken)
+ ************************************************************************
+ */
+static int hme_next_item(HMEThreads *p_threads)
+{
+  int item;
+
+  mutex_lock(&p_threads->mutex);
+  item = (p_threads->next_item < p_threads->num_items) ? p_threads->next_item++ : -1;
+  mutex_unlock(&p_threads->mutex);
+
+  return item;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Pool thread: run the jobs until the pool is stopped
+ ************************************************************************
+ */
+static void hme_worker_thread(void *arg)
+{
+  HMEWorker  *worker    = (HMEWorker *) arg;
+  HMEThreads *p_threads = worker->p_threads;
+  int generation = 0;
+
+  mutex_lock(&p_threads->mutex);
+  for (;;)
+  {
+    while (!p_threads->stop && p_threads->generation == generation)
+      cond_wait(&p_threads->cond, &p_threads->mutex);
+    if (p_threads->stop)
+      break;
+    generation = p_threads->generation;
+    mutex_unlock(&p_threads->mutex);
+
+    p_threads->job(p_threads, worker);
+
+    mutex_lock(&p_threads->mutex);
+    if (--p_threads->running == 0)
+      cond_signal(&p_threads->done);
+  }
+  mutex_unlock(&p_threads->mutex);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Run a job of num_items items on the pool and the calling thread
+ ************************************************************************
+ */
+static void hme_threads_run(HMEThreads *p_threads, void (*job)(HMEThreads *, HMEWorker *), int num_items)
+{
+  mutex_lock(&p_threads->mutex);
+  p_threads->job       = job;
+  p_threads->next_item = 0;
+  p_threads->num_items = num_items;
+  p_threads->running   = p_threads->num_workers - 1;
+  ++p_threads->generation;
+  cond_broadcast(&p_threads->cond);
+  mutex_unlock(&p_threads->mutex);
+
+  job(p_threads, &p_threads->workers[0]);
+
+  mutex_lock(&p_threads->mutex);
+  while (p_threads->running)
+    cond_wait(&p_threads->done, &p_threads->mutex);
+  mutex_unlock(&p_threads->mutex);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Reserve the pool, returns 0 if it is already in use
+ ************************************************************************
+ */
+static int hme_threads_acquire(HMEThreads *p_threads)
+{
+  int acquired;
+
+  mutex_lock(&p_threads->mutex);
+  acquired = !p_threads->busy;
+  p_threads->busy = 1;
+  mutex_unlock(&p_threads->mutex);
+
+  return acquired;
+}
+
+static void hme_threads_release(HMEThreads *p_threads)
+{
+  mutex_lock(&p_threads->mutex);
+  p_threads->busy = 0;
+  mutex_unlock(&p_threads->mutex);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Create the pool with num_threads threads (including the caller)
+ * \return
+ *    the pool or NULL if no additional thread could be started
+ ************************************************************************
+ */
+HMEThreads *hme_threads_create(VideoParameters *p_Vid, int num_threads)
+{
+  HMEThreads *p_threads;
+  int i;
+
+  if (num_threads < 2)
+    return NULL;
+
+  if ((p_threads = (HMEThreads *) calloc(1, sizeof(HMEThreads))) == NULL)
+    no_mem_exit("hme_threads_create: p_threads");
+  if ((p_threads->workers = (HMEWorker *) calloc(num_threads, sizeof(HMEWorker))) == NULL)
+    no_mem_exit("hme_threads_create: p_threads->workers");
+
+  p_threads->p_Vid = p_Vid;
+  p_threads->wf.p_threads = p_threads;
+  mutex_init(&p_threads->mutex);
+  cond_init(&p_threads->cond);
+  cond_init(&p_threads->done);
+  cond_init(&p_threads->progress);
+
+  for (i = 0; i < num_threads; i++)
+  {
+    HMEWorker *worker = &p_threads->workers[i];
+
+    worker->p_threads = p_threads;
+    worker->idx = i;
+    get_mem2Dpel(&worker->orig_pic, 1, MB_PIXELS);
+
+    if (i > 0)
+    {
+      worker->threaded = (thread_create(&worker->thread, hme_worker_thread, worker) == 0);
+      if (!worker->threaded)
+      {
+        free_mem2Dpel(worker->orig_pic);
+        break;
+      }
+    }
+    p_threads->num_workers = i + 1;
+  }
+
+  if (p_threads->num_workers < 2)
+  {
+    hme_threads_destroy(p_threads);
+    return NULL;
+  }
+
+  return p_threads;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Stop the threads of the pool and free it
+ ************************************************************************
+ */
+void hme_threads_destroy(HMEThreads *p_threads)
+{
+  int i;
+
+  if (p_threads == NULL)
+    return;
+
+  mutex_lock(&p_threads->mutex);
+  p_threads->stop = 1;
+  cond_broadcast(&p_threads->cond);
+  mutex_unlock(&p_threads->mutex);
+
+  for (i = 0; i < p_threads->num_workers; i++)
+  {
+    HMEWorker *worker = &p_threads->workers[i];
+
+    if (worker->threaded)
+      thread_join(worker->thread);
+    free_mem2Dpel(worker->orig_pic);
+    if (worker->EPZSMap)
+      free_mem2Dshort((short **) worker->EPZSMap);
+    free(worker->points);
+  }
+
+  mutex_destroy(&p_threads->mutex);
+  cond_destroy(&p_threads->cond);
+  cond_destroy(&p_threads->done);
+  cond_destroy(&p_threads->progress);
+
+  free(p_threads->wf.progress);
+  free(p_threads->row_dist);
+  free(p_threads->workers);
+  free(p_threads);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Pyramid level job: filter bands of destination rows
+ ************************************************************************
+ */
+static void hme_pyramid_job(HMEThreads *p_threads, HMEWorker *worker)
+{
+  int item;
+
+  while ((item = hme_next_item(p_threads)) >= 0)
+  {
+    int y0 = item * HME_PYR_BAND;
+    int y1 = imin(y0 + HME_PYR_BAND, p_threads->height >> 1);
+
+    PyrDownG5x5_C1R_Rows(p_threads->src, p_threads->srcstep, p_threads->width, p_threads->height,
+      p_threads->dst, p_threads->dststep, y0, y1);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Build the next (2:1 downsampled) level of an image pyramid; the
+ *    bands of the level are filtered concurrently when the pool is
+ *    available. Strides are in bytes as for PyrDownG5x5_U8CnR().
+ ************************************************************************
+ */
+void hme_pyramid_level(VideoParameters *p_Vid, const imgpel *src, int srcstep, int width, int height, imgpel *dst, int dststep)
+{
+  HMEThreads *p_threads = p_Vid->pHMEInfo ? p_Vid->pHMEInfo->p_threads : NULL;
+
+  if (p_threads && width >= 4 && !(height & 1) && (height >> 1) >= 2 * HME_PYR_BAND && hme_threads_acquire(p_threads))
+  {
+    p_threads->src     = src;
+    p_threads->srcstep = srcstep;
+    p_threads->width   = width;
+    p_threads->height  = height;
+    p_threads->dst     = dst;
+    p_threads->dststep = dststep;
+
+    hme_threads_run(p_threads, hme_pyramid_job, ((height >> 1) + HME_PYR_BAND - 1) / HME_PYR_BAND);
+    hme_threads_release(p_threads);
+  }
+  else
+    PyrDownG5x5_U8CnR(src, srcstep, width, height, dst, dststep, 1);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Wait until row - 1 has searched at least "blocks" blocks
+ *    (the first block row of a reference does not wait)
+ ************************************************************************
+ */
+void hme_wavefront_wait(HMEWavefront *wf, int row, int blocks)
+{
+  HMEThreads *p_threads = wf->p_threads;
+
+  if (row % wf->rows_per_ref == 0)
+    return;
+
+  mutex_lock(&p_threads->mutex);
+  while (wf->progress[row - 1] < blocks)
+  {
+    ++wf->waiting;
+    cond_wait(&p_threads->progress, &p_threads->mutex);
+    --wf->waiting;
+  }
+  mutex_unlock(&p_threads->mutex);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Signal that row has searched "blocks" blocks
+ ************************************************************************
+ */
+void hme_wavefront_done(HMEWavefront *wf, int row, int blocks)
+{
+  HMEThreads *p_threads = wf->p_threads;
+
+  mutex_lock(&p_threads->mutex);
+  wf->progress[row] = blocks;
+  if (wf->waiting)
+    cond_broadcast(&p_threads->progress);
+  mutex_unlock(&p_threads->mutex);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Level search job: search the block rows handed out to the thread
+ ************************************************************************
+ */
+static void hme_search_job(HMEThreads *p_threads, HMEWorker *worker)
+{
+  int rows = p_threads->wf.rows_per_ref;
+  int item;
+
+  while ((item = hme_next_item(p_threads)) >= 0)
+  {
+    int r = item / rows;
+    int list = (r >= p_threads->num_refs[0]);
+
+    worker->mv_block.list    = (char) list;
+    worker->mv_block.ref_idx = (char) (list ? r - p_threads->num_refs[0] : r);
+    p_threads->row_dist[item] = HMERowMotionSearch(p_threads->currSlice, &worker->epzs, &worker->mv_block, item % rows,
+      p_threads->lambda_factor, &p_threads->wf, item);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Set up the private search state of a thread for the level search
+ ************************************************************************
+ */
+static void hme_worker_prepare(HMEWorker *worker, EPZSParameters *p_EPZS, MEBlock *mv_block)
+{
+  EPZSStructure *predictor = p_EPZS->predictor;
+
+  if (worker->searcharray != p_EPZS->searcharray)
+  {
+    if (worker->EPZSMap)
+      free_mem2Dshort((short **) worker->EPZSMap);
+    get_mem2Dshort((short ***) &worker->EPZSMap, p_EPZS->searcharray, p_EPZS->searcharray);
+    worker->searcharray = p_EPZS->searcharray;
+    worker->BlkCount = 0;
+  }
+
+  if (worker->max_points < predictor->searchPoints)
+  {
+    free(worker->points);
+    if ((worker->points = (SPoint *) calloc(predictor->searchPoints, sizeof(SPoint))) == NULL)
+      no_mem_exit("hme_worker_prepare: worker->points");
+    worker->max_points = predictor->searchPoints;
+  }
+
+  worker->predictor       = *predictor;
+  worker->predictor.point = worker->points;
+
+  worker->epzs            = *p_EPZS;
+  worker->epzs.predictor  = &worker->predictor;
+  worker->epzs.EPZSMap    = worker->EPZSMap;
+  worker->epzs.BlkCount   = worker->BlkCount;
+
+  worker->mv_block          = *mv_block;
+  worker->mv_block.orig_pic = worker->orig_pic;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Search the current level for all references concurrently
+ * \return
+ *    0 if the level has to be searched serially
+ ************************************************************************
+ */
+int hme_threads_level_search(HMEThreads *p_threads, Slice *currSlice, MEBlock *mv_block, int *lambda_factor)
+{
+  HMEInfo_t *pHMEInfo = p_threads->p_Vid->pHMEInfo;
+  int pyr_level = mv_block->hme_level;
+  int rows = (pHMEInfo->iImageHeight >> pyr_level) >> 3;
+  int num_items, item, list, ref, by, i;
+
+  if (mv_block->blocksize_x * mv_block->blocksize_y > MB_PIXELS)
+    return 0;
+
+  p_threads->num_refs[0] = currSlice->listXsize[0];
+  p_threads->num_refs[1] = (currSlice->slice_type == B_SLICE) ? currSlice->listXsize[1] : 0;
+  num_items = rows * (p_threads->num_refs[0] + p_threads->num_refs[1]);
+
+  if (num_items < 2 || !hme_threads_acquire(p_threads))
+    return 0;
+
+  if (p_threads->max_items < num_items)
+  {
+    free(p_threads->wf.progress);
+    free(p_threads->row_dist);
+    if ((p_threads->wf.progress = (int *) calloc(num_items, sizeof(int))) == NULL)
+      no_mem_exit("hme_threads_level_search: progress");
+    if ((p_threads->row_dist = (int64 *) calloc(num_items, sizeof(int64))) == NULL)
+      no_mem_exit("hme_threads_level_search: row_dist");
+    p_threads->max_items = num_items;
+  }
+  memset(p_threads->wf.progress, 0, num_items * sizeof(int));
+
+  for (i = 0; i < p_threads->num_workers; i++)
+    hme_worker_prepare(&p_threads->workers[i], currSlice->p_EPZS, mv_block);
+
+  p_threads->currSlice       = currSlice;
+  p_threads->mv_block        = mv_block;
+  p_threads->lambda_factor   = lambda_factor;
+  p_threads->wf.rows_per_ref = rows;
+  p_threads->wf.waiting      = 0;
+
+  hme_threads_run(p_threads, hme_search_job, num_items);
+
+  for (i = 0; i < p_threads->num_workers; i++)
+    p_threads->workers[i].BlkCount = p_threads->workers[i].epzs.BlkCount;
+
+  item = 0;
+  for (list = 0; list < 2; list++)
+  {
+    for (ref = 0; ref < p_threads->num_refs[list]; ref++)
+    {
+      for (by = 0; by < rows; by++)
+        pHMEInfo->hme_distortion[pyr_level][list][ref] += p_threads->row_dist[item++];
+    }
+  }
+
+  hme_threads_release(p_threads);
+
+  return 1;
+}
@@ -0,0 +1,99 @@
+/*!
+ ***************************************************************************
+ * \file
+ *    me_hme_threads.h
+ *
+ * \brief
+ *    Headerfile for the concurrent hierarchical motion estimation.
+ *
+ *    A pool of HMEThreads threads (the encoder thread being one of them)
+ *    builds the levels of the image pyramids in bands of rows and searches
+ *    the block rows of each pyramid level as a wavefront: a block is only
+ *    searched once the block above right of it is done, which keeps the
+ *    spatial predictors and the result identical to the raster order
+ *    search. The rows of all references of a level are handed out in one
+ *    job, so that the threads also work on different references.
+ **************************************************************************
+ */
+
+#ifndef _ME_HME_THREADS_H_
+#define _ME_HME_THREADS_H_
+
+#include "thread_common.h"
+#include "me_epzs_common.h"
+
+struct hme_threads;
+
+//! one thread of the pool with its private search state
+typedef struct hme_worker
+{
+  struct hme_threads *p_threads;
+  int             idx;
+  ThreadHandle    thread;
+  int             threaded;
+
+  MEBlock         mv_block;       //!< copy of the block of the level with its own original block buffer
+  imgpel        **orig_pic;
+  EPZSParameters  epzs;           //!< copy of the EPZS parameters with its own predictors and map
+  EPZSStructure   predictor;
+  SPoint         *points;
+  int             max_points;
+  uint16        **EPZSMap;
+  int             searcharray;
+  uint16          BlkCount;
+} HMEWorker;
+
+//! progress of the rows of a wavefront search
+typedef struct hme_wavefront
+{
+  struct hme_threads *p_threads;
+  int   rows_per_ref;             //!< block rows of one reference
+  int  *progress;                 //!< blocks done per row
+  int   waiting;                  //!< threads waiting for progress
+} HMEWavefront;
+
+typedef struct hme_threads
+{
+  VideoParameters *p_Vid;
+  int          num_workers;       //!< including the encoder thread (worker 0)
+  HMEWorker   *workers;
+
+  ThreadMutex  mutex;
+  ThreadCond   cond;              //!< new job
+  ThreadCond   done;              //!< job finished
+  ThreadCond   progress;          //!< wavefront progress
+  int          generation;        //!< incremented for every job
+  int          running;           //!< threads working on the current job
+  int          busy;              //!< the pool is in use
+  int          stop;
+
+  // current job
+  void       (*job)(struct hme_threads *p_threads, HMEWorker *worker);
+  int          next_item;
+  int          num_items;
+
+  // pyramid level job
+  const imgpel *src;
+  imgpel      *dst;
+  int          srcstep, dststep;
+  int          width, height;
+
+  // search job
+  Slice       *currSlice;
+  MEBlock     *mv_block;
+  int         *lambda_factor;
+  int          num_refs[2];
+  int          max_items;
+  int64       *row_dist;          //!< cost of each row
+  HMEWavefront wf;
+} HMEThreads;
+
+extern HMEThreads *hme_threads_create       (VideoParameters *p_Vid, int num_threads);
+extern void        hme_threads_destroy      (HMEThreads *p_threads);
+extern void        hme_pyramid_level        (VideoParameters *p_Vid, const imgpel *src, int srcstep, int width, int height, imgpel *dst, int dststep);
+extern int         hme_threads_level_search (HMEThreads *p_threads, Slice *currSlice, MEBlock *mv_block, int *lambda_factor);
+
+extern void        hme_wavefront_wait       (HMEWavefront *wf, int row, int blocks);
+extern void        hme_wavefront_done       (HMEWavefront *wf, int row, int blocks);
+
+#endif
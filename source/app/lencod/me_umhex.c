@@ -148,6 +148,7 @@ int UMHEX_get_mem(VideoParameters *p_Vid, InputParameters *p_Inp)
   if (NULL==(p_UMHex->flag_intra = calloc ((p_Vid->width>>4)+1,sizeof(byte)))) no_mem_exit("UMHEX_get_mem: p_UMHex->flag_intra"); //fwf 20050330
 
   memory_size += get_mem2D(&p_UMHex->McostState, 2*search_range+1, 2*search_range+1);
+  memory_size += alloc_me_cand_batch(&p_UMHex->batch, 2*search_range+32, &p_Vid->p_Stats->me_cand);
 
   memory_size += get_mem4Ddistblk(&(p_UMHex->fastme_ref_cost), p_Vid->max_num_references, 9, 4, 4);
   memory_size += get_mem3Ddistblk(&(p_UMHex->fastme_l0_cost), 9, p_Vid->height >> 2, p_Vid->width >> 2);
@@ -174,6 +175,7 @@ void UMHEX_free_mem(VideoParameters *p_Vid, InputParameters *p_Inp)
 {
   UMHexStruct *p_UMHex = p_Vid->p_UMHex;
   free_mem2D(p_UMHex->McostState);
+  free_me_cand_batch(p_UMHex->batch);
 
   free_mem4Ddistblk(p_UMHex->fastme_ref_cost);
   free_mem3Ddistblk(p_UMHex->fastme_l0_cost );
@@ -270,6 +272,7 @@ UMHEXIntegerPelBlockMotionSearch  (Macroblock *currMB,     // <--  current Macro
 
   //////allocate memory for search state//////////////////////////
   memset(p_UMHex->McostState[0],0,(2*p_Inp->search_range[p_Vid->view_id]+1)*(2*p_Inp->search_range[p_Vid->view_id]+1));
+  me_batch_new_search (p_UMHex->batch);
 
 
   //check the center median predictor
@@ -294,19 +297,22 @@ UMHEXIntegerPelBlockMotionSearch  (Macroblock *currMB,     // <--  current Macro
     cand.mv_y = iMinNow.mv_y + Diamond[m].mv_y;
     SEARCH_ONE_PIXEL
   }
+  SCORE_PIXEL_BATCH
 
   if(center.mv_x != pic_pix_x || center.mv_y != pic_pix_y)
   {
     cand.mv_x = pic_pix_x ;
     cand.mv_y = pic_pix_y ;
     SEARCH_ONE_PIXEL
-      iMinNow = best;  
+    SCORE_PIXEL_BATCH
+    iMinNow = best;  
     for (m = 0; m < 4; m++)
     {
       cand.mv_x = iMinNow.mv_x + Diamond[m].mv_x;
       cand.mv_y = iMinNow.mv_y + Diamond[m].mv_y;
       SEARCH_ONE_PIXEL
     }
+    SCORE_PIXEL_BATCH
   }
   /***********************************init process*************************/
   //for multi ref
@@ -355,6 +361,8 @@ UMHEXIntegerPelBlockMotionSearch  (Macroblock *currMB,     // <--  current Macro
     cand.mv_y = (short) (pic_pix_y + (p_UMHex->pred_MV_ref[1] / 4) * 4);
     SEARCH_ONE_PIXEL
   }
+  SCORE_PIXEL_BATCH
+
   // Small local search
   iMinNow = best;
   for (m = 0; m < 4; m++)
@@ -363,6 +371,7 @@ UMHEXIntegerPelBlockMotionSearch  (Macroblock *currMB,     // <--  current Macro
     cand.mv_y = iMinNow.mv_y + Diamond[m].mv_y;
     SEARCH_ONE_PIXEL
   }
+  SCORE_PIXEL_BATCH
 
   //early termination algorithm, refer to JVT-G016
   EARLY_TERMINATION
@@ -395,7 +404,7 @@ sec_step: //Unsymmetrical-cross search
     cand.mv_y = (short) (iMinNow.mv_y - search_step);
     SEARCH_ONE_PIXEL
   }
-
+  SCORE_PIXEL_BATCH
 
   //early termination alogrithm, refer to JVT-G016
   EARLY_TERMINATION
@@ -410,6 +419,7 @@ sec_step: //Unsymmetrical-cross search
     cand.mv_y = iMinNow.mv_y + p_Vid->spiral_qpel_search[pos].mv_y;
     SEARCH_ONE_PIXEL
   }
+  SCORE_PIXEL_BATCH
 
   //early termination alogrithm, refer to JVT-G016
   EARLY_TERMINATION
@@ -429,6 +439,7 @@ sec_step: //Unsymmetrical-cross search
 
       SEARCH_ONE_PIXEL
     }
+    SCORE_PIXEL_BATCH
     // ET_Thd2: early termination Threshold for strong motion
     if(min_mcost < ET_Thred)
     {
@@ -449,6 +460,7 @@ fourth_1_step:  //sub step 1: small Hexagon search
       cand.mv_y = iMinNow.mv_y + Hexagon[m].mv_y;
       SEARCH_ONE_PIXEL
     }
+    SCORE_PIXEL_BATCH
 
     if (best.mv_x == iMinNow.mv_x && best.mv_y == iMinNow.mv_y)
     {
@@ -466,6 +478,7 @@ fourth_2_step: //sub step 2: small Diamond search
       cand.mv_y = iMinNow.mv_y + Diamond[m].mv_y;
       SEARCH_ONE_PIXEL
     }
+    SCORE_PIXEL_BATCH
     if(best.mv_x == iMinNow.mv_x && best.mv_y == iMinNow.mv_y)
       break;
   }
@@ -882,6 +895,7 @@ UMHEXBipredIntegerPelBlockMotionSearch (Macroblock *currMB,      // <--  current
 
   //////allocate memory for search state//////////////////////////
   memset(p_UMHex->McostState[0],0,(2*search_range+1)*(2*search_range+1));
+  me_batch_new_search (p_UMHex->batch);
 
   //check the center median predictor
   best = cand = center2;
@@ -904,12 +918,14 @@ UMHEXBipredIntegerPelBlockMotionSearch (Macroblock *currMB,      // <--  current
     cand.mv_y = iMinNow.mv_y + Diamond[m].mv_y;
     SEARCH_ONE_PIXEL_BIPRED;
   }
+  SCORE_PIXEL_BATCH_BIPRED
 
   if(center2.mv_x != pic_pix_x || center2.mv_y != pic_pix_y)
   {
     cand.mv_x = pic_pix_x ;
     cand.mv_y = pic_pix_y ;
     SEARCH_ONE_PIXEL_BIPRED;
+    SCORE_PIXEL_BATCH_BIPRED
 
     iMinNow = best;
 
@@ -919,6 +935,7 @@ UMHEXBipredIntegerPelBlockMotionSearch (Macroblock *currMB,      // <--  current
       cand.mv_y = iMinNow.mv_y + Diamond[m].mv_y;
       SEARCH_ONE_PIXEL_BIPRED;
     }
+    SCORE_PIXEL_BATCH_BIPRED
   }
   /***********************************init process*************************/
 
@@ -982,6 +999,7 @@ UMHEXBipredIntegerPelBlockMotionSearch (Macroblock *currMB,      // <--  current
     cand.mv_x = (short) (pic_pix_x + (p_UMHex->pred_MV_ref[0] / 4) * 4);
     cand.mv_y = (short) (pic_pix_y + (p_UMHex->pred_MV_ref[1] / 4) * 4);
     SEARCH_ONE_PIXEL_BIPRED;
+    SCORE_PIXEL_BATCH_BIPRED
   }
 
 
@@ -993,6 +1011,7 @@ UMHEXBipredIntegerPelBlockMotionSearch (Macroblock *currMB,      // <--  current
     cand.mv_y = iMinNow.mv_y + Diamond[m].mv_y;
     SEARCH_ONE_PIXEL_BIPRED;
   }
+  SCORE_PIXEL_BATCH_BIPRED
 
   //early termination alogrithm, refer to JVT-G016
   EARLY_TERMINATION;
@@ -1020,6 +1039,7 @@ UMHEXBipredIntegerPelBlockMotionSearch (Macroblock *currMB,      // <--  current
     cand.mv_y = (short) (iMinNow.mv_y - search_step);
     SEARCH_ONE_PIXEL_BIPRED;
   }
+  SCORE_PIXEL_BATCH_BIPRED
   //early termination alogrithm, refer to JVT-G016
   EARLY_TERMINATION;
 
@@ -1032,6 +1052,7 @@ UMHEXBipredIntegerPelBlockMotionSearch (Macroblock *currMB,      // <--  current
     cand.mv_y = iMinNow.mv_y + p_Vid->spiral_qpel_search[pos].mv_y;
     SEARCH_ONE_PIXEL_BIPRED;
   }
+  SCORE_PIXEL_BATCH_BIPRED
 
   //early termination alogrithm, refer to JVT-G016
   EARLY_TERMINATION;      //added back by xxz
@@ -1051,6 +1072,7 @@ UMHEXBipredIntegerPelBlockMotionSearch (Macroblock *currMB,      // <--  current
 
       SEARCH_ONE_PIXEL_BIPRED;
     }
+    SCORE_PIXEL_BATCH_BIPRED
     if(min_mcost < ET_Thred)
     {
       goto terminate_step;
@@ -1069,6 +1091,7 @@ fourth_1_step:
       cand.mv_y = iMinNow.mv_y + Hexagon[m].mv_y;
       SEARCH_ONE_PIXEL_BIPRED;
     }
+    SCORE_PIXEL_BATCH_BIPRED
     if(best.mv_x == iMinNow.mv_x && best.mv_y == iMinNow.mv_y)
       break;
   }
@@ -1083,6 +1106,7 @@ fourth_2_step:
       cand.mv_y = iMinNow.mv_y + Diamond[m].mv_y;
       SEARCH_ONE_PIXEL_BIPRED;
     }
+    SCORE_PIXEL_BATCH_BIPRED
     if(best.mv_x == iMinNow.mv_x && best.mv_y == iMinNow.mv_y)
       break;
   }
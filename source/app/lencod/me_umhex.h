@@ -24,6 +24,8 @@
 #define _ME_UMHEX_H_
 
 #include "mbuffer.h"
+#include "mv_search.h"
+#include "me_candidates.h"
 
 struct umhex_struct {
   float AlphaFourth_1[8];
@@ -36,6 +38,7 @@ struct umhex_struct {
   distblk Multi_Ref_Thd_MB[8];
   distblk Threshold_DSR_MB[8];                    //!<  Threshold for usage of DSR. DSR refer to JVT-Q088
   byte **McostState;                          //!< state for integer pel search
+  MECandBatch *batch;                         //!< candidates of the current integer pel search step
   byte **SearchState;                         //!< state for fractional pel search
   distblk ****fastme_ref_cost;                    //!< store SAD information needed for forward ref-frame prediction
   distblk ***fastme_l0_cost;                      //!< store SAD information needed for forward median and uplayer prediction
@@ -65,47 +68,53 @@ typedef struct umhex_struct UMHexStruct;
   else if((min_mcost - p_UMHex->pred_SAD) < p_UMHex->pred_SAD * betaFourth_1)                                 \
   goto fourth_1_step;
 
+/*!
+ ***********************************************************************
+ * \brief
+ *    Add an integer pel candidate to the UMHEX candidate batch.
+ *    Candidates outside the search range or already visited
+ *    (McostState) are dropped.
+ ***********************************************************************
+ */
+static inline void UMHEX_add_candidate(UMHexStruct *p_UMHex, const MotionVector *center, int search_range, const MotionVector *cand)
+{
+  MECandBatch *batch = p_UMHex->batch;
+  int dx = cand->mv_x - center->mv_x;
+  int dy = cand->mv_y - center->mv_y;
+
+  if (batch->stats)
+    ++batch->stats->proposed;
+
+  if ((iabs(dx) >> 2) < search_range && (iabs(dy) >> 2) < search_range)
+  {
+    byte *state = &p_UMHex->McostState[(dy >> 2) + search_range][(dx >> 2) + search_range];
+    if (!*state)
+    {
+      *state = 1;
+      me_batch_push(batch, *cand, *cand, 0);
+    }
+  }
+}
+
+//! gather one candidate around center
 #define SEARCH_ONE_PIXEL                                                              \
-  if((iabs(cand.mv_x - center.mv_x)>>2) < search_range && (iabs(cand.mv_y - center.mv_y)>>2)< search_range)\
-  {                                                                                   \
-    if(!p_UMHex->McostState[((cand.mv_y - center.mv_y) >> 2)+ search_range][((cand.mv_x-center.mv_x)>>2)+search_range])       \
-    {                                                                                 \
-      mcost = mv_cost (p_Vid, lambda_factor, &cand, &pred);                           \
-      if(mcost<min_mcost)                                                             \
-      {                                                                               \
-        mcost += mv_block->computePredFPel(ref_picture, mv_block,                     \
-        min_mcost - mcost, &cand);                                     \
-        p_UMHex->McostState[((cand.mv_y - center.mv_y) >> 2) + search_range][((cand.mv_x - center.mv_x) >> 2) + search_range] = 1;   \
-        if (mcost < min_mcost)                                                        \
-        {                                                                             \
-          best = cand;                                                                \
-          min_mcost = mcost;                                                          \
-        }                                                                             \
-      }                                                                               \
-    }                                                                                 \
-   }
-
-#define SEARCH_ONE_PIXEL_BIPRED                                                                         \
-if((iabs(cand.mv_x - center2.mv_x) >> 2) < search_range && (iabs(cand.mv_y - center2.mv_y) >> 2) < search_range)     \
-{                                                                                                       \
-  if(!p_UMHex->McostState[((cand.mv_y - center2.mv_y) >> 2) + search_range][((cand.mv_x-center2.mv_x) >> 2)+search_range])         \
-  {                                                                                                     \
-    mcost  = mv_cost (p_Vid, lambda_factor, &center1, &pred1);                                          \
-    mcost += mv_cost (p_Vid, lambda_factor, &cand, &pred2);                                             \
-    if(mcost<min_mcost)                                                                                   \
-    {                                                                                                     \
-      mcost  += mv_block->computeBiPredFPel(ref_picture1, ref_picture2,                                 \
-      mv_block, min_mcost - mcost, &center1, &cand);                                                \
-      p_UMHex->McostState[((cand.mv_y - center2.mv_y) >> 2) + search_range][((cand.mv_x - center2.mv_x) >> 2) + search_range] = 1; \
-      if (mcost < min_mcost)                                                                            \
-      {                                                                                                 \
-        best = cand;                                                                                    \
-        min_mcost = mcost;                                                                              \
-      }                                                                                                 \
-    }                                                                                                   \
-  }                                                                                                     \
-}                                                                                                       \
-
+  UMHEX_add_candidate(p_UMHex, &center, search_range, &cand);
+
+//! score all gathered candidates and start a new batch
+#define SCORE_PIXEL_BATCH                                                             \
+  me_batch_mv_cost (p_Vid, p_UMHex->batch, lambda_factor, &pred, 0);                  \
+  me_score_batch (p_UMHex->batch, mv_block, ref_picture, &best, &min_mcost, NULL, NULL); \
+  me_batch_reset (p_UMHex->batch);
+
+//! gather one candidate around center2 (list of the searched vector)
+#define SEARCH_ONE_PIXEL_BIPRED                                                       \
+  UMHEX_add_candidate(p_UMHex, &center2, search_range, &cand);
+
+//! score all gathered candidates against the fixed vector center1 and start a new batch
+#define SCORE_PIXEL_BATCH_BIPRED                                                      \
+  me_batch_mv_cost (p_Vid, p_UMHex->batch, lambda_factor, &pred2, mv_cost (p_Vid, lambda_factor, &center1, &pred1)); \
+  me_score_bipred_batch (p_UMHex->batch, mv_block, ref_picture1, ref_picture2, &center1, LIST_1, &best, &min_mcost, NULL, NULL); \
+  me_batch_reset (p_UMHex->batch);
 
 extern void UMHEX_DefineThreshold  (VideoParameters *p_Vid);
 extern void UMHEX_DefineThresholdMB(VideoParameters *p_Vid, InputParameters *p_Inp);
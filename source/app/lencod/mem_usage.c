@@ -0,0 +1,104 @@
+/*!
+ *************************************************************************************
+ * \file mem_usage.c
+ *
+ * \brief
+ *    Memory accounting of the encoder by subsystem.
+ *
+ *************************************************************************************
+ */
+
+#include "global.h"
+#include "mem_usage.h"
+
+static const char *mem_category_name[MEM_CATEGORIES] = { "source", "pictures", "motion search", "errdo", "other" };
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Create the memory accounting of an encoder
+ ************************************************************************
+ */
+MemUsage *mem_usage_create(void)
+{
+  MemUsage *p_mem;
+
+  if ((p_mem = (MemUsage *) calloc(1, sizeof(MemUsage))) == NULL)
+    no_mem_exit("mem_usage_create: p_mem");
+  mutex_init(&p_mem->mutex);
+
+  return p_mem;
+}
+
+void mem_usage_free(MemUsage *p_mem)
+{
+  if (p_mem == NULL)
+    return;
+
+  mutex_destroy(&p_mem->mutex);
+  free(p_mem);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Account size bytes (negative: released) to a subsystem
+ * \return
+ *    size, so that the accounting can wrap the get_mem* calls
+ ************************************************************************
+ */
+int mem_usage_add(MemUsage *p_mem, MemCategory category, int size)
+{
+  if (p_mem == NULL)
+    return size;
+
+  mutex_lock(&p_mem->mutex);
+  p_mem->current[category] += size;
+  p_mem->total += size;
+  if (p_mem->current[category] > p_mem->peak[category])
+    p_mem->peak[category] = p_mem->current[category];
+  if (p_mem->total > p_mem->total_peak)
+    p_mem->total_peak = p_mem->total;
+  mutex_unlock(&p_mem->mutex);
+
+  return size;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Bytes currently accounted to all subsystems
+ ************************************************************************
+ */
+int64 mem_usage_total(MemUsage *p_mem)
+{
+  int64 total;
+
+  if (p_mem == NULL)
+    return 0;
+
+  mutex_lock(&p_mem->mutex);
+  total = p_mem->total;
+  mutex_unlock(&p_mem->mutex);
+
+  return total;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Print the peak memory of each subsystem
+ ************************************************************************
+ */
+void mem_usage_report(MemUsage *p_mem)
+{
+  int i;
+
+  if (p_mem == NULL)
+    return;
+
+  fprintf(stdout,  " Peak memory                       : %9.2f MB (", p_mem->total_peak / (1024.0 * 1024.0));
+  for (i = 0; i < MEM_CATEGORIES; ++i)
+    fprintf(stdout, "%s%s %.2f", i ? ", " : "", mem_category_name[i], p_mem->peak[i] / (1024.0 * 1024.0));
+  fprintf(stdout, ")\n");
+}
@@ -0,0 +1,48 @@
+/*!
+ ***************************************************************************
+ * \file
+ *    mem_usage.h
+ *
+ * \brief
+ *    Headerfile for the memory accounting of the encoder.
+ *
+ *    The buffers allocated when the encoder is set up are accounted to a
+ *    subsystem from the sizes returned by the get_mem* functions. The
+ *    reconstructed pictures are accounted when they are allocated and
+ *    freed, so that the peak of the DPB and the coded pictures is known.
+ *    The report is printed with the sequence statistics.
+ **************************************************************************
+ */
+
+#ifndef _MEM_USAGE_H_
+#define _MEM_USAGE_H_
+
+#include "global.h"
+#include "thread_common.h"
+
+typedef enum
+{
+  MEM_SOURCE,          //!< source picture buffers
+  MEM_PICTURES,        //!< reconstructed pictures of the DPB and of the coding passes
+  MEM_MOTION_SEARCH,   //!< fast motion search tables
+  MEM_ERRDO,           //!< decoders simulated by the loss-aware mode decision
+  MEM_OTHER,           //!< other buffers allocated with the encoder
+  MEM_CATEGORIES
+} MemCategory;
+
+typedef struct mem_usage
+{
+  ThreadMutex mutex;                      //!< pictures are allocated by the coding threads as well
+  int64       current[MEM_CATEGORIES];
+  int64       peak[MEM_CATEGORIES];
+  int64       total;
+  int64       total_peak;
+} MemUsage;
+
+extern MemUsage *mem_usage_create (void);
+extern void      mem_usage_free   (MemUsage *p_mem);
+extern int       mem_usage_add    (MemUsage *p_mem, MemCategory category, int size);
+extern int64     mem_usage_total  (MemUsage *p_mem);
+extern void      mem_usage_report (MemUsage *p_mem);
+
+#endif
@@ -294,12 +294,14 @@ void low_delay_ref_management_frame_pic(DecodedPictureBuffer *p_Dpb, int current
 ************************************************************************
 * \brief
 *    POC-based reference management (FRAME)
+*
+*    The commands are stored in p_Vid, which may be the parameters of a
+*    concurrently coded RD picture pass sharing p_Dpb.
 ************************************************************************
 */
 
-void poc_based_ref_management_frame_pic(DecodedPictureBuffer *p_Dpb, int current_pic_num)
+void poc_based_ref_management_frame_pic(VideoParameters *p_Vid, DecodedPictureBuffer *p_Dpb, int current_pic_num)
 {
-  VideoParameters *p_Vid = p_Dpb->p_Vid;
   unsigned i;
   int pic_num = 0;
 
@@ -375,9 +377,8 @@ void poc_based_ref_management_frame_pic(DecodedPictureBuffer *p_Dpb, int current
 ************************************************************************
 */
 
-void poc_based_ref_management_field_pic(DecodedPictureBuffer *p_Dpb, int current_pic_num)
+void poc_based_ref_management_field_pic(VideoParameters *p_Vid, DecodedPictureBuffer *p_Dpb, int current_pic_num)
 {
-  VideoParameters *p_Vid = p_Dpb->p_Vid;
   unsigned int i; 
   int pic_num1 = 0, pic_num2 = 0;
 
@@ -26,6 +26,7 @@
 #include "slice.h"
 #include "conformance.h"
 #include "rdopt.h"
+#include "qp_map.h"
 
 
 /*!
@@ -144,6 +145,18 @@ void init_enc_mb_params(Macroblock* currMB, RD_PARAMS *enc_mb, int intra)
   enc_mb->valid[7]     = (short) (!intra && InterSearch[7] && !(p_Inp->Transform8x8Mode==2));
   enc_mb->valid[P8x8]  = (short) (enc_mb->valid[4] || enc_mb->valid[5] || enc_mb->valid[6] || enc_mb->valid[7]);
 
+  // low priority macroblocks: skip, 16x16 and intra 16x16 only
+  if (qp_map_fast_mb(currMB))
+  {
+    for (l = 2; l < 8; ++l)
+      enc_mb->valid[l] = 0;
+    enc_mb->valid[P8x8] = 0;
+    if (enc_mb->valid[I16MB])
+    {
+      enc_mb->valid[I4MB] = 0;
+      enc_mb->valid[I8MB] = 0;
+    }
+  }
 
   if (currSlice->UseRDOQuant && p_Inp->RDOQ_CP_Mode && (p_Vid->qp != p_Vid->masterQP) )  
     RDOQ_update_mode(currSlice, enc_mb);
@@ -197,6 +210,10 @@ void init_enc_mb_params(Macroblock* currMB, RD_PARAMS *enc_mb, int intra)
     {
       for(k = 0; k < currSlice->listXsize[l]; k++)
       {
+        // frame references keep the adjustment 0 they are allocated with
+        if (currSlice->listX[l][k]->structure == FRAME)
+          continue;
+
         if(currSlice->structure != currSlice->listX[l][k]->structure)
         {
           if (currSlice->structure == TOP_FIELD)
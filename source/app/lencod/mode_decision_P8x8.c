@@ -21,6 +21,7 @@
 #include "q_around.h"
 #include "md_common.h"
 #include "rdopt.h"
+#include "profile.h"
 
 
 void copy_part_info(Info8x8 *b8x8, Info8x8 *part)
@@ -983,7 +984,9 @@ void submacroblock_mode_decision_low(Macroblock *currMB,
     list_mode[0] = (pdir == 0 || pdir == 2 ? mode : 0);
     list_mode[1] = (pdir == 1 || pdir == 2 ? mode : 0);
 
+    profile_enter(p_Vid->p_prof, PROF_TRANSFORM);
     best_cnt_nonz = currSlice->luma_residual_coding_8x8 (currMB, &dummy, &curr_cbp_blk, block, pdir, list_mode, dataTr->part[block].ref);
+    profile_leave(p_Vid->p_prof);
 
     if (currSlice->P444_joined)
     {
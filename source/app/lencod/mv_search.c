@@ -52,6 +52,8 @@
 #include "me_umhex.h"
 #include "me_umhexsmp.h"
 #include "rdoq.h"
+#include "qp_map.h"
+#include "profile.h"
 
 
 static const short bx0[5][4] = {{0,0,0,0}, {0,0,0,0}, {0,0,0,0}, {0,2,0,0}, {0,2,0,2}};
@@ -89,6 +91,15 @@ void get_search_range(MEBlock *mv_block, InputParameters *p_Inp, short ref, int
     searchRange->min_y /= scale;
     searchRange->max_y /= scale;
   }
+
+  // low priority macroblocks search a quarter of the range
+  if (mv_block->reduced_search)
+  {
+    searchRange->min_x /= 4;
+    searchRange->max_x /= 4;
+    searchRange->min_y /= 4;
+    searchRange->max_y /= 4;
+  }
 }
 
 /*!
@@ -717,6 +728,7 @@ void init_mv_block(Macroblock *currMB, MEBlock *mv_block, short blocktype, int l
   mv_block->p_Vid             = p_Vid;
   mv_block->p_Slice           = currSlice;
   mv_block->cost              = INT_MAX;
+  mv_block->reduced_search    = qp_map_fast_mb(currMB);
   mv_block->search_pos2       = 9;
   mv_block->search_pos4       = 9;
 
@@ -957,7 +969,9 @@ BlockMotionSearch (Macroblock *currMB,      //!< Current Macroblock
   clip_mv_range(p_Vid, 0, mv, Q_PEL);
 
   //--- perform motion search ---
+  profile_enter(p_Vid->p_prof, PROF_INT_ME);
   min_mcost = currMB->IntPelME (currMB, &pred, mv_block, min_mcost, lambda_factor[F_PEL]);
+  profile_leave(p_Vid->p_prof);
 
   //==============================
   //=====   SUB-PEL SEARCH   =====
@@ -972,7 +986,9 @@ BlockMotionSearch (Macroblock *currMB,      //!< Current Macroblock
       {
         min_mcost = max_value;
       }
+      profile_enter(p_Vid->p_prof, PROF_SUB_ME);
       min_mcost =  currMB->SubPelME (currMB, &pred, mv_block, min_mcost, lambda_factor);
+      profile_leave(p_Vid->p_prof);
     }
   }
 
@@ -1103,9 +1119,11 @@ static distblk BiPredBlockMotionSearch(Macroblock   *currMB,      //!< Current M
 
     PrepareBiPredMEParams(currSlice, mv_block, mv_block->ChromaMEEnable, iterlist, currMB->list_offset, mv_block->ref_idx);
     // Get bipred mvs for list iterlist given previously computed mvs from other list
+    profile_enter(p_Vid->p_prof, PROF_INT_ME);
     min_mcostbi = currMB->BiPredME (currMB, iterlist, 
       &pred_mv1, &pred_mv2, bi_mv1, bi_mv2, mv_block, 
       (p_Inp->BiPredMESearchRange[p_Vid->view_id] <<2)>>mv_block->iteration_no, min_mcostbi, lambda_factor[F_PEL]);
+    profile_leave(p_Vid->p_prof);
 
     if (mv_block->iteration_no > 0 && (tempmv.mv_x == bi_mv1->mv_x) && (tempmv.mv_y == bi_mv1->mv_y))
     {
@@ -1121,7 +1139,9 @@ static distblk BiPredBlockMotionSearch(Macroblock   *currMB,      //!< Current M
         min_mcostbi = DISTBLK_MAX;
       PrepareBiPredMEParams(currSlice, mv_block, mv_block->ChromaMEEnable, iterlist, currMB->list_offset, mv_block->ref_idx);
 
+      profile_enter(p_Vid->p_prof, PROF_SUB_ME);
       min_mcostbi =  currMB->SubPelBiPredME (currMB, mv_block, iterlist, &pred_mv1, &pred_mv2, bi_mv1, bi_mv2, min_mcostbi, lambda_factor);
+      profile_leave(p_Vid->p_prof);
     }
 
     if (p_Inp->BiPredMESubPel==2)
@@ -1130,7 +1150,9 @@ static distblk BiPredBlockMotionSearch(Macroblock   *currMB,      //!< Current M
         min_mcostbi = DISTBLK_MAX;
       PrepareBiPredMEParams(currSlice, mv_block, mv_block->ChromaMEEnable, iterlist ^ 1, currMB->list_offset, mv_block->ref_idx);
 
+      profile_enter(p_Vid->p_prof, PROF_SUB_ME);
       min_mcostbi =  currMB->SubPelBiPredME (currMB, mv_block, iterlist ^ 1, &pred_mv2, &pred_mv1, bi_mv2, bi_mv1, min_mcostbi, lambda_factor);
+      profile_leave(p_Vid->p_prof);
     }
   }
 
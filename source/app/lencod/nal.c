@@ -75,10 +75,27 @@ int RBSPtoEBSP(byte *NaluBuffer, unsigned char *rbsp, int rbsp_size)
 {
   int j     = 0;
   int count = 0;
-  int i;
+  int i     = 0;
 
-  for(i = 0; i < rbsp_size; i++)
+  while (i < rbsp_size)
   {
+    // eight bytes without a zero byte that do not follow two zero bytes
+    // need no emulation prevention and are copied at once
+    if (count < ZEROBYTES_SHORTSTARTCODE && i + 8 <= rbsp_size)
+    {
+      uint64 word;
+
+      memcpy(&word, &rbsp[i], 8);
+      if (!((word - 0x0101010101010101ULL) & ~word & 0x8080808080808080ULL))
+      {
+        memcpy(&NaluBuffer[j], &word, 8);
+        i += 8;
+        j += 8;
+        count = 0;
+        continue;
+      }
+    }
+
     if(count == ZEROBYTES_SHORTSTARTCODE && !(rbsp[i] & 0xFC))
     {
       NaluBuffer[j] = 0x03;
@@ -90,6 +107,7 @@ int RBSPtoEBSP(byte *NaluBuffer, unsigned char *rbsp, int rbsp_size)
       count++;
     else
       count = 0;
+    i++;
     j++;
   }
 
@@ -81,6 +81,7 @@ struct inp_par_enc
   int enable_inter_view_flag;           //!< Enables inter_view_flag (allows pictures that are to be used for inter-view only prediction)
   double enh_layer_lambda_multiplier;   //!< Weight lambda for enhancement layer
   double enh_layer_me_lambda_multiplier;//!< Weight ME lambda for enhancement layer
+  int MVCViewParallel;                  //!< code the second view of an access unit next to the base view of the next one
 
 #endif
   VideoDataFile   input_file1;          //!< Input video file1
@@ -89,6 +90,7 @@ struct inp_par_enc
   char ReconFile2    [FILE_NAME_SIZE];  //!< Reconstructed Pictures (view 1)
   char TraceFile     [FILE_NAME_SIZE];  //!< Trace Outputs
   char StatsFile     [FILE_NAME_SIZE];  //!< Stats File
+  int  ModuleProfile;                   //!< Time the coding modules, written next to the Stats File
   char QmatrixFile   [FILE_NAME_SIZE];  //!< Q matrix cfg file
   int  ProcessInput;                    //!< Filter Input Sequence
   int  EnableOpenGOP;                   //!< support for open gops.
@@ -102,6 +104,7 @@ struct inp_par_enc
   int adaptive_intra_period;            //!< reinitialize start of intra period
 
   int start_frame;                      //!< Encode sequence starting from Frame start_frame
+  int ReadAheadFrames;                  //!< Number of source frames read ahead by the input reader thread (0: read synchronously)
 
   int enable_32_pulldown;
 
@@ -157,6 +160,7 @@ struct inp_par_enc
   int RDPictureMaxPassBSlice;        //!< Max # of coding passes for B-slice
   int RDPictureDeblocking;           //!< Whether to choose between deblocked and non-deblocked picture
   int RDPictureDirectMode;           //!< Whether to check the other direct mode for B slices
+  int RDPictureParallel;             //!< Code the independent RDPictureDecision passes of a picture concurrently
   int RDPictureFrameQPPSlice;        //!< Whether to check additional frame level QP values for P slices
   int RDPictureFrameQPBSlice;        //!< Whether to check additional frame level QP values for B slices
 
@@ -219,6 +223,7 @@ struct inp_par_enc
   int Distortion[TOTAL_DIST_TYPES];
   double VisualResWavPSNR;
   int SSIMOverlapSize;
+  int DistortionParallel;     //!< compute the SSIM indices of the chroma planes next to the luma plane
   int DistortionYUVtoRGB;
   int CtxAdptLagrangeMult;    //!< context adaptive lagrangian multiplier
   int FastCrIntraDecision;
@@ -226,6 +231,7 @@ struct inp_par_enc
   int nobskip;
   int BiasSkipRDO;
   int ForceTrueRateRDO;
+  int CABACRateEstimation;    //!< table based CABAC rate estimation during RDO
 
 #ifdef _LEAKYBUCKET_
   int  NumberLeakyBuckets;
@@ -235,6 +241,7 @@ struct inp_par_enc
 
   int PicInterlace;           //!< picture adaptive frame/field
   int MbInterlace;            //!< macroblock adaptive frame/field
+  int PicInterlaceParallel;   //!< code the frame of an adaptive frame/field picture next to the fields
   int IntraBottom;            //!< Force Intra Bottom at GOP periods.
 
   // Error resilient RDO parameters
@@ -244,12 +251,15 @@ struct inp_par_enc
   int FirstFrameCorrect;      //!< the first frame is encoded under the assumption that it is always correctly received.
   int NoOfDecoders;
   int ErrorConcealment;       //!< Error concealment method used for loss-aware RDO (0: Copy Concealment)
+  int ErrdoThreads;           //!< Threads simulating the decoders of loss-aware RDO (0/1: serial)
   int RestrictRef;
   int NumFramesInELSubSeq;
 
   int RandomIntraMBRefresh;     //!< Number of pseudo-random intra-MBs per picture
 
   int OnTheFlyFractMCP;         //!< On the fly interpolation mode
+  int LowMemory;                //!< Allocate the sub-pel planes of a reference picture only when it is stored
+  int PlaneMemory;              //!< Allocation backend of the sample planes (MemPlanesBackend)
 
   // Chroma interpolation and buffering
   int ChromaMCBuffer;
@@ -308,6 +318,8 @@ struct inp_par_enc
   int    RCMinQP[NUM_SLICE_TYPES];
   int    RCMaxQP[NUM_SLICE_TYPES];
   int    RCMaxQPChange;
+  int    RCPass;                      //!< two-pass rate control: 0 one pass, 1 first pass, 2 second pass
+  char   RCStatsFile[FILE_NAME_SIZE]; //!< statistics file written by the first pass and read by the second pass
 
   // Motion Estimation related parameters
   int    UseMVLimits;
@@ -355,6 +367,7 @@ struct inp_par_enc
   int HMEEnable;
   int HMEDisableMMCO;
   int PyramidLevels;
+  int HMEThreads;                       //!< Threads building the HME pyramids and searching the HME levels (0/1: serial)
   
   
   // IDR min distance
@@ -390,6 +403,9 @@ struct inp_par_enc
   // Fast Mode Decision
   int EarlySkipEnable;
   int SelectiveIntraEnable;
+  int MDPruning;              //!< mode decision pruning rules (bit mask, see md_prune.h)
+  int MDPruningScale;         //!< threshold scale of the pruning rules in percent
+  int MDPruningAudit;         //!< evaluate the pruning rules without pruning
   int DisposableP;
   int DispPQPOffset;
 
@@ -406,6 +422,13 @@ struct inp_par_enc
   int PreferDispOrder;       //!< Prefer display order when building the prediction structure as opposed to coding order
   int PreferPowerOfTwo;      //!< Prefer prediction structures that have lengths expressed as powers of two
   int FrmStructBufferLength; //!< Number of frames that is populated every time populate_frm_struct is called
+  int LookAheadDepth;        //!< Number of frames analysed ahead of the current frame (0: look-ahead disabled)
+  int SceneCutThreshold;     //!< Scene cut sensitivity of the look-ahead in percent (0: no scene cut detection)
+  int LookAheadBFrames;      //!< Adapt the number of B frames of each prediction structure to the look-ahead costs
+  int MBTree;                //!< Macroblock QP offsets from the propagation of the look-ahead block costs
+  double MBTreeStrength;     //!< QP offset per doubling of the propagated cost of a macroblock
+  char QPMapFile[FILE_NAME_SIZE]; //!< Macroblock QP offsets of each frame (signed bytes in raster order, empty: none)
+  int QPOffsetFastThreshold; //!< Macroblocks with a QP offset of at least this are coded with reduced search (0: off)
   // support for "soft" 3:2 pulldown
   int rc_cpb_size;
   int SEIVUI32Pulldown;                //!< Enable 3:2 pulldown through VUI and SEI metadata signalling. Three methods are supported.
@@ -423,6 +446,7 @@ struct inp_par_enc
   int RDOQ_CP_Mode;
   int RDOQ_CP_MV;
   int RDOQ_Fast;
+  int RDOQ_Prune;
 
   int EnableVUISupport;
   // VUI parameters
@@ -16,6 +16,7 @@
 
 #include "pred_struct.h"
 #include "explicit_seq.h"
+#include "lookahead.h"
 
 #define DEBUG_PRED_STRUCT 0
 
@@ -456,8 +457,12 @@ SeqStructure * init_seq_structure( VideoParameters *p_Vid, InputParameters *p_In
   p_Vid->frm_struct_buffer = imin( p_Vid->frm_struct_buffer, p_Inp->no_frames );
   p_Inp->FrmStructBufferLength = imin( p_Inp->FrmStructBufferLength, p_Inp->no_frames ); 
 
-  p_Inp->FrmStructBufferLength = p_Inp->no_frames;
-  p_Vid->frm_struct_buffer = p_Inp->no_frames;
+  // the look-ahead decisions are taken while the sequence is coded: keep populating the structure in windows
+  if ( !p_Inp->LookAheadDepth )
+  {
+    p_Inp->FrmStructBufferLength = p_Inp->no_frames;
+    p_Vid->frm_struct_buffer = p_Inp->no_frames;
+  }
 
   *memory_size += sizeof( SeqStructure );
 
@@ -477,6 +482,7 @@ SeqStructure * init_seq_structure( VideoParameters *p_Vid, InputParameters *p_In
   p_seq_struct->last_sp_frame            = 0;
   p_seq_struct->last_sp_disp             = 0;
   p_seq_struct->pop_flag                 = 0;
+  p_seq_struct->p_la                     = p_Inp->LookAheadDepth ? la_create( p_Vid, p_Inp ) : NULL;
 
 #if (MVC_EXTENSION_ENABLE)
   p_seq_struct->num_frames_mvc           = p_seq_struct->num_frames * p_Inp->num_of_views; // two views hence twice the buffer size
@@ -519,6 +525,8 @@ SeqStructure * init_seq_structure( VideoParameters *p_Vid, InputParameters *p_In
 
 void free_seq_structure( SeqStructure *p_seq_struct )
 {
+  la_destroy( p_seq_struct->p_la );
+  p_seq_struct->p_la = NULL;
   free_frame_buffer( p_seq_struct->p_frm, p_seq_struct->num_frames );
   p_seq_struct->p_frm = NULL;
 #if (MVC_EXTENSION_ENABLE)
@@ -688,6 +696,11 @@ static int establish_random_access( InputParameters *p_Inp, SeqStructure *p_seq_
     }
   }
   // additional case can be added to insert IDR based on *pre-analysis* and other "pre-scient" tools
+  // scene cuts detected by the look-ahead are coded with the shortest random access structure (a single IDR frame)
+  if ( !is_random_access && la_is_scene_cut( p_seq_struct->p_la, curr_frame ) )
+  {
+    is_random_access = 1;
+  }
 
   return is_random_access;
 }
@@ -2199,6 +2212,11 @@ static int populate_reg_pred_struct_atom( VideoParameters *p_Vid, InputParameter
         break; // the pred_frame loop
       }
     }        
+    // shorten the prediction structure where the look-ahead motion costs make long structures inefficient
+    if ( p_Inp->LookAheadBFrames && p_seq_struct->p_la != NULL )
+    {
+      pred_idx = get_prd_index( p_Inp, p_seq_struct, la_max_prd_length( p_seq_struct->p_la, curr_frame + pred_frame, avail_frames - pred_frame ) );
+    }
     // prediction structure pointer
     p_cur_prd = p_seq_struct->p_prd + pred_idx;
     // populate gop structure from selected structure
@@ -2290,9 +2308,9 @@ static int populate_rnd_acc_pred_struct_atom( VideoParameters *p_Vid, InputParam
   // in the future we have to take care of the avail_frames = 0 case
 
   // select prediction structure for random access
-  if ( !curr_frame && !(p_Inp->EnableIDRGOP) && !(p_Inp->intra_delay) )
+  if ( (!curr_frame || (!no_rnd_acc && la_is_scene_cut( p_seq_struct->p_la, curr_frame ))) && !(p_Inp->EnableIDRGOP) && !(p_Inp->intra_delay) )
   {
-    gop_idx = 0; // force shortest IDR pred struct for first frame
+    gop_idx = 0; // force shortest IDR pred struct for first frame (and look-ahead scene cuts)
   }
   else if ( !curr_frame && !(p_Inp->EnableIDRGOP) && p_Inp->intra_delay )
   {
@@ -138,6 +138,8 @@ typedef struct seq_struct
   PredStructAtom *p_prd; // regular prediction structure
   PredStructAtom *p_gop; // IDR GOPs
   PredStructAtom *p_intra_gop; // Intra GOPs
+
+  struct look_ahead *p_la; // look-ahead analysis (NULL if disabled)
 } SeqStructure;
 
 #endif
@@ -0,0 +1,267 @@
+/*!
+ *************************************************************************************
+ * \file profile.c
+ *
+ * \brief
+ *    Per-module timing of the encoder by slice type and hierarchy layer.
+ *
+ *************************************************************************************
+ */
+
+#include "global.h"
+#include "profile.h"
+
+static const char *prof_module_name[PROF_MODULES] =
+{
+  "other", "input", "interpolation", "integer_me", "subpel_me", "intra", "mode_decision",
+  "transform_quant", "trellis", "entropy", "deblocking", "distortion", "rate_control", "output"
+};
+
+static const char *prof_slice_name[NUM_SLICE_TYPES] = { "P", "B", "I", "SP", "SI" };
+
+//! split the time of the macroblocks timed as a whole like the one of the timed macroblocks
+static void split_untimed_mbs(EncProfile *p)
+{
+  int64 mb_ticks = 0;
+  int i;
+
+  for (i = 0; i < PROF_MODULES; ++i)
+    mb_ticks += p->mb_ticks[i];
+
+  if (mb_ticks > 0)
+  {
+    for (i = 0; i < PROF_MODULES; ++i)
+      p->pic[i].ticks += (int64) ((double) p->untimed_ticks * p->mb_ticks[i] / mb_ticks);
+  }
+  else
+    p->pic[PROF_MODE_DECISION].ticks += p->untimed_ticks;
+
+  memset(p->mb_ticks, 0, sizeof(p->mb_ticks));
+  p->untimed_ticks = 0;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Create the profile of a coding thread
+ ************************************************************************
+ */
+EncProfile *profile_create(void)
+{
+  EncProfile *p;
+
+  if ((p = (EncProfile *) calloc(1, sizeof(EncProfile))) == NULL)
+    no_mem_exit("profile_create: p");
+
+  gettime(&p->start_time);
+  p->start_ticks = p->last = profile_ticks();
+
+  return p;
+}
+
+void profile_free(EncProfile *p)
+{
+  free(p);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Restart the clock of a thread that has been idle, so that the idle
+ *    time is not charged to a module
+ ************************************************************************
+ */
+void profile_resume(EncProfile *p)
+{
+  if (p != NULL)
+    p->last = profile_ticks();
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Charge the time up to now to from and continue timing with to,
+ *    when a thread does work for the profile of another one
+ ************************************************************************
+ */
+void profile_handover(EncProfile *from, EncProfile *to)
+{
+  if (from != NULL)
+    profile_charge(from, profile_ticks());
+  if (to != NULL)
+    to->last = (from != NULL) ? from->last : profile_ticks();
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Add the counters of the picture just finished to its slice type and
+ *    hierarchy layer
+ ************************************************************************
+ */
+void profile_picture_done(EncProfile *p, int type, int layer)
+{
+  int i;
+
+  if (p == NULL)
+    return;
+
+  layer = iClip3(0, PROF_LAYERS - 1, layer);
+  // the time up to the end of the picture belongs to it
+  profile_charge(p, profile_ticks());
+  split_untimed_mbs(p);
+
+  for (i = 0; i < PROF_MODULES; ++i)
+  {
+    p->total[type][layer][i].ticks += p->pic[i].ticks;
+    p->total[type][layer][i].calls += p->pic[i].calls;
+  }
+  ++p->frames[type][layer];
+  memset(p->pic, 0, sizeof(p->pic));
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Merge the profile of a coding thread that has finished into p.
+ *    The counters of a picture the thread has not finished are added to
+ *    the picture being coded by p.
+ ************************************************************************
+ */
+void profile_merge(EncProfile *p, EncProfile *src)
+{
+  int type, layer, i;
+
+  if (p == NULL || src == NULL)
+    return;
+
+  for (i = 0; i < PROF_MODULES; ++i)
+  {
+    p->pic[i].ticks += src->pic[i].ticks;
+    p->pic[i].calls += src->pic[i].calls;
+    p->mb_ticks[i]  += src->mb_ticks[i];
+  }
+  p->untimed_ticks += src->untimed_ticks;
+  for (type = 0; type < NUM_SLICE_TYPES; ++type)
+  {
+    for (layer = 0; layer < PROF_LAYERS; ++layer)
+    {
+      for (i = 0; i < PROF_MODULES; ++i)
+      {
+        p->total[type][layer][i].ticks += src->total[type][layer][i].ticks;
+        p->total[type][layer][i].calls += src->total[type][layer][i].calls;
+      }
+      p->frames[type][layer] += src->frames[type][layer];
+    }
+  }
+
+  memset(src->pic, 0, sizeof(src->pic));
+  memset(src->mb_ticks, 0, sizeof(src->mb_ticks));
+  src->untimed_ticks = 0;
+  memset(src->total, 0, sizeof(src->total));
+  memset(src->frames, 0, sizeof(src->frames));
+}
+
+static void write_counters(FILE *f, ProfCounter *c, double ms_per_tick, const char *indent)
+{
+  int i;
+
+  fprintf(f, "{");
+  for (i = 0; i < PROF_MODULES; ++i)
+  {
+    fprintf(f, "%s\n%s  \"%s\": { \"ms\": %.3f, \"calls\": %" FORMAT_OFF_T " }", i ? "," : "",
+      indent, prof_module_name[i], c[i].ticks * ms_per_tick, c[i].calls);
+  }
+  fprintf(f, "\n%s}", indent);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Write the profile as JSON next to the statistics file
+ *    (stats.dat: stats.profile.json) and print the module times of the
+ *    sequence if print is set
+ ************************************************************************
+ */
+void profile_report(EncProfile *p, char *stats_file, int print)
+{
+  char   name[FILE_NAME_SIZE];
+  char  *ext;
+  FILE  *f;
+  ProfCounter sum[PROF_MODULES];
+  int64  all_ticks = 0;
+  int64  us;
+  double ms_per_tick;
+  TIME_T now;
+  int    type, layer, i, first = 1;
+
+  if (p == NULL)
+    return;
+
+  profile_charge(p, profile_ticks());
+  split_untimed_mbs(p);
+
+  // calibrate the ticks against the timer of the encoder
+  gettime(&now);
+  us = timenorm(1000 * timediff(&p->start_time, &now));
+  ms_per_tick = (p->last > p->start_ticks) ? 0.001 * us / (double) (p->last - p->start_ticks) : 0.0;
+
+  // pictures not finished (flushing the DPB) are only counted in the totals
+  memcpy(sum, p->pic, sizeof(sum));
+  for (type = 0; type < NUM_SLICE_TYPES; ++type)
+  {
+    for (layer = 0; layer < PROF_LAYERS; ++layer)
+    {
+      for (i = 0; i < PROF_MODULES; ++i)
+      {
+        sum[i].ticks += p->total[type][layer][i].ticks;
+        sum[i].calls += p->total[type][layer][i].calls;
+      }
+    }
+  }
+  for (i = 0; i < PROF_MODULES; ++i)
+    all_ticks += sum[i].ticks;
+
+  strncpy(name, (strlen(stats_file) > 0) ? stats_file : "stats.dat", FILE_NAME_SIZE - 1);
+  name[FILE_NAME_SIZE - 1] = '\0';
+  if ((ext = strrchr(name, '.')) != NULL && strpbrk(ext, "/\\") == NULL)
+    *ext = '\0';
+  strncat(name, ".profile.json", FILE_NAME_SIZE - 1 - strlen(name));
+
+  if (print)
+  {
+    fprintf(stdout, " Module profile                    : %s\n", name);
+    for (i = 0; i < PROF_MODULES; ++i)
+    {
+      fprintf(stdout, "   %-16s                : %9.3f sec %5.1f%% %10" FORMAT_OFF_T " calls\n", prof_module_name[i],
+        0.001 * sum[i].ticks * ms_per_tick, all_ticks ? 100.0 * sum[i].ticks / all_ticks : 0.0, sum[i].calls);
+    }
+    fprintf(stdout, "\n");
+  }
+
+  if ((f = fopen(name, "w")) == NULL)
+  {
+    snprintf(errortext, ET_SIZE, "Error open file %s", name);
+    error(errortext, 500);
+  }
+
+  fprintf(f, "{\n  \"ms_per_tick\": %.9g,\n  \"total_ms\": %.3f,\n", ms_per_tick, all_ticks * ms_per_tick);
+  fprintf(f, "  \"modules\": ");
+  write_counters(f, sum, ms_per_tick, "  ");
+  fprintf(f, ",\n  \"pictures\": [");
+  for (type = 0; type < NUM_SLICE_TYPES; ++type)
+  {
+    for (layer = 0; layer < PROF_LAYERS; ++layer)
+    {
+      if (p->frames[type][layer] == 0)
+        continue;
+      fprintf(f, "%s\n    { \"type\": \"%s\", \"layer\": %d, \"frames\": %d,\n      \"modules\": ", first ? "" : ",",
+        prof_slice_name[type], layer, p->frames[type][layer]);
+      write_counters(f, p->total[type][layer], ms_per_tick, "      ");
+      fprintf(f, " }");
+      first = 0;
+    }
+  }
+  fprintf(f, "\n  ]\n}\n");
+  fclose(f);
+}
@@ -0,0 +1,183 @@
+/*!
+ ***************************************************************************
+ * \file
+ *    profile.h
+ *
+ * \brief
+ *    Headerfile for the per-module timing of the encoder.
+ *
+ *    The coding steps are bracketed with profile_enter()/profile_leave().
+ *    The time between two brackets is charged to the innermost module, so
+ *    the module times are exclusive and add up to the time of the thread.
+ *    Reading the clock at every bracket within a macroblock would cost
+ *    more than the steps timed, so the modules within a macroblock are
+ *    timed in one of PROF_MB_PERIOD macroblocks only. The other ones are
+ *    timed as a whole and their time is split like the one of the timed
+ *    macroblocks of the picture. The calls are always counted.
+ *    The times and calls of a picture are added to the totals of its
+ *    slice type and hierarchy layer when the picture is finished. Each
+ *    coding thread keeps its own counters, which are merged when the
+ *    thread has finished its picture, so the totals of concurrent threads
+ *    can exceed the coding time.
+ **************************************************************************
+ */
+
+#ifndef _PROFILE_H_
+#define _PROFILE_H_
+
+#include "global.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+#define PROF_LAYERS     8     //!< hierarchy layers reported separately, deeper layers go to the last one
+#define PROF_MAX_DEPTH  16    //!< nesting depth of the brackets
+#define PROF_MB_PERIOD  8     //!< one of these macroblocks is timed by module
+
+typedef enum
+{
+  PROF_OTHER,          //!< not covered by one of the modules below
+  PROF_INPUT,          //!< reading and converting the source pictures
+  PROF_INTERPOLATION,  //!< sub-pel interpolation of the reference pictures
+  PROF_INT_ME,         //!< integer pel motion search (including HME)
+  PROF_SUB_ME,         //!< sub-pel motion search
+  PROF_INTRA,          //!< intra mode search
+  PROF_MODE_DECISION,  //!< macroblock mode decision and inter RD costs
+  PROF_TRANSFORM,      //!< transform, quantization and reconstruction
+  PROF_TRELLIS,        //!< trellis (RDOQ) quantization
+  PROF_ENTROPY,        //!< entropy coding and rate estimation
+  PROF_DEBLOCK,        //!< deblocking filter
+  PROF_DISTORTION,     //!< picture distortion metrics
+  PROF_RATE_CONTROL,   //!< rate control
+  PROF_OUTPUT,         //!< writing the stream and the reconstructed pictures
+  PROF_MODULES
+} ProfModule;
+
+typedef struct prof_counter
+{
+  int64 ticks;
+  int64 calls;
+} ProfCounter;
+
+typedef struct enc_profile
+{
+  ProfCounter pic[PROF_MODULES];                                    //!< picture being coded
+  ProfCounter total[NUM_SLICE_TYPES][PROF_LAYERS][PROF_MODULES];    //!< finished pictures
+  int         frames[NUM_SLICE_TYPES][PROF_LAYERS];
+  int64       last;                                                 //!< ticks at the last bracket
+  int         depth;
+  byte        stack[PROF_MAX_DEPTH];                                //!< open modules, PROF_OTHER at the bottom
+
+  int64       mb_count;
+  int         timed_mb;                                             //!< in a macroblock timed by module
+  int         untimed_mb;                                           //!< in a macroblock timed as a whole
+  int64       mb_ticks[PROF_MODULES];                               //!< timed macroblocks of the picture
+  int64       untimed_ticks;                                        //!< other macroblocks of the picture
+
+  int64       start_ticks;                                          //!< to convert the ticks to time
+  TIME_T      start_time;
+} EncProfile;
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Time stamp of the profile: the time stamp counter of the CPU where
+ *    available, a monotonic clock otherwise
+ ************************************************************************
+ */
+static inline int64 profile_ticks(void)
+{
+#if (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))) || ((defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)))
+  return (int64) __rdtsc();
+#else
+  TIME_T now;
+  gettime(&now);
+#ifdef _WIN32
+  return (int64) now.QuadPart;
+#else
+  return (int64) now.tv_sec * 1000000 + now.tv_usec;
+#endif
+#endif
+}
+
+//! charge the time since the last bracket to the innermost open module
+static inline void profile_charge(EncProfile *p, int64 now)
+{
+  int64 ticks = now - p->last;
+
+  p->pic[p->stack[p->depth]].ticks += ticks;
+  if (p->timed_mb)
+    p->mb_ticks[p->stack[p->depth]] += ticks;
+  p->last = now;
+}
+
+static inline void profile_enter(EncProfile *p, ProfModule module)
+{
+  if (p != NULL)
+  {
+    if (!p->untimed_mb)
+      profile_charge(p, profile_ticks());
+    p->stack[++p->depth] = (byte) module;
+    ++p->pic[module].calls;
+  }
+}
+
+static inline void profile_leave(EncProfile *p)
+{
+  if (p != NULL)
+  {
+    if (!p->untimed_mb)
+      profile_charge(p, profile_ticks());
+    --p->depth;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Bracket the mode decision of a macroblock, which decides whether
+ *    the modules within the macroblock are timed
+ ************************************************************************
+ */
+static inline void profile_enter_mb(EncProfile *p)
+{
+  if (p != NULL)
+  {
+    profile_enter(p, PROF_MODE_DECISION);
+    if (++p->mb_count % PROF_MB_PERIOD)
+      p->untimed_mb = TRUE;
+    else
+      p->timed_mb = TRUE;
+  }
+}
+
+static inline void profile_leave_mb(EncProfile *p)
+{
+  if (p != NULL)
+  {
+    int64 now = profile_ticks();
+
+    if (p->untimed_mb)
+    {
+      p->untimed_ticks += now - p->last;
+      p->last = now;
+    }
+    else
+      profile_charge(p, now);
+    p->timed_mb = p->untimed_mb = FALSE;
+    --p->depth;
+  }
+}
+
+extern EncProfile *profile_create       (void);
+extern void        profile_free         (EncProfile *p);
+extern void        profile_resume       (EncProfile *p);
+extern void        profile_handover     (EncProfile *from, EncProfile *to);
+extern void        profile_picture_done (EncProfile *p, int type, int layer);
+extern void        profile_merge        (EncProfile *p, EncProfile *src);
+extern void        profile_report       (EncProfile *p, char *stats_file, int print);
+
+#endif
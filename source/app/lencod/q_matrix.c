@@ -166,8 +166,6 @@ static const int dequant_coef8[6][8][8] =
 };
 
 
-int matrix4x4_check[6] = {0, 0, 0, 0, 0, 0};
-int matrix8x8_check[6] = {0, 0, 0, 0, 0, 0};
 
 static const char MatrixType4x4[6][20] =
 {
@@ -374,13 +372,13 @@ static void ParseMatrix (VideoParameters *p_Vid, char *buf, int bufsize)
     {
       range = 16;
       ScalingList = p_QScale->ScalingList4x4input[MapIdx];
-      matrix4x4_check[MapIdx] = 1; //to indicate matrix found in cfg file
+      p_QScale->matrix4x4_check[MapIdx] = 1; //to indicate matrix found in cfg file
     }
     else //8x8 matrix
     {
       range = 64;
       ScalingList = p_QScale->ScalingList8x8input[MapIdx];
-      matrix8x8_check[MapIdx] = 1; //to indicate matrix found in cfg file
+      p_QScale->matrix8x8_check[MapIdx] = 1; //to indicate matrix found in cfg file
     }
 
     for(j=0; j<range; j++)
@@ -416,7 +414,7 @@ static void PatchMatrix(VideoParameters *p_Vid, InputParameters *p_Inp)
     if(p_Inp->ScalingListPresentFlag[i])
     {
       ScalingList = p_QScale->ScalingList4x4input[i];
-      if(matrix4x4_check[i])
+      if(p_QScale->matrix4x4_check[i])
       {
         fail=0;
         for(cnt=0; cnt<16; cnt++)
@@ -451,7 +449,7 @@ static void PatchMatrix(VideoParameters *p_Vid, InputParameters *p_Inp)
     if(p_Inp->ScalingListPresentFlag[i+6])
     {
       ScalingList = p_QScale->ScalingList8x8input[i];
-      if(matrix8x8_check[i])
+      if(p_QScale->matrix8x8_check[i])
       {
         fail=0;
         for(cnt=0; cnt<64; cnt++)
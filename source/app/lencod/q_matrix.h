@@ -23,6 +23,9 @@ struct scaling_list {
 
   short UseDefaultScalingMatrix4x4Flag[6];
   short UseDefaultScalingMatrix8x8Flag[6];
+
+  int   matrix4x4_check[6];               //!< matrix found in the matrix file
+  int   matrix8x8_check[6];
 };
 
 extern void init_qmatrix (VideoParameters *p_Vid, InputParameters *p_Inp);
@@ -18,9 +18,6 @@ extern char *GetConfigFileContent (char *Filename, int error_type);
 
 #define MAX_ITEMS_TO_PARSE  2000
 
-int offset4x4_check[15] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-int offset8x8_check[15] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-
 static const char OffsetType4x4[15][24] = {
   "INTRA4X4_LUMA_INTRA",
   "INTRA4X4_CHROMAU_INTRA",
@@ -424,13 +421,11 @@ void ParseQOffsetMatrix (QuantParameters *p_Quant, char *buf, int bufsize)
     {
       range = 16;
       OffsetList = p_Quant->OffsetList4x4input[MapIdx];
-      offset4x4_check[MapIdx] = 1; //to indicate matrix found in cfg file
     }
     else //8x8 matrix
     {
       range = 64;
       OffsetList = p_Quant->OffsetList8x8input[MapIdx];
-      offset8x8_check[MapIdx] = 1; //to indicate matrix found in cfg file
     }
 
     for (j = 0; j < range; j++)
@@ -0,0 +1,86 @@
+/*!
+ *************************************************************************************
+ * \file qp_map.c
+ *
+ * \brief
+ *    Macroblock QP offset map (region of interest).
+ *
+ *    The map of a frame is read from QPMapFile when the frame is set up,
+ *    at frame_no * FrameSizeInMbs bytes, so that the frames may be coded
+ *    in any order. Frames past the end of the file get no offsets from
+ *    the map. The offsets are signed bytes and are added to the MBTree
+ *    offsets of the frame, if any; the sum is clipped to
+ *    +-QP_MAP_MAX_OFFSET.
+ *
+ *************************************************************************************
+ */
+
+#include "global.h"
+#include "qp_map.h"
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Open the QP offset map
+ ************************************************************************
+ */
+QPMap *qp_map_open(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  QPMap *p_map;
+
+  if ((p_map = (QPMap *) calloc(1, sizeof(QPMap))) == NULL)
+    no_mem_exit("qp_map_open: p_map");
+
+  if ((p_map->file = fopen(p_Inp->QPMapFile, "rb")) == NULL)
+  {
+    snprintf(errortext, ET_SIZE, "Error open file %s", p_Inp->QPMapFile);
+    error(errortext, 500);
+  }
+
+  p_map->num_mbs = p_Vid->FrameSizeInMbs;
+  if ((p_map->buf = (signed char *) malloc(p_map->num_mbs * sizeof(signed char))) == NULL)
+    no_mem_exit("qp_map_open: p_map->buf");
+
+  return p_map;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Close the QP offset map
+ ************************************************************************
+ */
+void qp_map_close(QPMap *p_map)
+{
+  if (p_map == NULL)
+    return;
+
+  if (p_map->file != NULL)
+    fclose(p_map->file);
+  free(p_map->buf);
+  free(p_map);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Set the macroblock QP offsets of a frame from the map
+ * \param add
+ *    qp_offset holds offsets (MBTree) the map is added to
+ * \return
+ *    1 if qp_offset holds offsets for the frame
+ ************************************************************************
+ */
+int qp_map_offsets(QPMap *p_map, int frame, int *qp_offset, int add)
+{
+  int i;
+
+  if (frame < 0 || fseek(p_map->file, (long) frame * p_map->num_mbs, SEEK_SET) != 0
+    || fread(p_map->buf, sizeof(signed char), p_map->num_mbs, p_map->file) != (size_t) p_map->num_mbs)
+    return add;
+
+  for (i = 0; i < p_map->num_mbs; ++i)
+    qp_offset[i] = iClip3(-QP_MAP_MAX_OFFSET, QP_MAP_MAX_OFFSET, (add ? qp_offset[i] : 0) + p_map->buf[i]);
+
+  return 1;
+}
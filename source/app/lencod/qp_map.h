@@ -0,0 +1,51 @@
+/*!
+ ***************************************************************************
+ * \file
+ *    qp_map.h
+ *
+ * \brief
+ *    Headerfile for the macroblock QP offset map (region of interest).
+ *
+ *    QPMapFile holds one signed byte per macroblock in raster order for
+ *    each frame in display order. The offsets of a frame are added to the
+ *    macroblock QPs of all its views, on top of the MBTree offsets, and
+ *    the lambdas follow the macroblock QP. Macroblocks with a total offset
+ *    of at least QPOffsetFastThreshold are coded with a reduced search
+ *    range and without the partitions below 16x16.
+ **************************************************************************
+ */
+
+#ifndef _QP_MAP_H_
+#define _QP_MAP_H_
+
+#include "global.h"
+
+#define QP_MAP_MAX_OFFSET 12 //!< largest total macroblock QP offset, keeps the QP steps between macroblocks codable
+
+typedef struct qp_map
+{
+  FILE        *file;
+  int          num_mbs;       //!< entries per frame
+  signed char *buf;           //!< entries of the frame read last
+} QPMap;
+
+extern QPMap *qp_map_open    (VideoParameters *p_Vid, InputParameters *p_Inp);
+extern void   qp_map_close   (QPMap *p_map);
+extern int    qp_map_offsets (QPMap *p_map, int frame, int *qp_offset, int add);
+
+/*!
+ ************************************************************************
+ * \brief
+ *    The macroblock is of low priority: its QP is raised by at least
+ *    QPOffsetFastThreshold
+ ************************************************************************
+ */
+static inline int qp_map_fast_mb(Macroblock *currMB)
+{
+  VideoParameters *p_Vid = currMB->p_Vid;
+  int threshold = currMB->p_Inp->QPOffsetFastThreshold;
+
+  return threshold && p_Vid->use_mb_qp_offset && p_Vid->mb_qp_offset[currMB->mbAddrX] >= threshold;
+}
+
+#endif
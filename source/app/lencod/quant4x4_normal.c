@@ -32,162 +32,122 @@
 /*!
  ************************************************************************
  * \brief
- *    Quantization process for All coefficients for a 4x4 block
+ *    Quantizes and dequantizes all coefficients of a 4x4 block in
+ *    raster order without branches. The levels are stored in raster
+ *    order and a mask of the nonzero levels (bit 4 * j + i) is returned.
  *
  ************************************************************************
  */
-int quant_4x4_normal(Macroblock *currMB, int **tblock, struct quant_methods *q_method)
+static int quant_levels_4x4(int **tblock, int block_x, LevelQuantParams **q_params_4x4, int qp_per, int q_bits, int level_limit, int *levels)
 {
-  VideoParameters *p_Vid = currMB->p_Vid;
-  QuantParameters *p_Quant = p_Vid->p_Quant;
-  Slice *currSlice = currMB->p_Slice;
-  Boolean is_cavlc = (Boolean) (currSlice->symbol_mode == CAVLC);
-
-  int   block_x = q_method->block_x;
-  int  qp = q_method->qp;
-  int*  ACL = &q_method->ACLevel[0];
-  int*  ACR = &q_method->ACRun[0];  
-  LevelQuantParams **q_params_4x4 = q_method->q_params;
-  const byte (*pos_scan)[2] = q_method->pos_scan;
-  const byte *c_cost = q_method->c_cost;
-  int *coeff_cost = q_method->coeff_cost;
-
-  
-  LevelQuantParams *q_params = NULL;
-  int i,j, coeff_ctr;
-
-  int *m7;
-  int scaled_coeff;
+  int i, j;
+  int nz_mask = 0;
 
-  int   level, run = 0;
-  int   nonzero = FALSE;
-  int   qp_per = p_Quant->qp_per_matrix[qp];
-  int   q_bits = Q_BITS + qp_per;
-  const byte *p_scan = &pos_scan[0][0];
-
-  // Quantization
-  for (coeff_ctr = 0; coeff_ctr < 16; ++coeff_ctr)
+  for (j = 0; j < BLOCK_SIZE; ++j)
   {
-    i = *p_scan++;  // horizontal position
-    j = *p_scan++;  // vertical position
-
-    m7 = &tblock[j][block_x + i];
+    int *m7 = &tblock[j][block_x];
+    LevelQuantParams *q_params = q_params_4x4[j];
+    int *lev = &levels[j << 2];
 
-    if (*m7 != 0)
+    for (i = 0; i < BLOCK_SIZE; ++i)
     {
-      q_params = &q_params_4x4[j][i];
-      scaled_coeff = iabs (*m7) * q_params->ScaleComp;
-      level = (scaled_coeff + q_params->OffsetComp) >> q_bits;
-
-      if (level != 0)
-      {
-        if (is_cavlc)
-          level = imin(level, CAVLC_LEVEL_LIMIT);
-
-        *coeff_cost += (level > 1) ? MAX_VALUE : c_cost[run];
-
-        level  = isignab(level, *m7);
-        *m7     = rshift_rnd_sf(((level * q_params->InvScaleComp) << qp_per), 4);
-        // inverse scale can be alternative performed as follows to ensure 16bit
-        // arithmetic is satisfied.
-        // *m7 = (qp_per<4) ? rshift_rnd_sf((level*q_params->InvScaleComp),4-qp_per) : (level*q_params->InvScaleComp)<<(qp_per-4);
-        *ACL++ = level;
-        *ACR++ = run; 
-        // reset zero level counter
-        run    = 0;
-        nonzero = TRUE;        
-      }
-      else
-      {
-        *m7 = 0;
-        ++run;
-      }
+      int level = imin((iabs(m7[i]) * q_params[i].ScaleComp + q_params[i].OffsetComp) >> q_bits, level_limit);
+
+      level   = (m7[i] != 0) ? isignab(level, m7[i]) : 0;
+      lev[i]  = level;
+      m7[i]   = rshift_rnd_sf(((level * q_params[i].InvScaleComp) << qp_per), 4);
+      // inverse scale can be alternative performed as follows to ensure 16bit
+      // arithmetic is satisfied.
+      // m7[i] = (qp_per<4) ? rshift_rnd_sf((level*q_params[i].InvScaleComp),4-qp_per) : (level*q_params[i].InvScaleComp)<<(qp_per-4);
+      nz_mask |= (level != 0) << ((j << 2) + i);
     }
-    else
-    {
-      ++run;
-    } 
   }
 
-  *ACL = 0;
-
-  return nonzero;
+  return nz_mask;
 }
 
-int quant_ac4x4_normal(Macroblock *currMB, int **tblock, struct quant_methods *q_method)
+/*!
+ ************************************************************************
+ * \brief
+ *    Extracts the levels and runs of a 4x4 block in scan order, starting
+ *    at scan position first, from the raster order levels and nonzero
+ *    mask of quant_levels_4x4()
+ *
+ ************************************************************************
+ */
+static int scan_levels_4x4(const int *levels, int nz_mask, int first, struct quant_methods *q_method)
 {
-  int   block_x = q_method->block_x;
-
-  int   qp = q_method->qp;
   int*  ACL = &q_method->ACLevel[0];
-  int*  ACR = &q_method->ACRun[0]; 
-  LevelQuantParams **q_params_4x4 = q_method->q_params;
-  const byte (*pos_scan)[2] = q_method->pos_scan;
+  int*  ACR = &q_method->ACRun[0];
   const byte *c_cost = q_method->c_cost;
   int *coeff_cost = q_method->coeff_cost;
+  const byte *p_scan = &q_method->pos_scan[first][0];
+  int   coeff_ctr, pos[16];
+  int   scan_mask = 0;
+  int   next = first;
 
-  Boolean is_cavlc = (Boolean) (currMB->p_Slice->symbol_mode == CAVLC);
-  VideoParameters *p_Vid = currMB->p_Vid;
-  QuantParameters *p_Quant = p_Vid->p_Quant;
-  LevelQuantParams *q_params = NULL;
+  // nonzero mask in scan order
+  for (coeff_ctr = first; coeff_ctr < 16; ++coeff_ctr, p_scan += 2)
+  {
+    pos[coeff_ctr] = (p_scan[1] << 2) + p_scan[0];
+    scan_mask |= ((nz_mask >> pos[coeff_ctr]) & 1) << coeff_ctr;
+  }
 
-  int i,j, coeff_ctr;
+  while (scan_mask)
+  {
+    int   k     = ictz(scan_mask);
+    int   level = levels[pos[k]];
+    int   run   = k - next;
 
-  int *m7;
-  int scaled_coeff;
+    *coeff_cost += (iabs(level) > 1) ? MAX_VALUE : c_cost[run];
+    *ACL++ = level;
+    *ACR++ = run;
 
-  int   level, run = 0;
-  int   nonzero = FALSE;  
-  int   qp_per = p_Quant->qp_per_matrix[qp];
-  int   q_bits = Q_BITS + qp_per;
-  const byte *p_scan = &pos_scan[1][0];
+    next = k + 1;
+    scan_mask &= scan_mask - 1;
+  }
 
-  // Quantization
-  for (coeff_ctr = 1; coeff_ctr < 16; ++coeff_ctr)
-  {
-    i = *p_scan++;  // horizontal position
-    j = *p_scan++;  // vertical position
+  *ACL = 0;
 
-    m7 = &tblock[j][block_x + i];
-    if (*m7 != 0)
-    {
-      q_params = &q_params_4x4[j][i];
-      scaled_coeff = iabs (*m7) * q_params->ScaleComp;
-      level = (scaled_coeff + q_params->OffsetComp) >> q_bits;
+  return (ACL != &q_method->ACLevel[0]);
+}
 
-      if (level != 0)
-      {
-        if (is_cavlc)
-          level = imin(level, CAVLC_LEVEL_LIMIT);
+/*!
+ ************************************************************************
+ * \brief
+ *    Quantization process for All coefficients for a 4x4 block
+ *
+ ************************************************************************
+ */
+int quant_4x4_normal(Macroblock *currMB, int **tblock, struct quant_methods *q_method)
+{
+  QuantParameters *p_Quant = currMB->p_Vid->p_Quant;
+  Boolean is_cavlc = (Boolean) (currMB->p_Slice->symbol_mode == CAVLC);
+  int   qp_per = p_Quant->qp_per_matrix[q_method->qp];
+  int   q_bits = Q_BITS + qp_per;
+  int   levels[16];
+  int   nz_mask;
 
-        *coeff_cost += (level > 1) ? MAX_VALUE : c_cost[run];
+  nz_mask = quant_levels_4x4(tblock, q_method->block_x, q_method->q_params, qp_per, q_bits, is_cavlc ? CAVLC_LEVEL_LIMIT : INT_MAX, levels);
 
-        level  = isignab(level, *m7);
-        *m7    = rshift_rnd_sf(((level * q_params->InvScaleComp) << qp_per), 4);
-        // inverse scale can be alternative performed as follows to ensure 16bit
-        // arithmetic is satisfied.
-        // *m7 = (qp_per<4) ? rshift_rnd_sf((level*q_params->InvScaleComp),4-qp_per) : (level*q_params->InvScaleComp)<<(qp_per-4);
-        *ACL++  = level;
-        *ACR++  = run; 
-        // reset zero level counter
-        run     = 0;
-        nonzero = TRUE;
-      }
-      else
-      {
-        *m7 = 0;
-        ++run;        
-      }
-    }
-    else
-    {
-      ++run;
-    }          
-  }
+  return scan_levels_4x4(levels, nz_mask, 0, q_method);
+}
 
-  *ACL = 0;
+int quant_ac4x4_normal(Macroblock *currMB, int **tblock, struct quant_methods *q_method)
+{
+  QuantParameters *p_Quant = currMB->p_Vid->p_Quant;
+  Boolean is_cavlc = (Boolean) (currMB->p_Slice->symbol_mode == CAVLC);
+  int   qp_per = p_Quant->qp_per_matrix[q_method->qp];
+  int   q_bits = Q_BITS + qp_per;
+  int   levels[16];
+  int   nz_mask;
+  int   dc = tblock[0][q_method->block_x];
 
-  return nonzero;
+  // the DC coefficient is quantized separately and left untouched
+  nz_mask = quant_levels_4x4(tblock, q_method->block_x, q_method->q_params, qp_per, q_bits, is_cavlc ? CAVLC_LEVEL_LIMIT : INT_MAX, levels);
+  tblock[0][q_method->block_x] = dc;
+
+  return scan_levels_4x4(levels, nz_mask & ~1, 1, q_method);
 }
  
 /*!
@@ -30,6 +30,7 @@
 #include "q_matrix.h"
 #include "quant4x4.h"
 #include "rdoq.h"
+#include "profile.h"
 
 /*!
  ************************************************************************
@@ -65,7 +66,9 @@ int quant_4x4_trellis(Macroblock *currMB, int **tblock, struct quant_methods *q_
 
   int levelTrellis[16];
 
+  profile_enter(currMB->p_Vid->p_prof, PROF_TRELLIS);
   currSlice->rdoq_4x4(currMB, tblock, q_method, levelTrellis);
+  profile_leave(currMB->p_Vid->p_prof);
 
   // Quantization
   for (coeff_ctr = 0; coeff_ctr < 16; ++coeff_ctr)
@@ -169,7 +172,8 @@ void rdoq_4x4_CABAC(Macroblock *currMB, int **tblock, struct quant_methods *q_me
   double lambda_md = p_Vid->lambda_rdoq[p_Vid->type][p_Vid->masterQP]; 
 
   noCoeff = init_trellis_data_4x4_CABAC(currMB, tblock, q_method, p_scan, &levelData[0], &kStart, &kStop, LUMA_4x4);
-  estBits = est_write_and_store_CBP_block_bit(currMB, LUMA_4x4);
+  // the coded block flag is only estimated if a level can be nonzero
+  estBits = (noCoeff > 0) ? est_write_and_store_CBP_block_bit(currMB, LUMA_4x4) : 0;
   est_writeRunLevel_CABAC(currMB, levelData, levelTrellis, LUMA_4x4, lambda_md, kStart, kStop, noCoeff, estBits);
 }
 
@@ -207,7 +211,9 @@ int quant_ac4x4_trellis(Macroblock *currMB, int **tblock, struct quant_methods *
 
   int levelTrellis[16]; 
 
+  profile_enter(currMB->p_Vid->p_prof, PROF_TRELLIS);
   currSlice->rdoq_ac4x4(currMB, tblock, q_method, levelTrellis);
+  profile_leave(currMB->p_Vid->p_prof);
 
   // Quantization
   for (coeff_ctr = 1; coeff_ctr < 16; coeff_ctr++)
@@ -314,7 +320,8 @@ void rdoq_ac4x4_CABAC(Macroblock *currMB, int **tblock, struct quant_methods *q_
   int kStart = 0, kStop = 0, noCoeff = 0, estBits;
 
   noCoeff = init_trellis_data_4x4_CABAC(currMB, tblock, q_method, p_scan, &levelData[0], &kStart, &kStop, type);
-  estBits = est_write_and_store_CBP_block_bit(currMB, type);
+  // the coded block flag is only estimated if a level can be nonzero
+  estBits = (noCoeff > 0) ? est_write_and_store_CBP_block_bit(currMB, type) : 0;
   est_writeRunLevel_CABAC(currMB, levelData, levelTrellis, type, lambda_md, kStart, kStop, noCoeff, estBits);
 }
 
@@ -345,7 +352,9 @@ int quant_dc4x4_trellis(Macroblock *currMB, int **tblock, int qp, int* DCLevel,
 
   int levelTrellis[16];
 
+  profile_enter(currMB->p_Vid->p_prof, PROF_TRELLIS);
   currSlice->rdoq_dc(currMB, tblock, qp_per, qp_rem, q_params_4x4, pos_scan, levelTrellis, LUMA_16DC);
+  profile_leave(currMB->p_Vid->p_prof);
 
   // Quantization
   for (coeff_ctr = 0; coeff_ctr < 16; coeff_ctr++)
@@ -427,7 +436,8 @@ void rdoq_dc_CABAC(Macroblock *currMB, int **tblock, int qp_per, int qp_rem, Lev
   int kStart = 0, kStop = 0, noCoeff = 0, estBits;
 
   noCoeff = init_trellis_data_DC_CABAC(currMB, tblock, qp_per, qp_rem, q_params_4x4, p_scan, &levelData[0], &kStart, &kStop);
-  estBits = est_write_and_store_CBP_block_bit(currMB, type);
+  // the coded block flag is only estimated if a level can be nonzero
+  estBits = (noCoeff > 0) ? est_write_and_store_CBP_block_bit(currMB, type) : 0;
   est_writeRunLevel_CABAC(currMB, levelData, levelTrellis, type, lambda_md, kStart, kStop, noCoeff, estBits);
 }
 
@@ -32,80 +32,117 @@
 /*!
  ************************************************************************
  * \brief
- *    Quantization process for All coefficients for a 8x8 block
- *
- * \par Input:
- *
- * \par Output:
+ *    Quantizes and dequantizes all coefficients of a 8x8 block in
+ *    raster order without branches. The levels are stored in raster
+ *    order and a mask of the nonzero levels (bit 8 * j + i) is returned.
  *
  ************************************************************************
  */
-int quant_8x8_normal(Macroblock *currMB, int **tblock, struct quant_methods *q_method)
+static uint64 quant_levels_8x8(int **tblock, int block_x, LevelQuantParams **q_params_8x8, int qp_per, int q_bits, int level_limit, int *levels)
 {
-  VideoParameters *p_Vid = currMB->p_Vid;
-  QuantParameters *p_Quant = p_Vid->p_Quant;
-  int block_x = q_method->block_x;
-  int*  ACLevel = q_method->ACLevel;
-  int*  ACRun   = q_method->ACRun;
-  int  qp = q_method->qp;
-  LevelQuantParams **q_params_8x8 = q_method->q_params;
-  const byte (*pos_scan)[2] = q_method->pos_scan;
-  const byte *c_cost = q_method->c_cost;
-  int *coeff_cost = q_method->coeff_cost;
-
-  int i,j, coeff_ctr;
-
-  int *m7;
-  int scaled_coeff;
-
-  int   level, run = 0;
-  int   nonzero = FALSE;
-  int   qp_per = p_Quant->qp_per_matrix[qp];
-  int   q_bits = Q_BITS_8 + qp_per;
-  const byte *p_scan = &pos_scan[0][0];
-  int*  ACL = &ACLevel[0];
-  int*  ACR = &ACRun[0];
+  int i, j;
+  uint64 nz_mask = 0;
 
-  // Quantization
-  for (coeff_ctr = 0; coeff_ctr < 64; coeff_ctr++)
+  for (j = 0; j < BLOCK_SIZE_8x8; ++j)
   {
-    i = *p_scan++;  // horizontal position
-    j = *p_scan++;  // vertical position
+    int *m7 = &tblock[j][block_x];
+    LevelQuantParams *q_params = q_params_8x8[j];
+    int *lev = &levels[j << 3];
+    int row_mask = 0;
 
-    m7 = &tblock[j][block_x + i];
-    if (*m7 != 0)
-    {
-      scaled_coeff = iabs (*m7) * q_params_8x8[j][i].ScaleComp;
-      level = (scaled_coeff + q_params_8x8[j][i].OffsetComp) >> q_bits;
-
-      if (level != 0)
-      {
-        nonzero = TRUE;
-
-        *coeff_cost += (level > 1) ? MAX_VALUE : c_cost[run];
-
-        level  = isignab(level, *m7);
-        *m7    = rshift_rnd_sf(((level * q_params_8x8[j][i].InvScaleComp) << qp_per), 6);
-        *ACL++ = level;
-        *ACR++ = run; 
-        // reset zero level counter
-        run    = 0;
-      }
-      else
-      {
-        run++;
-        *m7 = 0;
-      }
-    }
-    else
+    for (i = 0; i < BLOCK_SIZE_8x8; ++i)
     {
-      run++;
+      int level = imin((iabs(m7[i]) * q_params[i].ScaleComp + q_params[i].OffsetComp) >> q_bits, level_limit);
+
+      level    = (m7[i] != 0) ? isignab(level, m7[i]) : 0;
+      lev[i]   = level;
+      m7[i]    = rshift_rnd_sf(((level * q_params[i].InvScaleComp) << qp_per), 6);
+      row_mask |= (level != 0) << i;
     }
+    nz_mask |= (uint64) row_mask << (j << 3);
+  }
+
+  return nz_mask;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Maps the raster order levels of quant_levels_8x8() to scan order
+ *    and returns the nonzero mask in scan order
+ *
+ ************************************************************************
+ */
+static uint64 scan_order_8x8(const int *levels, uint64 nz_mask, const byte (*pos_scan)[2], int *scan_levels)
+{
+  const byte *p_scan = &pos_scan[0][0];
+  uint64 scan_mask = 0;
+  int coeff_ctr;
+
+  for (coeff_ctr = 0; coeff_ctr < 64; ++coeff_ctr, p_scan += 2)
+  {
+    int pos = (p_scan[1] << 3) + p_scan[0];
+
+    scan_levels[coeff_ctr] = levels[pos];
+    scan_mask |= ((nz_mask >> pos) & 1) << coeff_ctr;
+  }
+
+  return scan_mask;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Writes the levels and runs of the scan positions [first, first + len)
+ *    selected by scan_mask and terminates the level list
+ *
+ ************************************************************************
+ */
+static void scan_levels_8x8(const int *scan_levels, uint64 scan_mask, int first, int *ACL, int *ACR, const byte *c_cost, int *coeff_cost)
+{
+  int next = first;
+
+  while (scan_mask)
+  {
+    int k     = ictz(scan_mask);
+    int level = scan_levels[k];
+    int run   = k - next;
+
+    *coeff_cost += (iabs(level) > 1) ? MAX_VALUE : c_cost[run];
+    *ACL++ = level;
+    *ACR++ = run;
+
+    next = k + 1;
+    scan_mask &= scan_mask - 1;
   }
 
   *ACL = 0;
+}
 
-  return nonzero;
+/*!
+ ************************************************************************
+ * \brief
+ *    Quantization process for All coefficients for a 8x8 block
+ *
+ * \par Input:
+ *
+ * \par Output:
+ *
+ ************************************************************************
+ */
+int quant_8x8_normal(Macroblock *currMB, int **tblock, struct quant_methods *q_method)
+{
+  QuantParameters *p_Quant = currMB->p_Vid->p_Quant;
+  int  qp_per = p_Quant->qp_per_matrix[q_method->qp];
+  int  q_bits = Q_BITS_8 + qp_per;
+  int  levels[64], scan_levels[64];
+  uint64 scan_mask;
+
+  scan_mask = quant_levels_8x8(tblock, q_method->block_x, q_method->q_params, qp_per, q_bits, INT_MAX, levels);
+  scan_mask = scan_order_8x8(levels, scan_mask, q_method->pos_scan, scan_levels);
+  scan_levels_8x8(scan_levels, scan_mask, 0, q_method->ACLevel, q_method->ACRun, q_method->c_cost, q_method->coeff_cost);
+
+  return (scan_mask != 0);
 }
 
 /*!
@@ -123,80 +160,20 @@ int quant_8x8_normal(Macroblock *currMB, int **tblock, struct quant_methods *q_m
 int quant_8x8cavlc_normal(Macroblock *currMB, int **tblock, struct quant_methods *q_method, int***  cofAC)
 {
   QuantParameters *p_Quant = currMB->p_Vid->p_Quant;
-  int block_x = q_method->block_x;
-
-  int  qp = q_method->qp;
-  LevelQuantParams **q_params_8x8 = q_method->q_params;
-  const byte (*pos_scan)[2] = q_method->pos_scan;
-  const byte *c_cost = q_method->c_cost;
-  int *coeff_cost = q_method->coeff_cost;  
+  int  qp_per = p_Quant->qp_per_matrix[q_method->qp];
+  int  q_bits = Q_BITS_8 + qp_per;
+  int  levels[64], scan_levels[64];
+  uint64 scan_mask;
+  int  k;
 
+  scan_mask = quant_levels_8x8(tblock, q_method->block_x, q_method->q_params, qp_per, q_bits, CAVLC_LEVEL_LIMIT, levels);
+  scan_mask = scan_order_8x8(levels, scan_mask, q_method->pos_scan, scan_levels);
 
-  int i,j, k, coeff_ctr;
-
-  int *m7;
-  int scaled_coeff;  
-
-  int level, runs[4] = { 0 };
-  int nonzero = FALSE; 
-  int qp_per = p_Quant->qp_per_matrix[qp];  
-  int q_bits = Q_BITS_8 + qp_per;
-  const byte *p_scan = &pos_scan[0][0];
-  int*  ACL[4];  
-  int*  ACR[4];
-
+  // each 4x4 CAVLC block takes 16 consecutive scan positions
   for (k = 0; k < 4; k++)
   {
-    ACL[k] = &cofAC[k][0][0];
-    ACR[k] = &cofAC[k][1][0];
+    scan_levels_8x8(scan_levels, scan_mask & ((uint64) 0xFFFF << (k << 4)), k << 4, &cofAC[k][0][0], &cofAC[k][1][0], q_method->c_cost, q_method->coeff_cost);
   }
 
-  // Quantization
-  for (k = 0; k < 4; k++)
-  {
-    for (coeff_ctr = 0; coeff_ctr < 16; coeff_ctr++)
-    {
-      i = *p_scan++;  // horizontal position
-      j = *p_scan++;  // vertical position
-
-      m7 = &tblock[j][block_x + i];
-      if (*m7 != 0)
-      {
-      scaled_coeff = iabs (*m7) * q_params_8x8[j][i].ScaleComp;
-      level = (scaled_coeff + q_params_8x8[j][i].OffsetComp) >> q_bits;
-
-      if (level != 0)
-      {
-        level = imin(level, CAVLC_LEVEL_LIMIT);
-
-        nonzero=TRUE;
-
-        *coeff_cost += (level > 1) ? MAX_VALUE : c_cost[runs[k]];
-
-        level  = isignab(level, *m7);
-        *m7    = rshift_rnd_sf(((level * q_params_8x8[j][i].InvScaleComp) << qp_per), 6);
-
-        *(ACL[k])++ = level;
-        *(ACR[k])++ = runs[k];
-        // reset zero level counter
-        runs[k] = 0;
-      }
-      else
-      {        
-          runs[k]++;
-          *m7 = 0;      
-        }
-      }
-      else
-      {
-        runs[k]++;
-      }
-    }
-  }
-
-  for(k = 0; k < 4; k++)
-    *(ACL[k]) = 0;
-
-  return nonzero;
+  return (scan_mask != 0);
 }
-
@@ -26,6 +26,7 @@
 #include "q_matrix.h"
 #include "quant8x8.h"
 #include "rdoq.h"
+#include "profile.h"
 
 /*!
 ************************************************************************
@@ -111,7 +112,9 @@ int quant_8x8_trellis(Macroblock *currMB, int **tblock, struct quant_methods *q_
   int*  ACR = &ACRun[0];
   int   levelTrellis[64];
 
+  profile_enter(currMB->p_Vid->p_prof, PROF_TRELLIS);
   rdoq_8x8_CABAC(currMB, tblock, block_x, qp_per, qp_rem, q_params_8x8, p_scan, levelTrellis);
+  profile_leave(currMB->p_Vid->p_prof);
 
   // Quantization
   for (coeff_ctr = 0; coeff_ctr < 64; coeff_ctr++)
@@ -190,7 +193,9 @@ int quant_8x8cavlc_trellis(Macroblock *currMB, int **tblock, struct quant_method
 
   int levelTrellis[4][16];
 
+  profile_enter(currMB->p_Vid->p_prof, PROF_TRELLIS);
   rdoq_8x8_CAVLC(currMB, tblock, block_y, block_x, qp_per, qp_rem, q_params_8x8, p_scan, levelTrellis);
+  profile_leave(currMB->p_Vid->p_prof);
 
   for (k = 0; k < 4; k++)
   {
@@ -22,6 +22,7 @@
 #include "quant4x4.h"
 #include "quantChroma.h"
 #include "rdoq.h"
+#include "profile.h"
 
 /*!
  ************************************************************************
@@ -54,7 +55,9 @@ int quant_dc2x2_trellis(Macroblock *currMB, int **tblock, int qp, int* DCLevel,
 
   int levelTrellis[16];
 
+  profile_enter(currMB->p_Vid->p_prof, PROF_TRELLIS);
   currSlice->rdoq_dc_cr(currMB, tblock,qp_per,qp_rem, q_params_4x4, pos_scan, levelTrellis, CHROMA_DC);
+  profile_leave(currMB->p_Vid->p_prof);
 
   m7 = *tblock;
 
@@ -131,7 +134,9 @@ int quant_dc4x2_trellis(Macroblock *currMB, int **tblock, int qp, int* DCLevel,
 
   int levelTrellis[16];
 
+  profile_enter(currMB->p_Vid->p_prof, PROF_TRELLIS);
   currSlice->rdoq_dc_cr(currMB, tblock,qp_per,qp_rem, q_params_4x4,pos_scan, levelTrellis, CHROMA_DC_2x4);
+  profile_leave(currMB->p_Vid->p_prof);
 
   for (coeff_ctr=0; coeff_ctr < 8; coeff_ctr++)
   {
@@ -216,7 +221,8 @@ void rdoq_dc_cr_CABAC(Macroblock *currMB, int **tblock, int qp_per, int qp_rem,
   lambda_md = p_Vid->lambda_rdoq[p_Vid->type][p_Vid->masterQP]; 
 
   noCoeff = init_trellis_data_DC_cr_CABAC(currMB, tblock, qp_per, qp_rem, q_params_4x4, p_scan, &levelData[0], &kStart, &kStop);
-  estBits = est_write_and_store_CBP_block_bit(currMB, type);
+  // the coded block flag is only estimated if a level can be nonzero
+  estBits = (noCoeff > 0) ? est_write_and_store_CBP_block_bit(currMB, type) : 0;
   est_writeRunLevel_CABAC(currMB, levelData, levelTrellis, type, lambda_md, kStart, kStop, noCoeff, estBits);
 }
 
@@ -21,6 +21,8 @@
 
 #include "global.h"
 #include "ratectl.h"
+#include "lookahead.h"
+#include "rc_stats.h"
 
 
 /*!
@@ -314,7 +316,9 @@ void rc_init_frame(VideoParameters *p_Vid, InputParameters *p_Inp)
       rc_copy_quadratic( p_Vid, p_Inp, p_Vid->p_rc_quad_init, p_Vid->p_rc_quad ); // store rate allocation quadratic...    
       rc_copy_generic( p_Vid, p_Vid->p_rc_gen_init, p_Vid->p_rc_gen ); // ...and generic model
     }
-    p_Vid->rc_init_pict_ptr(p_Vid, p_Inp, p_Vid->p_rc_quad, p_Vid->p_rc_gen, 1,0,1, 1.0F);
+    // scale the target bits with the first pass or the look-ahead complexity of the frame (1.0 without either)
+    p_Vid->rc_init_pict_ptr(p_Vid, p_Inp, p_Vid->p_rc_quad, p_Vid->p_rc_gen, 1,0,1, (p_Inp->RCPass == 2)
+      ? rc_stats_rate_factor(p_Vid->p_rc_stats, p_Vid->frame_no) : la_rate_factor(p_Vid->p_pred->p_la, p_Vid->frame_no, p_Vid->type == I_SLICE));
 
     if( p_Vid->active_sps->frame_mbs_only_flag)
       p_Vid->p_rc_gen->TopFieldFlag=0;
@@ -0,0 +1,253 @@
+/*!
+ *************************************************************************************
+ * \file rc_stats.c
+ *
+ * \brief
+ *    Statistics file of the two-pass rate control.
+ *
+ *    Each frame of the first pass is written as
+ *      frame <frame_no> <type> layer <layer> qp <qp> bits <bits> mad <mad> mbs <n>
+ *    followed by n lines "<mad> <bits>" for its macroblocks in raster
+ *    order. The type is P, B, I, p (SP) or i (SI).
+ *
+ *    In the second pass the target bits of a frame are scaled by its share
+ *    of (bits * Qstep) ^ RC_STATS_QCOMP, the complexity of the frame raised
+ *    to the usual compression exponent, relative to the mean share of the
+ *    frames of the same type and temporal layer (the bits of the types and
+ *    layers are already balanced by the rate control model). The factors
+ *    are clipped like the look-ahead factor, with the mean adjusted so that
+ *    the clipped factors of each type and layer still average to one, and
+ *    the scaled target is still bounded by the HRD buffer limits of the
+ *    quadratic model.
+ *
+ *************************************************************************************
+ */
+
+#include <math.h>
+
+#include "global.h"
+#include "ratectl.h"
+#include "rc_stats.h"
+
+static const char rc_stats_slice_type[NUM_SLICE_TYPES] = { 'P', 'B', 'I', 'p', 'i' };
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Read the frames of the first pass and compute their bit shares
+ ************************************************************************
+ */
+static void rc_stats_read(RCStats *p_stats, char *filename)
+{
+  int frame, layer, qp, bits, num_mbs, mad, mb_bits;
+  int num[NUM_SLICE_TYPES][RC_MAX_TEMPORAL_LEVELS] = {{ 0 }};
+  double mean[NUM_SLICE_TYPES][RC_MAX_TEMPORAL_LEVELS] = {{ 0.0 }};
+  double frame_mad;
+  char letter;
+  const char *type;
+  int i, j, iter;
+
+  while (fscanf(p_stats->file, " frame %d %c layer %d qp %d bits %d mad %lf mbs %d", &frame, &letter, &layer, &qp, &bits, &frame_mad, &num_mbs) == 7)
+  {
+    RCStatsFrame *stats;
+
+    if (frame < 0 || (type = memchr(rc_stats_slice_type, letter, NUM_SLICE_TYPES)) == NULL)
+      break;
+
+    for (i = 0; i < num_mbs; ++i)
+    {
+      if (fscanf(p_stats->file, "%d %d", &mad, &mb_bits) != 2)
+        break;
+    }
+    if (i < num_mbs)
+      break;
+
+    if (frame >= p_stats->num_frames)
+    {
+      int num_frames = imax(frame + 1, p_stats->num_frames << 1);
+
+      if ((p_stats->frames = (RCStatsFrame *) realloc(p_stats->frames, num_frames * sizeof(RCStatsFrame))) == NULL)
+        no_mem_exit("rc_stats_read: p_stats->frames");
+      for (i = p_stats->num_frames; i < num_frames; ++i)
+        p_stats->frames[i].type = -1;
+      p_stats->num_frames = num_frames;
+    }
+
+    stats = &p_stats->frames[frame];
+    stats->type   = (int) (type - rc_stats_slice_type);
+    stats->layer  = iClip3(0, RC_MAX_TEMPORAL_LEVELS - 1, layer);
+    stats->qp     = qp;
+    stats->bits   = bits;
+    stats->weight = pow(imax(bits, 0) * QP2Qstep(iClip3(MIN_QP, MAX_QP, qp)), RC_STATS_QCOMP);
+  }
+
+  if (!feof(p_stats->file))
+  {
+    snprintf(errortext, ET_SIZE, "Error reading the rate control statistics file %s", filename);
+    error(errortext, 500);
+  }
+
+  for (frame = 0; frame < p_stats->num_frames; ++frame)
+  {
+    RCStatsFrame *stats = &p_stats->frames[frame];
+
+    if (stats->type >= 0)
+    {
+      mean[stats->type][stats->layer] += stats->weight;
+      ++num[stats->type][stats->layer];
+    }
+  }
+  for (i = 0; i < NUM_SLICE_TYPES; ++i)
+  {
+    for (j = 0; j < RC_MAX_TEMPORAL_LEVELS; ++j)
+    {
+      if (num[i][j])
+        mean[i][j] /= num[i][j];
+    }
+  }
+
+  // the frames far from the mean are clipped: rescale the mean until the factors average to one again
+  for (iter = 0; iter < 8; ++iter)
+  {
+    double sum[NUM_SLICE_TYPES][RC_MAX_TEMPORAL_LEVELS] = {{ 0.0 }};
+
+    for (frame = 0; frame < p_stats->num_frames; ++frame)
+    {
+      RCStatsFrame *stats = &p_stats->frames[frame];
+
+      if (stats->type >= 0)
+      {
+        stats->factor = (mean[stats->type][stats->layer] > 0.0) ? (float) dClip3(0.5, 2.0, stats->weight / mean[stats->type][stats->layer]) : 1.0F;
+        sum[stats->type][stats->layer] += stats->factor;
+      }
+    }
+    for (i = 0; i < NUM_SLICE_TYPES; ++i)
+    {
+      for (j = 0; j < RC_MAX_TEMPORAL_LEVELS; ++j)
+      {
+        if (num[i][j])
+          mean[i][j] *= sum[i][j] / num[i][j];
+      }
+    }
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Open the statistics file of the current pass
+ ************************************************************************
+ */
+RCStats *rc_stats_open(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  RCStats *p_stats;
+
+  if ((p_stats = (RCStats *) calloc(1, sizeof(RCStats))) == NULL)
+    no_mem_exit("rc_stats_open: p_stats");
+
+  if (strlen(p_Inp->RCStatsFile) == 0)
+    strcpy (p_Inp->RCStatsFile, "rc_stats.dat");
+
+  if ((p_stats->file = fopen(p_Inp->RCStatsFile, (p_Inp->RCPass == 1) ? "wt" : "rt")) == NULL)
+  {
+    snprintf(errortext, ET_SIZE, "Error open file %s", p_Inp->RCStatsFile);
+    error(errortext, 500);
+  }
+
+  if (p_Inp->RCPass == 1)
+  {
+    p_stats->num_mbs = p_Vid->FrameSizeInMbs;
+    if ((p_stats->mb_mad = (int *) calloc(p_stats->num_mbs, sizeof(int))) == NULL)
+      no_mem_exit("rc_stats_open: p_stats->mb_mad");
+    if ((p_stats->mb_bits = (int *) calloc(p_stats->num_mbs, sizeof(int))) == NULL)
+      no_mem_exit("rc_stats_open: p_stats->mb_bits");
+  }
+  else
+  {
+    rc_stats_read(p_stats, p_Inp->RCStatsFile);
+    fclose(p_stats->file);
+    p_stats->file = NULL;
+  }
+
+  return p_stats;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Close the statistics file
+ ************************************************************************
+ */
+void rc_stats_close(RCStats *p_stats)
+{
+  if (p_stats == NULL)
+    return;
+
+  if (p_stats->file != NULL)
+    fclose(p_stats->file);
+  free(p_stats->mb_mad);
+  free(p_stats->mb_bits);
+  free(p_stats->frames);
+  free(p_stats);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Store the luma MAD of the prediction of the coded macroblock mode
+ ************************************************************************
+ */
+void rc_stats_store_mad(Macroblock *currMB)
+{
+  currMB->p_Vid->p_rc_stats->mb_mad[currMB->mbAddrX] = ComputeMBMAD(currMB->p_Slice->diffy);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Store the bits of the written macroblock
+ ************************************************************************
+ */
+void rc_stats_store_bits(Macroblock *currMB)
+{
+  currMB->p_Vid->p_rc_stats->mb_bits[currMB->mbAddrX] = currMB->bits.mb_total;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Write the statistics of the coded frame
+ ************************************************************************
+ */
+void rc_stats_write_frame(VideoParameters *p_Vid, int bits)
+{
+  RCStats *p_stats = p_Vid->p_rc_stats;
+  int64 sum_mad = 0;
+  int i;
+
+  for (i = 0; i < p_stats->num_mbs; ++i)
+    sum_mad += p_stats->mb_mad[i];
+
+  fprintf(p_stats->file, "frame %d %c layer %d qp %d bits %d mad %.3f mbs %d\n", p_Vid->frame_no, rc_stats_slice_type[p_Vid->type],
+    p_Vid->p_curr_frm_struct->layer, p_Vid->AverageFrameQP, bits, (double) sum_mad / (p_stats->num_mbs * MB_PIXELS), p_stats->num_mbs);
+  for (i = 0; i < p_stats->num_mbs; ++i)
+    fprintf(p_stats->file, "%d %d\n", p_stats->mb_mad[i], p_stats->mb_bits[i]);
+
+  memset(p_stats->mb_mad,  0, p_stats->num_mbs * sizeof(int));
+  memset(p_stats->mb_bits, 0, p_stats->num_mbs * sizeof(int));
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Complexity of a frame in the first pass relative to the frames of
+ *    the same type and layer, used to scale the rate control target bits
+ ************************************************************************
+ */
+float rc_stats_rate_factor(RCStats *p_stats, int frame)
+{
+  if (frame < 0 || frame >= p_stats->num_frames || p_stats->frames[frame].type < 0)
+    return 1.0F;
+
+  return p_stats->frames[frame].factor;
+}
@@ -0,0 +1,57 @@
+/*!
+ ***************************************************************************
+ * \file
+ *    rc_stats.h
+ *
+ * \brief
+ *    Headerfile for the statistics file of the two-pass rate control.
+ *
+ *    The first pass (RCPass = 1) writes, for every coded frame, its slice
+ *    type, temporal layer, average QP, bits and luma MAD followed by the
+ *    MAD and the bits of each of its macroblocks. The second pass
+ *    (RCPass = 2) reads the frame statistics back and scales the rate
+ *    control target bits of each frame with its first pass complexity
+ *    relative to the frames of the same type and layer, in place of the
+ *    look-ahead complexity.
+ **************************************************************************
+ */
+
+#ifndef _RC_STATS_H_
+#define _RC_STATS_H_
+
+#include "global.h"
+
+//! exponent of the frame complexity in the bit allocation of the second pass
+#define RC_STATS_QCOMP 0.6
+
+//! first pass statistics of one frame (display order)
+typedef struct rc_stats_frame
+{
+  int    type;          //!< slice type, -1 if the frame was not coded in the first pass
+  int    layer;         //!< temporal layer (clipped to RC_MAX_TEMPORAL_LEVELS - 1)
+  int    qp;            //!< average QP
+  int    bits;
+  double weight;        //!< share of the bits: (bits * Qstep) ^ RC_STATS_QCOMP
+  float  factor;        //!< scale of the target bits of the second pass
+} RCStatsFrame;
+
+typedef struct rc_stats
+{
+  FILE         *file;
+  // first pass: macroblocks of the current frame
+  int          *mb_mad;
+  int          *mb_bits;
+  int           num_mbs;
+  // second pass
+  RCStatsFrame *frames;
+  int           num_frames;
+} RCStats;
+
+extern RCStats *rc_stats_open        (VideoParameters *p_Vid, InputParameters *p_Inp);
+extern void     rc_stats_close       (RCStats *p_stats);
+extern void     rc_stats_store_mad   (Macroblock *currMB);
+extern void     rc_stats_store_bits  (Macroblock *currMB);
+extern void     rc_stats_write_frame (VideoParameters *p_Vid, int bits);
+extern float    rc_stats_rate_factor (RCStats *p_stats, int frame);
+
+#endif
@@ -449,7 +449,7 @@ int mode_decision_for_I16x16_MB_RDO (Macroblock* currMB, int lambda)
   Slice *currSlice = currMB->p_Slice;
 
   SyntaxElement   se;
-  const int*      partMap    = assignSE2partition[currSlice->partition_mode];
+  const int*      partMap    = currSlice->partition_map;
   DataPartition*  dataPart   = &(currSlice->partArr[partMap[SE_MBTYPE]]);
 
   distblk min_rdcost = DISTBLK_MAX, rdcost;
@@ -45,6 +45,7 @@
 #include "md_common.h"
 #include "md_distortion.h"
 #include "intra16x16.h"
+#include "profile.h"
 
 #define FASTMODE 1
 
@@ -541,7 +542,7 @@ static distblk rdcost_for_4x4_intra_blocks (Macroblock *currMB,
   int     pic_opix_y  = currMB->opix_y + block_y;
 
   SyntaxElement  se;
-  const int      *partMap   = assignSE2partition[currSlice->partition_mode];
+  const int      *partMap   = currSlice->partition_map;
   //--- choose data partition ---
   DataPartition  *dataPart = &(currSlice->partArr[partMap[SE_INTRAPREDMODE]]);
 
@@ -618,7 +619,7 @@ static distblk rdcost_for_4x4_intra_blocks_444 (Macroblock *currMB,
   int     pic_opix_y  = currMB->opix_y + block_y;
 
   SyntaxElement  se;
-  const int      *partMap   = assignSE2partition[currSlice->partition_mode];
+  const int      *partMap   = currSlice->partition_map;
   DataPartition  *dataPart;
   ColorPlane k;
 
@@ -714,7 +715,7 @@ distblk rdcost_for_8x8blocks (Macroblock *currMB, // --> Current macroblock to c
 
   SyntaxElement se;  
   DataPartition *dataPart;
-  const int     *partMap   = assignSE2partition[currSlice->partition_mode];
+  const int     *partMap   = currSlice->partition_map;
 
   EncodingEnvironmentPtr eep_dp;
 
@@ -737,8 +738,10 @@ distblk rdcost_for_8x8blocks (Macroblock *currMB, // --> Current macroblock to c
     else
     {
       int list_mode[2] = {0, 0};
+      profile_enter(p_Vid->p_prof, PROF_TRANSFORM);
       *cnt_nonz = currSlice->luma_residual_coding_8x8 (currMB, &cbp, cbp_blk, block, (short) p_dir, list_mode,
         currSlice->direct_ref_idx[currMB->block_y+j0][currMB->block_x+i0]);
+      profile_leave(p_Vid->p_prof);
     }
   }
   else
@@ -755,7 +758,9 @@ distblk rdcost_for_8x8blocks (Macroblock *currMB, // --> Current macroblock to c
 
     list_mode[0]  = (pdir==0||pdir==2 ? mode : 0);
     list_mode[1]   = (pdir==1||pdir==2 ? mode : 0);
+    profile_enter(p_Vid->p_prof, PROF_TRANSFORM);
     *cnt_nonz = currSlice->luma_residual_coding_8x8 (currMB, &cbp, cbp_blk, block, pdir, list_mode, part->ref);
+    profile_leave(p_Vid->p_prof);
   }
 
   if(p_Vid->P444_joined) 
@@ -797,6 +802,7 @@ distblk rdcost_for_8x8blocks (Macroblock *currMB, // --> Current macroblock to c
   //=====
   //=====   GET RATE
   //=====
+  profile_enter(p_Vid->p_prof, PROF_ENTROPY);
   //----- block 8x8 mode -----
   if (currSlice->symbol_mode == CAVLC)
   {
@@ -855,6 +861,7 @@ distblk rdcost_for_8x8blocks (Macroblock *currMB, // --> Current macroblock to c
     rate += writeCoeff8x8( currMB, PLANE_U, block, mode, currMB->luma_transform_size_8x8_flag );
     rate += writeCoeff8x8( currMB, PLANE_V, block, mode, currMB->luma_transform_size_8x8_flag );
   }
+  profile_leave(p_Vid->p_prof);
   return (distortion + weight_cost(lambda, rate));
 }
 
@@ -1858,23 +1865,33 @@ int RDCost_for_macroblocks (Macroblock  *currMB,   // <-- Current Macroblock to
   //=====
   if (mode < P8x8)
   {
+    profile_enter(p_Vid->p_prof, PROF_TRANSFORM);
     currSlice->luma_residual_coding(currMB);
+    profile_leave(p_Vid->p_prof);
   }
   else if (mode == P8x8)
   {
+    profile_enter(p_Vid->p_prof, PROF_TRANSFORM);
     currSlice->set_coeff_and_recon_8x8 (currMB);
+    profile_leave(p_Vid->p_prof);
   }
   else if (mode==I4MB)
   {
+    profile_enter(p_Vid->p_prof, PROF_INTRA);
     currMB->cbp = mode_decision_for_I4x4_MB (currMB, lambda, &dummy_d);
+    profile_leave(p_Vid->p_prof);
   }
   else if (mode==I16MB)
   {
+    profile_enter(p_Vid->p_prof, PROF_INTRA);
     currMB->cbp = currSlice->mode_decision_for_I16x16_MB (currMB, lambda);
+    profile_leave(p_Vid->p_prof);
   }
   else if(mode==I8MB)
   {
+    profile_enter(p_Vid->p_prof, PROF_INTRA);
     currMB->cbp = mode_decision_for_I8x8_MB(currMB, lambda, &dummy_d);
+    profile_leave(p_Vid->p_prof);
   }
   else if(mode==IPCM)
   {
@@ -1900,7 +1917,11 @@ int RDCost_for_macroblocks (Macroblock  *currMB,   // <-- Current Macroblock to
   dummy = 0;
 
   if (((p_Vid->yuv_format != YUV400) && (active_sps->chroma_format_idc != YUV444)) && (mode != IPCM))
+  {
+    profile_enter(p_Vid->p_prof, PROF_TRANSFORM);
     currSlice->chroma_residual_coding (currMB);
+    profile_leave(p_Vid->p_prof);
+  }
 
   if (mode==I16MB)
     currMB->i16offset = I16Offset  (currMB->cbp, currMB->i16mode);
@@ -1942,7 +1963,9 @@ int RDCost_for_macroblocks (Macroblock  *currMB,   // <-- Current Macroblock to
       // cod counter and macroblock mode are written ==> do not consider code counter
       tmp_cc = p_Vid->cod_counter;
 
+      profile_enter(p_Vid->p_prof, PROF_ENTROPY);
       rate = currSlice->write_MB_layer (currMB, 1, &coeff_rate);
+      profile_leave(p_Vid->p_prof);
 
       ue_linfo (tmp_cc, dummy, &cc_rate, &dummy);
       rate  -= cc_rate;
@@ -1958,7 +1981,9 @@ int RDCost_for_macroblocks (Macroblock  *currMB,   // <-- Current Macroblock to
   }
   else
   {
+    profile_enter(p_Vid->p_prof, PROF_ENTROPY);
     rate = currSlice->write_MB_layer (currMB, 1, &coeff_rate);
+    profile_leave(p_Vid->p_prof);
   }
 
   //=====   R E S T O R E   C O D I N G   S T A T E   =====
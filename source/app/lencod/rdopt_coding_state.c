@@ -85,6 +85,7 @@ CSobj *create_coding_state (InputParameters *p_Inp)
     //=== context for binary arithmetic coding ===
     cs->mot_ctx = create_contexts_MotionInfo ();
     cs->tex_ctx = create_contexts_TextureInfo();
+    cs->ctx_epoch = -1;
 
   }
   else
@@ -108,6 +109,171 @@ CSobj *create_coding_state (InputParameters *p_Inp)
   return cs;
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    create journal of changed contexts for the given slice contexts
+ ************************************************************************
+ */
+CtxJournal *create_ctx_journal (MotionInfoContexts *mot_ctx, TextureInfoContexts *tex_ctx)
+{
+  CtxJournal *jr;
+
+  if ((jr = (CtxJournal *) calloc (1, sizeof(CtxJournal))) == NULL)
+    no_mem_exit("create_ctx_journal: jr");
+
+  jr->mot_base = (BiContextType *) mot_ctx;
+  jr->tex_base = (BiContextType *) tex_ctx;
+  jr->mot_num  = sizeof(MotionInfoContexts)  / sizeof(BiContextType);
+  jr->tex_num  = sizeof(TextureInfoContexts) / sizeof(BiContextType);
+  jr->size     = 8 * (jr->mot_num + jr->tex_num);
+
+  if ((jr->stamp = (unsigned int *) calloc (jr->mot_num + jr->tex_num, sizeof(unsigned int))) == NULL)
+    no_mem_exit("create_ctx_journal: jr->stamp");
+  if ((jr->entry = (int *) calloc (jr->size, sizeof(int))) == NULL)
+    no_mem_exit("create_ctx_journal: jr->entry");
+
+  jr->segment = 1;
+
+  return jr;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    delete journal of changed contexts
+ ************************************************************************
+ */
+void delete_ctx_journal (CtxJournal *jr)
+{
+  if (jr != NULL)
+  {
+    free (jr->entry);
+    free (jr->stamp);
+    free (jr);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    clear the journal. All stored coding states become invalid and
+ *    are fully copied at their next store/reset. Has to be called
+ *    whenever the slice contexts are changed without being logged
+ *    (e.g. context initialization).
+ ************************************************************************
+ */
+void clear_ctx_journal (CtxJournal *jr)
+{
+  jr->num = 0;
+  ++jr->epoch;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    return context idx (as numbered by the journal) of the given contexts
+ ************************************************************************
+ */
+static inline BiContextType *journal_ctx (CtxJournal *jr, MotionInfoContexts *mot_ctx, TextureInfoContexts *tex_ctx, int idx)
+{
+  return (idx < (int) jr->mot_num) ? (BiContextType *) mot_ctx + idx : (BiContextType *) tex_ctx + (idx - jr->mot_num);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    store the slice contexts. Only the contexts changed since the
+ *    coding state was last synchronized are copied.
+ ************************************************************************
+ */
+static void store_contexts (Slice *currSlice, CSobj *cs)
+{
+  CtxJournal *jr = currSlice->ctx_journal;
+
+  if (jr == NULL)
+  {
+    *cs->mot_ctx = *currSlice->mot_ctx;
+    *cs->tex_ctx = *currSlice->tex_ctx;
+    return;
+  }
+
+  if (cs->ctx_epoch == jr->epoch)
+  {
+    int i;
+    for (i = cs->ctx_mark; i < jr->num; ++i)
+    {
+      int idx = jr->entry[i];
+      *journal_ctx (jr, cs->mot_ctx, cs->tex_ctx, idx) = *journal_ctx (jr, currSlice->mot_ctx, currSlice->tex_ctx, idx);
+    }
+  }
+  else
+  {
+    *cs->mot_ctx = *currSlice->mot_ctx;
+    *cs->tex_ctx = *currSlice->tex_ctx;
+    cs->ctx_epoch = jr->epoch;
+  }
+
+  cs->ctx_mark = jr->num;
+  ++jr->segment;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    restore the slice contexts. Only the contexts changed since the
+ *    coding state was last synchronized are copied; they are logged
+ *    again so that the other stored coding states remain valid.
+ ************************************************************************
+ */
+static void reset_contexts (Slice *currSlice, CSobj *cs)
+{
+  CtxJournal *jr = currSlice->ctx_journal;
+
+  if (jr == NULL)
+  {
+    *currSlice->mot_ctx = *cs->mot_ctx;
+    *currSlice->tex_ctx = *cs->tex_ctx;
+    return;
+  }
+
+  if (cs->ctx_epoch == jr->epoch && jr->num + (jr->num - cs->ctx_mark) <= jr->size)
+  {
+    int i, last = jr->num;
+
+    ++jr->segment;
+    for (i = cs->ctx_mark; i < last; ++i)
+    {
+      BiContextType *ctx = journal_ctx (jr, currSlice->mot_ctx, currSlice->tex_ctx, jr->entry[i]);
+      *ctx = *journal_ctx (jr, cs->mot_ctx, cs->tex_ctx, jr->entry[i]);
+      ctx_journal_log (jr, ctx);
+    }
+  }
+  else
+  {
+    // the live contexts change in an untracked way
+    if (cs->ctx_epoch == jr->epoch)
+    {
+      int i;
+      for (i = cs->ctx_mark; i < jr->num; ++i)
+      {
+        int idx = jr->entry[i];
+        *journal_ctx (jr, currSlice->mot_ctx, currSlice->tex_ctx, idx) = *journal_ctx (jr, cs->mot_ctx, cs->tex_ctx, idx);
+      }
+    }
+    else
+    {
+      *currSlice->mot_ctx = *cs->mot_ctx;
+      *currSlice->tex_ctx = *cs->tex_ctx;
+    }
+    clear_ctx_journal (jr);
+    cs->ctx_epoch = jr->epoch;
+  }
+
+  cs->ctx_mark = jr->num;
+  ++jr->segment;
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -171,8 +337,7 @@ static void store_coding_state_cabac (Macroblock *currMB, CSobj *cs)
   }
 
   //=== contexts for binary arithmetic coding ===
-  *cs->mot_ctx = *currSlice->mot_ctx;
-  *cs->tex_ctx = *currSlice->tex_ctx;
+  store_contexts (currSlice, cs);
 
   //=== syntax element number and bitcounters ===
   cs->bits = currMB->bits;
@@ -251,8 +416,7 @@ static void reset_coding_state_cabac (Macroblock *currMB, CSobj *cs)
   }
 
   //=== contexts for binary arithmetic coding ===
-  *currSlice->mot_ctx = *cs->mot_ctx;
-  *currSlice->tex_ctx = *cs->tex_ctx;
+  reset_contexts (currSlice, cs);
 
   //=== syntax element number and bit counters ===
   currMB->bits = cs->bits;
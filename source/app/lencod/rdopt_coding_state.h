@@ -29,6 +29,8 @@ struct coding_state {
   // contexts for binary arithmetic coding
   MotionInfoContexts   *mot_ctx;
   TextureInfoContexts  *tex_ctx;
+  int                  ctx_epoch;  //!< journal epoch the contexts are synchronized with (-1: none)
+  int                  ctx_mark;   //!< journal position at which the contexts were synchronized
 
   // bit counter
   BitCounter            bits;
@@ -49,5 +51,38 @@ extern void init_coding_state_methods(Slice *currSlice);  //!< Init methods give
 extern void store_coding_state_cavlc (Macroblock *currMB, CSobj *cs);
 extern void reset_coding_state_cavlc (Macroblock *currMB, CSobj *cs);
 
+extern CtxJournal *create_ctx_journal (MotionInfoContexts *mot_ctx, TextureInfoContexts *tex_ctx);
+extern void        delete_ctx_journal (CtxJournal *jr);
+extern void        clear_ctx_journal  (CtxJournal *jr);
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Record a context change in the journal. Contexts that do not belong
+ *    to the journaled slice contexts are ignored, a context is logged
+ *    only once per segment.
+ ************************************************************************
+ */
+static inline void ctx_journal_log (CtxJournal *jr, BiContextType *ctx)
+{
+  unsigned int idx = (unsigned int) (ctx - jr->mot_base);
+
+  if (idx >= jr->mot_num)
+  {
+    idx = (unsigned int) (ctx - jr->tex_base);
+    if (idx >= jr->tex_num)
+      return;
+    idx += jr->mot_num;
+  }
+
+  if (jr->stamp[idx] != jr->segment)
+  {
+    jr->stamp[idx] = jr->segment;
+    if (jr->num == jr->size)
+      clear_ctx_journal (jr);
+    jr->entry[jr->num++] = idx;
+  }
+}
+
 #endif
 
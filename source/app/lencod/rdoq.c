@@ -20,6 +20,7 @@
 #include "rdopt.h"
 #include "rdoq.h"
 #include "mv_search.h"
+#include "profile.h"
 
 #define RDOQ_BASE 0
 
@@ -32,10 +33,23 @@
 */
 void init_rdoq_slice(Slice *currSlice)
 {
+  int qp_rem, i, j;
+
   //currSlice->norm_factor_4x4 = (double) ((int64) 1 << (2 * DQ_BITS + 19)); // norm factor 4x4 is basically (1<<31)
   //currSlice->norm_factor_8x8 = (double) ((int64) 1 << (2 * Q_BITS_8 + 9)); // norm factor 8x8 is basically (1<<41)
   currSlice->norm_factor_4x4 = pow(2, (2 * DQ_BITS + 19));
   currSlice->norm_factor_8x8 = pow(2, (2 * Q_BITS_8 + 9));
+
+  // the distortion weights only depend on qp_rem and the coefficient position
+  for (qp_rem = 0; qp_rem < 6; qp_rem++)
+  {
+    for (j = 0; j < 4; j++)
+      for (i = 0; i < 4; i++)
+        currSlice->est_err_4x4[qp_rem][j][i] = (double) estErr4x4[qp_rem][j][i] / currSlice->norm_factor_4x4;
+    for (j = 0; j < 8; j++)
+      for (i = 0; i < 8; i++)
+        currSlice->est_err_8x8[qp_rem][j][i] = (double) estErr8x8[qp_rem][j][i] / currSlice->norm_factor_8x8;
+  }
 }
 /*!
 ****************************************************************************
@@ -55,7 +69,7 @@ int init_trellis_data_DC_cr_CAVLC(Macroblock *currMB, int **tblock, int qp_per,
   int q_offset = ( 1 << (q_bits - 1) );
   double err; 
   int scaled_coeff, level, lowerInt, k;
-  double estErr = (double) estErr4x4[qp_rem][0][0] / currSlice->norm_factor_4x4; // note that we could also use int64
+  double estErr = currSlice->est_err_4x4[qp_rem][0][0];
 
   for (coeff_ctr = 0; coeff_ctr < end_coeff_ctr; coeff_ctr++)
   {
@@ -137,9 +151,10 @@ int init_trellis_data_DC_cr_CABAC(Macroblock *currMB, int **tblock, int qp_per,
   int *m7;
   int q_bits = Q_BITS + qp_per + 1; 
   int q_offset = ( 1 << (q_bits - 1) );
+  int z_offset = rdoq_zero_offset(currMB, q_offset);
   double err; 
   int scaled_coeff, level, lowerInt, k;
-  double estErr = (double) estErr4x4[qp_rem][0][0] / currSlice->norm_factor_4x4; // note that we could also use int64
+  double estErr = currSlice->est_err_4x4[qp_rem][0][0];
 
   for (coeff_ctr = 0; coeff_ctr < end_coeff_ctr; coeff_ctr++)
   {
@@ -161,7 +176,7 @@ int init_trellis_data_DC_cr_CABAC(Macroblock *currMB, int **tblock, int qp_per,
       dataLevel->levelDouble = scaled_coeff;
       level = (scaled_coeff >> q_bits);
 
-      lowerInt=( (scaled_coeff - (level << q_bits)) < q_offset )? 1 : 0;
+      lowerInt=( (scaled_coeff - (level << q_bits)) < (level ? q_offset : z_offset) )? 1 : 0;
       dataLevel->level[0] = 0;
       if (level == 0)
       {
@@ -303,8 +318,10 @@ void trellis_mp(Macroblock *currMB)
     currMB->qp       = (short) p_Vid->qp;
     update_qp (currMB);
 
+    profile_enter_mb(p_Vid->p_prof);
     currSlice->encode_one_macroblock (currMB);
     end_encode_one_macroblock(currMB);
+    profile_leave_mb(p_Vid->p_prof);
 
 
     if ( currSlice->rddata_trellis_curr.min_rdcost < currSlice->rddata_trellis_best.min_rdcost)
@@ -362,8 +379,10 @@ void trellis_sp(Macroblock *currMB)
     }
   }
 
+  profile_enter_mb(p_Vid->p_prof);
   currSlice->encode_one_macroblock (currMB);
   end_encode_one_macroblock(currMB);
+  profile_leave_mb(p_Vid->p_prof);
 
   write_macroblock (currMB, 1);    
 }
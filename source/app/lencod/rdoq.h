@@ -147,6 +147,18 @@ typedef struct level_data_struct
   int sign;
 } levelDataStruct;
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Returns the remainder below which a coefficient quantized to zero
+ *    is not tried as level 1. Without pruning (RDOQ_Prune) this is half
+ *    a quantization step, with pruning 5/8 of a step.
+ ************************************************************************
+ */
+static inline int rdoq_zero_offset(Macroblock *currMB, int q_offset)
+{
+  return currMB->p_Inp->RDOQ_Prune ? q_offset + (q_offset >> 2) : q_offset;
+}
 
 extern void init_rdoq_slice(Slice *currSlice);
 
@@ -14,6 +14,7 @@
 
 #include "global.h"
 #include "cabac.h"
+#include "biariencode.h"
 #include "image.h"
 #include "fmo.h"
 #include "macroblock.h"
@@ -22,39 +23,6 @@
 
 #define RDOQ_SQ 0
 
-static const int entropyBits[128]= 
-{
-     895,    943,    994,   1048,   1105,   1165,   1228,   1294, 
-    1364,   1439,   1517,   1599,   1686,   1778,   1875,   1978, 
-    2086,   2200,   2321,   2448,   2583,   2725,   2876,   3034, 
-    3202,   3380,   3568,   3767,   3977,   4199,   4435,   4684, 
-    4948,   5228,   5525,   5840,   6173,   6527,   6903,   7303, 
-    7727,   8178,   8658,   9169,   9714,  10294,  10914,  11575, 
-   12282,  13038,  13849,  14717,  15650,  16653,  17734,  18899, 
-   20159,  21523,  23005,  24617,  26378,  28306,  30426,  32768, 
-   32768,  35232,  37696,  40159,  42623,  45087,  47551,  50015, 
-   52479,  54942,  57406,  59870,  62334,  64798,  67262,  69725, 
-   72189,  74653,  77117,  79581,  82044,  84508,  86972,  89436, 
-   91900,  94363,  96827,  99291, 101755, 104219, 106683, 109146, 
-  111610, 114074, 116538, 119002, 121465, 123929, 126393, 128857, 
-  131321, 133785, 136248, 138712, 141176, 143640, 146104, 148568, 
-  151031, 153495, 155959, 158423, 160887, 163351, 165814, 168278, 
-  170742, 173207, 175669, 178134, 180598, 183061, 185525, 187989
-};
-
-
-static int biari_no_bits(signed short symbol, BiContextTypePtr bi_ct )
-{
-  int ctx_state, estBits;
-
-  symbol = (short) (symbol != 0);
-
-  ctx_state = (symbol == bi_ct->MPS) ? 64 + bi_ct->state : 63 - bi_ct->state;
-  estBits = entropyBits[127 - ctx_state];
-
-  return(estBits);
-}
-
 static int biari_state(signed short symbol, BiContextTypePtr bi_ct )
 { 
   int ctx_state;
@@ -628,6 +596,7 @@ int init_trellis_data_4x4_CABAC(Macroblock *currMB, int **tblock,
   int end_coeff_ctr = ( ( type == LUMA_4x4 ) ? 16 : 15 );
   int q_bits = Q_BITS + qp_per; 
   int q_offset = ( 1 << (q_bits - 1) );
+  int z_offset = rdoq_zero_offset(currMB, q_offset);
   int scaled_coeff, level, lowerInt, k;
   double err, estErr;
   
@@ -648,13 +617,13 @@ int init_trellis_data_4x4_CABAC(Macroblock *currMB, int **tblock,
     }
     else
     {
-      estErr = ((double) estErr4x4[qp_rem][j][i]) / currSlice->norm_factor_4x4;
+      estErr = currSlice->est_err_4x4[qp_rem][j][i];
 
       scaled_coeff = iabs(*m7) * q_params_4x4[j][i].ScaleComp;
       dataLevel->levelDouble = scaled_coeff;
       level = (scaled_coeff >> q_bits);
 
-      lowerInt = ((scaled_coeff - (level << q_bits)) < q_offset )? 1 : 0;
+      lowerInt = ((scaled_coeff - (level << q_bits)) < (level ? q_offset : z_offset) )? 1 : 0;
 
 #if RDOQ_SQ
       dataLevel->level[0] = max(0, level - 1);
@@ -719,6 +688,7 @@ int init_trellis_data_8x8_CABAC(Macroblock *currMB, int **tblock, int block_x, i
   int i, j, coeff_ctr, end_coeff_ctr = 64;
   int q_bits = Q_BITS_8 + qp_per;
   int q_offset = ( 1 << (q_bits - 1) );
+  int z_offset = rdoq_zero_offset(currMB, q_offset);
   double err, estErr; 
   int level, lowerInt, k;
   int scaled_coeff;
@@ -740,13 +710,13 @@ int init_trellis_data_8x8_CABAC(Macroblock *currMB, int **tblock, int block_x, i
     }
     else
     {
-      estErr = (double) estErr8x8[qp_rem][j][i] / currSlice->norm_factor_8x8;
+      estErr = currSlice->est_err_8x8[qp_rem][j][i];
 
       scaled_coeff = iabs(*m7) * q_params[j][i].ScaleComp;
       dataLevel->levelDouble = scaled_coeff;
       level = (scaled_coeff >> q_bits);
 
-      lowerInt = ((scaled_coeff - (level << q_bits)) < q_offset )? 1 : 0;
+      lowerInt = ((scaled_coeff - (level << q_bits)) < (level ? q_offset : z_offset) )? 1 : 0;
 
 #if RDOQ_SQ
       dataLevel->level[0] = max(0, level - 1);
@@ -811,9 +781,10 @@ int init_trellis_data_DC_CABAC(Macroblock *currMB, int **tblock, int qp_per, int
   int i, j, coeff_ctr, end_coeff_ctr = 16;
   int q_bits   = Q_BITS + qp_per + 1; 
   int q_offset = ( 1 << (q_bits - 1) );
+  int z_offset = rdoq_zero_offset(currMB, q_offset);
   int scaled_coeff, level, lowerInt, k;
   int *m7;
-  double err, estErr = (double) estErr4x4[qp_rem][0][0] / currSlice->norm_factor_4x4; // note that we could also use int64
+  double err, estErr = currSlice->est_err_4x4[qp_rem][0][0];
 
   for (coeff_ctr = 0; coeff_ctr < end_coeff_ctr; coeff_ctr++)
   {
@@ -835,7 +806,7 @@ int init_trellis_data_DC_CABAC(Macroblock *currMB, int **tblock, int qp_per, int
       dataLevel->levelDouble = scaled_coeff;
       level = (scaled_coeff >> q_bits);
 
-      lowerInt=( (scaled_coeff - (level<<q_bits)) < q_offset )? 1 : 0;
+      lowerInt=( (scaled_coeff - (level<<q_bits)) < (level ? q_offset : z_offset) )? 1 : 0;
 
 #if RDOQ_SQ
       dataLevel->level[0] = max(0, level - 1);
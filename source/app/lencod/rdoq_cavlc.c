@@ -496,7 +496,7 @@ void init_trellis_data_4x4_CAVLC(Macroblock *currMB, int **tblock, int block_x,
     }
     else
     {
-      estErr = ((double) estErr4x4[qp_rem][j][i]) / currSlice->norm_factor_4x4;
+      estErr = currSlice->est_err_4x4[qp_rem][j][i];
 
       scaled_coeff = iabs(*m7) * q_params[j][i].ScaleComp;
       dataLevel->levelDouble = scaled_coeff;
@@ -558,7 +558,7 @@ void init_trellis_data_DC_CAVLC(Macroblock *currMB, int **tblock, int qp_per, in
   int q_offset = ( 1 << (q_bits - 1) );
   int scaled_coeff, level, lowerInt, k;
   int *m7;
-  double err, estErr = (double) estErr4x4[qp_rem][0][0] / currSlice->norm_factor_4x4; // note that we could also use int64
+  double err, estErr = currSlice->est_err_4x4[qp_rem][0][0];
 
   for (coeff_ctr = 0; coeff_ctr < end_coeff_ctr; coeff_ctr++)
   {
@@ -663,7 +663,7 @@ void init_trellis_data_8x8_CAVLC(Macroblock *currMB, int **tblock, int block_x,
       }
       else
       {
-        estErr = (double) estErr8x8[qp_rem][j][i] / currSlice->norm_factor_8x8;
+        estErr = currSlice->est_err_8x8[qp_rem][j][i];
 
         scaled_coeff = iabs(*m7) * q_params[j][i].ScaleComp;
         dataLevel->levelDouble = scaled_coeff;
@@ -29,6 +29,9 @@
 #include "parset.h"
 #include "report.h"
 #include "img_process_types.h"
+#include "lookahead.h"
+#include "mem_usage.h"
+#include "profile.h"
 
 
 static const char DistortionType[3][20] = {"SAD", "SSE", "Hadamard SAD"};
@@ -238,7 +241,8 @@ double report_slice_pred_stats(FILE *p_stat, StatParameters *p_Stats, int slice_
  */
 void report_stats_on_error(void)
 {
-  free_encoder_memory(p_Enc->p_Vid, p_Enc->p_Inp);
+  if (p_Enc)
+    free_encoder_memory(p_Enc->p_Vid, p_Enc->p_Inp);
   exit (-1);
 }
 
@@ -800,7 +804,32 @@ void report( VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *p_S
 #endif
 
     fprintf(stdout,  " Total encoding time for the seq.  : %7.3f sec (%3.2f fps)\n", (float) p_Vid->tot_time * 0.001, 1000.0 * (float) (p_Stats->frame_counter) / (float)p_Vid->tot_time);
-    fprintf(stdout,  " Total ME time for sequence        : %7.3f sec \n\n", (float)p_Vid->me_tot_time * 0.001);
+    fprintf(stdout,  " Total ME time for sequence        : %7.3f sec \n", (float)p_Vid->me_tot_time * 0.001);
+    if (p_Stats->me_cand.searches > 0)
+    {
+      fprintf(stdout,  " ME candidates per search          : %7.2f proposed, %7.2f accepted, %7.2f scored\n",
+        (double) p_Stats->me_cand.proposed / p_Stats->me_cand.searches,
+        (double) p_Stats->me_cand.accepted / p_Stats->me_cand.searches,
+        (double) p_Stats->me_cand.scored   / p_Stats->me_cand.searches);
+    }
+    if (p_Vid->md_prune_info != NULL)
+    {
+      static const char *rule_name[MD_PRUNE_RULES] = { "early skip", "early 16x16", "partition", "intra" };
+      int rule;
+      for (rule = 0; rule < MD_PRUNE_RULES; ++rule)
+      {
+        MDPruneStats *md_prune = &p_Stats->md_prune;
+        fprintf(stdout,  " MD pruning %-12s           : %7.2f%% of %8" FORMAT_OFF_T " checks",
+          rule_name[rule], md_prune->checked[rule] ? 100.0 * md_prune->hits[rule] / md_prune->checked[rule] : 0.0, md_prune->checked[rule]);
+        if (p_Inp->MDPruningAudit)
+          fprintf(stdout,  ", %7.2f%% misses", md_prune->hits[rule] ? 100.0 * md_prune->misses[rule] / md_prune->hits[rule] : 0.0);
+        fprintf(stdout,  "\n");
+      }
+    }
+    if (p_Vid->p_pred->p_la != NULL)
+      fprintf(stdout,  " Look-ahead scene cuts             : %d\n", la_num_scene_cuts(p_Vid->p_pred->p_la));
+    mem_usage_report(p_Vid->p_mem);
+    fprintf(stdout,  "\n");
 
     fprintf(stdout," Y { PSNR (dB), cSNR (dB), MSE }   : { %7.3f, %7.3f, %9.5f }\n", 
       snr->average[0], csnr_y, sse->average[0]/(float)impix);
@@ -877,6 +906,8 @@ void report( VideoParameters *p_Vid, InputParameters *p_Inp, StatParameters *p_S
   else
     fprintf(stdout,  " Total encoding time for the seq.  : %5.3f sec (%5.2f fps)\n\n", p_Vid->tot_time * 0.001, 1000.0 * (p_Stats->frame_counter) / p_Vid->tot_time);
 
+  profile_report(p_Vid->p_prof, p_Inp->StatsFile, p_Inp->Verbose != 0);
+
   total_bits = p_Stats->bit_ctr_parametersets;
   total_bits += p_Stats->bit_ctr_filler_data;
   for (i = 0; i < NUM_SLICE_TYPES; i++)
@@ -250,13 +250,12 @@ int WriteRTPNALU (VideoParameters *p_Vid, NALU_t *n, FILE **f_rtp)
 void RTPUpdateTimestamp (VideoParameters *p_Vid, int tr)
 {
   int delta;
-  static int oldtr = -1;
 
-  if (oldtr == -1)            // First invocation
+  if (p_Vid->CurrentRTPTr == -1)            // First invocation
   {
     p_Vid->CurrentRTPTimestamp = 0;  //! This is a violation of the security req. of
                               //! RTP (random timestamp), but easier to debug
-    oldtr = 0;
+    p_Vid->CurrentRTPTr = 0;
     return;
   }
 
@@ -270,13 +269,13 @@ void RTPUpdateTimestamp (VideoParameters *p_Vid, int tr)
       a wrap around.
   */
 
-  delta = tr - oldtr;
+  delta = tr - p_Vid->CurrentRTPTr;
 
   if (delta < -10)        // wrap-around
     delta+=256;
 
   p_Vid->CurrentRTPTimestamp += delta * RTP_TR_TIMESTAMP_MULT;
-  oldtr = tr;
+  p_Vid->CurrentRTPTr = tr;
 }
 
 
@@ -61,6 +61,7 @@
 #include "mc_prediction.h"
 #include "rd_intra_jm.h"
 #include "rd_intra_jm444.h"
+#include "profile.h"
 
 // Local declarations
 static Slice *malloc_slice(VideoParameters *p_Vid, InputParameters *p_Inp);
@@ -213,6 +214,9 @@ static int start_slice(Slice *currSlice, StatParameters *cur_stats)
       writeVlcByteAlign(p_Vid, currStream, cur_stats);
 
       eep->p_Vid = p_Vid;
+      eep->journal = currSlice->ctx_journal;
+      eep->rate_only = FALSE;
+      eep->rate_est = FALSE;
       arienco_start_encoding(eep, currStream->streamBuffer, &(currStream->byte_pos));
 
       arienco_reset_EC(eep);
@@ -227,6 +231,8 @@ static int start_slice(Slice *currSlice, StatParameters *cur_stats)
   if(currSlice->symbol_mode == CABAC)
   {
     init_contexts(currSlice);
+    if (currSlice->ctx_journal)
+      clear_ctx_journal(currSlice->ctx_journal);
   }
 
 #if MVC_EXTENSION_ENABLE
@@ -509,8 +515,10 @@ int encode_one_slice (VideoParameters *p_Vid, int SliceGroupId, int TotalCodedMB
     {
       p_Vid->masterQP = p_Vid->qp;
 
+      profile_enter_mb(p_Vid->p_prof);
       currSlice->encode_one_macroblock (currMB);
       end_encode_one_macroblock(currMB);
+      profile_leave_mb(p_Vid->p_prof);
 
       write_macroblock (currMB, 1);
     }
@@ -688,8 +696,10 @@ int encode_one_slice_MBAFF (VideoParameters *p_Vid, int SliceGroupId, int TotalC
 
       currSlice->rddata = &currSlice->rddata_top_frame_mb; // store data in top frame MB
       p_Vid->masterQP = p_Vid->qp;
+      profile_enter_mb(p_Vid->p_prof);
       currSlice->encode_one_macroblock (currMB);   // code the MB as frame
       end_encode_one_macroblock(currMB);
+      profile_leave_mb(p_Vid->p_prof);
 
       FrameRDCost = currSlice->rddata->min_rdcost;
       //***   Top MB coded as frame MB ***//
@@ -703,8 +713,10 @@ int encode_one_slice_MBAFF (VideoParameters *p_Vid, int SliceGroupId, int TotalC
       start_macroblock (currSlice, &currMB, CurrentMbAddr + 1, FALSE);
       currSlice->rddata = &currSlice->rddata_bot_frame_mb; // store data in top frame MB
       p_Vid->masterQP = p_Vid->qp;
+      profile_enter_mb(p_Vid->p_prof);
       currSlice->encode_one_macroblock (currMB);         // code the MB as frame
       end_encode_one_macroblock(currMB);
+      profile_leave_mb(p_Vid->p_prof);
 
       if ( p_Inp->RCEnable && p_Inp->RCUpdateMode <= MAX_RC_MODE )
       {
@@ -750,8 +762,10 @@ int encode_one_slice_MBAFF (VideoParameters *p_Vid, int SliceGroupId, int TotalC
       currSlice->rddata = &currSlice->rddata_top_field_mb; // store data in top frame MB
       //        TopFieldIsSkipped = 0;        // set the top field MB skipped flag to 0
       p_Vid->masterQP = p_Vid->qp;
+      profile_enter_mb(p_Vid->p_prof);
       currSlice->encode_one_macroblock (currMB);         // code the MB as field
       end_encode_one_macroblock(currMB);
+      profile_leave_mb(p_Vid->p_prof);
 
       FieldRDCost = currSlice->rddata->min_rdcost;
       //***   Top MB coded as field MB ***//
@@ -762,8 +776,10 @@ int encode_one_slice_MBAFF (VideoParameters *p_Vid, int SliceGroupId, int TotalC
       start_macroblock (currSlice, &currMB, CurrentMbAddr+1, TRUE);
       currSlice->rddata = &currSlice->rddata_bot_field_mb; // store data in top frame MB
       p_Vid->masterQP = p_Vid->qp;
+      profile_enter_mb(p_Vid->p_prof);
       currSlice->encode_one_macroblock (currMB);         // code the MB as field
       end_encode_one_macroblock(currMB);
+      profile_leave_mb(p_Vid->p_prof);
 
       FieldRDCost += currSlice->rddata->min_rdcost;
       //***   Bottom MB coded as field MB ***//
@@ -1496,11 +1512,11 @@ void init_slice (VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr)
   else if (p_Vid->nal_reference_idc && p_Inp->PocMemoryManagement == 1)
   {
     if (p_Vid->structure == FRAME && p_Dpb->ref_frames_in_buffer == active_sps->num_ref_frames)
-      poc_based_ref_management_frame_pic(p_Dpb, p_Vid->frame_num);
+      poc_based_ref_management_frame_pic(p_Vid, p_Dpb, p_Vid->frame_num);
     else if (p_Vid->structure == TOP_FIELD && p_Dpb->ref_frames_in_buffer== active_sps->num_ref_frames)
-      poc_based_ref_management_field_pic(p_Dpb, (p_Vid->frame_num << 1) + 1);      
+      poc_based_ref_management_field_pic(p_Vid, p_Dpb, (p_Vid->frame_num << 1) + 1);      
     else if (p_Vid->structure == BOTTOM_FIELD)
-      poc_based_ref_management_field_pic(p_Dpb, (p_Vid->frame_num << 1) + 1);
+      poc_based_ref_management_field_pic(p_Vid, p_Dpb, (p_Vid->frame_num << 1) + 1);
   }
   else if (p_Vid->nal_reference_idc && p_Inp->PocMemoryManagement == 2) 
   {
@@ -1680,15 +1696,18 @@ void init_slice (VideoParameters *p_Vid, Slice **currSlice, int start_mb_addr)
   }
 
   // assign luma common reference picture pointers to be used for ME/sub-pel interpolation
-
-  for(i = 0; i < active_ref_lists; i++)
+  // (4:4:4 only, the references of the other formats always point at the luma plane)
+  if (p_Vid->yuv_format == YUV444)
   {
-    for(j = 0; j < (*currSlice)->listXsize[i]; j++)
+    for(i = 0; i < active_ref_lists; i++)
     {
-      if( (*currSlice)->listX[i][j] )
+      for(j = 0; j < (*currSlice)->listXsize[i]; j++)
       {
-        (*currSlice)->listX[i][j]->p_curr_img     = (*currSlice)->listX[i][j]->p_img    [(short) p_Vid->colour_plane_id];
-        (*currSlice)->listX[i][j]->p_curr_img_sub = (*currSlice)->listX[i][j]->p_img_sub[(short) p_Vid->colour_plane_id];
+        if( (*currSlice)->listX[i][j] )
+        {
+          (*currSlice)->listX[i][j]->p_curr_img     = (*currSlice)->listX[i][j]->p_img    [(short) p_Vid->colour_plane_id];
+          (*currSlice)->listX[i][j]->p_curr_img_sub = (*currSlice)->listX[i][j]->p_img_sub[(short) p_Vid->colour_plane_id];
+        }
       }
     }
   }
@@ -1871,14 +1890,18 @@ void init_slice_lite (VideoParameters *p_Vid, Slice **currSlice, int start_mb_ad
     init_mbaff_lists(*currSlice);
 
   // assign luma common reference picture pointers to be used for ME/sub-pel interpolation
-  for(i = 0; i < active_ref_lists; i++)
+  // (4:4:4 only, the references of the other formats always point at the luma plane)
+  if (p_Vid->yuv_format == YUV444)
   {
-    for(j = 0; j < (*currSlice)->listXsize[i]; j++)
+    for(i = 0; i < active_ref_lists; i++)
     {
-      if( (*currSlice)->listX[i][j] )
+      for(j = 0; j < (*currSlice)->listXsize[i]; j++)
       {
-        (*currSlice)->listX[i][j]->p_curr_img     = (*currSlice)->listX[i][j]->p_img    [(short) p_Vid->colour_plane_id];
-        (*currSlice)->listX[i][j]->p_curr_img_sub = (*currSlice)->listX[i][j]->p_img_sub[(short) p_Vid->colour_plane_id];
+        if( (*currSlice)->listX[i][j] )
+        {
+          (*currSlice)->listX[i][j]->p_curr_img     = (*currSlice)->listX[i][j]->p_img    [(short) p_Vid->colour_plane_id];
+          (*currSlice)->listX[i][j]->p_curr_img_sub = (*currSlice)->listX[i][j]->p_img_sub[(short) p_Vid->colour_plane_id];
+        }
       }
     }
   }
@@ -1974,6 +1997,9 @@ static Slice *malloc_slice(VideoParameters *p_Vid, InputParameters *p_Inp)
     // create all context models
     currSlice->mot_ctx = create_contexts_MotionInfo ();
     currSlice->tex_ctx = create_contexts_TextureInfo();
+    // contexts changed during RD mode decision are journaled
+    if (p_Inp->rdopt != 0)
+      currSlice->ctx_journal = create_ctx_journal(currSlice->mot_ctx, currSlice->tex_ctx);
   }
 
   currSlice->max_part_nr = p_Inp->partition_mode==0?1:3;
@@ -1982,13 +2008,12 @@ static Slice *malloc_slice(VideoParameters *p_Vid, InputParameters *p_Inp)
   if(p_Vid->currentPicture->idr_flag)
     currSlice->max_part_nr = 1;
 
-  assignSE2partition[0] = assignSE2partition_NoDP;
   //ZL
   //for IDR p_Vid all the syntax element should be mapped to one partition
   if(!p_Vid->currentPicture->idr_flag && p_Inp->partition_mode == 1)
-    assignSE2partition[1] =  assignSE2partition_DP;
+    currSlice->partition_map = assignSE2partition_DP;
   else
-    assignSE2partition[1] =  assignSE2partition_NoDP;
+    currSlice->partition_map = assignSE2partition_NoDP;
 
   currSlice->num_mb = 0;          // no coded MBs so far
 
@@ -2055,13 +2080,12 @@ static Slice *malloc_slice_lite(VideoParameters *p_Vid, InputParameters *p_Inp)
   if(p_Vid->currentPicture->idr_flag)
     currSlice->max_part_nr = 1;
 
-  assignSE2partition[0] = assignSE2partition_NoDP;
   //ZL
   //for IDR p_Vid all the syntax element should be mapped to one partition
   if(!p_Vid->currentPicture->idr_flag && p_Inp->partition_mode == 1)
-    assignSE2partition[1] =  assignSE2partition_DP;
+    currSlice->partition_map = assignSE2partition_DP;
   else
-    assignSE2partition[1] =  assignSE2partition_NoDP;
+    currSlice->partition_map = assignSE2partition_NoDP;
 
   currSlice->num_mb = 0;          // no coded MBs so far
 
@@ -2208,6 +2232,7 @@ void free_slice(Slice *currSlice)
         delete_contexts_MotionInfo(currSlice->mot_ctx);
       if(currSlice->tex_ctx)
         delete_contexts_TextureInfo(currSlice->tex_ctx);
+      delete_ctx_journal(currSlice->ctx_journal);
     }
 
     if (p_Inp->WeightedPrediction || p_Inp->WeightedBiprediction || p_Inp->GenerateMultiplePPS)
@@ -310,7 +310,7 @@ distblk rdcost_for_8x8_intra_blocks(Macroblock *currMB, int *nonzero, int b8, in
   int     pic_opix_y  = currMB->opix_y + block_y;
 
   SyntaxElement  se;
-  const int      *partMap   = assignSE2partition[currSlice->partition_mode];
+  const int      *partMap   = currSlice->partition_map;
   DataPartition  *dataPart;
 
   //===== perform forward transform, Q, IQ, inverse transform, Reconstruction =====
@@ -384,7 +384,7 @@ distblk  rdcost_for_8x8_intra_blocks_444(Macroblock *currMB, int *nonzero, int b
   int     pic_opix_y  = currMB->opix_y + block_y;
 
   SyntaxElement  se;
-  const int      *partMap   = assignSE2partition[currSlice->partition_mode];
+  const int      *partMap   = currSlice->partition_map;
   DataPartition  *dataPart;
 
   if(currSlice->P444_joined == 0) 
@@ -0,0 +1,260 @@
+/*!
+ *************************************************************************************
+ * \file view_threads.c
+ *
+ * \brief
+ *    Pipelined coding of the two MVC views.
+ *
+ *    View 1 of an access unit is set up and its source picture read by the
+ *    encoder thread. It is then coded in its own thread on a private copy
+ *    of the coding parameters (see image_mp_threads.c) while the encoder
+ *    thread sets up and codes the base view of the next access unit. The
+ *    source buffers, the pictures and the frame unit structure of view 1
+ *    are private as well, and the layer 1 DPB is only used by view 1 until
+ *    the base view of the next access unit is stored. Writing, storing and
+ *    reporting view 1 is done by the encoder thread before it finishes the
+ *    next base view, so the stream is written in the serial order.
+ *
+ *    The adaptive state (rounding offsets, context models) of view 1 is
+ *    taken from the base view of its access unit and is not passed on to
+ *    the next base view.
+ *
+ *************************************************************************************
+ */
+
+#include "global.h"
+#include "image.h"
+#include "mbuffer.h"
+#include "wp_moments.h"
+#include "view_threads.h"
+#include "profile.h"
+
+#if (MVC_EXTENSION_ENABLE)
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Check whether view 1 can be coded next to the base view of the next
+ *    access unit. Tools that carry state from view 1 to the next base view
+ *    or change the order of the coding steps need serial coding.
+ *************************************************************************************
+ */
+static int view_threads_supported(InputParameters *p_Inp)
+{
+  if (!mp_pass_tools_supported(p_Inp))
+    return FALSE;
+  if (p_Inp->PicInterlace != FRAME_CODING || p_Inp->RDPictureDecision || p_Inp->WPMCPrecision || p_Inp->HMEEnable)
+    return FALSE;
+  if (p_Inp->sp_periodicity || p_Inp->si_frame_indicator || p_Inp->EnableOpenGOP)
+    return FALSE;
+  if (p_Inp->MDReference[0] || p_Inp->MDReference[1])
+    return FALSE;
+  // serial coding hands the adapted context models of view 1 to the next base view
+  if (p_Inp->context_init_method)
+    return FALSE;
+
+  return TRUE;
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Set up the pipelined coding of the views if it is enabled and
+ *    supported by the coding tools in use
+ *************************************************************************************
+ */
+void init_view_threads(VideoParameters *p_Vid, InputParameters *p_Inp)
+{
+  ViewThreads *vt;
+  int i;
+
+  p_Vid->p_view_threads = NULL;
+  if (!p_Inp->MVCViewParallel || p_Inp->num_of_views != 2)
+    return;
+  if (!view_threads_supported(p_Inp))
+  {
+    printf("MVCViewParallel: coding tools in use need serial coding of the views, disabled.\n");
+    return;
+  }
+
+  if ((vt = (ViewThreads *) calloc(1, sizeof(ViewThreads))) == NULL)
+    no_mem_exit("init_view_threads: vt");
+  p_Vid->p_view_threads = vt;
+
+  alloc_mp_pass(&vt->pass, p_Vid, p_Inp);
+  init_orig_buffers(p_Vid, &vt->imgData);
+
+  if ((vt->frame_pic = (Picture **) malloc(p_Vid->frm_iter * sizeof(Picture *))) == NULL)
+    no_mem_exit("init_view_threads: vt->frame_pic");
+  for (i = 0; i < p_Vid->frm_iter; ++i)
+    vt->frame_pic[i] = malloc_picture();
+
+  vt->max_num_slices = p_Vid->p_pred->max_num_slices;
+  for (i = 0; i < 3; ++i)
+  {
+    if ((vt->slices[i] = (SliceStructure *) calloc(vt->max_num_slices, sizeof(SliceStructure))) == NULL)
+      no_mem_exit("init_view_threads: vt->slices");
+  }
+}
+
+void free_view_threads(VideoParameters *p_Vid)
+{
+  ViewThreads *vt = p_Vid->p_view_threads;
+  int i;
+
+  if (vt == NULL)
+    return;
+
+  free_mp_pass(&vt->pass, p_Vid);
+  free_orig_planes(p_Vid, &vt->imgData);
+  for (i = 0; i < p_Vid->frm_iter; ++i)
+    free_picture(vt->frame_pic[i]);
+  free(vt->frame_pic);
+  for (i = 0; i < 3; ++i)
+    free(vt->slices[i]);
+
+  free(vt);
+  p_Vid->p_view_threads = NULL;
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Copy a picture structure of view 1 into entry idx of the private frame
+ *    unit structure. The shared entry is reused when the prediction
+ *    structure of the following access units is populated.
+ *************************************************************************************
+ */
+static PicStructure *copy_pic_struct(ViewThreads *vt, int idx, PicStructure *p_pic)
+{
+  if (p_pic == NULL)
+    return NULL;
+
+  vt->pic[idx] = *p_pic;
+  if (p_pic->p_Slice != NULL)
+  {
+    if (p_pic->num_slices > vt->max_num_slices)
+      error("copy_pic_struct: too many slices in the frame unit structure", 500);
+    memcpy(vt->slices[idx], p_pic->p_Slice, p_pic->num_slices * sizeof(SliceStructure));
+    vt->pic[idx].p_Slice = vt->slices[idx];
+  }
+  return &vt->pic[idx];
+}
+
+static void view_thread_code(void *arg)
+{
+  ViewThreads *vt = (ViewThreads *) arg;
+  VideoParameters *w = vt->pass.p_Vid;
+
+  code_one_frame(w, w->p_Inp);
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Start coding view 1, which has been set up and read by
+ *    start_one_frame(). The view is coded in place if no thread can be
+ *    created.
+ * \param start_time
+ *    time the coding of the view was started
+ *************************************************************************************
+ */
+void view_threads_start(VideoParameters *p_Vid, TIME_T *start_time)
+{
+  ViewThreads *vt = p_Vid->p_view_threads;
+  FrameUnitStruct *frm;
+  VideoParameters *w;
+  ImageData imgData;
+  int i;
+
+  w = sync_mp_pass(&vt->pass, p_Vid);
+
+  // the source picture just read stays with view 1, the next one is read into the spare buffers
+  imgData         = p_Vid->imgData;
+  p_Vid->imgData  = vt->imgData;
+  vt->imgData     = imgData;
+  p_Vid->p_wp_org = NULL;
+
+  w->frame_pic = vt->frame_pic;
+  w->enc_frame_picture = vt->enc_frame_picture;
+  for (i = 0; i < 6; ++i)
+    vt->enc_frame_picture[i] = NULL;
+
+  frm = w->p_curr_frm_struct;
+  frm->p_frame_pic   = copy_pic_struct(vt, 0, frm->p_frame_pic);
+  frm->p_top_fld_pic = copy_pic_struct(vt, 1, frm->p_top_fld_pic);
+  frm->p_bot_fld_pic = copy_pic_struct(vt, 2, frm->p_bot_fld_pic);
+
+  for (i = 0; i < (int) w->FrameSizeInMbs; ++i)
+    w->mb_data[i].slice_nr = -1;
+  w->p_view_threads = NULL;
+
+  // the DPB of view 1 is only used by view 1 until it is finished
+  p_Vid->p_Dpb_layer[1]->p_Vid = w;
+  // what finishing view 1 would leave for the next base view
+  p_Vid->prev_view_is_anchor = 0;
+
+  vt->start_time  = *start_time;
+  vt->tot_time    = p_Vid->tot_time;
+  vt->me_tot_time = p_Vid->me_tot_time;
+  vt->pending     = TRUE;
+
+  vt->pass.threaded = (thread_create(&vt->pass.thread, view_thread_code, vt) == 0);
+  if (!vt->pass.threaded)
+    view_thread_code(vt);
+}
+
+/*!
+ *************************************************************************************
+ * \brief
+ *    Wait for view 1, then write, store and report it in the encoder
+ *    thread and merge its statistics into the encoder
+ *************************************************************************************
+ */
+void view_threads_finish(VideoParameters *p_Vid)
+{
+  ViewThreads *vt = p_Vid->p_view_threads;
+  DistortionParams *p_Dist = p_Vid->p_Dist;
+  VideoParameters *w;
+  int i;
+
+  if (vt == NULL || !vt->pending)
+    return;
+
+  w = vt->pass.p_Vid;
+  if (vt->pass.threaded)
+  {
+    thread_join(vt->pass.thread);
+    vt->pass.threaded = FALSE;
+  }
+  vt->pending = FALSE;
+
+  merge_mp_pass_stats(&vt->pass, p_Vid->p_Stats);
+  w->p_Stats = p_Vid->p_Stats;
+
+  // the distortion averages of view 1 are accumulated over its own frame counters
+  profile_handover(p_Vid->p_prof, w->p_prof);
+  finish_sequence_position(w, w->p_Inp, &vt->start_time);
+  profile_handover(w->p_prof, p_Vid->p_prof);
+  profile_merge(p_Vid->p_prof, w->p_prof);
+
+  for (i = 0; i < TOTAL_DIST_TYPES; ++i)
+  {
+    memcpy(p_Dist->metric[i].average, vt->pass.dist.metric[i].average, sizeof(p_Dist->metric[i].average));
+    memcpy(p_Dist->metric[i].avslice, vt->pass.dist.metric[i].avslice, sizeof(p_Dist->metric[i].avslice));
+  }
+  memcpy(p_Dist->metric_v[1], vt->pass.dist.metric_v[1], sizeof(p_Dist->metric_v[1]));
+
+  p_Vid->tot_time    += w->tot_time    - vt->tot_time;
+  p_Vid->me_tot_time += w->me_tot_time - vt->me_tot_time;
+  p_Vid->last_bit_ctr_n = w->last_bit_ctr_n;
+#ifdef _LEAKYBUCKET_
+  p_Vid->total_frame_buffer = w->total_frame_buffer;
+#endif
+
+  p_Vid->p_Dpb_layer[1]->p_Vid = p_Vid;
+  wp_moments_free(w->p_wp_org);
+  w->p_wp_org = NULL;
+}
+
+#endif
@@ -0,0 +1,45 @@
+/*!
+ ***************************************************************************
+ * \file
+ *    view_threads.h
+ *
+ * \brief
+ *    Headerfile for the pipelined coding of the two MVC views.
+ *
+ *    The second view of access unit N only references the base view of
+ *    the same access unit and its own layer of the DPB. Once the base view
+ *    of N is stored, view 1 of N is coded in its own thread on a private
+ *    copy of the coding parameters while the encoder thread reads and
+ *    codes the base view of access unit N+1. The pictures are written,
+ *    stored and reported in the serial order by the encoder thread.
+ **************************************************************************
+ */
+
+#ifndef _VIEW_THREADS_H_
+#define _VIEW_THREADS_H_
+
+#include "image_mp_threads.h"
+
+typedef struct view_threads
+{
+  MPPass           pass;                  //!< private coding parameters of view 1
+  ImageData        imgData;               //!< source buffers exchanged with the encoder at each start
+  Picture        **frame_pic;             //!< private pictures of the frame coding passes
+  StorablePicture *enc_frame_picture[6];
+  PicStructure     pic[3];                //!< private copy of the frame unit structure of view 1
+  SliceStructure  *slices[3];
+  int              max_num_slices;
+
+  TIME_T           start_time;            //!< time view 1 was started
+  int64            tot_time;              //!< timers of the encoder when view 1 was started
+  int64            me_tot_time;
+  int              pending;               //!< view 1 is coded and not yet finished
+} ViewThreads;
+
+extern void init_view_threads  (VideoParameters *p_Vid, InputParameters *p_Inp);
+extern void free_view_threads  (VideoParameters *p_Vid);
+extern void view_threads_start (VideoParameters *p_Vid, TIME_T *start_time);
+extern void view_threads_finish(VideoParameters *p_Vid);
+
+#endif
+
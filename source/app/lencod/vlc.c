@@ -244,12 +244,9 @@ int write_u_v (int n, char *tracestring, int value, Bitstream *bitstream)
  */
 void ue_linfo(int ue, int dummy, int *len,int *info)
 {
-  int i, nn =(ue + 1) >> 1;
+  // number of suffix bits is floor(log2(ue + 1))
+  int i = ilog2((uint32) ue + 1);
 
-  for (i=0; i < 33 && nn != 0; i++)
-  {
-    nn >>= 1;
-  }
   *len  = (i << 1) + 1;
   *info = ue + 1 - (1 << i);
 }
@@ -273,12 +270,8 @@ void se_linfo(int se, int dummy, int *len,int *info)
 {  
   int sign = (se <= 0) ? 1 : 0;
   int n = iabs(se) << 1;   //  n+1 is the number in the code table.  Based on this we find length and info
-  int nn = (n >> 1);
-  int i;
-  for (i = 0; i < 33 && nn != 0; i++)
-  {
-    nn >>= 1;
-  }
+  int i = ilog2((uint32) n | 1);
+
   *len  = (i << 1) + 1;
   *info = n - (1 << i) + sign;
 }
@@ -592,6 +585,32 @@ int writeSyntaxElement2Buf_UVLC(SyntaxElement *se, Bitstream* this_streamBuffer
 }
 
 
+/*!
+ ************************************************************************
+ * \brief
+ *    appends the len (<= 32) least significant bits of value to the
+ *    bitstream. The pending bits of byte_buf and the new bits are
+ *    combined in a 64 bit word and all complete bytes are stored at
+ *    once; byte_buf keeps the remaining (less than 8) bits.
+ ************************************************************************
+ */
+static inline void write_bits(Bitstream *currStream, uint32 value, int len)
+{
+  int    pending = 8 - currStream->bits_to_go;
+  uint64 acc     = ((uint64) (currStream->byte_buf & ((1 << pending) - 1)) << len) | (value & (((uint64) 1 << len) - 1));
+  byte  *buf     = &currStream->streamBuffer[currStream->byte_pos];
+
+  pending += len;
+  while (pending >= 8)
+  {
+    pending -= 8;
+    *buf++ = (byte) (acc >> pending);
+  }
+  currStream->byte_pos   = (int) (buf - currStream->streamBuffer);
+  currStream->byte_buf   = (byte) (acc & ((1 << pending) - 1));
+  currStream->bits_to_go = 8 - pending;
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -600,64 +619,15 @@ int writeSyntaxElement2Buf_UVLC(SyntaxElement *se, Bitstream* this_streamBuffer
  */
 void  writeUVLC2buffer(SyntaxElement *se, Bitstream *currStream)
 {
-  unsigned int mask = 1 << (se->len - 1);
-  byte *byte_buf  = &currStream->byte_buf;
-  int *bits_to_go = &currStream->bits_to_go;
-  int i;
-
-  // Add the new bits to the bitstream.
-  // Write out a byte if it is full
   if ( se->len < 33 )
   {
-    for (i = 0; i < se->len; i++)
-    {
-      *byte_buf <<= 1;
-
-      if (se->bitpattern & mask)
-        *byte_buf |= 1;
-
-      mask >>= 1;
-
-      if ((--(*bits_to_go)) == 0)
-      {
-        *bits_to_go = 8;      
-        currStream->streamBuffer[currStream->byte_pos++] = *byte_buf;
-        *byte_buf = 0;      
-      }
-    }
+    write_bits(currStream, (uint32) se->bitpattern, se->len);
   }
   else
   {
-    // zeros
-    for (i = 0; i < (se->len - 32); i++)
-    {
-      *byte_buf <<= 1;
-
-      if ((--(*bits_to_go)) == 0)
-      {
-        *bits_to_go = 8;      
-        currStream->streamBuffer[currStream->byte_pos++] = *byte_buf;
-        *byte_buf = 0;      
-      }
-    }
-    // actual info
-    mask = (unsigned int) 1 << 31;
-    for (i = 0; i < 32; i++)
-    {
-      *byte_buf <<= 1;
-
-      if (se->bitpattern & mask)
-        *byte_buf |= 1;
-
-      mask >>= 1;
-
-      if ((--(*bits_to_go)) == 0)
-      {
-        *bits_to_go = 8;      
-        currStream->streamBuffer[currStream->byte_pos++] = *byte_buf;
-        *byte_buf = 0;      
-      }
-    }
+    // leading zeros followed by the 32 bit info
+    write_bits(currStream, 0, se->len - 32);
+    write_bits(currStream, (uint32) se->bitpattern, 32);
   }
 }
 
@@ -144,14 +144,19 @@ void ComputeImplicitWeights(Slice *currSlice,
 /*!
 ************************************************************************
 * \brief
-*    Compute sum of samples in a picture
+*    Compute sum of samples in a picture (read from the sums of the
+*    picture if there are any for the area)
 ************************************************************************
 */
-double ComputeImgSum(imgpel **CurrentImage, int height, int width)
+double ComputeImgSum(WPMoments *moments, imgpel **CurrentImage, int height, int width)
 {
   int i, j;
   double sum_value = 0.0;
   imgpel *p_tmp;
+  int64 sum;
+
+  if (wp_moments_plane_sum(moments, CurrentImage, height, width, &sum))
+    return (double) sum;
 
   for (i = 0; i < height; i++)
   {
@@ -187,7 +192,7 @@ static int ComputeBlockSum(imgpel **CurrentImage, int height_in_blk, int width_i
   return sum; 
 }
 
-void ComputeImgSumBlockBased(imgpel **CurrentImage, 
+void ComputeImgSumBlockBased(WPMoments *moments, imgpel **CurrentImage, 
                              int height_in_blk, int width_in_blk, 
                              int blk_size_y, int blk_size_x, 
                              int start_blk, int end_blk, double *dc)
@@ -196,6 +201,12 @@ void ComputeImgSumBlockBased(imgpel **CurrentImage,
   int block_sum; 
   int64 slice_sum = 0;
 
+  if (wp_moments_sum(moments, CurrentImage, width_in_blk, blk_size_y, blk_size_x, start_blk, end_blk, &slice_sum))
+  {
+    (*dc) = (double) slice_sum;
+    return;
+  }
+
   for(cur_blk = start_blk; cur_blk < end_blk; cur_blk++)
   {
     block_sum = ComputeBlockSum(CurrentImage, height_in_blk, width_in_blk, blk_size_y, blk_size_x, cur_blk);
@@ -204,7 +215,7 @@ void ComputeImgSumBlockBased(imgpel **CurrentImage,
   (*dc) = (double) slice_sum;
 }
 
-int64 ComputeSumBlockBased(imgpel **CurrentImage, 
+int64 ComputeSumBlockBased(WPMoments *moments, imgpel **CurrentImage, 
                              int height_in_blk, int width_in_blk, 
                              int blk_size_y, int blk_size_x, 
                              int start_blk, int end_blk)
@@ -212,6 +223,9 @@ int64 ComputeSumBlockBased(imgpel **CurrentImage,
   int cur_blk;
   int64 slice_sum = 0;
 
+  if (wp_moments_sum(moments, CurrentImage, width_in_blk, blk_size_y, blk_size_x, start_blk, end_blk, &slice_sum))
+    return slice_sum;
+
   for(cur_blk = start_blk; cur_blk < end_blk; cur_blk++)
   {
     slice_sum += ComputeBlockSum(CurrentImage, height_in_blk, width_in_blk, blk_size_y, blk_size_x, cur_blk);
@@ -253,13 +267,13 @@ void EstimateWPPSliceAlg0(Slice *currSlice, int select_offset)
   default_weight[0]       = 1 << currSlice->luma_log_weight_denom;
   default_weight[1]       = default_weight[2] = 1 << currSlice->chroma_log_weight_denom;
   
-  dc_org = ComputeImgSum(p_Vid->pCurImg, p_Vid->height, p_Vid->width);
+  dc_org = ComputeImgSum(p_Vid->p_wp_org, p_Vid->pCurImg, p_Vid->height, p_Vid->width);
 
   if (p_Inp->ChromaWeightSupport == 1)
   {
     for (k = 0; k < 2; k++)
     {
-      dc_org_UV[k] = ComputeImgSum(p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
+      dc_org_UV[k] = ComputeImgSum(p_Vid->p_wp_org, p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
     } 
   }
 
@@ -280,7 +294,7 @@ void EstimateWPPSliceAlg0(Slice *currSlice, int select_offset)
 
         // Y
         tmpPtr = currSlice->listX[clist][n]->p_curr_img;      
-        dc_ref[n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+        dc_ref[n] = ComputeImgSum(currSlice->listX[clist][n]->wp_moments, tmpPtr, p_Vid->height, p_Vid->width);
 
         if (p_Inp->ChromaWeightSupport == 1)
         {
@@ -288,7 +302,7 @@ void EstimateWPPSliceAlg0(Slice *currSlice, int select_offset)
           {
             // UV
             tmpPtr = currSlice->listX[clist][n]->imgUV[k];
-            dc_ref_UV[n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+            dc_ref_UV[n][k] = ComputeImgSum(currSlice->listX[clist][n]->wp_moments, tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
           }        
         }
 
@@ -438,13 +452,13 @@ void EstimateWPBSliceAlg0(Slice *currSlice)
   }
   else
   {
-    dc_org = ComputeImgSum(p_Vid->pCurImg, p_Vid->height, p_Vid->width);
+    dc_org = ComputeImgSum(p_Vid->p_wp_org, p_Vid->pCurImg, p_Vid->height, p_Vid->width);
 
     if (p_Inp->ChromaWeightSupport == 1)
     {
       for (k = 0; k < 2; k++)
       {
-        dc_org_UV[k] = ComputeImgSum(p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
+        dc_org_UV[k] = ComputeImgSum(p_Vid->p_wp_org, p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
       } 
     }
 
@@ -466,7 +480,7 @@ void EstimateWPBSliceAlg0(Slice *currSlice)
           // stored in the reference buffer and attach them to the storedimage structure!!!
           // Y
           tmpPtr = currSlice->listX[clist][n]->p_curr_img;
-          dc_ref[clist][n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+          dc_ref[clist][n] = ComputeImgSum(currSlice->listX[clist][n]->wp_moments, tmpPtr, p_Vid->height, p_Vid->width);
 
           if (dc_ref[clist][n] != 0.0)
             wf_weight = (short) (default_weight[0] * dc_org / dc_ref[clist][n] + 0.5);
@@ -486,7 +500,7 @@ void EstimateWPBSliceAlg0(Slice *currSlice)
             for (k = 0; k < 2; k++)
             {        	
               tmpPtr = currSlice->listX[clist][n]->imgUV[k];
-              dc_ref_UV[clist][n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+              dc_ref_UV[clist][n][k] = ComputeImgSum(currSlice->listX[clist][n]->wp_moments, tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
 
               if (dc_ref_UV[clist][n][k] != 0.0)
                 wf_weight = (short) (default_weight[k + 1] * dc_org_UV[k] / dc_ref_UV[clist][n][k] + 0.5);
@@ -604,13 +618,13 @@ int TestWPPSliceAlg0(Slice *currSlice, int select_offset)
     }
   }
 
-  dc_org = ComputeImgSum(p_Vid->pCurImg, p_Vid->height, p_Vid->width);
+  dc_org = ComputeImgSum(p_Vid->p_wp_org, p_Vid->pCurImg, p_Vid->height, p_Vid->width);
 
   if (p_Inp->ChromaWeightSupport == 1)
   {
     for (k = 0; k < 2; k++)
     {
-      dc_org_UV[k] = ComputeImgSum(p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
+      dc_org_UV[k] = ComputeImgSum(p_Vid->p_wp_org, p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
     } 
   }
 
@@ -619,14 +633,14 @@ int TestWPPSliceAlg0(Slice *currSlice, int select_offset)
     for (n = 0; n < currSlice->listXsize[clist]; n++)
     {
       tmpPtr = currSlice->listX[clist][n]->p_curr_img;
-      dc_ref[n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+      dc_ref[n] = ComputeImgSum(currSlice->listX[clist][n]->wp_moments, tmpPtr, p_Vid->height, p_Vid->width);
 
       if (p_Inp->ChromaWeightSupport == 1)
       {
         for (k = 0; k < 2; k++)
         {
           tmpPtr = currSlice->listX[clist][n]->imgUV[k];
-          dc_ref_UV[n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+          dc_ref_UV[n][k] = ComputeImgSum(currSlice->listX[clist][n]->wp_moments, tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
         }        
       }
 
@@ -787,13 +801,13 @@ int TestWPBSliceAlg0(Slice *currSlice, int select_method)
   }
   else
   {
-    dc_org = ComputeImgSum(p_Vid->pCurImg, p_Vid->height, p_Vid->width);
+    dc_org = ComputeImgSum(p_Vid->p_wp_org, p_Vid->pCurImg, p_Vid->height, p_Vid->width);
 
     if (p_Inp->ChromaWeightSupport == 1)
     {
       for (k = 0; k < 2; k++)
       {
-        dc_org_UV[k] = ComputeImgSum(p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
+        dc_org_UV[k] = ComputeImgSum(p_Vid->p_wp_org, p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
       } 
     }
 
@@ -805,7 +819,7 @@ int TestWPBSliceAlg0(Slice *currSlice, int select_method)
         // stored in the reference buffer and attach them to the storedimage structure!!!
         // Y
         tmpPtr = currSlice->listX[clist][n]->p_curr_img;
-        dc_ref[clist][n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+        dc_ref[clist][n] = ComputeImgSum(currSlice->listX[clist][n]->wp_moments, tmpPtr, p_Vid->height, p_Vid->width);
 
         if (dc_ref[clist][n] != 0.0)
           wf_weight = (short) (default_weight[0] * dc_org / dc_ref[clist][n] + 0.5);
@@ -823,7 +837,7 @@ int TestWPBSliceAlg0(Slice *currSlice, int select_method)
           for (k = 0; k < 2; k++)
           {
             tmpPtr = currSlice->listX[clist][n]->imgUV[k];
-            dc_ref_UV[clist][n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+            dc_ref_UV[clist][n][k] = ComputeImgSum(currSlice->listX[clist][n]->wp_moments, tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
 
             if (dc_ref_UV[clist][n][k] != 0.0)
               wf_weight = (short) (default_weight[k + 1] * dc_org_UV[k] / dc_ref_UV[clist][n][k] + 0.5);
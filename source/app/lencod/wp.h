@@ -22,6 +22,7 @@
 #include "wp_mciter.h"
 #include "wp_random.h"
 #include "wp_periodic.h"
+#include "wp_moments.h"
 
 #define DEBUG_WP  0
 
@@ -32,9 +33,9 @@ extern void   EstimateWPBSliceAlg0   (Slice *currSlice);
 extern void   EstimateWPPSliceAlg0   (Slice *currSlice, int offset);
 extern int    TestWPPSliceAlg0       (Slice *currSlice, int offset);
 extern int    TestWPBSliceAlg0       (Slice *currSlice, int method);
-extern double ComputeImgSum          (imgpel **CurrentImage, int height, int width);
-extern void   ComputeImgSumBlockBased(imgpel **CurrentImage, int height_in_blk, int width_in_blk, int blk_size_y, int blk_size_x, int start_blk, int end_blk, double *dc);
-extern int64  ComputeSumBlockBased   (imgpel **CurrentImage, int height_in_blk, int width_in_blk, int blk_size_y, int blk_size_x, int start_blk, int end_blk);
+extern double ComputeImgSum          (WPMoments *moments, imgpel **CurrentImage, int height, int width);
+extern void   ComputeImgSumBlockBased(WPMoments *moments, imgpel **CurrentImage, int height_in_blk, int width_in_blk, int blk_size_y, int blk_size_x, int start_blk, int end_blk, double *dc);
+extern int64  ComputeSumBlockBased   (WPMoments *moments, imgpel **CurrentImage, int height_in_blk, int width_in_blk, int blk_size_y, int blk_size_x, int start_blk, int end_blk);
 
 extern void   ComputeImplicitWeights    (Slice *currSlice,
                                          short default_weight[3],
@@ -105,7 +105,7 @@ void ComputeExplicitWPParamsLMS(Slice *currSlice,
   slice_size    = (end_mb-start_mb)*MB_BLOCK_SIZE*MB_BLOCK_SIZE;
   slice_size_cr = (end_mb-start_mb)*p_Vid->mb_cr_size_x*p_Vid->mb_cr_size_y;
 
-  ComputeImgSumBlockBased(p_Vid->pCurImg, p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, MB_BLOCK_SIZE, MB_BLOCK_SIZE,
+  ComputeImgSumBlockBased(p_Vid->p_wp_org, p_Vid->pCurImg, p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, MB_BLOCK_SIZE, MB_BLOCK_SIZE,
     start_mb, end_mb, &dc_org[0]);  
 
   norm_org[0] = dc_org[0]/((double) slice_size);
@@ -116,7 +116,7 @@ void ComputeExplicitWPParamsLMS(Slice *currSlice,
   {
     for (k = 0; k < 2; k++)
     {
-      ComputeImgSumBlockBased(p_Vid->pImgOrg[k + 1], p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x,
+      ComputeImgSumBlockBased(p_Vid->p_wp_org, p_Vid->pImgOrg[k + 1], p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x,
         start_mb, end_mb, &dc_org[k+1]);  
     } 
   }
@@ -126,7 +126,7 @@ void ComputeExplicitWPParamsLMS(Slice *currSlice,
     for (n = 0; n < currSlice->listXsize[clist]; n++)
     {
       cur_ref = currSlice->listX[clist][n]->p_curr_img;
-      ComputeImgSumBlockBased(cur_ref, p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, MB_BLOCK_SIZE, MB_BLOCK_SIZE, 
+      ComputeImgSumBlockBased(currSlice->listX[clist][n]->wp_moments, cur_ref, p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, MB_BLOCK_SIZE, MB_BLOCK_SIZE, 
         start_mb, end_mb, &dc_ref[0]);  
       norm_ref[0] = dc_ref[0] / ((double) slice_size);
       ComputeNormMeanBlockBased(cur_ref, p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, MB_BLOCK_SIZE, MB_BLOCK_SIZE, 
@@ -137,7 +137,7 @@ void ComputeExplicitWPParamsLMS(Slice *currSlice,
         for (k = 0; k < 2; k++)
         {
           cur_ref = currSlice->listX[clist][n]->imgUV[k];
-          ComputeImgSumBlockBased(cur_ref, p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x, 
+          ComputeImgSumBlockBased(currSlice->listX[clist][n]->wp_moments, cur_ref, p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x, 
             start_mb, end_mb, &dc_ref[k+1]);  
         }        
       }
@@ -235,14 +235,14 @@ void ComputeExplicitWPParamsJNT(Slice *currSlice,
     }
   }
 
-  dc_org[0] = ComputeSumBlockBased   (p_Vid->pCurImg, p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, MB_BLOCK_SIZE, MB_BLOCK_SIZE,
+  dc_org[0] = ComputeSumBlockBased   (p_Vid->p_wp_org, p_Vid->pCurImg, p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, MB_BLOCK_SIZE, MB_BLOCK_SIZE,
     start_mb, end_mb);  
 
   if (p_Inp->ChromaWeightSupport == 1)
   {
     for (k = 0; k < 2; k++)
     {
-      dc_org[k+1] = ComputeSumBlockBased(p_Vid->pImgOrg[k + 1], p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x,
+      dc_org[k+1] = ComputeSumBlockBased(p_Vid->p_wp_org, p_Vid->pImgOrg[k + 1], p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x,
         start_mb, end_mb);  
     } 
   }
@@ -252,14 +252,14 @@ void ComputeExplicitWPParamsJNT(Slice *currSlice,
     for (n = 0; n < currSlice->listXsize[clist]; n++)
     {
       cur_ref = currSlice->listX[clist][n]->p_curr_img;
-      dc_cur_ref[clist][n][0] = ComputeSumBlockBased (cur_ref, p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, MB_BLOCK_SIZE, MB_BLOCK_SIZE, start_mb, end_mb);  
+      dc_cur_ref[clist][n][0] = ComputeSumBlockBased (currSlice->listX[clist][n]->wp_moments, cur_ref, p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, MB_BLOCK_SIZE, MB_BLOCK_SIZE, start_mb, end_mb);  
 
       if (p_Inp->ChromaWeightSupport == 1)
       {
         for (k = 0; k < 2; k++)
         {
           cur_ref = currSlice->listX[clist][n]->imgUV[k];
-          dc_cur_ref[clist][n][k+1] = ComputeSumBlockBased (cur_ref, p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x, start_mb, end_mb);  
+          dc_cur_ref[clist][n][k+1] = ComputeSumBlockBased (currSlice->listX[clist][n]->wp_moments, cur_ref, p_Vid->FrameHeightInMbs, p_Vid->PicWidthInMbs, p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x, start_mb, end_mb);  
         }        
       }
     }
@@ -51,13 +51,13 @@ void EstimateWPPSliceAlg2(Slice *currSlice, int select_offset)
   default_weight[0]       = 1 << currSlice->luma_log_weight_denom;
   default_weight[1]       = default_weight[2] = 1 << currSlice->chroma_log_weight_denom;
   
-  dc_org = ComputeImgSum(p_Vid->pCurImg, p_Vid->height, p_Vid->width);
+  dc_org = ComputeImgSum(p_Vid->p_wp_org, p_Vid->pCurImg, p_Vid->height, p_Vid->width);
 
   if (p_Inp->ChromaWeightSupport == 1)
   {
     for (k = 0; k < 2; k++)
     {
-      dc_org_UV[k] = ComputeImgSum(p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
+      dc_org_UV[k] = ComputeImgSum(p_Vid->p_wp_org, p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
     } 
   }
 
@@ -78,7 +78,7 @@ void EstimateWPPSliceAlg2(Slice *currSlice, int select_offset)
 
         // Y
         tmpPtr = currSlice->listX[clist][n]->p_curr_img;      
-        dc_ref[n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+        dc_ref[n] = ComputeImgSum(currSlice->listX[clist][n]->wp_moments, tmpPtr, p_Vid->height, p_Vid->width);
 
         if (p_Inp->ChromaWeightSupport == 1)
         {
@@ -86,7 +86,7 @@ void EstimateWPPSliceAlg2(Slice *currSlice, int select_offset)
           {
             // UV
             tmpPtr = currSlice->listX[clist][n]->imgUV[k];
-            dc_ref_UV[n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+            dc_ref_UV[n][k] = ComputeImgSum(currSlice->listX[clist][n]->wp_moments, tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
           }        
         }
 
@@ -260,13 +260,13 @@ void EstimateWPBSliceAlg2(Slice *currSlice)
   }
   else
   {
-    //dc_org = ComputeImgSum(p_Vid->pCurImg, p_Vid->height, p_Vid->width);
+    //dc_org = ComputeImgSum(p_Vid->p_wp_org, p_Vid->pCurImg, p_Vid->height, p_Vid->width);
 
     if (p_Inp->ChromaWeightSupport == 1)
     {
       for (k = 0; k < 2; k++)
       {
-        dc_org_UV[k] = ComputeImgSum(p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
+        dc_org_UV[k] = ComputeImgSum(p_Vid->p_wp_org, p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
       } 
     }
 
@@ -295,7 +295,7 @@ void EstimateWPBSliceAlg2(Slice *currSlice)
             for (k = 0; k < 2; k++)
             {
               tmpPtr = currSlice->listX[clist][n]->imgUV[k];
-              dc_ref_UV[clist][n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+              dc_ref_UV[clist][n][k] = ComputeImgSum(currSlice->listX[clist][n]->wp_moments, tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
 
               if (dc_ref_UV[clist][n][k] != 0.0)
                 wf_weight = (short) (default_weight[k + 1] * dc_org_UV[k] / dc_ref_UV[clist][n][k] + 0.5);
@@ -414,13 +414,13 @@ int TestWPPSliceAlg2(Slice *currSlice, int select_offset)
     }
   }
 
-  dc_org = ComputeImgSum(p_Vid->pCurImg, p_Vid->height, p_Vid->width);
+  dc_org = ComputeImgSum(p_Vid->p_wp_org, p_Vid->pCurImg, p_Vid->height, p_Vid->width);
 
   if (p_Inp->ChromaWeightSupport == 1)
   {
     for (k = 0; k < 2; k++)
     {
-      dc_org_UV[k] = ComputeImgSum(p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
+      dc_org_UV[k] = ComputeImgSum(p_Vid->p_wp_org, p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
     } 
   }
 
@@ -429,14 +429,14 @@ int TestWPPSliceAlg2(Slice *currSlice, int select_offset)
     for (n = 0; n < currSlice->listXsize[clist]; n++)
     {
       tmpPtr = currSlice->listX[clist][n]->p_curr_img;
-      dc_ref[n] = ComputeImgSum(tmpPtr, p_Vid->height, p_Vid->width);
+      dc_ref[n] = ComputeImgSum(currSlice->listX[clist][n]->wp_moments, tmpPtr, p_Vid->height, p_Vid->width);
 
       if (p_Inp->ChromaWeightSupport == 1)
       {
         for (k = 0; k < 2; k++)
         {
           tmpPtr = currSlice->listX[clist][n]->imgUV[k];
-          dc_ref_UV[n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+          dc_ref_UV[n][k] = ComputeImgSum(currSlice->listX[clist][n]->wp_moments, tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
         }        
       }
 
@@ -638,13 +638,13 @@ int TestWPBSliceAlg2(Slice *currSlice, int select_method)
   else
   {
     /*
-    dc_org = ComputeImgSum(p_Vid->pCurImg, p_Vid->height, p_Vid->width);
+    dc_org = ComputeImgSum(p_Vid->p_wp_org, p_Vid->pCurImg, p_Vid->height, p_Vid->width);
 
     if (p_Inp->ChromaWeightSupport == 1)
     {
       for (k = 0; k < 2; k++)
       {
-        dc_org_UV[k] = ComputeImgSum(p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
+        dc_org_UV[k] = ComputeImgSum(p_Vid->p_wp_org, p_Vid->pImgOrg[k + 1], p_Vid->height_cr, p_Vid->width_cr);
       } 
     }
     */
@@ -662,7 +662,7 @@ int TestWPBSliceAlg2(Slice *currSlice, int select_method)
           for (k = 0; k < 2; k++)
           {
             tmpPtr = currSlice->listX[clist][n]->imgUV[k];
-            dc_ref_UV[clist][n][k] = ComputeImgSum(tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
+            dc_ref_UV[clist][n][k] = ComputeImgSum(currSlice->listX[clist][n]->wp_moments, tmpPtr, p_Vid->height_cr, p_Vid->width_cr);
 
             if (dc_ref_UV[clist][n][k] != 0.0)
               wf_weight = (short) (default_weight[k + 1] * dc_org_UV[k] / dc_ref_UV[clist][n][k] + 0.5);
@@ -0,0 +1,260 @@
+/*!
+ *************************************************************************************
+ * \file wp_moments.c
+ *
+ * \brief
+ *    Sample sums of the source and reference pictures for the weighted
+ *    prediction estimators.
+ *
+ *    The sums are computed once per picture and plane on the macroblock
+ *    grid: the rows of a block row are added into column sums (a loop over
+ *    whole rows that the compiler vectorizes) which are then split into
+ *    the blocks. The block sums are accumulated in raster order, so that
+ *    the sum of any range of macroblocks (a slice) takes two reads.
+ *
+ *    The sums of a picture are only written before the picture is used
+ *    for estimation (after reading the source, when storing a reference),
+ *    so that the concurrently coded passes read them without locking.
+ *
+ *************************************************************************************
+ */
+
+#include "global.h"
+#include "memalloc.h"
+#include "wp_moments.h"
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Weighted prediction may be estimated for some picture
+ ************************************************************************
+ */
+int wp_moments_enabled(InputParameters *p_Inp)
+{
+  return (p_Inp->WeightedPrediction || p_Inp->WeightedBiprediction || p_Inp->GenerateMultiplePPS) && p_Inp->intra_period != 1;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Free the sums of a picture
+ ************************************************************************
+ */
+void wp_moments_free(WPMoments *moments)
+{
+  int i;
+
+  if (moments == NULL)
+    return;
+
+  for (i = 0; i < moments->num_planes; ++i)
+    free(moments->plane[i].acc);
+  free(moments);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Compute the accumulated block sums of a plane into the next free
+ *    entry of moments
+ ************************************************************************
+ */
+static void wp_add_plane(WPMoments *moments, imgpel **img, int height_in_blk, int width_in_blk, int blk_size_y, int blk_size_x)
+{
+  WPPlaneSums *plane;
+  int width = width_in_blk * blk_size_x;
+  int num_blks = height_in_blk * width_in_blk;
+  int *col;
+  int bx, by, x, y;
+
+  if (img == NULL || num_blks <= 0 || moments->num_planes == WP_MOMENTS_PLANES)
+    return;
+
+  plane = &moments->plane[moments->num_planes++];
+  if ((plane->acc = (int64 *) malloc((num_blks + 1) * sizeof(int64))) == NULL)
+    no_mem_exit("wp_add_plane: plane->acc");
+  if ((col = (int *) malloc(width * sizeof(int))) == NULL)
+    no_mem_exit("wp_add_plane: col");
+
+  plane->img           = img;
+  plane->width_in_blk  = width_in_blk;
+  plane->height_in_blk = height_in_blk;
+  plane->blk_size_x    = blk_size_x;
+  plane->blk_size_y    = blk_size_y;
+  plane->acc[0]        = 0;
+
+  for (by = 0; by < height_in_blk; ++by)
+  {
+    int64 *acc = &plane->acc[by * width_in_blk];
+
+    memset(col, 0, width * sizeof(int));
+    for (y = 0; y < blk_size_y; ++y)
+    {
+      const imgpel *row = img[by * blk_size_y + y];
+
+      for (x = 0; x < width; ++x)
+        col[x] += row[x];
+    }
+    for (bx = 0; bx < width_in_blk; ++bx)
+    {
+      const int *blk = &col[bx * blk_size_x];
+      int sum = 0;
+
+      for (x = 0; x < blk_size_x; ++x)
+        sum += blk[x];
+      acc[bx + 1] = acc[bx] + sum;
+    }
+  }
+
+  free(col);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Compute the sums of the source picture just read, for the frame and,
+ *    with interlaced coding, for its fields
+ ************************************************************************
+ */
+void wp_moments_org(VideoParameters *p_Vid)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+  ImageData *imgData = &p_Vid->imgData;
+  int height_in_mbs = p_Vid->FrameHeightInMbs;
+  int width_in_mbs  = p_Vid->PicWidthInMbs;
+  int k;
+
+  if (!wp_moments_enabled(p_Inp))
+    return;
+
+  // the planes of the previous source picture may be in other buffers
+  wp_moments_free(p_Vid->p_wp_org);
+  if ((p_Vid->p_wp_org = (WPMoments *) calloc(1, sizeof(WPMoments))) == NULL)
+    no_mem_exit("wp_moments_org: p_Vid->p_wp_org");
+
+  wp_add_plane(p_Vid->p_wp_org, imgData->frm_data[0], height_in_mbs, width_in_mbs, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  if (p_Inp->PicInterlace || p_Inp->MbInterlace)
+  {
+    wp_add_plane(p_Vid->p_wp_org, imgData->top_data[0], height_in_mbs >> 1, width_in_mbs, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+    wp_add_plane(p_Vid->p_wp_org, imgData->bot_data[0], height_in_mbs >> 1, width_in_mbs, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  }
+
+  if (p_Vid->yuv_format != YUV400)
+  {
+    for (k = 1; k < 3; ++k)
+    {
+      wp_add_plane(p_Vid->p_wp_org, imgData->frm_data[k], height_in_mbs, width_in_mbs, p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x);
+      if (p_Inp->PicInterlace || p_Inp->MbInterlace)
+      {
+        wp_add_plane(p_Vid->p_wp_org, imgData->top_data[k], height_in_mbs >> 1, width_in_mbs, p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x);
+        wp_add_plane(p_Vid->p_wp_org, imgData->bot_data[k], height_in_mbs >> 1, width_in_mbs, p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x);
+      }
+    }
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Compute the sums of a reconstructed reference picture
+ ************************************************************************
+ */
+static void wp_moments_picture(VideoParameters *p_Vid, StorablePicture *p)
+{
+  int height_in_mbs, width_in_mbs;
+
+  if (p == NULL || p->wp_moments != NULL || p->imgY == NULL)
+    return;
+
+  if ((p->wp_moments = (WPMoments *) calloc(1, sizeof(WPMoments))) == NULL)
+    no_mem_exit("wp_moments_picture: p->wp_moments");
+
+  height_in_mbs = p->size_y / MB_BLOCK_SIZE;
+  width_in_mbs  = p->size_x / MB_BLOCK_SIZE;
+
+  wp_add_plane(p->wp_moments, p->imgY, height_in_mbs, width_in_mbs, MB_BLOCK_SIZE, MB_BLOCK_SIZE);
+  if (p_Vid->yuv_format != YUV400 && p->imgUV != NULL)
+  {
+    wp_add_plane(p->wp_moments, p->imgUV[0], height_in_mbs, width_in_mbs, p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x);
+    wp_add_plane(p->wp_moments, p->imgUV[1], height_in_mbs, width_in_mbs, p_Vid->mb_cr_size_y, p_Vid->mb_cr_size_x);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Compute the sums of the reference pictures of a frame store just
+ *    filled (the field views only with interlaced coding)
+ ************************************************************************
+ */
+void wp_moments_store(VideoParameters *p_Vid, FrameStore *fs)
+{
+  InputParameters *p_Inp = p_Vid->p_Inp;
+
+  if (!wp_moments_enabled(p_Inp) || !fs->is_reference)
+    return;
+
+  wp_moments_picture(p_Vid, fs->frame);
+  if (p_Inp->PicInterlace || p_Inp->MbInterlace)
+  {
+    wp_moments_picture(p_Vid, fs->top_field);
+    wp_moments_picture(p_Vid, fs->bottom_field);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Sum of the blocks start_blk .. end_blk - 1 of a block grid of img
+ * \return
+ *    0 if there are no sums for the plane and grid
+ ************************************************************************
+ */
+int wp_moments_sum(WPMoments *moments, imgpel **img, int width_in_blk, int blk_size_y, int blk_size_x, int start_blk, int end_blk, int64 *sum)
+{
+  int i;
+
+  if (moments == NULL)
+    return 0;
+
+  for (i = 0; i < moments->num_planes; ++i)
+  {
+    WPPlaneSums *plane = &moments->plane[i];
+
+    if (plane->img == img && plane->width_in_blk == width_in_blk && plane->blk_size_y == blk_size_y && plane->blk_size_x == blk_size_x
+      && start_blk >= 0 && start_blk <= end_blk && end_blk <= plane->width_in_blk * plane->height_in_blk)
+    {
+      *sum = plane->acc[end_blk] - plane->acc[start_blk];
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Sum of the samples of the height x width area of img
+ * \return
+ *    0 if there are no sums for the plane covering exactly that area
+ ************************************************************************
+ */
+int wp_moments_plane_sum(WPMoments *moments, imgpel **img, int height, int width, int64 *sum)
+{
+  int i;
+
+  if (moments == NULL)
+    return 0;
+
+  for (i = 0; i < moments->num_planes; ++i)
+  {
+    WPPlaneSums *plane = &moments->plane[i];
+
+    if (plane->img == img && plane->height_in_blk * plane->blk_size_y == height && plane->width_in_blk * plane->blk_size_x == width)
+    {
+      *sum = plane->acc[plane->width_in_blk * plane->height_in_blk];
+      return 1;
+    }
+  }
+  return 0;
+}
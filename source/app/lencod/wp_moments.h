@@ -0,0 +1,51 @@
+/*!
+ ***************************************************************************
+ * \file
+ *    wp_moments.h
+ *
+ * \brief
+ *    Headerfile for the sample sums shared by the weighted prediction
+ *    estimators.
+ *
+ *    The macroblock sums of the source picture are computed once after it
+ *    is read, and those of a reference picture once when it is stored in
+ *    the DPB. The DC, LMS, joint and iterative estimators and their tests
+ *    then read the sums of a picture or of a range of macroblocks from the
+ *    accumulated block sums instead of scanning the samples again. A plane
+ *    or a block grid without stored sums is scanned as before.
+ **************************************************************************
+ */
+
+#ifndef _WP_MOMENTS_H_
+#define _WP_MOMENTS_H_
+
+#include "global.h"
+#include "mbuffer.h"
+
+#define WP_MOMENTS_PLANES  9   //!< frame, top and bottom field of three colour planes
+
+//! macroblock sums of one plane
+typedef struct wp_plane_sums
+{
+  imgpel **img;               //!< plane the sums belong to (NULL: unused)
+  int      width_in_blk;
+  int      height_in_blk;
+  int      blk_size_x;
+  int      blk_size_y;
+  int64   *acc;               //!< acc[b]: sum of the blocks 0 .. b - 1 in raster order
+} WPPlaneSums;
+
+typedef struct wp_moments
+{
+  WPPlaneSums plane[WP_MOMENTS_PLANES];
+  int         num_planes;
+} WPMoments;
+
+extern int    wp_moments_enabled  (InputParameters *p_Inp);
+extern void   wp_moments_free     (WPMoments *moments);
+extern void   wp_moments_org      (VideoParameters *p_Vid);
+extern void   wp_moments_store    (VideoParameters *p_Vid, FrameStore *fs);
+extern int    wp_moments_sum      (WPMoments *moments, imgpel **img, int width_in_blk, int blk_size_y, int blk_size_x, int start_blk, int end_blk, int64 *sum);
+extern int    wp_moments_plane_sum(WPMoments *moments, imgpel **img, int height, int width, int64 *sum);
+
+#endif
@@ -17,6 +17,25 @@
 #define _ENC_STATISTICS_H_
 #include "global.h"
 
+//! Candidate counters of the integer pel motion search engines
+typedef struct me_cand_stats
+{
+  int64  searches;                    //!< integer pel searches performed
+  int64  proposed;                    //!< candidates proposed by predictors and search patterns
+  int64  accepted;                    //!< candidates left after range check and duplicate removal
+  int64  scored;                      //!< candidates for which the distortion was computed
+} MECandStats;
+
+#define MD_PRUNE_RULES  4             //!< number of mode decision pruning rules
+
+//! Counters of the mode decision pruning rules
+typedef struct md_prune_stats
+{
+  int64  checked[MD_PRUNE_RULES];     //!< mode decisions for which the rule was tested
+  int64  hits   [MD_PRUNE_RULES];     //!< mode decisions for which the rule fired
+  int64  misses [MD_PRUNE_RULES];     //!< audit mode: rule fired but one of its modes was selected
+} MDPruneStats;
+
 struct stat_parameters
 {
   float  bitrate;                     //!< average bit rate for the sequence except first frame
@@ -53,6 +72,9 @@ struct stat_parameters
   int64  bit_ctr_filler_data;
   int64  bit_ctr_filler_data_n;
 
+  MECandStats me_cand;                //!< motion search candidate statistics
+  MDPruneStats md_prune;              //!< mode decision pruning statistics
+
 #if (MVC_EXTENSION_ENABLE)
   float  bitrate_v[2];                       //!< average bit rate for the sequence except first frame
   int64  bit_ctr_v[2];                     //!< counter for bit usage
@@ -23,6 +23,9 @@
 #endif
 #include <math.h>
 #include <limits.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 
 static inline short smin(short a, short b)
@@ -260,6 +263,43 @@ static inline int64 i64_power2(int x)
   return((x > 63) ? 0 : po2[x]);
 }
 
+//! floor(log2(x)) for x > 0
+static inline int ilog2(uint32 x)
+{
+#if defined(__GNUC__)
+  return 31 - __builtin_clz(x);
+#elif defined(_MSC_VER)
+  unsigned long idx;
+  _BitScanReverse(&idx, x);
+  return (int) idx;
+#else
+  int n = 0;
+  while (x >>= 1)
+    n++;
+  return n;
+#endif
+}
+
+//! number of trailing zero bits of x > 0
+static inline int ictz(uint64 x)
+{
+#if defined(__GNUC__)
+  return __builtin_ctzll(x);
+#elif defined(_MSC_VER) && defined(_WIN64)
+  unsigned long idx;
+  _BitScanForward64(&idx, x);
+  return (int) idx;
+#else
+  int n = 0;
+  while (!(x & 1))
+  {
+    x >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
 static inline int float2int (float x)
 {
   return (int)((x < 0) ? (x - 0.5f) : (x + 0.5f));
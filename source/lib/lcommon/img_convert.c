@@ -0,0 +1,697 @@
+/*!
+ *************************************************************************************
+ * \file img_convert.c
+ *
+ * \brief
+ *    Conversion of file read buffers to image planes: deinterleaving of
+ *    packed formats, sample size and bit depth conversion and padding.
+ *
+ *    The conversions work on whole rows with the sample size resolved
+ *    outside of the inner loops, so that the compiler can vectorize
+ *    them. The packed 4:2:2 formats use SSSE3 byte shuffles if available.
+ *
+ * \author
+ *    Main contributors (see contributors.h for copyright, address and affiliation details)
+ *     - Karsten Suehring
+ *     - Alexis Michael Tourapis         <alexismt@ieee.org>
+ *************************************************************************************
+ */
+#include "contributors.h"
+
+#include "global.h"
+#include "input.h"
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Distribute the samples of a packed buffer to the component planes.
+ *    Each group of "group_size" samples holds the components listed in
+ *    "pattern" (0: Y, 1: U, 2: V).
+ ************************************************************************
+ */
+static void deinterleave_packed ( unsigned char *icmp, unsigned char *ocmp[3], const int *pattern, int group_size, int num_groups, int symbol_size_in_bytes)
+{
+  int i, k;
+
+  if (symbol_size_in_bytes == 1)
+  {
+    unsigned char *out[3] = { ocmp[0], ocmp[1], ocmp[2] };
+
+    for (i = 0; i < num_groups; i++)
+      for (k = 0; k < group_size; k++)
+        *(out[pattern[k]]++) = *(icmp++);
+  }
+  else if (symbol_size_in_bytes == 2)
+  {
+    uint16 *in = (uint16 *) icmp;
+    uint16 *out[3] = { (uint16 *) ocmp[0], (uint16 *) ocmp[1], (uint16 *) ocmp[2] };
+
+    for (i = 0; i < num_groups; i++)
+      for (k = 0; k < group_size; k++)
+        *(out[pattern[k]]++) = *(in++);
+  }
+  else
+  {
+    unsigned char *out[3] = { ocmp[0], ocmp[1], ocmp[2] };
+
+    for (i = 0; i < num_groups; i++)
+    {
+      for (k = 0; k < group_size; k++)
+      {
+        memcpy(out[pattern[k]], icmp, symbol_size_in_bytes);
+        out[pattern[k]] += symbol_size_in_bytes;
+        icmp += symbol_size_in_bytes;
+      }
+    }
+  }
+}
+
+#if defined(__SSSE3__)
+/*!
+ ************************************************************************
+ * \brief
+ *    Packed 4:2:2 (two luma and two chroma samples per group) with
+ *    8 or 16 bit samples, 32 bytes per iteration
+ * \return
+ *    number of groups done
+ ************************************************************************
+ */
+static int deinterleave_422_ssse3 ( unsigned char *icmp, unsigned char *ocmp[3], const int pattern[4], int num_groups, int symbol_size_in_bytes)
+{
+  int groups_per_vec = 4 / symbol_size_in_bytes;     // groups in 16 bytes
+  int num_vec = num_groups / (2 * groups_per_vec);
+  int luma_bytes = 2 * groups_per_vec * symbol_size_in_bytes;
+  int pos[3] = { 0, 0, 0 };
+  char mask[16];
+  __m128i shuf, a, b, uv;
+  int g, k, c, n, i;
+
+  // mask: the luma bytes of the groups, then the U bytes and the V bytes
+  for (g = 0; g < groups_per_vec; g++)
+  {
+    for (k = 0; k < 4; k++)
+    {
+      c = pattern[k];
+      n = (c == 0) ? pos[0]++ : pos[c]++;
+      for (i = 0; i < symbol_size_in_bytes; i++)
+        mask[(c == 0 ? 0 : luma_bytes + (c - 1) * (luma_bytes >> 1)) + n * symbol_size_in_bytes + i] = (char) ((g * 4 + k) * symbol_size_in_bytes + i);
+    }
+  }
+  shuf = _mm_loadu_si128((const __m128i *) mask);
+
+  for (n = 0; n < num_vec; n++)
+  {
+    a = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) icmp), shuf);
+    b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (icmp + 16)), shuf);
+    icmp += 32;
+
+    // a, b: 8 luma bytes, 4 U bytes, 4 V bytes each
+    _mm_storeu_si128((__m128i *) ocmp[0], _mm_unpacklo_epi64(a, b));
+    uv = _mm_unpackhi_epi32(a, b);
+    _mm_storel_epi64((__m128i *) ocmp[1], uv);
+    _mm_storel_epi64((__m128i *) ocmp[2], _mm_srli_si128(uv, 8));
+    ocmp[0] += 16;
+    ocmp[1] += 8;
+    ocmp[2] += 8;
+  }
+
+  return num_vec * 2 * groups_per_vec;
+}
+#endif
+
+static void deinterleave_yuv420( unsigned char** input,       //!< input buffer
+  unsigned char** output,      //!< output buffer
+  FrameFormat *source,         //!< format of source buffer
+  int symbol_size_in_bytes     //!< number of bytes per symbol
+  ) 
+{
+  // U Y Y V Y Y
+  static const int pattern[6] = { 1, 0, 0, 2, 0, 0 };
+  unsigned char *icmp = *input;
+  unsigned char *ocmp[3];
+
+  ocmp[0] = *output;
+  ocmp[1] = ocmp[0] + symbol_size_in_bytes * source->size_cmp[Y_COMP];
+  ocmp[2] = ocmp[1] + symbol_size_in_bytes * source->size_cmp[U_COMP];
+
+  deinterleave_packed(icmp, ocmp, pattern, 6, source->size_cmp[U_COMP], symbol_size_in_bytes);
+
+  // flip buffers
+  *input  = *output;
+  *output = icmp;  
+}
+
+static void deinterleave_yuv444( unsigned char** input,       //!< input buffer
+  unsigned char** output,      //!< output buffer
+  FrameFormat *source,         //!< format of source buffer
+  int symbol_size_in_bytes     //!< number of bytes per symbol
+  ) 
+{
+  static const int pattern[3] = { 0, 1, 2 };
+  unsigned char *icmp = *input;
+  unsigned char *ocmp[3];
+
+  ocmp[0] = *output;
+  ocmp[1] = ocmp[0] + symbol_size_in_bytes * source->size_cmp[Y_COMP];
+  ocmp[2] = ocmp[1] + symbol_size_in_bytes * source->size_cmp[U_COMP];
+
+  deinterleave_packed(icmp, ocmp, pattern, 3, source->size_cmp[Y_COMP], symbol_size_in_bytes);
+
+  // flip buffers
+  *input  = *output;
+  *output = icmp;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Packed 4:2:2 formats (YUYV, YVYU, UYVY)
+ ************************************************************************
+ */
+static void deinterleave_422 ( unsigned char** input,       //!< input buffer
+  unsigned char** output,      //!< output buffer
+  FrameFormat *source,         //!< format of source buffer
+  int symbol_size_in_bytes,    //!< number of bytes per symbol
+  const int pattern[4]         //!< component order of a group
+  ) 
+{
+  unsigned char *icmp = *input;
+  unsigned char *ocmp[3];
+  int num_groups = source->size_cmp[U_COMP];
+
+  ocmp[0] = *output;
+  ocmp[1] = ocmp[0] + symbol_size_in_bytes * source->size_cmp[Y_COMP];
+  ocmp[2] = ocmp[1] + symbol_size_in_bytes * source->size_cmp[U_COMP];
+
+#if defined(__SSSE3__)
+  if (symbol_size_in_bytes == 1 || symbol_size_in_bytes == 2)
+  {
+    int done = deinterleave_422_ssse3(icmp, ocmp, pattern, num_groups, symbol_size_in_bytes);
+    num_groups -= done;
+    icmp += done * 4 * symbol_size_in_bytes;
+  }
+#endif
+  deinterleave_packed(icmp, ocmp, pattern, 4, num_groups, symbol_size_in_bytes);
+
+  // flip buffers
+  icmp    = *input;
+  *input  = *output;
+  *output = icmp;
+}
+
+static void deinterleave_yuyv ( unsigned char** input, unsigned char** output, FrameFormat *source, int symbol_size_in_bytes)
+{
+  static const int pattern[4] = { 0, 1, 0, 2 };
+  deinterleave_422(input, output, source, symbol_size_in_bytes, pattern);
+}
+
+static void deinterleave_yvyu ( unsigned char** input, unsigned char** output, FrameFormat *source, int symbol_size_in_bytes)
+{
+  static const int pattern[4] = { 0, 2, 0, 1 };
+  deinterleave_422(input, output, source, symbol_size_in_bytes, pattern);
+}
+
+static void deinterleave_uyvy ( unsigned char** input, unsigned char** output, FrameFormat *source, int symbol_size_in_bytes)
+{
+  static const int pattern[4] = { 1, 0, 2, 0 };
+  deinterleave_422(input, output, source, symbol_size_in_bytes, pattern);
+}
+
+static void deinterleave_v210 ( unsigned char** input,       //!< input buffer
+  unsigned char** output,      //!< output buffer
+  FrameFormat *source,         //!< format of source buffer
+  int symbol_size_in_bytes     //!< number of bytes per symbol
+  ) 
+{
+  int i;  
+  // original buffer
+  unsigned char *icmp  = *input;
+
+  unsigned int   *ui32cmp = (unsigned int *) *input;
+  unsigned short *ui16cmp0 = (unsigned short *) *output;
+  unsigned short *ui16cmp1 = ui16cmp0 + source->size_cmp[0];
+  unsigned short *ui16cmp2 = ui16cmp1 + source->size_cmp[1];
+
+  for (i = 0; i < source->size_cmp[U_COMP] / 3; i++) 
+  {
+    // Byte 3          Byte 2          Byte 1          Byte 0
+    // Cr 0                Y 0                 Cb 0
+    // X X 9 8 7 6 5 4 3 2 1 0 9 8 7 6 5 4 3 2 1 0 9 8 7 6 5 4 3 2 1 0
+    *ui16cmp2   = (*ui32cmp & 0x3FF00000)>>20;         // Cr 0
+    *ui16cmp0   = (*ui32cmp & 0xffc00)>>10;            // Y 0
+    *ui16cmp1   = (*(ui32cmp++) & 0x3FF);              // Cb 0
+
+    // Byte 7          Byte 6          Byte 5          Byte 4
+    // Y 2                 Cb 1                Y 1
+    // X X 9 8 7 6 5 4 3 2 1 0 9 8 7 6 5 4 3 2 1 0 9 8 7 6 5 4 3 2 1 0
+    *(ui16cmp0 + 2) = (*ui32cmp & 0x3FF00000)>>20;     // Y 2
+    *(ui16cmp1 + 1) = (*ui32cmp & 0xffc00)>>10;        // Cb 1
+    *(ui16cmp0 + 1) = (*(ui32cmp++) & 0x3FF);          // Y 1
+
+    // Byte 11         Byte 10         Byte 9          Byte 8
+    // Cb 2                Y 3                 Cr 1
+    // X X 9 8 7 6 5 4 3 2 1 0 9 8 7 6 5 4 3 2 1 0 9 8 7 6 5 4 3 2 1 0
+    *(ui16cmp1 + 2) = (*ui32cmp & 0x3FF00000)>>20;     // Cb 2
+    *(ui16cmp0 + 3) = (*ui32cmp & 0xffc00)>>10;        // Y 3
+    *(ui16cmp2 + 1) = (*(ui32cmp++) & 0x3FF);          // Cr 1
+
+    // Byte 15         Byte 14         Byte 13         Byte 12
+    // Y 5                 Cr 2                Y 4
+    // X X 9 8 7 6 5 4 3 2 1 0 9 8 7 6 5 4 3 2 1 0 9 8 7 6 5 4 3 2 1 0
+    *(ui16cmp0 + 5) = (*ui32cmp & 0x3FF00000)>>20;     // Y 2
+    *(ui16cmp2 + 2) = (*ui32cmp & 0xffc00)>>10;        // Cb 1
+    *(ui16cmp0 + 4) = (*(ui32cmp++) & 0x3FF);          // Y 1
+
+    //printf("luma: %d %d %d %d %d %d\n", *(ui16cmp0 + 0), *(ui16cmp0 + 1), *(ui16cmp0 + 2), *(ui16cmp0 + 3), *(ui16cmp0 + 4), *(ui16cmp0 + 5));
+
+    ui16cmp0 += 6;
+    ui16cmp1 += 3;
+    ui16cmp2 += 3;
+  }
+  // flip buffers
+  icmp    = *input;
+  *input  = *output;
+  *output = icmp;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Deinterleave file read buffer to source picture structure
+ ************************************************************************
+ */
+void deinterleave ( unsigned char** input,       //!< input buffer
+                           unsigned char** output,      //!< output buffer
+                           FrameFormat *source,         //!< format of source buffer
+                           int symbol_size_in_bytes     //!< number of bytes per symbol
+                          )
+{
+  if (source->yuv_format == YUV420) 
+  { // UYYVYY 
+    deinterleave_yuv420(input, output, source, symbol_size_in_bytes);
+  }  
+  else if (source->yuv_format == YUV422)
+  {
+    if (source->pixel_format == YUYV || source->pixel_format == YUY2) 
+    {
+      deinterleave_yuyv(input, output, source, symbol_size_in_bytes);
+    }
+    else if (source->pixel_format == YVYU)
+    {
+      deinterleave_yvyu(input, output, source, symbol_size_in_bytes);
+    }
+    else if (source->pixel_format == UYVY) 
+    {
+      deinterleave_uyvy(input, output, source, symbol_size_in_bytes);
+    }
+    else if (source->pixel_format == V210) 
+    {
+      deinterleave_v210(input, output, source, symbol_size_in_bytes);
+    }
+    else {
+      fprintf(stderr, "Unsupported pixel format.\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+  else if (source->yuv_format == YUV444)  
+    deinterleave_yuv444(input, output, source, symbol_size_in_bytes);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Convert one row of (little endian) file samples to image samples
+ ************************************************************************
+ */
+static void row2img ( imgpel *dst, const unsigned char *src, int width, int symbol_size_in_bytes, int bitshift)
+{
+  int i;
+
+  if (symbol_size_in_bytes == sizeof(imgpel) && bitshift == 0)
+  {
+    memcpy(dst, src, width * sizeof(imgpel));
+  }
+  else if (symbol_size_in_bytes == 1)
+  {
+    if (bitshift > 0)
+    {
+      int rnd = 1 << (bitshift - 1);
+      for (i = 0; i < width; i++)
+        dst[i] = (imgpel) ((src[i] + rnd) >> bitshift);
+    }
+    else
+    {
+      for (i = 0; i < width; i++)
+        dst[i] = (imgpel) (src[i] << (-bitshift));
+    }
+  }
+  else if (symbol_size_in_bytes == 2)
+  {
+    const uint16 *src16 = (const uint16 *) src;
+
+    if (bitshift > 0)
+    {
+      int rnd = 1 << (bitshift - 1);
+      for (i = 0; i < width; i++)
+        dst[i] = (imgpel) ((src16[i] + rnd) >> bitshift);
+    }
+    else
+    {
+      for (i = 0; i < width; i++)
+        dst[i] = (imgpel) (src16[i] << (-bitshift));
+    }
+  }
+  else
+  {
+    uint16 ui16;
+    for (i = 0; i < width; i++)
+    {
+      ui16 = 0;
+      memcpy(&ui16, src + i * symbol_size_in_bytes, imin(symbol_size_in_bytes, sizeof(uint16)));
+      dst[i] = (imgpel) rshift_rnd(ui16, bitshift);
+    }
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Convert a plane of (host endian) samples with a row stride of
+ *    "stride" bytes to an image plane, centering or cropping the picture
+ *    if the sizes differ
+ ************************************************************************
+ */
+void plane2img ( imgpel** imgX, const unsigned char* buf, int stride, int size_x, int size_y, int o_size_x, int o_size_y, int symbol_size_in_bytes, int bitshift)
+{
+  int j;
+
+  if (size_x == o_size_x && size_y == o_size_y)
+  {
+    for (j = 0; j < o_size_y; j++)
+      row2img(imgX[j], buf + j * stride, o_size_x, symbol_size_in_bytes, bitshift);
+  }
+  else
+  {
+    int iminwidth   = imin(size_x, o_size_x);
+    int iminheight  = imin(size_y, o_size_y);
+    int dst_offset_x  = 0, dst_offset_y = 0;
+    int offset_x = 0, offset_y = 0; // currently not used
+
+    // determine whether we need to center the copied frame or crop it
+    if ( o_size_x >= size_x ) 
+      dst_offset_x = ( o_size_x  - size_x  ) >> 1;
+
+    if (o_size_y >= size_y) 
+      dst_offset_y = ( o_size_y - size_y ) >> 1;
+
+    // check copied area to avoid copying memory garbage
+    // source
+    iminwidth  =  ( (offset_x + iminwidth ) > size_x ) ? (size_x  - offset_x) : iminwidth;
+    iminheight =  ( (offset_y + iminheight) > size_y ) ? (size_y - offset_y) : iminheight;
+    // destination
+    iminwidth  =  ( (dst_offset_x + iminwidth ) > o_size_x  ) ? (o_size_x  - dst_offset_x) : iminwidth;
+    iminheight =  ( (dst_offset_y + iminheight) > o_size_y )  ? (o_size_y - dst_offset_y) : iminheight;
+
+    for (j = 0; j < iminheight; j++)
+      row2img(&imgX[j + dst_offset_y][dst_offset_x], buf + (j + offset_y) * stride + offset_x * symbol_size_in_bytes, iminwidth, symbol_size_in_bytes, bitshift);
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Convert a little endian file read buffer to an image plane
+ ************************************************************************
+ */
+static void buf2img_le ( imgpel** imgX, unsigned char* buf, int size_x, int size_y, int o_size_x, int o_size_y, int symbol_size_in_bytes, int bitshift)
+{
+  plane2img(imgX, buf, size_x * symbol_size_in_bytes, size_x, size_y, o_size_x, o_size_y, symbol_size_in_bytes, bitshift);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Convert file read buffer to source picture structure
+ ************************************************************************
+ */
+void buf2img_bitshift ( imgpel** imgX,            //!< Pointer to image plane
+                        unsigned char* buf,       //!< Buffer for file output
+                        int size_x,               //!< horizontal size of picture
+                        int size_y,               //!< vertical size of picture
+                        int o_size_x,             //!< horizontal size of picture
+                        int o_size_y,             //!< vertical size of picture
+                        int symbol_size_in_bytes, //!< number of bytes in file used for one pixel
+                        int bitshift              //!< variable for bitdepth expansion
+                       )
+{
+  int i,j;
+
+  uint16 tmp16, ui16;
+  unsigned long  tmp32, ui32;
+
+  // This test should be done once.
+  if (((symbol_size_in_bytes << 3) - bitshift) > (sizeof(imgpel)<< 3))
+  {
+    error ("Source picture has higher bit depth than imgpel data type. \nPlease recompile with larger data type for imgpel.", 500);
+  }
+
+  if (testEndian())
+  {
+    if (size_x != o_size_x || size_y != o_size_y)
+    {
+      error ("Rescaling not supported in big endian architectures. ", 500);
+    }
+
+    // big endian
+    switch (symbol_size_in_bytes)
+    {
+    case 1:
+      {
+        for(j = 0; j < o_size_y; j++)
+        {
+          for(i = 0; i < o_size_x; i++)
+          {
+            imgX[j][i]= (imgpel) rshift_rnd(buf[i + j*size_x], bitshift);
+          }
+        }
+        break;
+      }
+    case 2:
+      {
+        for(j = 0; j < o_size_y; j++)
+        {
+          for(i = 0; i < o_size_x; i++)
+          {
+            memcpy(&tmp16, buf + ((i + j * size_x) * 2), 2);
+            ui16  = (tmp16 >> 8) | ((tmp16 & 0xFF) << 8);
+            imgX[j][i] = (imgpel) rshift_rnd(ui16, bitshift);
+          }
+        }
+        break;
+      }
+    case 4:
+      {
+        for(j = 0; j < o_size_y; j++)
+        {
+          for(i = 0; i < o_size_x; i++)
+          {
+            memcpy(&tmp32, buf + ((i + j * size_x) * 4), 4);
+            ui32  = ((tmp32 & 0xFF00) << 8) | ((tmp32 & 0xFF)<<24) | ((tmp32 & 0xFF0000)>>8) | ((tmp32 & 0xFF000000)>>24);
+            imgX[j][i] = (imgpel) rshift_rnd(ui32, bitshift);
+          }
+        }
+        break;
+      }
+    default:
+      {
+        error ("reading only from formats of 8, 16 or 32 bit allowed on big endian architecture", 500);
+        break;
+      }
+    }
+  }
+  else
+  {
+    // little endian
+    buf2img_le(imgX, buf, size_x, size_y, o_size_x, o_size_y, symbol_size_in_bytes, bitshift);
+  }
+}
+
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Convert file read buffer to source picture structure
+ ************************************************************************
+ */
+void buf2img_basic (imgpel** imgX,            //!< Pointer to image plane
+                    unsigned char* buf,       //!< Buffer for file output
+                    int size_x,               //!< horizontal size of picture
+                    int size_y,               //!< vertical size of picture
+                    int o_size_x,             //!< horizontal size of picture
+                    int o_size_y,             //!< vertical size of picture
+                    int symbol_size_in_bytes, //!< number of bytes in file used for one pixel
+                    int dummy                 //!< dummy variable used for allowing function pointer use
+                    )
+{
+  if (symbol_size_in_bytes> sizeof(imgpel))
+  {
+    error ("Source picture has higher bit depth than imgpel data type. \nPlease recompile with larger data type for imgpel.", 500);
+  }
+
+  buf2img_le(imgX, buf, size_x, size_y, o_size_x, o_size_y, symbol_size_in_bytes, 0);
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Convert file read buffer to source picture structure
+ ************************************************************************
+ */
+void buf2img_endian (imgpel** imgX,            //!< Pointer to image plane
+                     unsigned char* buf,       //!< Buffer for file output
+                     int size_x,               //!< horizontal size of picture
+                     int size_y,               //!< vertical size of picture
+                     int o_size_x,             //!< horizontal size of picture
+                     int o_size_y,             //!< vertical size of picture
+                     int symbol_size_in_bytes, //!< number of bytes in file used for one pixel
+                     int dummy                 //!< dummy variable used for allowing function pointer use
+                     )
+{
+  int i,j;
+
+  uint16 tmp16, ui16;
+  unsigned long  tmp32, ui32;
+
+  if (symbol_size_in_bytes > sizeof(imgpel))
+  {
+    error ("Source picture has higher bit depth than imgpel data type. \nPlease recompile with larger data type for imgpel.", 500);
+  }
+
+  if (size_x != o_size_x || size_y != o_size_y)
+  {
+    error ("Rescaling not supported in big endian architectures. ", 500);
+  }
+
+  // big endian
+  switch (symbol_size_in_bytes)
+  {
+  case 1:
+    {
+      for(j=0;j<size_y;j++)
+      {
+        for(i=0;i<size_x;i++)
+        {
+          imgX[j][i]= (imgpel) buf[i + j*size_x];
+        }
+      }
+      break;
+    }
+  case 2:
+    {
+      for(j=0;j<size_y;j++)
+      {
+        for(i=0;i<size_x;i++)
+        {
+          memcpy(&tmp16, buf+((i+j*size_x)*2), 2);
+          ui16  = (tmp16 >> 8) | ((tmp16&0xFF)<<8);
+          imgX[j][i] = (imgpel) ui16;
+        }
+      }
+      break;
+    }
+  case 4:
+    {
+      for(j=0;j<size_y;j++)
+      {
+        for(i=0;i<size_x;i++)
+        {
+          memcpy(&tmp32, buf+((i+j*size_x)*4), 4);
+          ui32  = ((tmp32&0xFF00)<<8) | ((tmp32&0xFF)<<24) | ((tmp32&0xFF0000)>>8) | ((tmp32&0xFF000000)>>24);
+          imgX[j][i] = (imgpel) ui32;
+        }
+      }
+      break;
+    }
+  default:
+    {
+      error ("reading only from formats of 8, 16 or 32 bit allowed on big endian architecture", 500);
+      break;
+    }
+  }   
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Repeat the last sample of each row up to the coded picture width
+ ************************************************************************
+ */
+static void pad_right ( imgpel **img, int width, int height, int img_size_x)
+{
+  int x, y;
+
+  for (y = 0; y < height; y++)
+  {
+    imgpel *row = img[y];
+    imgpel val = row[width - 1];
+    for (x = width; x < img_size_x; x++)
+      row[x] = val;
+  }
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Padding of automatically added border for picture sizes that are not
+ *     multiples of macroblock/macroblock pair size
+ *
+ * \param output
+ *    Image dimensions
+ * \param img_size_x
+ *    coded image horizontal size (luma)
+ * \param img_size_y
+ *    code image vertical size (luma)
+ * \param img_size_x_cr
+ *    coded image horizontal size (chroma)
+ * \param img_size_y_cr
+ *    code image vertical size (chroma)
+ * \param pImage
+ *    image planes
+ ************************************************************************
+ */
+void pad_borders (FrameFormat output, int img_size_x, int img_size_y, int img_size_x_cr, int img_size_y_cr, imgpel **pImage[3])
+{
+  int y;
+
+  // Luma or 1st component
+  // padding right border
+  if (output.width[0] < img_size_x)
+    pad_right(pImage[0], output.width[0], output.height[0], img_size_x);
+
+  // padding bottom border
+  if (output.height[0] < img_size_y)
+    for (y = output.height[0]; y<img_size_y; y++)
+      memcpy(pImage[0][y], pImage[0][y - 1], img_size_x * sizeof(imgpel));
+
+  // Chroma or all other components
+  if (output.yuv_format != YUV400)
+  {
+    int k;
+
+    for (k = 1; k < 3; k++)
+    {
+      //padding right border
+      if (output.width[1] < img_size_x_cr)
+        pad_right(pImage[k], output.width[1], output.height[1], img_size_x_cr);
+
+      //padding bottom border
+      if (output.height[1] < img_size_y_cr)
+        for (y = output.height[1]; y < img_size_y_cr; y++)
+          memcpy(pImage[k][y], pImage[k][y - 1], img_size_x_cr * sizeof(imgpel));
+    }
+  }
+}
@@ -0,0 +1,24 @@
+/*!
+ ************************************************************************
+ * \file img_convert.h
+ *
+ * \brief
+ *    Conversion of file read buffers to image planes
+ *    (deinterleaving, sample size and bit depth conversion, padding)
+ *
+ ************************************************************************
+ */
+
+#ifndef _IMG_CONVERT_H_
+#define _IMG_CONVERT_H_
+
+#include "frame.h"
+
+extern void deinterleave     ( unsigned char** input, unsigned char** output, FrameFormat *source, int symbol_size_in_bytes);
+extern void buf2img_basic    ( imgpel** imgX, unsigned char* buf, int size_x, int size_y, int o_size_x, int o_size_y, int symbol_size_in_bytes, int bitshift);
+extern void buf2img_endian   ( imgpel** imgX, unsigned char* buf, int size_x, int size_y, int o_size_x, int o_size_y, int symbol_size_in_bytes, int bitshift);
+extern void buf2img_bitshift ( imgpel** imgX, unsigned char* buf, int size_x, int size_y, int o_size_x, int o_size_y, int symbol_size_in_bytes, int bitshift);
+extern void plane2img        ( imgpel** imgX, const unsigned char* buf, int stride, int size_x, int size_y, int o_size_x, int o_size_y, int symbol_size_in_bytes, int bitshift);
+extern void pad_borders      ( FrameFormat output, int img_size_x, int img_size_y, int img_size_x_cr, int img_size_y_cr, imgpel **pImage[3]);
+
+#endif
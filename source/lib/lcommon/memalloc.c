@@ -18,6 +18,10 @@
 #include "global.h"
 #include "memalloc.h"
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
 /*!
  ************************************************************************
  * \brief
@@ -837,6 +841,217 @@ void free_mem7Dmv(MotionVector *******array7D)
   }
 }
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Allocation backends of the padded sample planes.
+ *
+ *    The heap backend keeps the rows of a plane packed. The other
+ *    backends start the first visible sample of each row on a cache line
+ *    and round the stride up to whole cache lines; a stride of a multiple
+ *    of 4 KB, which maps all rows of a column to the same cache sets, is
+ *    extended by one more line. Planes are mapped zero filled and, but
+ *    for a header line, not written on allocation, so with first-touch
+ *    placement their pages are placed on the NUMA node of the thread that
+ *    fills them. Planes of a
+ *    huge page and more are 2 MB aligned and advised for transparent huge
+ *    pages or taken from the reserved huge pages.
+ ************************************************************************
+ */
+#define MEM_ROW_ALIGN   64          //!< alignment of the rows in bytes (cache line)
+#define MEM_ALIAS_SIZE  4096        //!< strides of a multiple of this size are extended
+#define MEM_HUGE_PAGE   (2 << 20)
+
+//! bookkeeping of a mapped plane, in the MEM_ROW_ALIGN bytes in front of it
+typedef struct mem_plane_header
+{
+  byte   *base;                     //!< start of the allocation
+  size_t  size;                     //!< size of the mapping (0: heap)
+} MemPlaneHeader;
+
+typedef struct mem_planes_ops
+{
+  int     row_align;                //!< alignment of the row starts and strides in bytes (1: packed)
+  void *(*alloc)(size_t size);      //!< zero filled plane
+  void  (*free) (void *plane);
+} MemPlanesOps;
+
+static void *heap_plane_alloc(size_t size)
+{
+  void *d;
+
+  // calloc leaves the fresh pages of a large plane untouched as well
+  if ((d = calloc(size, 1)) == NULL)
+    no_mem_exit("heap_plane_alloc: plane");
+  return d;
+}
+
+static void heap_plane_free(void *plane)
+{
+  free(plane);
+}
+
+#if defined(__linux__)
+/*!
+ ************************************************************************
+ * \brief
+ *    Map size bytes at a huge page boundary and advise them for
+ *    transparent huge pages
+ ************************************************************************
+ */
+static byte *map_huge_aligned(size_t size)
+{
+  byte *map = (byte *) mmap(NULL, size + MEM_HUGE_PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  size_t head;
+
+  if (map == (byte *) MAP_FAILED)
+    return map;
+
+  head = (MEM_HUGE_PAGE - ((size_t) map & (MEM_HUGE_PAGE - 1))) & (MEM_HUGE_PAGE - 1);
+  if (head)
+    munmap(map, head);
+  munmap(map + head + size, MEM_HUGE_PAGE - head);
+#ifdef MADV_HUGEPAGE
+  madvise(map + head, size, MADV_HUGEPAGE);
+#endif
+  return map + head;
+}
+
+static void *map_plane(size_t size, int backend)
+{
+  size_t total = size + MEM_ROW_ALIGN;
+  byte *base = (byte *) MAP_FAILED;
+  MemPlaneHeader *header;
+
+  if (backend != MEM_PLANES_ALIGNED && total >= MEM_HUGE_PAGE)
+  {
+    total = (total + MEM_HUGE_PAGE - 1) & ~((size_t) MEM_HUGE_PAGE - 1);
+#ifdef MAP_HUGETLB
+    if (backend == MEM_PLANES_HUGETLB)
+      base = (byte *) mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+    // no huge pages reserved
+    if (base == (byte *) MAP_FAILED)
+      base = map_huge_aligned(total);
+  }
+  else
+    base = (byte *) mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+  if (base == (byte *) MAP_FAILED)
+    no_mem_exit("map_plane: plane");
+
+  header = (MemPlaneHeader *) base;
+  header->base = base;
+  header->size = total;
+  return base + MEM_ROW_ALIGN;
+}
+#else
+static void *map_plane(size_t size, int backend)
+{
+  byte *base, *plane;
+  MemPlaneHeader *header;
+
+  // huge pages are not supported, aligned heap memory
+  (void) backend;
+  if ((base = (byte *) malloc(size + 2 * MEM_ROW_ALIGN)) == NULL)
+    no_mem_exit("map_plane: plane");
+
+  plane = base + 2 * MEM_ROW_ALIGN - ((size_t) base & (MEM_ROW_ALIGN - 1));
+  memset(plane, 0, size);
+
+  header = (MemPlaneHeader *) (plane - MEM_ROW_ALIGN);
+  header->base = base;
+  header->size = 0;
+  return plane;
+}
+#endif
+
+static void unmap_plane(void *plane)
+{
+  MemPlaneHeader header = *(MemPlaneHeader *) ((byte *) plane - MEM_ROW_ALIGN);
+
+#if defined(__linux__)
+  if (header.size)
+  {
+    munmap(header.base, header.size);
+    return;
+  }
+#endif
+  free(header.base);
+}
+
+static void *aligned_plane_alloc(size_t size) { return map_plane(size, MEM_PLANES_ALIGNED); }
+static void *thp_plane_alloc    (size_t size) { return map_plane(size, MEM_PLANES_THP); }
+static void *hugetlb_plane_alloc(size_t size) { return map_plane(size, MEM_PLANES_HUGETLB); }
+
+static const MemPlanesOps planes_ops[] =
+{
+  { 1,             heap_plane_alloc,    heap_plane_free },   // MEM_PLANES_HEAP
+  { MEM_ROW_ALIGN, aligned_plane_alloc, unmap_plane     },   // MEM_PLANES_ALIGNED
+  { MEM_ROW_ALIGN, thp_plane_alloc,     unmap_plane     },   // MEM_PLANES_THP
+  { MEM_ROW_ALIGN, hugetlb_plane_alloc, unmap_plane     }    // MEM_PLANES_HUGETLB
+};
+
+static int planes_backend = -1;
+static const MemPlanesOps *p_planes = &planes_ops[MEM_PLANES_HEAP];
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Select the allocation backend of the padded sample planes. The
+ *    strides of the planes depend on the backend, so it is shared by all
+ *    users of the process and fixed by the first call (the heap backend
+ *    without a call).
+ *
+ * \return
+ *    backend in use
+ ************************************************************************
+ */
+int mem_set_planes_backend(int backend)
+{
+  if (planes_backend < 0)
+  {
+    planes_backend = iClip3(MEM_PLANES_HEAP, MEM_PLANES_HUGETLB, backend);
+    p_planes = &planes_ops[planes_backend];
+  }
+  return planes_backend;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Row stride in samples of a plane of width dim1 padded by iPadX
+ *    samples on each side
+ ************************************************************************
+ */
+int get_pel_stride(int dim1, int iPadX)
+{
+  int stride = dim1 + 2 * iPadX;
+  int align = p_planes->row_align / (int) sizeof(imgpel);
+
+  if (align > 1)
+  {
+    stride = (stride + align - 1) / align * align;
+    if ((stride * sizeof(imgpel)) % MEM_ALIAS_SIZE == 0)
+      stride += align;
+  }
+  return stride;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Samples in front of the left padding of the first row, so that
+ *    the first visible sample of each row is aligned
+ ************************************************************************
+ */
+static int get_pel_lead(int iPadX)
+{
+  int align = p_planes->row_align / (int) sizeof(imgpel);
+
+  return (align > 1) ? (align - iPadX % align) % align : 0;
+}
+
 /*!
  ************************************************************************
  * \brief
@@ -882,16 +1097,17 @@ int get_mem2Dpel_pad(imgpel ***array2D, int dim0, int dim1, int iPadY, int iPadX
 {
   int i;
   imgpel *curr = NULL;
-  int iHeight, iWidth;
+  int iHeight, iWidth, iLead;
   
   iHeight = dim0+2*iPadY;
-  iWidth = dim1+2*iPadX;
+  iWidth = get_pel_stride(dim1, iPadX);
+  iLead  = get_pel_lead(iPadX);
   if((*array2D    = (imgpel**)mem_malloc(iHeight*sizeof(imgpel*))) == NULL)
     no_mem_exit("get_mem2Dpel_pad: array2D");
-  if((*(*array2D) = (imgpel* )mem_calloc(iHeight * iWidth, sizeof(imgpel ))) == NULL)
+  if((*(*array2D) = (imgpel* )p_planes->alloc((iLead + iHeight * iWidth) * sizeof(imgpel))) == NULL)
     no_mem_exit("get_mem2Dpel_pad: array2D");
 
-  (*array2D)[0] += iPadX;
+  (*array2D)[0] += iLead + iPadX;
   curr = (*array2D)[0];
   for(i = 1 ; i < iHeight; i++)
   {
@@ -1070,7 +1286,7 @@ void free_mem2Dpel_pad(imgpel **array2D, int iPadY, int iPadX)
   {
     if (*array2D)
     {
-      mem_free (array2D[-iPadY]-iPadX);
+      p_planes->free(array2D[-iPadY] - iPadX - get_pel_lead(iPadX));
     }
     else 
       error ("free_mem2Dpel_pad: trying to free unused memory",100);
@@ -23,6 +23,18 @@
 #include "lagrangian.h"
 #include "quant_params.h"
 
+//! allocation backends of the padded sample planes (get_mem2Dpel_pad() and up)
+typedef enum
+{
+  MEM_PLANES_HEAP    = 0,   //!< packed rows on the heap
+  MEM_PLANES_ALIGNED = 1,   //!< 64-byte aligned row starts and strides
+  MEM_PLANES_THP     = 2,   //!< aligned, planes of 2 MB and more advised for transparent huge pages
+  MEM_PLANES_HUGETLB = 3    //!< aligned, planes of 2 MB and more in reserved huge pages (else as MEM_PLANES_THP)
+} MemPlanesBackend;
+
+extern int  mem_set_planes_backend(int backend);
+extern int  get_pel_stride(int dim1, int iPadX);
+
 extern int  get_mem2Ddist(DistortionData ***array2D, int dim0, int dim1);
 
 extern int  get_mem2Dlm  (LambdaParams ***array2D, int dim0, int dim1);
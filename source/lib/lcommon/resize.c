@@ -14,6 +14,7 @@
 //#include <stdlib.h>
 //#include <malloc.h>
 #include "global.h"
+#include "memalloc.h"
 #include "resize.h"
 
 /****************************************************************************************\
@@ -103,6 +104,65 @@ Up-sampling pyramids macros
 
 typedef int worktype;
 
+/*!
+ ************************************************************************
+ * \brief
+ *    Rows [dst_y0, dst_y1) of the 2:1 single channel pyramid level.
+ *    The vertical filter is applied first on whole source rows and the
+ *    horizontal filter on the column sums, so that both loops run over
+ *    contiguous samples and vectorize; the borders are reflected the way
+ *    PD_LT/PD_RB do it. Requires width >= 4 and an even height >= 4,
+ *    the result is identical to PyrDownG5x5_U8CnR.
+ ************************************************************************
+ */
+void PyrDownG5x5_C1R_Rows( const imgpel* src,
+                           int srcstep,      //stride of source in bytes;
+                           int width,        //width of source;
+                           int height,       //height of source;
+                           imgpel* dst,
+                           int dststep,      //stride of destination in bytes;
+                           int dst_y0,       //first destination row;
+                           int dst_y1        //last destination row (exclusive);
+                           )
+{
+  int  Wd = width/2, W = Wd*2;
+  worktype *col = (worktype *) malloc((W + 4) * sizeof(worktype));
+  int  x, y;
+
+  if (col == NULL)
+    no_mem_exit("PyrDownG5x5_C1R_Rows: col");
+
+  srcstep /= sizeof(src[0]);
+  dststep /= sizeof(dst[0]);
+
+  for (y = dst_y0; y < dst_y1; y++)
+  {
+    int ys = 2 * y;
+    const imgpel *r0 = src + ys * srcstep;
+    const imgpel *r1 = r0 + srcstep;
+    const imgpel *rm1 = (ys > 0) ? r0 - srcstep : r1;
+    const imgpel *rm2 = (ys > 0) ? r0 - 2 * srcstep : r1 + srcstep;
+    const imgpel *r2  = (ys + 2 < height) ? r1 + srcstep : r0;
+    worktype *c = col + 2;
+    imgpel *d = dst + y * dststep;
+
+    // vertical filter
+    for (x = 0; x < W; x++)
+      c[x] = PD_FILTER(rm2[x], rm1[x], r0[x], r1[x], r2[x]);
+
+    // reflected borders
+    c[-1] = c[1];
+    c[-2] = c[2];
+    c[W]  = c[W - 2];
+
+    // horizontal filter
+    for (x = 0; x < Wd; x++)
+      d[x] = (imgpel) PD_SCALE_INT(PD_FILTER(c[2 * x - 2], c[2 * x - 1], c[2 * x], c[2 * x + 1], c[2 * x + 2]));
+  }
+
+  free(col);
+}
+
 /*******************************************************
 only downsample 2:1, the destination is width/2*(height+1)/2;
 ********************************************************/
@@ -126,6 +186,12 @@ int PyrDownG5x5_U8CnR(  const imgpel* src,
 
   assert( Cs == 1 || Cs == 3 );
 
+  if (Cs == 1 && width >= 4 && height >= 4 && !(height & 1))
+  {
+    PyrDownG5x5_C1R_Rows(src, srcstep, width, height, dst, dststep, 0, height / 2);
+    return 0;
+  }
+
   //alloc buffer;
   buf = malloc((width&-2)*2*Cs*sizeof(worktype)*(PD_SZ + 1)); //buf size is 2 times larger than required;
   buffer = buf;
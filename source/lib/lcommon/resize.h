@@ -23,5 +23,14 @@ extern int PyrDownG5x5_U8CnR(  const imgpel* src,
                         int dststep,
                         int Cs 
                      );
+extern void PyrDownG5x5_C1R_Rows( const imgpel* src,
+                        int srcstep,      //stride of source in bytes;
+                        int width,        //width of source;
+                        int height,       //height of source;
+                        imgpel* dst,
+                        int dststep,      //stride of destination in bytes;
+                        int dst_y0,       //first destination row;
+                        int dst_y1        //last destination row (exclusive);
+                     );
 #endif
 
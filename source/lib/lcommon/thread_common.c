@@ -0,0 +1,135 @@
+
+/*!
+ *************************************************************************************
+ * \file thread_common.c
+ *
+ * \brief
+ *    Minimal portable threading primitives
+ *
+ *************************************************************************************
+ */
+
+#include <stdlib.h>
+#include "thread_common.h"
+
+//! start parameters of a thread
+typedef struct thread_start
+{
+  ThreadFunc func;
+  void      *arg;
+} ThreadStart;
+
+#if defined(WIN32) || defined (WIN64)
+
+static DWORD WINAPI thread_entry(LPVOID param)
+{
+  ThreadStart start = *((ThreadStart *) param);
+
+  free(param);
+  start.func(start.arg);
+  return 0;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Create a thread running func(arg)
+ * \return
+ *    0 on success, -1 if the thread could not be created
+ ************************************************************************
+ */
+int thread_create(ThreadHandle *thread, ThreadFunc func, void *arg)
+{
+  ThreadStart *start = (ThreadStart *) malloc(sizeof(ThreadStart));
+
+  if (start == NULL)
+    return -1;
+  start->func = func;
+  start->arg  = arg;
+  if ((*thread = CreateThread(NULL, 0, thread_entry, start, 0, NULL)) == NULL)
+  {
+    free(start);
+    return -1;
+  }
+  return 0;
+}
+
+void thread_join(ThreadHandle thread)
+{
+  WaitForSingleObject(thread, INFINITE);
+  CloseHandle(thread);
+}
+
+void mutex_init    (ThreadMutex *mutex) { InitializeCriticalSection(mutex); }
+void mutex_destroy (ThreadMutex *mutex) { DeleteCriticalSection(mutex); }
+void mutex_lock    (ThreadMutex *mutex) { EnterCriticalSection(mutex); }
+void mutex_unlock  (ThreadMutex *mutex) { LeaveCriticalSection(mutex); }
+
+void cond_init     (ThreadCond *cond) { InitializeConditionVariable(cond); }
+void cond_destroy  (ThreadCond *cond) { (void) cond; }
+void cond_wait     (ThreadCond *cond, ThreadMutex *mutex) { SleepConditionVariableCS(cond, mutex, INFINITE); }
+void cond_signal   (ThreadCond *cond) { WakeConditionVariable(cond); }
+void cond_broadcast(ThreadCond *cond) { WakeAllConditionVariable(cond); }
+
+static SRWLOCK global_lock = SRWLOCK_INIT;
+
+void global_lock_acquire (void) { AcquireSRWLockExclusive(&global_lock); }
+void global_lock_release (void) { ReleaseSRWLockExclusive(&global_lock); }
+
+#else
+
+static void *thread_entry(void *param)
+{
+  ThreadStart start = *((ThreadStart *) param);
+
+  free(param);
+  start.func(start.arg);
+  return NULL;
+}
+
+/*!
+ ************************************************************************
+ * \brief
+ *    Create a thread running func(arg)
+ * \return
+ *    0 on success, -1 if the thread could not be created
+ ************************************************************************
+ */
+int thread_create(ThreadHandle *thread, ThreadFunc func, void *arg)
+{
+  ThreadStart *start = (ThreadStart *) malloc(sizeof(ThreadStart));
+
+  if (start == NULL)
+    return -1;
+  start->func = func;
+  start->arg  = arg;
+  if (pthread_create(thread, NULL, thread_entry, start) != 0)
+  {
+    free(start);
+    return -1;
+  }
+  return 0;
+}
+
+void thread_join(ThreadHandle thread)
+{
+  pthread_join(thread, NULL);
+}
+
+void mutex_init    (ThreadMutex *mutex) { pthread_mutex_init(mutex, NULL); }
+void mutex_destroy (ThreadMutex *mutex) { pthread_mutex_destroy(mutex); }
+void mutex_lock    (ThreadMutex *mutex) { pthread_mutex_lock(mutex); }
+void mutex_unlock  (ThreadMutex *mutex) { pthread_mutex_unlock(mutex); }
+
+void cond_init     (ThreadCond *cond) { pthread_cond_init(cond, NULL); }
+void cond_destroy  (ThreadCond *cond) { pthread_cond_destroy(cond); }
+void cond_wait     (ThreadCond *cond, ThreadMutex *mutex) { pthread_cond_wait(cond, mutex); }
+void cond_signal   (ThreadCond *cond) { pthread_cond_signal(cond); }
+void cond_broadcast(ThreadCond *cond) { pthread_cond_broadcast(cond); }
+
+static pthread_mutex_t global_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void global_lock_acquire (void) { pthread_mutex_lock(&global_lock); }
+void global_lock_release (void) { pthread_mutex_unlock(&global_lock); }
+
+#endif
@@ -0,0 +1,48 @@
+
+/*!
+ *************************************************************************************
+ * \file thread_common.h
+ *
+ * \brief
+ *    Minimal portable threading primitives (threads, mutexes and condition
+ *    variables) on top of POSIX threads or the native Windows API
+ *
+ *************************************************************************************
+ */
+
+#ifndef _THREAD_COMMON_H_
+#define _THREAD_COMMON_H_
+
+#if defined(WIN32) || defined (WIN64)
+# include <windows.h>
+typedef HANDLE             ThreadHandle;
+typedef CRITICAL_SECTION   ThreadMutex;
+typedef CONDITION_VARIABLE ThreadCond;
+#else
+# include <pthread.h>
+typedef pthread_t          ThreadHandle;
+typedef pthread_mutex_t    ThreadMutex;
+typedef pthread_cond_t     ThreadCond;
+#endif
+
+typedef void (*ThreadFunc)(void *arg);
+
+extern int  thread_create   (ThreadHandle *thread, ThreadFunc func, void *arg);
+extern void thread_join     (ThreadHandle thread);
+
+extern void mutex_init      (ThreadMutex *mutex);
+extern void mutex_destroy   (ThreadMutex *mutex);
+extern void mutex_lock      (ThreadMutex *mutex);
+extern void mutex_unlock    (ThreadMutex *mutex);
+
+extern void cond_init       (ThreadCond *cond);
+extern void cond_destroy    (ThreadCond *cond);
+extern void cond_wait       (ThreadCond *cond, ThreadMutex *mutex);
+extern void cond_signal     (ThreadCond *cond);
+extern void cond_broadcast  (ThreadCond *cond);
+
+// process wide lock for code that still works on global state
+extern void global_lock_acquire (void);
+extern void global_lock_release (void);
+
+#endif
@@ -51,11 +51,9 @@ int64 timenorm(int64  cur_time)
 
 #else
 
-static struct timezone tz;
-
 void gettime(TIME_T* time)
 {
-  gettimeofday(time, &tz);
+  gettimeofday(time, NULL);
 }
 
 void init_time(void)